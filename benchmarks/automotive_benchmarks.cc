@@ -0,0 +1,27 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "automotive_benchmarks.hh"
+#include "../examples/automotive/lib/automotive_common.h"
+#include "benchmark.hh"
+
+using sonata::benchmark::Benchmark;
+
+void automotive_benchmarks()
+{
+	// Frames are encoded as normal and then dropped, so that only the codec is
+	// measured.
+	AutomotiveCallbacks benchmarkCallbacks = {};
+	benchmarkCallbacks.ethernet_transmit   = [](const uint8_t *, uint16_t) {};
+	init_callbacks(benchmarkCallbacks);
+
+	const uint64_t PedalData[2] = {0x0123456789ABCDEF, 0xFEDCBA9876543210};
+
+	const Benchmark Benchmarks[] = {
+	  {"automotive.send_data_frame",
+	   [&] { send_data_frame(PedalData, FixedDemoHeader, 2); }},
+	  {"automotive.send_mode_frame",
+	   [&] { send_mode_frame(FixedDemoHeader, DemoModeSimulated); }},
+	};
+	sonata::benchmark::run(Benchmarks);
+}
@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Times the encoding of the automotive demo's Ethernet frames.
+void automotive_benchmarks();
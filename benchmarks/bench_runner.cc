@@ -0,0 +1,48 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "automotive_benchmarks.hh"
+#include "format_benchmarks.hh"
+#include "game_of_life_benchmarks.hh"
+#include "i2c_benchmarks.hh"
+#include "lcd_benchmarks.hh"
+#include "sense_hat_benchmarks.hh"
+#include <debug.hh>
+#include <thread.h>
+
+using Debug = ConditionalDebug<true, "Sonata Benchmark Runner">;
+
+[[noreturn]] void finish_running(const char *message)
+{
+	Debug::log(message);
+
+	while (true)
+	{
+		Timeout t{100};
+		thread_sleep(&t);
+	}
+}
+
+[[noreturn]] void __cheri_compartment("bench_runner") run_benchmarks()
+{
+	format_benchmarks();
+	game_of_life_benchmarks();
+	automotive_benchmarks();
+	i2c_benchmarks();
+	sense_hat_benchmarks();
+	lcd_benchmarks();
+	lcd_image_benchmarks();
+	lcd_console_benchmarks();
+	lcd_scene_benchmarks();
+	finish_running("All benchmarks finished");
+}
+
+extern "C" ErrorRecoveryBehaviour
+compartment_error_handler(ErrorState *frame, size_t mcause, size_t mtval)
+{
+	auto [exceptionCode, registerNumber] = CHERI::extract_cheri_mtval(mtval);
+	Debug::log(
+	  "Exception[ mcause({}), {}, {} ]", mcause, exceptionCode, registerNumber);
+	finish_running("One or more benchmarks failed");
+	return ErrorRecoveryBehaviour::ForceUnwind;
+}
@@ -0,0 +1,200 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <debug.hh>
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread.h>
+
+/**
+ * A small framework for timing code on the Ibex.
+ *
+ * Each benchmark's body is run once to warm up and then `iterations` times,
+ * with the cycle and retired instruction counters read around every run. The
+ * minimum, median and maximum of both are printed in decimal on a single
+ * line:
+ *
+ * ```
+ * bench name=lcd.clean iterations=8 cycles_min=... cycles_median=...
+ *   cycles_max=... instret_min=... instret_median=... instret_max=...
+ * ```
+ *
+ * Benchmarks can report further values with `report_metric`, which prints
+ * `bench name=<name> <metric>=<value>`. `scripts/test_runner.py` collects
+ * these lines. Names must not contain spaces.
+ */
+namespace sonata::benchmark
+{
+	using Debug = ConditionalDebug<true, "Benchmark">;
+
+	/// The most times a benchmark's body can be timed.
+	static constexpr size_t MaxIterations = 32;
+
+	/**
+	 * Reads the 64-bit retired instruction counter, in the same way that
+	 * `rdcycle64` reads the cycle counter.
+	 */
+	static inline uint64_t rdinstret64()
+	{
+		uint32_t low;
+		uint32_t high;
+		uint32_t check;
+		do
+		{
+			__asm__ volatile("csrr %0, minstreth" : "=r"(high));
+			__asm__ volatile("csrr %0, minstret" : "=r"(low));
+			__asm__ volatile("csrr %0, minstreth" : "=r"(check));
+		} while (high != check);
+		return (static_cast<uint64_t>(high) << 32) | low;
+	}
+
+	struct Statistics
+	{
+		uint64_t min;
+		uint64_t median;
+		uint64_t max;
+	};
+
+	struct Measurement
+	{
+		Statistics cycles;
+		Statistics instructions;
+	};
+
+	/// A named piece of code to time.
+	struct Benchmark
+	{
+		const char           *name;
+		std::function<void()> body;
+		size_t                iterations = 16;
+	};
+
+	/**
+	 * Sorts `samples` in place and summarises them.
+	 */
+	inline Statistics summarise(uint64_t *samples, size_t count)
+	{
+		std::sort(samples, samples + count);
+		return {samples[0], samples[count / 2], samples[count - 1]};
+	}
+
+	/**
+	 * Times `body` over `iterations` runs, after one untimed run.
+	 */
+	inline Measurement measure(const std::function<void()> &body,
+	                           size_t                       iterations)
+	{
+		uint64_t cycles[MaxIterations];
+		uint64_t instructions[MaxIterations];
+		iterations = std::clamp<size_t>(iterations, 1, MaxIterations);
+
+		body();
+		for (size_t i = 0; i < iterations; i++)
+		{
+			const uint64_t StartInstructions = rdinstret64();
+			const uint64_t StartCycles       = rdcycle64();
+			body();
+			const uint64_t EndCycles       = rdcycle64();
+			const uint64_t EndInstructions = rdinstret64();
+			cycles[i]       = EndCycles - StartCycles;
+			instructions[i] = EndInstructions - StartInstructions;
+		}
+		return {summarise(cycles, iterations),
+		        summarise(instructions, iterations)};
+	}
+
+	/**
+	 * A number written out in decimal. `Debug::log` prints unsigned integers
+	 * in hexadecimal, and a 64-bit count doesn't fit in a signed integer, so
+	 * the values of bench lines are logged as these.
+	 */
+	class Decimal
+	{
+		char text[21];
+
+		public:
+		explicit Decimal(uint64_t value)
+		{
+			char   digits[20];
+			size_t digitCount = 0;
+			do
+			{
+				digits[digitCount++] = '0' + value % 10;
+				value /= 10;
+			} while (value != 0);
+			size_t length = 0;
+			while (digitCount > 0)
+			{
+				text[length++] = digits[--digitCount];
+			}
+			text[length] = '\0';
+		}
+
+		const char *c_str() const
+		{
+			return text;
+		}
+	};
+
+	inline void
+	report(const char *name, size_t iterations, const Measurement &measurement)
+	{
+		Debug::log("bench name={} iterations={} cycles_min={} cycles_median={} "
+		           "cycles_max={} instret_min={} instret_median={} "
+		           "instret_max={}",
+		           name,
+		           Decimal(std::min(iterations, MaxIterations)).c_str(),
+		           Decimal(measurement.cycles.min).c_str(),
+		           Decimal(measurement.cycles.median).c_str(),
+		           Decimal(measurement.cycles.max).c_str(),
+		           Decimal(measurement.instructions.min).c_str(),
+		           Decimal(measurement.instructions.median).c_str(),
+		           Decimal(measurement.instructions.max).c_str());
+	}
+
+	/**
+	 * Reports a value, such as a rate derived from a measurement, alongside a
+	 * benchmark's timings.
+	 */
+	inline void
+	report_metric(const char *name, const char *metric, uint64_t value)
+	{
+		Debug::log("bench name={} {}={}", name, metric, Decimal(value).c_str());
+	}
+
+	/**
+	 * Times and reports each of the given benchmarks in turn.
+	 */
+	template<size_t N>
+	void run(const Benchmark (&benchmarks)[N])
+	{
+		for (const Benchmark &benchmark : benchmarks)
+		{
+			report(benchmark.name,
+			       benchmark.iterations,
+			       measure(benchmark.body, benchmark.iterations));
+		}
+	}
+
+	/**
+	 * Times and reports each of the given benchmarks in turn, and also
+	 * reports how many times a second the body runs, from its median cycle
+	 * count, as `metric`. The metric's name should end in `_per_s`.
+	 */
+	template<size_t N>
+	void run_with_rate(const Benchmark (&benchmarks)[N], const char *metric)
+	{
+		for (const Benchmark &benchmark : benchmarks)
+		{
+			const Measurement Result =
+			  measure(benchmark.body, benchmark.iterations);
+			report(benchmark.name, benchmark.iterations, Result);
+			const uint64_t Cycles = std::max<uint64_t>(Result.cycles.median, 1);
+			report_metric(benchmark.name, metric, CPU_TIMER_HZ / Cycles);
+		}
+	}
+} // namespace sonata::benchmark
@@ -0,0 +1,36 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ethernet_benchmarks.hh"
+#include <debug.hh>
+#include <thread.h>
+
+using Debug = ConditionalDebug<true, "Sonata Ethernet Benchmark Runner">;
+
+[[noreturn]] void finish_running(const char *message)
+{
+	Debug::log(message);
+
+	while (true)
+	{
+		Timeout t{100};
+		thread_sleep(&t);
+	}
+}
+
+[[noreturn]] void __cheri_compartment("ethernet_bench_runner")
+  run_ethernet_benchmarks()
+{
+	ethernet_benchmarks();
+	finish_running("All benchmarks finished");
+}
+
+extern "C" ErrorRecoveryBehaviour
+compartment_error_handler(ErrorState *frame, size_t mcause, size_t mtval)
+{
+	auto [exceptionCode, registerNumber] = CHERI::extract_cheri_mtval(mtval);
+	Debug::log(
+	  "Exception[ mcause({}), {}, {} ]", mcause, exceptionCode, registerNumber);
+	finish_running("One or more benchmarks failed");
+	return ErrorRecoveryBehaviour::ForceUnwind;
+}
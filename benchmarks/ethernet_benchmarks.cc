@@ -0,0 +1,313 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ethernet_benchmarks.hh"
+#include "../libraries/ksz8851.hh"
+#include "benchmark.hh"
+#include <concepts>
+#include <platform-ethernet.hh>
+
+using namespace sonata::ksz8851;
+using sonata::benchmark::Debug;
+using sonata::benchmark::Measurement;
+
+/// The address that the MAC is given, which every frame is sent to.
+static constexpr MacAddress LocalMac = {0x3a, 0x30, 0x25, 0x24, 0xfe, 0x7c};
+
+/// The EtherType of the frames, the second of IEEE 802's experimental ones.
+static constexpr uint16_t BenchEtherType = 0x88B6;
+
+/// The sizes of frame sent, without their CRC, from the smallest to the
+/// largest that Ethernet allows.
+static constexpr uint16_t FrameSizes[] = {60, 128, 256, 512, 1024, 1514};
+
+/// The frames sent back to back when measuring throughput.
+static constexpr uint32_t BurstFrames = 8;
+
+/// How long to wait for a frame to come back before counting it as lost.
+static constexpr uint64_t ReceiveTimeoutCycles = CPU_TIMER_HZ / 100;
+
+/// The times each benchmark is run.
+static constexpr size_t Iterations = 16;
+
+/// The frame that is sent, which is as large as the largest in the sweep.
+static uint8_t frame[1514];
+
+/// The frames that didn't come back in time during the current benchmark.
+static uint32_t lostFrames;
+
+/// The ways that a looped back frame can be waited for.
+enum class ReceivePath
+{
+	/// Polls the MAC for a received frame.
+	Polling,
+	/// Sleeps on the driver's receive interrupt between polls.
+	Interrupt,
+};
+
+/**
+ * Whether the Ethernet driver lets its receive interrupt be waited for, which
+ * not every version of the RTOS's driver does.
+ */
+template<typename Device>
+concept WithReceiveInterrupt = requires(Device &device, Timeout *timeout) {
+	{ device.receive_interrupt_value() } -> std::convertible_to<uint32_t>;
+	device.receive_interrupt_complete(timeout, uint32_t{0});
+};
+
+/**
+ * The driver's check of a frame before it's sent, which accepts every frame.
+ */
+static bool frame_check(uint8_t *, uint16_t)
+{
+	return true;
+}
+
+/**
+ * Writes the header of the frame, from and to the MAC's own address, and
+ * fills its payload with a pattern.
+ */
+static void frame_build()
+{
+	for (size_t i = 0; i < LocalMac.size(); ++i)
+	{
+		frame[i]                   = LocalMac[i];
+		frame[LocalMac.size() + i] = LocalMac[i];
+	}
+	frame[12] = BenchEtherType >> 8;
+	frame[13] = BenchEtherType & 0xFF;
+	for (size_t i = 14; i < sizeof(frame); ++i)
+	{
+		frame[i] = static_cast<uint8_t>(i);
+	}
+}
+
+/**
+ * Waits for a frame to be received along `Path`. Returns false if none
+ * arrives within `ReceiveTimeoutCycles`.
+ */
+template<ReceivePath Path, typename Device>
+static bool frame_wait(Device &ethernet)
+{
+	const uint64_t Deadline = rdcycle64() + ReceiveTimeoutCycles;
+	while (rdcycle64() < Deadline)
+	{
+		// The interrupt's value is read before polling, so that a frame that
+		// arrives in between wakes the wait rather than being missed.
+		uint32_t interruptValue = 0;
+		if constexpr (Path == ReceivePath::Interrupt)
+		{
+			interruptValue = ethernet.receive_interrupt_value();
+		}
+		if (ethernet.receive_frame().has_value())
+		{
+			return true;
+		}
+		if constexpr (Path == ReceivePath::Interrupt)
+		{
+			Timeout timeout{1};
+			ethernet.receive_interrupt_complete(&timeout, interruptValue);
+		}
+	}
+	return false;
+}
+
+/**
+ * Appends `str` to the name being built in `name`, at `*length`.
+ */
+template<size_t N>
+static void name_append(char (&name)[N], size_t *length, const char *str)
+{
+	while (*str != '\0' && *length < N - 1)
+	{
+		name[(*length)++] = *str++;
+	}
+	name[*length] = '\0';
+}
+
+/**
+ * Writes the name of a benchmark of frames of `size` bytes, of the form
+ * `ethernet.loopback.<path>.<kind>.<size>`, to `name`.
+ */
+template<size_t N>
+static void name_build(char (&name)[N],
+                       const char *path,
+                       const char *kind,
+                       uint16_t    size)
+{
+	char    digits[6];
+	uint8_t digitCount = sizeof(digits) - 1;
+	digits[digitCount] = '\0';
+	do
+	{
+		digits[--digitCount] = '0' + size % 10;
+		size /= 10;
+	} while (size != 0);
+
+	size_t length = 0;
+	name_append(name, &length, "ethernet.loopback.");
+	name_append(name, &length, path);
+	name_append(name, &length, ".");
+	name_append(name, &length, kind);
+	name_append(name, &length, ".");
+	name_append(name, &length, &digits[digitCount]);
+}
+
+/**
+ * Reports the frames lost during the benchmark `name`, if there were any,
+ * and clears the count.
+ */
+static void lost_frames_report(const char *name)
+{
+	if (lostFrames != 0)
+	{
+		sonata::benchmark::report_metric(name, "lost_frames", lostFrames);
+		lostFrames = 0;
+	}
+}
+
+/**
+ * Times sending a frame of `size` bytes and receiving it back along `Path`,
+ * one frame at a time, after one untimed round trip. Only the frames that
+ * come back are timed, so a lost frame doesn't count its whole timeout, and
+ * the rest are counted in `lostFrames`. Returns how many were timed, whose
+ * times are summarised in `measurement`.
+ */
+template<ReceivePath Path, typename Device>
+static size_t
+round_trips_measure(Device &ethernet, uint16_t size, Measurement *measurement)
+{
+	uint64_t cycles[Iterations];
+	uint64_t instructions[Iterations];
+	size_t   received = 0;
+
+	ethernet.send_frame(frame, size, frame_check);
+	frame_wait<Path>(ethernet);
+	for (size_t i = 0; i < Iterations; i++)
+	{
+		const uint64_t StartInstructions = sonata::benchmark::rdinstret64();
+		const uint64_t StartCycles       = rdcycle64();
+		ethernet.send_frame(frame, size, frame_check);
+		const bool     Received        = frame_wait<Path>(ethernet);
+		const uint64_t EndCycles       = rdcycle64();
+		const uint64_t EndInstructions = sonata::benchmark::rdinstret64();
+		if (!Received)
+		{
+			lostFrames++;
+			continue;
+		}
+		cycles[received]       = EndCycles - StartCycles;
+		instructions[received] = EndInstructions - StartInstructions;
+		received++;
+	}
+	if (received != 0)
+	{
+		*measurement = {sonata::benchmark::summarise(cycles, received),
+		                sonata::benchmark::summarise(instructions, received)};
+	}
+	return received;
+}
+
+/**
+ * Times sending a frame of each size and receiving it back along `Path`.
+ *
+ * The round trip is timed one frame at a time, and its median is also
+ * reported in nanoseconds. Frames that don't come back are left out of the
+ * round trip times and reported as lost. The throughput is timed by sending
+ * `BurstFrames` frames back to back, taking any that have come back in
+ * between, and is reported in frames and kilobits (of the frame, without its
+ * CRC) a second.
+ */
+template<ReceivePath Path, typename Device>
+static void frame_size_sweep(Device &ethernet, const char *pathName)
+{
+	char name[48];
+	for (const uint16_t Size : FrameSizes)
+	{
+		name_build(name, pathName, "rtt", Size);
+		Measurement  roundTrip;
+		const size_t RoundTrips =
+		  round_trips_measure<Path>(ethernet, Size, &roundTrip);
+		if (RoundTrips != 0)
+		{
+			sonata::benchmark::report(name, RoundTrips, roundTrip);
+			sonata::benchmark::report_metric(
+			  name,
+			  "rtt_ns",
+			  roundTrip.cycles.median * 1000000000 / CPU_TIMER_HZ);
+		}
+		lost_frames_report(name);
+
+		name_build(name, pathName, "stream", Size);
+		const Measurement Stream = sonata::benchmark::measure(
+		  [&] {
+			  uint32_t received = 0;
+			  for (uint32_t i = 0; i < BurstFrames; ++i)
+			  {
+				  ethernet.send_frame(frame, Size, frame_check);
+				  while (ethernet.receive_frame().has_value())
+				  {
+					  received++;
+				  }
+			  }
+			  while (received < BurstFrames && frame_wait<Path>(ethernet))
+			  {
+				  received++;
+			  }
+			  lostFrames += BurstFrames - std::min(received, BurstFrames);
+		  },
+		  Iterations);
+		sonata::benchmark::report(name, Iterations, Stream);
+		const uint64_t Cycles = std::max<uint64_t>(Stream.cycles.median, 1);
+		const uint64_t FramesPerSecond = BurstFrames * CPU_TIMER_HZ / Cycles;
+		sonata::benchmark::report_metric(name, "frames_per_s", FramesPerSecond);
+		sonata::benchmark::report_metric(
+		  name,
+		  "kbit_per_s",
+		  uint64_t{BurstFrames} * Size * 8 * CPU_TIMER_HZ / Cycles / 1000);
+		lost_frames_report(name);
+	}
+}
+
+/**
+ * Runs the sweep along each receive path that the driver has.
+ */
+template<typename Device>
+static void receive_path_sweeps(Device &ethernet)
+{
+	frame_size_sweep<ReceivePath::Polling>(ethernet, "poll");
+	if constexpr (WithReceiveInterrupt<Device>)
+	{
+		frame_size_sweep<ReceivePath::Interrupt>(ethernet, "interrupt");
+	}
+	else
+	{
+		Debug::log("The Ethernet driver can't wait for its receive interrupt, "
+		           "so only polling is measured");
+	}
+}
+
+void ethernet_benchmarks()
+{
+	EthernetDevice *ethernet = new EthernetDevice();
+	ethernet->mac_address_set(LocalMac);
+	frame_build();
+
+	// Loop frames back inside the PHY, at a fixed 100 Mbit/s full duplex so
+	// that there's no link to negotiate, and so no cable is needed.
+	const uint16_t PhyControl = register_read(Register::Port1MiiBasicControl);
+	register_write(Register::Port1MiiBasicControl,
+	               Port1MiiBasicControl::LocalLoopback |
+	                 Port1MiiBasicControl::ForceSpeed100 |
+	                 Port1MiiBasicControl::ForceFullDuplex);
+	thread_millisecond_wait(10);
+
+	// Drop anything that arrived before the PHY was looped back.
+	while (ethernet->receive_frame().has_value()) {}
+	lostFrames = 0;
+
+	receive_path_sweeps(*ethernet);
+
+	register_write(Register::Port1MiiBasicControl, PhyControl);
+	delete ethernet;
+}
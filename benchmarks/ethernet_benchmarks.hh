@@ -0,0 +1,8 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * Times sending frames through the Ethernet MAC and receiving them back, with
+ * its PHY looped back, across a sweep of frame sizes.
+ */
+void ethernet_benchmarks();
@@ -0,0 +1,29 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "format_benchmarks.hh"
+#include "../examples/automotive/cheri/common.hh"
+#include "../libraries/trace.hh"
+#include "benchmark.hh"
+
+using sonata::benchmark::Benchmark;
+using Trace = sonata::trace::Tracer<16, 1>;
+
+void format_benchmarks()
+{
+	char buffer[32];
+
+	const Benchmark Benchmarks[] = {
+	  {"format.size_t_to_str.zero",
+	   [&] { size_t_to_str_base10(buffer, 0, 0, 0); }},
+	  {"format.size_t_to_str.max",
+	   [&] { size_t_to_str_base10(buffer, UINT32_MAX, 0, 0); }},
+	  {"format.size_t_to_str.padded",
+	   [&] { size_t_to_str_base10(buffer, 1234, 4, 4); }},
+	  {"format.trace_event.no_arguments",
+	   [&] { Trace::event<"Benchmark event">(); }},
+	  {"format.trace_event.two_arguments",
+	   [&] { Trace::event<"Benchmark event {} {}">(1234, UINT32_MAX); }},
+	};
+	sonata::benchmark::run(Benchmarks);
+}
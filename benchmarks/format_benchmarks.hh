@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Times the number formatting and event tracing used by the demos.
+void format_benchmarks();
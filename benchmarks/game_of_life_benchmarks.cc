@@ -0,0 +1,100 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "game_of_life_benchmarks.hh"
+#include "../libraries/game_of_life.hh"
+#include "benchmark.hh"
+#include <string.h>
+
+using namespace sonata::game_of_life;
+using sonata::benchmark::Benchmark;
+
+/*
+ * The Sense HAT demo's original Game of Life, which holds the board as an
+ * array of cells and counts each cell's neighbours in turn.
+ */
+
+static uint8_t reference_neighbours(bool state[8][8], uint8_t y, uint8_t x)
+{
+	uint8_t neighbours = 0u;
+	for (int8_t ny = static_cast<int8_t>(y - 1); ny <= y + 1; ny++)
+	{
+		for (int8_t nx = static_cast<int8_t>(x - 1); nx <= x + 1; nx++)
+		{
+			if ((ny == y && nx == x) || ny < 0 || ny >= 8 || nx < 0 || nx >= 8)
+				continue;
+			neighbours += state[ny][nx];
+		}
+	}
+	return neighbours;
+}
+
+static void reference_step(bool state[8][8])
+{
+	bool result[8][8] = {0u};
+	for (uint8_t y = 0u; y < 8u; y++)
+	{
+		for (uint8_t x = 0u; x < 8u; x++)
+		{
+			uint8_t neighbours = reference_neighbours(state, y, x);
+			if (state[y][x] && neighbours != 2u && neighbours != 3u)
+			{
+				result[y][x] = 0u;
+			}
+			else if (!state[y][x] && neighbours == 3u)
+			{
+				result[y][x] = 1u;
+			}
+			else
+			{
+				result[y][x] = state[y][x];
+			}
+		}
+	}
+	memcpy(state, result, sizeof(bool[8][8]));
+}
+
+/// The Sense HAT demo's octagon, which oscillates forever.
+static constexpr Board Octagon2 = from_rows({
+  0b00011000,
+  0b00100100,
+  0b01000010,
+  0b10000001,
+  0b10000001,
+  0b01000010,
+  0b00100100,
+  0b00011000,
+});
+
+/// The 64x64 world is kept out of the stack.
+static World<8, 8> world;
+
+void game_of_life_benchmarks()
+{
+	bool referenceState[8][8];
+	for (size_t y = 0; y < 8; y++)
+	{
+		for (size_t x = 0; x < 8; x++)
+		{
+			referenceState[y][x] = is_alive(Octagon2, x, y);
+		}
+	}
+	Board board        = Octagon2;
+	Board wrappedBoard = Octagon2;
+	for (size_t row = 0; row < 8; row++)
+	{
+		for (size_t column = 0; column < 8; column++)
+		{
+			world.set_tile(column, row, Octagon2);
+		}
+	}
+
+	const Benchmark Benchmarks[] = {
+	  {"game_of_life.reference.8x8", [&] { reference_step(referenceState); }},
+	  {"game_of_life.bitboard.8x8", [&] { board = step(board); }},
+	  {"game_of_life.bitboard.8x8_wrap",
+	   [&] { wrappedBoard = step(wrappedBoard, true); }},
+	  {"game_of_life.bitboard.64x64_wrap", [&] { world.step(); }, 8},
+	};
+	sonata::benchmark::run_with_rate(Benchmarks, "generations_per_s");
+}
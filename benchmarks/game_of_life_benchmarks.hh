@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Compares the bitboard Game of Life engine with the original array version.
+void game_of_life_benchmarks();
@@ -0,0 +1,89 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "i2c_benchmarks.hh"
+#include "../libraries/i2c_bus.hh"
+#include "benchmark.hh"
+#include <compartment.h>
+#include <platform-i2c.hh>
+
+using sonata::benchmark::Benchmark;
+
+template<class T>
+using Mmio = volatile T *;
+
+/// The AS6212 temperature sensor on `i2c1`.
+static constexpr uint8_t TemperatureSensorAddress = 0x48;
+/// The ID EEPROM on `i2c0`.
+static constexpr uint8_t IdEepromAddress = 0x50;
+
+/**
+ * Reads a 16-bit register of the temperature sensor with separate write and
+ * read transactions, as `i2c_example.cc` does.
+ */
+static bool read_temperature_register(Mmio<OpenTitanI2c> i2c, uint8_t reg)
+{
+	uint8_t buf[2] = {reg, 0};
+	if (!i2c->blocking_write(TemperatureSensorAddress, buf, 1, false))
+	{
+		return false;
+	}
+	return i2c->blocking_read(TemperatureSensorAddress, buf, 2u);
+}
+
+/**
+ * Reads `length` bytes of the ID EEPROM from its start.
+ */
+static bool read_id_eeprom(Mmio<OpenTitanI2c> i2c, size_t length)
+{
+	static uint8_t data[0x80];
+	uint8_t        addr[2] = {0};
+	if (!i2c->blocking_write(IdEepromAddress, addr, 2, true))
+	{
+		return false;
+	}
+	return i2c->blocking_read(
+	  IdEepromAddress, data, std::min(length, sizeof(data)));
+}
+
+void i2c_benchmarks()
+{
+	auto i2cSetup = [](Mmio<OpenTitanI2c> i2c) {
+		i2c->reset_fifos();
+		i2c->host_mode_set();
+		i2c->speed_set(100);
+	};
+	auto i2c0 = MMIO_CAPABILITY(OpenTitanI2c, i2c0);
+	auto i2c1 = MMIO_CAPABILITY(OpenTitanI2c, i2c1);
+	i2cSetup(i2c0);
+	i2cSetup(i2c1);
+
+	// The same read through the register layer, with a repeated start in
+	// place of a stop and a new start.
+	const sonata::i2c::Device TemperatureSensor(i2c1, TemperatureSensorAddress);
+
+	constexpr sonata::i2c::Register<int16_t> Temperature{0};
+	int16_t                                  temperature;
+
+	// The same read again, through the I2C bus compartment, to show the cost
+	// of sharing the bus.
+	SealedI2cDevice handle = nullptr;
+	i2c_device_open(
+	  &handle, 1, TemperatureSensorAddress, 100, I2cPriority::Normal);
+	const sonata::i2c::SharedDevice<> SharedTemperatureSensor(handle);
+
+	const Benchmark Benchmarks[] = {
+	  {"i2c.as6212.read_temperature",
+	   [&] { read_temperature_register(i2c1, 0); }},
+	  {"i2c.as6212.read_temperature.device",
+	   [&] { TemperatureSensor.read(Temperature, &temperature); }},
+	  {"i2c.as6212.read_temperature.shared",
+	   [&] { SharedTemperatureSensor.read(Temperature, &temperature); }},
+	  {"i2c.as6212.read_configuration",
+	   [&] { read_temperature_register(i2c1, 1); }},
+	  {"i2c.eeprom.read_16_bytes", [&] { read_id_eeprom(i2c0, 16); }},
+	  {"i2c.eeprom.read_128_bytes", [&] { read_id_eeprom(i2c0, 128); }, 8},
+	};
+	sonata::benchmark::run(Benchmarks);
+	i2c_device_close(handle);
+}
@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Times register reads from the devices on the Sonata's I2C buses.
+void i2c_benchmarks();
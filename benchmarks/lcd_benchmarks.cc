@@ -0,0 +1,221 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "lcd_benchmarks.hh"
+#include "../libraries/lcd.hh"
+#include "../libraries/lcd_console.hh"
+#include "benchmark.hh"
+
+using namespace sonata::lcd;
+using sonata::benchmark::Benchmark;
+
+/// Test image data, large enough for a 32x32 image in either pixel format.
+static uint8_t image[32 * 32 * 3];
+
+/// The rows of a full-screen image drawn at a time, to keep the image small.
+static constexpr uint32_t StripRows = 16;
+static constexpr size_t   StripPixels =
+  internal::Panel::Resolution.width * StripRows;
+
+/// A strip of a full-screen image in either pixel format, and the RGB565
+/// that it's converted to.
+alignas(4) static uint8_t strip[StripPixels * 3];
+alignas(4) static uint8_t stripRgb565[StripPixels * 2];
+
+/// A copy of the screen, which the scene is captured from to be checked.
+static uint8_t framebuffer[internal::Panel::Resolution.width *
+                           internal::Panel::Resolution.height * 2];
+
+/**
+ * Whether the scene's pixels are printed as well as its CRC, for
+ * `scripts/lcd_frames_to_png.py`. This prints about 100 KiB, which takes a
+ * while over the UART.
+ */
+static constexpr bool DumpScene = false;
+
+/**
+ * Converts BGR888 to RGB565 a byte at a time, as the display driver does,
+ * for comparison with `bgr888_to_rgb565`.
+ */
+static void
+bgr888_to_rgb565_per_pixel(const uint8_t *bgr, uint8_t *rgb565, size_t pixels)
+{
+	for (size_t i = 0; i < pixels; i++, bgr += 3, rgb565 += 2)
+	{
+		const uint16_t Pixel =
+		  Color565::from_rgb888(bgr[2] << 16 | bgr[1] << 8 | bgr[0]).rgb565();
+		rgb565[0] = static_cast<uint8_t>(Pixel >> 8);
+		rgb565[1] = static_cast<uint8_t>(Pixel);
+	}
+}
+
+/**
+ * Draws a scene with each of the drawing primitives, from the 32x32 `image`.
+ */
+static void scene_draw(SonataLcd &lcd)
+{
+	const Size Display = lcd.resolution();
+	lcd.clean(Color::Black);
+	lcd.fill_rect(Rect::from_point_and_size({4, 4}, {40, 24}), Color::Red);
+	lcd.fill_rect(Rect::from_point_and_size({48, 4}, {40, 24}),
+	              Color565::from_rgb888(0x00C080));
+	lcd.draw_line({0, 32}, {Display.width - 1, 32}, Color::White);
+	lcd.draw_line({92, 4}, {92, 28}, Color::Blue);
+	lcd.draw_pixel({96, 16}, Color::Green);
+	lcd.draw_str({4, 40},
+	             "Sonata scene",
+	             Color::Black,
+	             Color::White,
+	             Font::LucidaConsole_10pt);
+	lcd.draw_str({4, 60}, "Checked by CRC", Color::Black, Color::Red);
+	lcd.draw_image_rgb565(Rect::from_point_and_size({100, 40}, {32, 32}),
+	                      image);
+	lcd.draw_image_bgr(Rect::from_point_and_size({100, 80}, {16, 16}), image);
+}
+
+void lcd_benchmarks()
+{
+	for (size_t i = 0; i < sizeof(image); i++)
+	{
+		image[i] = static_cast<uint8_t>(i * 7);
+	}
+
+	SonataLcd lcd;
+
+	// The SPI clock that the LCD was calibrated to, and the fill rate that
+	// it reached.
+	const SpiCalibration &Calibration = lcd.spi_calibration();
+	sonata::benchmark::report_metric(
+	  "lcd.spi_calibration", "divider", Calibration.divider);
+	sonata::benchmark::report_metric(
+	  "lcd.spi_calibration", "pixels_per_s", Calibration.pixelsPerSecond);
+
+	const Size  Display = lcd.resolution();
+	const Rect  Square  = Rect::from_point_and_size({16, 16}, {32, 32});
+	const Point Left    = {0, Display.height / 2};
+	const Point Right   = {Display.width - 1, Display.height / 2};
+	const Point Top     = {Display.width / 2, 0};
+	const Point Bottom  = {Display.width / 2, Display.height - 1};
+
+	const Benchmark Benchmarks[] = {
+	  {"lcd.clean", [&] { lcd.clean(Color::Black); }, 8},
+	  {"lcd.fill_rect.32x32", [&] { lcd.fill_rect(Square, Color::Red); }},
+	  {"lcd.draw_pixel", [&] { lcd.draw_pixel({8, 8}, Color::White); }},
+	  {"lcd.draw_line.horizontal",
+	   [&] { lcd.draw_line(Left, Right, Color::Green); }},
+	  {"lcd.draw_line.vertical",
+	   [&] { lcd.draw_line(Top, Bottom, Color::Blue); }},
+	  {"lcd.draw_str.m3x6",
+	   [&] {
+		   lcd.draw_str({4, 100}, "Sonata bench", Color::Black, Color::White);
+	   }},
+	  {"lcd.draw_str.lucida_console_10pt",
+	   [&] {
+		   lcd.draw_str({4, 84},
+		                "Sonata bench",
+		                Color::Black,
+		                Color::White,
+		                Font::LucidaConsole_10pt);
+	   }},
+	  {"lcd.draw_image_rgb565.32x32",
+	   [&] { lcd.draw_image_rgb565(Square, image); }},
+	  {"lcd.draw_image_bgr.32x32", [&] { lcd.draw_image_bgr(Square, image); }},
+	};
+	sonata::benchmark::run(Benchmarks);
+}
+
+void lcd_image_benchmarks()
+{
+	for (size_t i = 0; i < sizeof(strip); i++)
+	{
+		strip[i] = static_cast<uint8_t>(i * 13);
+	}
+
+	// A full screen is drawn as strips of the same image, from top to bottom.
+	SonataLcd      lcd;
+	const Size     Display    = lcd.resolution();
+	const uint32_t Strips     = Display.height / StripRows;
+	const auto     FullScreen = [&](auto draw) {
+		for (uint32_t i = 0; i < Strips; i++)
+		{
+			draw(Rect::from_point_and_size({0, i * StripRows},
+			                               {Display.width, StripRows}));
+		}
+	};
+
+	const Benchmark Benchmarks[] = {
+	  {"lcd.draw_image_bgr.full_screen",
+	   [&] { FullScreen([&](Rect rect) { lcd.draw_image_bgr(rect, strip); }); },
+	   8},
+	  {"lcd.draw_image_rgb565.full_screen",
+	   [&] {
+		   FullScreen([&](Rect rect) { lcd.draw_image_rgb565(rect, strip); });
+	   },
+	   8},
+	  {"lcd.bgr888_to_rgb565.full_screen",
+	   [&] {
+		   for (uint32_t i = 0; i < Strips; i++)
+		   {
+			   bgr888_to_rgb565(strip, stripRgb565, StripPixels);
+		   }
+	   }},
+	  {"lcd.bgr888_to_rgb565.full_screen.per_pixel",
+	   [&] {
+		   for (uint32_t i = 0; i < Strips; i++)
+		   {
+			   bgr888_to_rgb565_per_pixel(strip, stripRgb565, StripPixels);
+		   }
+	   }},
+	};
+	sonata::benchmark::run(Benchmarks);
+}
+
+void lcd_console_benchmarks()
+{
+	// The console scrolls in hardware in portrait, so it is compared against
+	// redrawing every line of the same area, as a log would without it.
+	constexpr uint32_t Lines      = 12;
+	constexpr uint32_t LineHeight = 10;
+
+	SonataLcd  lcd(internal::LCD_Rotate90);
+	LcdConsole console(
+	  lcd, 16, Lines, LineHeight, Color::Black, Color::White);
+	const Rect Area = console.area();
+
+	const Benchmark Benchmarks[] = {
+	  {"lcd.console.append", [&] { console.append("bench: a line of log"); }},
+	  {"lcd.console.redraw",
+	   [&] {
+		   lcd.fill_rect(Area, Color::Black);
+		   for (uint32_t line = 0; line < Lines; line++)
+		   {
+			   lcd.draw_str({2, Area.top + line * LineHeight},
+			                "bench: a line of log",
+			                Color::Black,
+			                Color::White,
+			                Font::M5x7_16pt);
+		   }
+	   }},
+	};
+	sonata::benchmark::run(Benchmarks);
+}
+
+void lcd_scene_benchmarks()
+{
+	for (size_t i = 0; i < sizeof(image); i++)
+	{
+		image[i] = static_cast<uint8_t>(i * 7);
+	}
+
+	SonataLcd       lcd;
+	const Benchmark Benchmarks[] = {
+	  {"lcd.scene", [&] { scene_draw(lcd); }, 8},
+	};
+	sonata::benchmark::run(Benchmarks);
+
+	// The scene is drawn once more with a copy of the screen kept, so that
+	// its CRC can be checked against a golden one even in the simulator.
+	lcd.attach_shadow(framebuffer);
+	scene_draw(lcd);
+	lcd.report_frame("lcd.scene", DumpScene);
+}
@@ -0,0 +1,20 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Times the drawing primitives of `SonataLcd`.
+void lcd_benchmarks();
+
+/**
+ * Times drawing a full screen of BGR888 and RGB565 images, and compares
+ * converting BGR888 to RGB565 a word at a time with a pixel at a time.
+ */
+void lcd_image_benchmarks();
+
+/// Compares appending to an `LcdConsole` with redrawing all of its lines.
+void lcd_console_benchmarks();
+
+/**
+ * Times drawing a scene with each of the drawing primitives, then reports
+ * the CRC of the frame it draws, for golden-image checks.
+ */
+void lcd_scene_benchmarks();
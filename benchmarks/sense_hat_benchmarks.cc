@@ -0,0 +1,30 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "sense_hat_benchmarks.hh"
+#include "../libraries/sense_hat.hh"
+#include "benchmark.hh"
+
+using sonata::benchmark::Benchmark;
+
+void sense_hat_benchmarks()
+{
+	SenseHat         senseHat;
+	SenseHat::Colour off[64]      = {};
+	SenseHat::Colour gradient[64] = {};
+	for (uint8_t i = 0; i < 64; i++)
+	{
+		gradient[i] = {.red   = static_cast<uint8_t>(i >> 1),
+		               .green = i,
+		               .blue  = static_cast<uint8_t>(31 - (i >> 1))};
+	}
+
+	const Benchmark Benchmarks[] = {
+	  {"sense_hat.set_pixels.off", [&] { senseHat.set_pixels(off); }},
+	  {"sense_hat.set_pixels.gradient",
+	   [&] { senseHat.set_pixels(gradient); }},
+	  {"sense_hat.set_pixels.bitboard",
+	   [&] { senseHat.set_pixels(0x8142241818244281, gradient[63], off[0]); }},
+	};
+	sonata::benchmark::run(Benchmarks);
+}
@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Times writes to the Sense HAT's LED matrix.
+void sense_hat_benchmarks();
@@ -0,0 +1,67 @@
+-- Copyright lowRISC Contributors.
+-- SPDX-License-Identifier: Apache-2.0
+
+set_project("Sonata Benchmarks")
+sdkdir = "../cheriot-rtos/sdk"
+includes(sdkdir)
+set_toolchains("cheriot-clang")
+
+includes(path.join(sdkdir, "lib"))
+includes("../libraries")
+includes("../common.lua")
+
+option("board")
+    set_default("sonata-1.1")
+
+-- The benchmarks hold state in globals, so they are built into the runner
+-- compartment rather than as libraries.
+compartment("bench_runner")
+    add_deps("debug", "lcd", "i2c_bus", "sense_hat")
+    add_files("../examples/automotive/lib/automotive_common.c")
+    add_files(
+        "bench_runner.cc",
+        "automotive_benchmarks.cc",
+        "format_benchmarks.cc",
+        "game_of_life_benchmarks.cc",
+        "i2c_benchmarks.cc",
+        "lcd_benchmarks.cc",
+        "sense_hat_benchmarks.cc"
+    )
+
+firmware("sonata_bench_suite")
+    add_deps("freestanding", "bench_runner")
+    on_load(function(target)
+        target:values_set("board", "$(board)")
+        target:values_set("threads", {
+            {
+                compartment = "bench_runner",
+                priority = 20,
+                entry_point = "run_benchmarks",
+                stack_size = 0x1000,
+                trusted_stack_frames = 3
+            },
+        }, {expand = false})
+    end)
+    after_link(convert_to_uf2)
+
+-- The Ethernet benchmarks need the MAC, which the simulator doesn't model, so
+-- they are kept out of the suite and run on the FPGA.
+compartment("ethernet_bench_runner")
+    add_deps("debug", "ksz8851")
+    add_files("ethernet_bench_runner.cc", "ethernet_benchmarks.cc")
+
+firmware("sonata_ethernet_bench")
+    add_deps("freestanding", "ethernet_bench_runner")
+    on_load(function(target)
+        target:values_set("board", "$(board)")
+        target:values_set("threads", {
+            {
+                compartment = "ethernet_bench_runner",
+                priority = 20,
+                entry_point = "run_ethernet_benchmarks",
+                stack_size = 0x1000,
+                trusted_stack_frames = 3
+            },
+        }, {expand = false})
+    end)
+    after_link(convert_to_uf2)
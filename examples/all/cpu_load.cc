@@ -0,0 +1,232 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "../../libraries/cpu_accounting.hh"
+#include "../../libraries/lcd.hh"
+#include <compartment.h>
+#include <debug.hh>
+#include <thread.h>
+
+using namespace sonata::lcd;
+using sonata::cpu_accounting::Load;
+using sonata::cpu_accounting::load_between;
+
+/// Expose debugging features unconditionally for this compartment.
+using Debug = ConditionalDebug<true, "CPU load">;
+
+/// The time between the tables printed over the UART.
+static constexpr uint32_t PrintPeriodMsec = 2000;
+/// The time between updates of the bars drawn on the LCD.
+static constexpr uint32_t DisplayPeriodMsec = 500;
+
+/// The layout of the bars, each of which is a row with its label on the left
+/// and its percentage on the right.
+static constexpr uint32_t RowHeight    = 12;
+static constexpr uint32_t LabelWidth   = 64;
+static constexpr uint32_t PercentWidth = 28;
+static constexpr uint32_t BarHeight    = 8;
+
+static constexpr Color Background        = Color::Black;
+static constexpr Color TextColour        = Color::White;
+static constexpr Color BusyColour        = Color::Grey;
+static constexpr Color ThreadColour      = Color::Green;
+static constexpr Color CompartmentColour = Color::Blue;
+static constexpr Color UnreportedColour  = Color::Red;
+
+/// A bar of the chart.
+struct Row
+{
+	const char *label;
+	uint32_t    permille;
+	Color       colour;
+};
+
+/// The most bars drawn: the busy and unreported ones, and one for each entry.
+static constexpr size_t MaxRows =
+  2 + CpuAccountingMaxThreads + CpuAccountingMaxCompartments;
+
+/**
+ * Writes `permille` to `text` as a percentage with one decimal place, or as
+ * dashes if the cycles aren't counted.
+ */
+static void percent_format(char (&text)[8], uint32_t permille, bool counted)
+{
+	if (!counted)
+	{
+		text[0] = text[1] = '-';
+		text[2]           = '\0';
+		return;
+	}
+	char   digits[4];
+	size_t digitCount = 0;
+	for (uint32_t whole = permille / 10; digitCount == 0 || whole != 0;
+	     whole /= 10)
+	{
+		digits[digitCount++] = '0' + whole % 10;
+	}
+	size_t length = 0;
+	while (digitCount > 0)
+	{
+		text[length++] = digits[--digitCount];
+	}
+	text[length++] = '.';
+	text[length++] = '0' + permille % 10;
+	text[length++] = '%';
+	text[length]   = '\0';
+}
+
+/**
+ * Takes a snapshot into `after` and returns the load since `before`, which is
+ * then updated to it.
+ */
+static Load load_update(CpuAccountingSnapshot *before,
+                        CpuAccountingSnapshot *after)
+{
+	cpu_accounting_snapshot(after);
+	const Load Result = load_between(*before, *after);
+	*before           = *after;
+	return Result;
+}
+
+/**
+ * Prints the load as a table, with the busy and unreported shares and then a
+ * line for each thread and compartment that has reported.
+ */
+static void table_print(const CpuAccountingSnapshot &snapshot, const Load &load)
+{
+	if (!load.cyclesCounted)
+	{
+		Debug::log("Cycles aren't counted, so only samples are shown; build "
+		           "the RTOS with --scheduler-accounting=y to count them");
+	}
+	// Unsigned integers are logged in hexadecimal, so everything is cast to
+	// int to be logged in decimal.
+	Debug::log("Over {} ms: {}.{}% busy, {}.{}% unreported",
+	           static_cast<int>(load.cycles / (CPU_TIMER_HZ / 1000)),
+	           static_cast<int>(load.busyPermille / 10),
+	           static_cast<int>(load.busyPermille % 10),
+	           static_cast<int>(load.unreportedPermille / 10),
+	           static_cast<int>(load.unreportedPermille % 10));
+	for (size_t i = 0; i < CpuAccountingMaxThreads; i++)
+	{
+		const CpuAccountingEntry &Entry = snapshot.threads[i];
+		if (Entry.name[0] != '\0')
+		{
+			Debug::log("  thread {} {}: {}.{}%, {} samples",
+			           static_cast<int>(i + 1),
+			           static_cast<const char *>(Entry.name),
+			           static_cast<int>(load.threads[i].permille / 10),
+			           static_cast<int>(load.threads[i].permille % 10),
+			           static_cast<int>(load.threads[i].samples));
+		}
+	}
+	for (size_t i = 0; i < CpuAccountingMaxCompartments; i++)
+	{
+		const CpuAccountingEntry &Entry = snapshot.compartments[i];
+		if (Entry.name[0] != '\0')
+		{
+			Debug::log("  compartment {}: {}.{}%, {} calls",
+			           static_cast<const char *>(Entry.name),
+			           static_cast<int>(load.compartments[i].permille / 10),
+			           static_cast<int>(load.compartments[i].permille % 10),
+			           static_cast<int>(load.compartments[i].samples));
+		}
+	}
+}
+
+/**
+ * Fills `rows` with the bars for the load and returns how many there are.
+ * The names are those of `snapshot`.
+ */
+static size_t rows_build(const CpuAccountingSnapshot &snapshot,
+                         const Load                  &load,
+                         Row (&rows)[MaxRows])
+{
+	size_t count  = 0;
+	rows[count++] = {"busy", load.busyPermille, BusyColour};
+	for (size_t i = 0; i < CpuAccountingMaxThreads; i++)
+	{
+		if (snapshot.threads[i].name[0] != '\0')
+		{
+			rows[count++] = {
+			  snapshot.threads[i].name, load.threads[i].permille, ThreadColour};
+		}
+	}
+	for (size_t i = 0; i < CpuAccountingMaxCompartments; i++)
+	{
+		if (snapshot.compartments[i].name[0] != '\0')
+		{
+			rows[count++] = {snapshot.compartments[i].name,
+			                 load.compartments[i].permille,
+			                 CompartmentColour};
+		}
+	}
+	rows[count++] = {"unreported", load.unreportedPermille, UnreportedColour};
+	return count;
+}
+
+/**
+ * Draws the bar of `row` at `top`, overwriting the one that was there.
+ */
+static void row_draw(SonataLcd &lcd, uint32_t top, const Row &row, bool counted)
+{
+	const uint32_t Width    = lcd.resolution().width;
+	const uint32_t BarLeft  = LabelWidth;
+	const uint32_t BarRight = Width - PercentWidth;
+	const uint32_t BarTop   = top + (RowHeight - BarHeight) / 2;
+	const uint32_t Filled =
+	  BarLeft + (BarRight - BarLeft - 1) * row.permille / 1000;
+
+	lcd.fill_rect({0, top, BarLeft, top + RowHeight}, Background);
+	lcd.draw_str({2, top}, row.label, Background, TextColour);
+	lcd.fill_rect({BarLeft, BarTop, Filled + 1, BarTop + BarHeight},
+	              row.colour);
+	lcd.fill_rect({Filled + 1, BarTop, BarRight, BarTop + BarHeight},
+	              Background);
+
+	char percent[8];
+	percent_format(percent, row.permille, counted);
+	lcd.fill_rect({BarRight, top, Width, top + RowHeight}, Background);
+	lcd.draw_str({BarRight + 2, top}, percent, Background, TextColour);
+}
+
+/// Thread entry point, which prints the load over the UART.
+[[noreturn]] void __cheri_compartment("cpu_load") cpu_load_print()
+{
+	CpuAccountingSnapshot before = {};
+	CpuAccountingSnapshot after;
+	cpu_accounting_snapshot(&before);
+	while (true)
+	{
+		thread_millisecond_wait(PrintPeriodMsec);
+		cpu_accounting_sample("cpu_load_print");
+		table_print(after, load_update(&before, &after));
+	}
+}
+
+/// Thread entry point, which draws the load as bars on the LCD.
+[[noreturn]] void __cheri_compartment("cpu_load") cpu_load_display()
+{
+	auto lcd = SonataLcd(internal::LCD_Rotate90);
+	lcd.clean(Background);
+
+	CpuAccountingSnapshot before = {};
+	CpuAccountingSnapshot after;
+	cpu_accounting_snapshot(&before);
+	while (true)
+	{
+		thread_millisecond_wait(DisplayPeriodMsec);
+		cpu_accounting_sample("cpu_load_display");
+		const Load Current = load_update(&before, &after);
+
+		// Entries are never removed, so the rows only ever grow, and each
+		// is drawn over the last.
+		Row          rows[MaxRows];
+		const size_t Count    = rows_build(after, Current, rows);
+		const size_t MaxShown = lcd.resolution().height / RowHeight;
+		for (size_t i = 0; i < std::min(Count, MaxShown); i++)
+		{
+			row_draw(lcd, i * RowHeight, rows[i], Current.cyclesCounted);
+		}
+	}
+}
@@ -1,6 +1,7 @@
 // Copyright lowRISC Contributors.
 // SPDX-License-Identifier: Apache-2.0
 
+#include "../../libraries/cpu_accounting.hh"
 #include <compartment.h>
 #include <platform-uart.hh>
 #include <thread.h>
@@ -13,6 +14,9 @@
 	char ch = '\n';
 	while (true)
 	{
+		// The read spins until a character arrives, so this thread only
+		// reports its cycles once it gets one.
+		cpu_accounting_sample("echo");
 		ch = uart->blocking_read();
 		uart->blocking_write(ch);
 	}
@@ -1,33 +1,31 @@
 // Copyright lowRISC Contributors.
 // SPDX-License-Identifier: Apache-2.0
 
+#include "../../libraries/i2c_bus.hh"
 #include <compartment.h>
 #include <ctype.h>
 #include <debug.hh>
-#include <platform-i2c.hh>
 #include <thread.h>
 
 /// Expose debugging features unconditionally for this compartment.
 using Debug = ConditionalDebug<true, "i2c example">;
 
-template<class T>
-using Mmio = volatile T *;
+using sonata::i2c::Register;
+using sonata::i2c::SharedDevice;
+
+/// The AS6212 temperature sensor's registers.
+constexpr Register<int16_t> TemperatureRegister{0};
+constexpr Register<int16_t> ConfigurationRegister{1};
 
 /// Read from the AS612 Temperature Sensor
-static void read_temperature_sensor_value(Mmio<OpenTitanI2c> i2c,
-                                          const char        *regName,
-                                          const uint8_t      RegIdx)
+static void read_temperature_sensor_value(const SharedDevice<> &sensor,
+                                          const char           *regName,
+                                          Register<int16_t>     reg)
 {
-	uint8_t buf[2] = {RegIdx, 0};
-	if (!i2c->blocking_write(0x48, buf, 1, false))
-	{
-		Debug::log("Could not write the {} address", regName);
-		return;
-	}
-	if (i2c->blocking_read(0x48, buf, 2u))
+	int16_t regValue;
+	if (sensor.read(reg, &regValue))
 	{
-		int16_t regValue = static_cast<int16_t>((buf[0] << 8) | buf[1]);
-		int64_t temp     = regValue * 1000000LL / 128;
+		int64_t temp = regValue * 1000000LL / 128;
 		Debug::log("The {} readout is {} microdegrees Celcius", regName, temp);
 	}
 	else
@@ -37,24 +35,28 @@ static void read_temperature_sensor_value(Mmio<OpenTitanI2c> i2c,
 	}
 }
 
-static void id_eeprom_report(Mmio<OpenTitanI2c> i2c, const uint8_t IdAddr)
+static void id_eeprom_report(uint8_t bus, const uint8_t IdAddr)
 {
-	uint8_t addr[2] = {0};
-	if (!i2c->blocking_write(0x50u, addr, 2, true))
+	SealedI2cDevice handle;
+	if (i2c_device_open(&handle, bus, IdAddr, 100, I2cPriority::Low) != 0)
 	{
-		Debug::log("Could not write the ID EEPROM address");
+		Debug::log("Failed to open the EEPROM at address {}", IdAddr);
 		return;
 	}
+	// The ID EEPROM takes 16-bit addresses.
+	const SharedDevice<uint16_t> Eeprom(handle);
 
 	static uint8_t data[0x80];
 	// Initialize the buffer to known contents in case of read issues.
 	memset(data, 0xddu, sizeof(data));
 
-	if (!i2c->blocking_read(IdAddr, data, sizeof(data)))
+	if (!Eeprom.read(0, data, sizeof(data)))
 	{
 		Debug::log("Failed to read EEPROM ID of device at address {}", IdAddr);
+		i2c_device_close(handle);
 		return;
 	}
+	i2c_device_close(handle);
 
 	Debug::log("EEPROM ID of device at address {}:", IdAddr);
 	for (size_t idx = 0u; idx + 4 < sizeof(data); idx += 4)
@@ -74,24 +76,42 @@ static void id_eeprom_report(Mmio<OpenTitanI2c> i2c, const uint8_t IdAddr)
 	}
 }
 
-[[noreturn]] void __cheri_compartment("i2c_example") run()
+/// Logs how busy I2C bus `bus` has been since this was last called.
+static void report_bus_statistics(uint8_t bus)
 {
-	auto i2cSetup = [](Mmio<OpenTitanI2c> i2c) {
-		i2c->reset_fifos();
-		i2c->host_mode_set();
-		i2c->speed_set(100);
-	};
-	auto i2c0 = MMIO_CAPABILITY(OpenTitanI2c, i2c0);
-	auto i2c1 = MMIO_CAPABILITY(OpenTitanI2c, i2c1);
-	i2cSetup(i2c0);
-	i2cSetup(i2c1);
+	I2cBusStatistics statistics;
+	if (i2c_bus_statistics(bus, &statistics, true) != 0)
+	{
+		return;
+	}
+	Debug::log("I2C bus {}: {} transfers ({} failed), {} bytes, busy for {} "
+	           "of {} cycles, at most {} waiting",
+	           bus,
+	           statistics.transfers,
+	           statistics.failedTransfers,
+	           statistics.bytesTransferred,
+	           statistics.busyCycles,
+	           statistics.elapsedCycles,
+	           statistics.maxQueueDepth);
+}
 
-	id_eeprom_report(i2c0, 0x50);
+[[noreturn]] void __cheri_compartment("i2c_example") run()
+{
+	id_eeprom_report(0, 0x50);
 
-	read_temperature_sensor_value(i2c1, "temporature sensor configuration", 1);
+	SealedI2cDevice handle;
+	const int       Opened =
+	  i2c_device_open(&handle, 1, 0x48, 100, I2cPriority::Normal);
+	Debug::Assert(Opened == 0, "Failed to open the temperature sensor");
+	const SharedDevice<> TemperatureSensor(handle);
+	read_temperature_sensor_value(TemperatureSensor,
+	                              "temporature sensor configuration",
+	                              ConfigurationRegister);
 	while (true)
 	{
-		read_temperature_sensor_value(i2c1, "temporature", 0);
+		read_temperature_sensor_value(
+		  TemperatureSensor, "temporature", TemperatureRegister);
+		report_bus_statistics(1);
 		thread_millisecond_wait(4000);
 	}
 }
@@ -4,67 +4,100 @@
 #include <compartment.h>
 #include <thread.h>
 
+#include "../../libraries/cpu_accounting.hh"
 #include "../../libraries/lcd.hh"
 #include "../snake/cherry_bitmap.h"
-#include "lowrisc_logo_light.h"
+#ifdef SONATA_XL
+#	include "lowrisc_logo_dark.h"
+#else
+#	include "lowrisc_logo_light.h"
+#endif
 
 using namespace sonata::lcd;
 
+/// The resolution that the positions below are laid out for.
+static constexpr Size ReferenceResolution = {128, 160};
+
 // Positions to draw messages on the screen
 static constexpr Point TopMessagePos       = {24, 6};
-static constexpr Size  TopMessageOffset    = {14, 14};
 static constexpr Point BottomMessagePos    = {24, 136};
 static constexpr Size  BottomMessageOffset = {77, 0};
 
-/// Thread entry point.
-void __cheri_compartment("lcd_test") lcd_test()
+/// How the demo looks on each board.
+struct Theme
+{
+	const char    *boardName;
+	Size           boardNameOffset;
+	const uint8_t *logo;
+	Color          background;
+	Color          foreground;
+};
+
+/// The cherry, whose black background is transparent.
+static const Sprite CherrySprite = {{10, 10},
+                                    cherryImage10x10,
+                                    Color565(Color::Black)};
+
+#ifdef SONATA_XL
+/// The Sonata XL build of the demo is its own compartment, which only
+/// changes the theme.
+#	define LCD_TEST_COMPARTMENT "lcd_test_xl"
+static const Theme DemoTheme = {"Sonata XL!",
+                                {2, 14},
+                                lowriscLogoDark105x80,
+                                Color::Black,
+                                Color::White};
+#else
+#	define LCD_TEST_COMPARTMENT "lcd_test"
+static const Theme DemoTheme = {"Sonata!",
+                                {14, 14},
+                                lowriscLogoLight105x80,
+                                Color::White,
+                                Color::Black};
+#endif
+
+/**
+ * Thread entry point, which draws the demo with its positions scaled from the
+ * reference resolution to the LCD's, then waits forever.
+ */
+void __cheri_compartment(LCD_TEST_COMPARTMENT) lcd_test()
 {
+	const Theme &theme = DemoTheme;
+
 	// Initialise the LCD
 	auto lcd    = SonataLcd(sonata::lcd::internal::LCD_Rotate90);
 	auto screen = Rect::from_point_and_size(Point::ORIGIN, lcd.resolution());
+	const Layout Scale(ReferenceResolution, lcd.resolution());
+	lcd.clean(theme.background);
 
 	// Draw the lowRISC logo to the LCD
 	auto logoRect = screen.centered_subrect({105, 80});
-	lcd.draw_image_rgb565(logoRect, lowriscLogoLight105x80);
-
-	// Make a version of the cherry bitmap with a white background.
-	uint8_t cherryImage10x10WhiteBg[200];
-	for (uint32_t i = 0; i < 200; i += 2)
-	{
-		if (cherryImage10x10[i] == 0x00 && cherryImage10x10[i + 1] == 0x00)
-		{
-			cherryImage10x10WhiteBg[i]     = 0xFF;
-			cherryImage10x10WhiteBg[i + 1] = 0xFF;
-		}
-		else
-		{
-			cherryImage10x10WhiteBg[i]     = cherryImage10x10[i];
-			cherryImage10x10WhiteBg[i + 1] = cherryImage10x10[i + 1];
-		}
-	}
-	const uint8_t *img = static_cast<const uint8_t *>(cherryImage10x10WhiteBg);
+	lcd.draw_image_rgb565(logoRect, theme.logo);
 
 	// Draw the messages & cherry image to the LCD
-	lcd.draw_str(TopMessagePos,
+	const Point TopPos    = Scale.at(TopMessagePos);
+	const Point BottomPos = Scale.at(BottomMessagePos);
+	lcd.draw_str(TopPos,
 	             "Running on",
-	             Color::White,
-	             Color::Black,
+	             theme.background,
+	             theme.foreground,
 	             Font::LucidaConsole_10pt);
-	lcd.draw_str(Point::offset(TopMessagePos, TopMessageOffset),
-	             "Sonata!",
-	             Color::White,
-	             Color::Black,
+	lcd.draw_str(Point::offset(TopPos, Scale.scale(theme.boardNameOffset)),
+	             theme.boardName,
+	             theme.background,
+	             theme.foreground,
 	             Font::LucidaConsole_10pt);
-	lcd.draw_str(BottomMessagePos,
+	lcd.draw_str(BottomPos,
 	             "Protected by CHERI",
-	             Color::White,
-	             Color::Black,
+	             theme.background,
+	             theme.foreground,
 	             Font::M3x6_16pt);
-	Point imgPos = Point::offset(BottomMessagePos, BottomMessageOffset);
-	lcd.draw_image_rgb565(Rect::from_point_and_size(imgPos, {10, 10}), img);
+	Point imgPos = Point::offset(BottomPos, Scale.scale(BottomMessageOffset));
+	lcd.draw_sprite(imgPos, CherrySprite, theme.background);
 
 	while (true)
 	{
+		cpu_accounting_sample("lcd_test");
 		thread_millisecond_wait(500);
 	}
 }
@@ -1,6 +1,7 @@
 // Copyright lowRISC Contributors.
 // SPDX-License-Identifier: Apache-2.0
 
+#include "../../libraries/cpu_accounting.hh"
 #include <compartment.h>
 #include <debug.hh>
 #include <platform-gpio.hh>
@@ -22,6 +23,7 @@ void __cheri_compartment("led_walk_raw") start_walking()
 	bool switchOn = true;
 	while (true)
 	{
+		cpu_accounting_sample("led_walk_raw");
 		if (switchOn)
 		{
 			gpio->led_on(count);
@@ -3,112 +3,61 @@
 
 // This examples requires a APDS9960 sensor
 // (https://www.adafruit.com/product/3595) connected to the qwiic0 connector.
-
+//
+// The `run` thread waits for the sensor to report a change in proximity and
+// publishes it, and the `display` thread fades the RGB LEDs to each change,
+// through the RGB LED animation compartment, and optionally shows it on the
+// Sense HAT. Nothing is read from the sensor or written
+// to the LEDs while the proximity stays the same. Wire the sensor's INT pin
+// to the mikroBUS INT pin under header P7 and set `INTERRUPT_PIN_WIRED` so
+// that the sensor doesn't need to be asked whether anything has changed.
+
+#include "../../libraries/apds9960.hh"
+#include "../../libraries/rgbled_animation.hh"
 #include "../../libraries/sense_hat.hh"
+#include "../../libraries/trace.hh"
 #include <compartment.h>
 #include <ctype.h>
 #include <debug.hh>
-#include <platform-i2c.hh>
-#include <platform-rgbctrl.hh>
+#include <futex.h>
+#include <platform-gpio.hh>
 #include <thread.h>
+#include <tick_macros.h>
 
-const uint8_t ApdS9960Enable = 0x80;
-const uint8_t ApdS9960Id     = 0x92;
-const uint8_t ApdS9960Ppc    = 0x8E;
-const uint8_t ApdS9960CR1    = 0x8F;
-const uint8_t ApdS9960Pdata  = 0x9C;
+#define SENSE_HAT_AVAILABLE false
+#define INTERRUPT_PIN_WIRED false
 
-const uint8_t ApdS9960IdExp      = 0xAB;
-const uint8_t ApdS9960I2cAddress = 0x39;
+/// The GPIO input of the mikroBUS INT pin, which the sensor's INT is wired to.
+static constexpr uint32_t InterruptPin = 1 << 13;
+/// How often to check for a change, when the INT pin is wired or not.
+static constexpr uint32_t InterruptPinPollMsec = 20;
+static constexpr uint32_t StatusPollMsec       = 100;
+/// How long the RGB LEDs take to fade to a new proximity.
+static constexpr uint16_t LedFadeMsec = 100;
 
-#define SENSE_HAT_AVAILABLE false
+/// The number of samples that the trace's ring holds.
+static constexpr uint32_t TraceCapacity = 16;
+/// How long the proximity must stay the same before the trace is written out.
+static constexpr uint32_t TraceFlushMsec = 500;
 
 /// Expose debugging features unconditionally for this compartment.
 using Debug = ConditionalDebug<true, "proximity sensor example">;
+/// Samples are traced and written out in batches rather than logged each time.
+using Trace = sonata::trace::Tracer<TraceCapacity, 1>;
 
 template<class T>
 using Mmio = volatile T *;
 
-static void setup_proximity_sensor(Mmio<OpenTitanI2c> i2c, const uint8_t Addr)
-{
-	uint8_t buf[2];
-
-	buf[0] = ApdS9960Id;
-
-	if (!i2c->blocking_write(ApdS9960I2cAddress, buf, 1, false))
-	{
-		Debug::log("Failed to write proximity sensor address");
-		return;
-	}
-	bool success = i2c->blocking_read(ApdS9960I2cAddress, buf, 1);
-	Debug::Assert(success, "Failed to read proximity sensor ID");
-
-	Debug::log("Proximity sensor ID: {}", buf[0]);
-
-	Debug::Assert(buf[0] == ApdS9960IdExp,
-	              "Proximity sensor ID was not expected value of {}, saw {}",
-	              ApdS9960IdExp,
-	              buf[0]);
-
-	// Disable everything
-	buf[0] = ApdS9960Enable;
-	buf[1] = 0x0;
-	if (!i2c->blocking_write(ApdS9960I2cAddress, buf, 2, true))
-	{
-		Debug::log("Failed to write proximity sensor address");
-		return;
-	}
-	// Wait for all engines to go idle
-	thread_millisecond_wait(25);
-
-	// Set PEN (proximity enable) and PON (power on)
-	buf[0] = ApdS9960Enable;
-	buf[1] = 0x5;
-	if (!i2c->blocking_write(ApdS9960I2cAddress, buf, 2, true))
-	{
-		Debug::log("Failed to write proximity sensor address");
-		return;
-	}
-	// Wait for power on
-	thread_millisecond_wait(10);
-
-	// Set proximity gain to 8x
-	buf[0] = ApdS9960CR1;
-	buf[1] = 0x0c;
-	if (!i2c->blocking_write(ApdS9960I2cAddress, buf, 2, true))
-	{
-		Debug::log("Failed to write proximity sensor address");
-		return;
-	}
-
-	// Set proximity pulse length to 4us and pulse count to 16us
-	// (experimentially determined, other values may work better!)
-	buf[0] = ApdS9960Ppc;
-	buf[1] = 0x04;
-	if (!i2c->blocking_write(ApdS9960I2cAddress, buf, 2, true))
-	{
-		Debug::log("Failed to write proximity sensor address");
-		return;
-	}
-}
+/**
+ * The latest proximity in the low byte and a count of changes above it, so
+ * that the `display` thread can wait on it as a futex for the next change.
+ */
+static uint32_t proximityEvent = 0;
 
-static uint8_t read_proximity_sensor(Mmio<OpenTitanI2c> i2c)
+static void publish_proximity(uint8_t proximity)
 {
-	uint8_t buf[1];
-
-	buf[0] = ApdS9960Pdata;
-	if (!i2c->blocking_write(ApdS9960I2cAddress, buf, 1, false))
-	{
-		Debug::log("Failed to write proximity sensor address");
-		return 0;
-	}
-	if (!i2c->blocking_read(ApdS9960I2cAddress, buf, 1))
-	{
-		Debug::log("Failed to read proximity sensor value");
-		return 0;
-	}
-
-	return buf[0];
+	proximityEvent = ((proximityEvent + 0x100) & ~0xFFu) | proximity;
+	futex_wake(&proximityEvent, UINT32_MAX);
 }
 
 void update_sense_hat(SenseHat *senseHat, uint8_t prox)
@@ -136,7 +85,41 @@ void update_sense_hat(SenseHat *senseHat, uint8_t prox)
 	senseHat->set_pixels(fb);
 }
 
+/// Thread entry point that waits for the proximity to change.
 [[noreturn]] void __cheri_compartment("proximity_sensor_example") run()
+{
+	auto gpio = MMIO_CAPABILITY(SonataGpioBoard, gpio_board);
+
+	// The sensor is on the qwiic0 connector, which is on I2C bus 0.
+	Apds9960 sensor(0, 1);
+	Debug::Assert(sensor.init(), "Failed to set up the proximity sensor");
+
+	uint8_t proximity = 0;
+	if (sensor.acknowledge(&proximity))
+	{
+		publish_proximity(proximity);
+	}
+	while (true)
+	{
+		// The INT pin is active low.
+		const bool Changed = INTERRUPT_PIN_WIRED
+		                       ? (gpio->input & InterruptPin) == 0
+		                       : sensor.interrupt_pending();
+		if (!Changed)
+		{
+			thread_millisecond_wait(INTERRUPT_PIN_WIRED ? InterruptPinPollMsec
+			                                            : StatusPollMsec);
+			continue;
+		}
+		if (sensor.acknowledge(&proximity))
+		{
+			publish_proximity(proximity);
+		}
+	}
+}
+
+/// Thread entry point that shows each change in proximity.
+[[noreturn]] void __cheri_compartment("proximity_sensor_example") display()
 {
 	// Initialise the Sense HAT if we use it in this demo
 	SenseHat *senseHat = NULL;
@@ -145,38 +128,48 @@ void update_sense_hat(SenseHat *senseHat, uint8_t prox)
 		senseHat = new SenseHat();
 	}
 
-	auto i2cSetup = [](Mmio<OpenTitanI2c> i2c) {
-		i2c->reset_fifos();
-		i2c->host_mode_set();
-		i2c->speed_set(1);
-	};
-
-	auto i2c0 = MMIO_CAPABILITY(OpenTitanI2c, i2c0);
-	i2cSetup(i2c0);
-	uint8_t addr;
-
-	auto rgbled = MMIO_CAPABILITY(SonataRgbLedController, rgbled);
-
-	setup_proximity_sensor(i2c0, ApdS9960I2cAddress);
-
+	uint32_t seen      = 0;
+	uint32_t unflushed = 0;
 	while (true)
 	{
-		uint8_t prox = read_proximity_sensor(i2c0);
-		Debug::log("Proximity is {}\r", prox);
-		rgbled->rgb(SonataRgbLed::Led0, ((prox) >> 3), 0, 0);
-		rgbled->rgb(SonataRgbLed::Led1, 0, (255 - prox) >> 3, 0);
-		rgbled->update();
+		if (unflushed == 0)
+		{
+			futex_wait(&proximityEvent, seen);
+		}
+		else
+		{
+			Timeout timeout{MS_TO_TICKS(TraceFlushMsec)};
+			futex_timed_wait(&timeout, &proximityEvent, seen);
+		}
+		if (proximityEvent == seen)
+		{
+			// The proximity has settled, so write out the samples traced
+			// since the last flush.
+			Trace::flush();
+			unflushed = 0;
+			continue;
+		}
+		seen         = proximityEvent;
+		uint8_t prox = seen & 0xFF;
+
+		Trace::event<"Proximity is {}">(prox);
+		// Fade to the new proximity, rather than jumping to it, as the
+		// sensor only reports moves outside of its window.
+		const uint8_t Far = UINT8_MAX - prox;
+		rgbled_set(SonataRgbLed::Led0, {prox, 0, 0}, LedFadeMsec);
+		rgbled_set(SonataRgbLed::Led1, {0, Far, 0}, LedFadeMsec);
 
 		if (SENSE_HAT_AVAILABLE)
 		{
 			update_sense_hat(senseHat, prox);
 		}
 
-		thread_millisecond_wait(100);
-	}
-
-	if (SENSE_HAT_AVAILABLE)
-	{
-		delete senseHat;
+		// Write the trace out during a long run of changes too, before its
+		// ring fills and the oldest samples are overwritten.
+		if (++unflushed == TraceCapacity / 2)
+		{
+			Trace::flush();
+			unflushed = 0;
+		}
 	}
 }
@@ -1,42 +1,40 @@
 // Copyright lowRISC Contributors.
 // SPDX-License-Identifier: Apache-2.0
 
+#include "../../libraries/rgbled_animation.hh"
 #include <compartment.h>
-#include <ctype.h>
-#include <platform-rgbctrl.hh>
-#include <thread.h>
+#include <debug.hh>
 
-// The max brightness of the RGB LEDs
-static constexpr uint8_t MaxBrightness = 25;
-// The number of milliseconds per RGB LED update
-static constexpr uint32_t MsecPerUpdate = 150;
+/// Expose debugging features unconditionally for this compartment.
+using Debug = ConditionalDebug<true, "RGB LED lerp">;
 
-[[noreturn]] void __cheri_compartment("rgbled_lerp") lerp_rgbleds()
+// The number of milliseconds to fade between colours
+static constexpr uint16_t FadeMsec = 3750;
+
+/**
+ * Fades the RGB LEDs back and forth between colours forever. The fades are
+ * played by the RGB LED animation compartment's thread, so this thread
+ * posts them and exits.
+ */
+void __cheri_compartment("rgbled_lerp") lerp_rgbleds()
 {
-	// Initialise the LED RGB driver.
-	auto rgbled = MMIO_CAPABILITY(SonataRgbLedController, rgbled);
+	static constexpr RgbLedColour Red   = {255, 0, 0};
+	static constexpr RgbLedColour Green = {0, 255, 0};
+	static constexpr RgbLedColour Blue  = {0, 0, 255};
 
-	bool    increasing = true;
-	uint8_t lerpT      = 0;
-	while (true)
+	const RgbLedKeyframe Led0[] = {
+	  {Green, 0},
+	  {Red, FadeMsec, RgbLedEasing::EaseInOut},
+	  {Green, FadeMsec, RgbLedEasing::EaseInOut},
+	};
+	const RgbLedKeyframe Led1[] = {
+	  {Green, 0},
+	  {Blue, FadeMsec, RgbLedEasing::EaseInOut},
+	  {Green, FadeMsec, RgbLedEasing::EaseInOut},
+	};
+	if (rgbled_animate(SonataRgbLed::Led0, Led0, 3, true) != 0 ||
+	    rgbled_animate(SonataRgbLed::Led1, Led1, 3, true) != 0)
 	{
-		// Update the RGB values by linearly interpolating
-		rgbled->rgb(SonataRgbLed::Led0, lerpT, MaxBrightness - lerpT, 0);
-		rgbled->rgb(SonataRgbLed::Led1, 0, MaxBrightness - lerpT, lerpT);
-		rgbled->update();
-
-		// Progress one timestep, increasing or decreasing the lerp variable.
-		thread_millisecond_wait(MsecPerUpdate);
-		if (increasing && lerpT == MaxBrightness)
-		{
-			increasing = false;
-			continue;
-		}
-		if (!increasing && lerpT == 0)
-		{
-			increasing = true;
-			continue;
-		}
-		lerpT = increasing ? ++lerpT : --lerpT;
+		Debug::log("Failed to start the RGB LED animations");
 	}
 }
@@ -3,10 +3,11 @@
 
 /*
  * Simple demo using the LED Matrix. Can switch between a small 8x8 Conway's
- * Game of Life example from an initial state, and displaying some text
- * sweeping across the LED matrix.
+ * Game of Life example from an initial state, a larger 64x64 Game of Life
+ * world that scrolls across the LED matrix, and displaying some text sweeping
+ * across the LED matrix.
  *
- * Hold down the joystick to switch between the two demos.
+ * Press the joystick to switch between the demos.
  *
  * Refer to the comment on the `sense_hat.hh` library: be careful about using
  * this demo when switching software / bitstream / resetting the FPGA. If used
@@ -15,7 +16,10 @@
  * cycle the FPGA.
  */
 
+#include "../../libraries/game_of_life.hh"
+#include "../../libraries/gpio_input.hh"
 #include "../../libraries/sense_hat.hh"
+#include "../../libraries/text_scroller.hh"
 #include "../../third_party/display_drivers/src/core/m3x6_16pt.h"
 #include <compartment.h>
 #include <debug.hh>
@@ -26,11 +30,15 @@
 using Debug  = ConditionalDebug<true, "Sense HAT">;
 using Colour = SenseHat::Colour;
 
+using namespace sonata::game_of_life;
+using namespace sonata::text_scroller;
+
 const Colour OnColour  = {.red = Colour::MaxRedValue, .green = 0, .blue = 0};
 const Colour OffColour = {.red = 25, .green = 25, .blue = 25};
-constexpr uint64_t GolFrameWaitMsec  = 400;
-constexpr char     DemoText[]        = "CHERIoT <3 Sonata! ";
-constexpr uint64_t TextFrameWaitMsec = 150;
+constexpr uint64_t GolFrameWaitMsec      = 400;
+constexpr uint64_t GolWorldFrameWaitMsec = 200;
+constexpr char     DemoText[]            = "CHERIoT <3 Sonata! ";
+constexpr uint64_t TextFrameWaitMsec     = 150;
 
 /// Use a custom bitmap for "g" to make presentation slightly cleaner
 constexpr uint8_t GBitmap[8] = {
@@ -45,177 +53,116 @@ constexpr uint8_t GBitmap[8] = {
 };
 
 /// Game of Life starting patterns
-constexpr bool Mold[8][8] = {
-  {0, 0, 0, 0, 0, 0, 0, 0},
-  {0, 0, 0, 0, 1, 1, 0, 0},
-  {0, 0, 0, 1, 0, 0, 1, 0},
-  {0, 0, 1, 0, 1, 0, 1, 0},
-  {0, 0, 1, 0, 0, 1, 0, 0},
-  {0, 1, 0, 0, 0, 0, 0, 0},
-  {0, 0, 1, 0, 1, 0, 0, 0},
-  {0, 0, 0, 0, 0, 0, 0, 0},
-};
-
-constexpr bool Octagon2[8][8] = {
-  {0, 0, 0, 1, 1, 0, 0, 0},
-  {0, 0, 1, 0, 0, 1, 0, 0},
-  {0, 1, 0, 0, 0, 0, 1, 0},
-  {1, 0, 0, 0, 0, 0, 0, 1},
-  {1, 0, 0, 0, 0, 0, 0, 1},
-  {0, 1, 0, 0, 0, 0, 1, 0},
-  {0, 0, 1, 0, 0, 1, 0, 0},
-  {0, 0, 0, 1, 1, 0, 0, 0},
-};
-
-constexpr bool Mazing[8][8] = {
-  {0, 0, 0, 0, 0, 0, 0, 0},
-  {0, 0, 0, 1, 1, 0, 0, 0},
-  {0, 1, 0, 1, 0, 0, 0, 0},
-  {1, 0, 0, 0, 0, 0, 1, 0},
-  {0, 1, 0, 0, 0, 1, 1, 0},
-  {0, 0, 0, 0, 0, 0, 0, 0},
-  {0, 0, 0, 1, 0, 1, 0, 0},
-  {0, 0, 0, 0, 1, 0, 0, 0},
-};
+constexpr Board Mold = from_rows({
+  0b00000000,
+  0b00001100,
+  0b00010010,
+  0b00101010,
+  0b00100100,
+  0b01000000,
+  0b00101000,
+  0b00000000,
+});
+
+constexpr Board Octagon2 = from_rows({
+  0b00011000,
+  0b00100100,
+  0b01000010,
+  0b10000001,
+  0b10000001,
+  0b01000010,
+  0b00100100,
+  0b00011000,
+});
+
+constexpr Board Mazing = from_rows({
+  0b00000000,
+  0b00011000,
+  0b01010000,
+  0b10000010,
+  0b01000110,
+  0b00000000,
+  0b00010100,
+  0b00001000,
+});
+
+constexpr Board Glider = from_rows({
+  0b01000000,
+  0b00100000,
+  0b11100000,
+  0b00000000,
+  0b00000000,
+  0b00000000,
+  0b00000000,
+  0b00000000,
+});
+
+/// The 64x64 world, which is scrolled across the LED matrix.
+static World<8, 8> world;
 
 enum class Demo : uint8_t
 {
-	GameOfLife    = 0,
-	ScrollingText = 1,
+	GameOfLife      = 0,
+	GameOfLifeWorld = 1,
+	ScrollingText   = 2,
+	Count,
 };
 
-void update_image(const bool state[8][8], Colour fb[64])
-{
-	// Update the pixel framebuffer based on the current GOL game state
-	for (uint8_t i = 0; i < 64u; i++)
-	{
-		fb[i] = state[i / 8u][i % 8u] ? OnColour : OffColour;
-	}
-}
-
-uint8_t get_neighbours(bool state[8][8], uint8_t y, uint8_t x)
+/**
+ * Returns a row of a character in the m3x6 font, moved down a row to centre
+ * it on the LED matrix.
+ */
+static uint8_t glyph_row(char character, size_t row)
 {
-	// Count neighbours
-	uint8_t neighbours = 0u;
-	for (int8_t ny = static_cast<int8_t>(y - 1); ny <= y + 1; ny++)
+	if (row == 0)
 	{
-		for (int8_t nx = static_cast<int8_t>(x - 1); nx <= x + 1; nx++)
-		{
-			if ((ny == y && nx == x) || ny < 0 || ny >= 8 || nx < 0 || nx >= 8)
-				continue;
-			neighbours += state[ny][nx];
-		}
+		return 0;
 	}
-	return neighbours;
-}
-
-void update_gol_state(bool state[8][8])
-{
-	bool result[8][8] = {0u};
-	// Iterate through cells
-	for (uint8_t y = 0u; y < 8u; y++)
+	if (character == 'g')
 	{
-		for (uint8_t x = 0u; x < 8u; x++)
-		{
-			uint8_t neighbours = get_neighbours(
-			  state, static_cast<int16_t>(y), static_cast<int16_t>(x));
-			// Calculate the new state and store into a temporary result array
-			if (state[y][x] && neighbours != 2u && neighbours != 3u)
-			{
-				result[y][x] = 0u;
-			}
-			else if (!state[y][x] && neighbours == 3u)
-			{
-				result[y][x] = 1u;
-			}
-			else
-			{
-				result[y][x] = state[y][x];
-			}
-		}
+		return GBitmap[row - 1];
 	}
-	// Copy the newly calculated state back into the original 2D array
-	memcpy(state, result, sizeof(bool[8][8]));
+	return m3x6_16ptBitmaps[(static_cast<uint8_t>(character) - 32u) * 8u +
+	                        row - 1];
 }
 
-void update_text_state(bool state[8][8], uint32_t *index, uint32_t *column)
+/// Returns the time to wait between frames of a demo.
+static uint32_t frame_wait_msec(Demo currentDemo)
 {
-	uint8_t currentChar = static_cast<uint8_t>(DemoText[*index]);
-
-	/// If at the end of the string, reset to the beginning (wrap around)
-	if (currentChar == '\0')
-	{
-		*index      = 0;
-		*column     = 0;
-		currentChar = static_cast<uint8_t>(DemoText[0]);
-	}
-
-	/// Copy all columns left by 1.
-	for (uint8_t x = 0u; x < 7u; x++)
-	{
-		for (uint8_t y = 0u; y < 8u; y++)
-		{
-			state[y][x] = state[y][x + 1];
-		}
-	}
-
-	/// Render the bitmap on the last column
-	bool noBitsInColumn = true;
-	for (uint8_t y = 1u; y < 8u; y++)
-	{
-		const uint32_t BitmapAddr = (currentChar - 32u) * 8u + y - 1u;
-		const uint8_t  Bit        = 1u << *column;
-
-		/// Retrieve bitmap
-		if (currentChar == 'g')
-		{
-			state[y][7] = (GBitmap[y - 1u] & Bit) >> *column;
-		}
-		else
-		{
-			state[y][7] = (m3x6_16ptBitmaps[BitmapAddr] & Bit) >> *column;
-		}
-
-		/* (Slightly hacky): detect gaps (columns with no bits) to determine
-		when the character ends, so that we can render this monospaced font
-		without monospacing. This won't work for every character, but is good
-		enough for our purposes. */
-		if (state[y][7])
-		{
-			noBitsInColumn = false;
-		}
-	}
-
-	/* If a gap is found, or the entire character is rendered, progress to the
-	next character to render. */
-	if ((noBitsInColumn && (currentChar != ' ')) || (*column == 6u))
-	{
-		if (++*index > sizeof(DemoText))
-		{
-			*index = 0;
-		}
-		*column = 0;
-	}
-	else
+	switch (currentDemo)
 	{
-		*column += 1;
+		case Demo::GameOfLife:
+			return GolFrameWaitMsec;
+		case Demo::GameOfLifeWorld:
+			return GolWorldFrameWaitMsec;
+		case Demo::ScrollingText:
+			return TextFrameWaitMsec;
+		default:
+			return 100;
 	}
 }
 
-void initialize_demo(Demo      currentDemo,
-                     bool      ledState[8][8],
-                     uint32_t *index,
-                     uint32_t *column)
+void initialize_demo(Demo currentDemo, Board *ledState, uint32_t *column)
 {
 	switch (currentDemo)
 	{
 		case Demo::GameOfLife:
-			memcpy(ledState, Octagon2, sizeof(bool[8][8]));
+			*ledState = Octagon2;
 			break;
-		case Demo::ScrollingText:
-			memset(ledState, 0u, sizeof(bool[8][8]));
+		case Demo::GameOfLifeWorld:
+			// Scatter the starting patterns across the world.
+			world.clear();
+			world.set_tile(0, 0, Octagon2);
+			world.set_tile(3, 1, Mold);
+			world.set_tile(5, 4, Mazing);
+			world.set_tile(2, 6, Octagon2);
+			world.set_tile(1, 3, Glider);
+			world.set_tile(6, 7, Glider);
 			*column = 0u;
-			*index  = 0u;
+			break;
+		case Demo::ScrollingText:
+			*ledState = 0u;
+			*column   = 0u;
 			break;
 		default:
 			Debug::log("Unknown demo type to intialize: {}", currentDemo);
@@ -229,60 +176,60 @@ void __cheri_compartment("sense_hat_demo") test()
 	Debug::log("Starting Sense HAT test");
 	Demo currentDemo = Demo::GameOfLife;
 
-	// Initialise GPIO capability for joystick inputs
-	auto gpio = MMIO_CAPABILITY(SonataGpioBoard, gpio_board);
-
 	// Initialise the Sense HAT
 	auto senseHat = SenseHat();
 
 	// Initialise a blank LED Matrix.
-	Colour fb[64] = {OffColour};
-	senseHat.set_pixels(fb);
+	senseHat.set_pixels(0u, OnColour, OffColour);
+
+	// Lay out the text once, rather than working out where each character
+	// ends on every frame.
+	const ColumnStream<sizeof(DemoText) * MaxGlyphWidth> TextColumns(
+	  DemoText, glyph_row);
 
 	// Initialise LED Matrix starting states
-	bool     ledState[8][8];
-	uint32_t index               = 0;
-	uint32_t column              = 0;
-	bool     joystickPrevPressed = false;
-	initialize_demo(currentDemo, ledState, &index, &column);
+	Board    ledState = 0u;
+	uint32_t column   = 0;
+	initialize_demo(currentDemo, &ledState, &column);
 
 	while (true)
 	{
-		/* If a joystick press is detected during an update, switch the demo
-		type. This is not polled in a while waiting between updates, so a press
-		can be missed between updates. */
-		bool joystickIsPressed = gpio->read_joystick().is_pressed();
-		if (!joystickPrevPressed && joystickIsPressed)
+		/* Sleep until the next frame, switching the demo type if the joystick
+		is pressed in the meantime. Presses are queued by the GPIO input
+		compartment, so none are missed however short they are. */
+		if (gpio_input_wait_for_press(
+		      frame_wait_msec(currentDemo),
+		      SonataGpioBoard::JoystickDirection::Pressed))
 		{
-			currentDemo =
-			  static_cast<Demo>((static_cast<uint8_t>(currentDemo) + 1) % 2);
-			thread_millisecond_wait(500);
-			initialize_demo(currentDemo, ledState, &index, &column);
-			joystickPrevPressed = true;
-		}
-		if (joystickPrevPressed && !joystickIsPressed)
-		{
-			joystickPrevPressed = false;
+			currentDemo = static_cast<Demo>(
+			  (static_cast<uint8_t>(currentDemo) + 1) %
+			  static_cast<uint8_t>(Demo::Count));
+			initialize_demo(currentDemo, &ledState, &column);
+			continue;
 		}
 
 		switch (currentDemo)
 		{
 			case Demo::GameOfLife:
 				/// Every frame, update the game state and LED matrix.
-				thread_millisecond_wait(GolFrameWaitMsec);
-				update_image(ledState, fb);
-				senseHat.set_pixels(fb);
-				update_gol_state(ledState);
+				senseHat.set_pixels(ledState, OnColour, OffColour);
+				ledState = step(ledState);
+				break;
+			case Demo::GameOfLifeWorld:
+				/// Every frame, step the whole world and move the viewport
+				/// diagonally across it by one cell.
+				senseHat.set_pixels(
+				  world.viewport(column, column), OnColour, OffColour);
+				world.step();
+				column = (column + 1) % world.CellsWide;
 				break;
 			case Demo::ScrollingText:
 				/// Every frame, update the scrolling text and LED matrix
-				thread_millisecond_wait(TextFrameWaitMsec);
-				update_image(ledState, fb);
-				senseHat.set_pixels(fb);
-				update_text_state(ledState, &index, &column);
+				senseHat.set_pixels(ledState, OnColour, OffColour);
+				ledState = slide(ledState, TextColumns.column(column));
+				column   = (column + 1) % TextColumns.size();
 				break;
 			default:
-				thread_millisecond_wait(100UL);
 				Debug::log("Unknown demo type: {}", currentDemo);
 		}
 	}
@@ -2,31 +2,54 @@
 -- SPDX-License-Identifier: Apache-2.0
 
 compartment("led_walk_raw")
+    add_options("cpu_accounting")
+    if has_config("cpu_accounting") then
+        add_deps("cpu_accounting")
+    end
     add_deps("debug")
     add_files("led_walk_raw.cc")
 
 compartment("echo")
+    add_options("cpu_accounting")
+    if has_config("cpu_accounting") then
+        add_deps("cpu_accounting")
+    end
     add_files("echo.cc")
 
 compartment("lcd_test")
+    add_options("cpu_accounting")
+    if has_config("cpu_accounting") then
+        add_deps("cpu_accounting")
+    end
     add_deps("lcd")
     add_files("lcd_test.cc")
 
+-- The same demo with the Sonata XL's theme.
 compartment("lcd_test_xl")
+    add_options("cpu_accounting")
+    if has_config("cpu_accounting") then
+        add_deps("cpu_accounting")
+    end
     add_deps("lcd")
-    add_files("lcd_test_xl.cc")
+    add_defines("SONATA_XL")
+    add_files("lcd_test.cc")
 
 compartment("i2c_example")
-    add_deps("debug")
+    add_deps("debug", "i2c_bus")
     add_files("i2c_example.cc")
 
 compartment("rgbled_lerp")
+    add_deps("debug", "rgbled_animation")
     add_files("rgbled_lerp.cc")
 
 compartment("proximity_sensor_example")
-    add_deps("debug", "sense_hat")
+    add_deps("debug", "sense_hat", "apds9960", "rgbled_animation")
     add_files("proximity_sensor_example.cc")
 
 compartment("sense_hat_demo")
-    add_deps("debug", "sense_hat")
+    add_deps("debug", "sense_hat", "gpio_input")
     add_files("sense_hat_demo.cc", "../../third_party/display_drivers/src/core/m3x6_16pt.c")
+
+compartment("cpu_load")
+    add_deps("debug", "lcd", "cpu_accounting")
+    add_files("cpu_load.cc")
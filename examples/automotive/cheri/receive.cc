@@ -8,16 +8,25 @@
 #include <platform-pwm.hh>
 #include <thread.h>
 
+#include "../../../libraries/gpio_input.hh"
+#include "../../../libraries/ksz8851.hh"
 #include "../../../libraries/lcd.hh"
+#include "../../../libraries/lcd_widgets.hh"
+#include "../../../libraries/trace.hh"
 
 #include "../lib/automotive_common.h"
 
 #include "common.hh"
 
 using Debug = ConditionalDebug<true, "Automotive-Receive">;
+// Per-frame events are traced rather than logged so that writing them to the
+// UART doesn't disturb the timing of the main loop. Only the main loop's thread
+// runs in this compartment. Use `scripts/trace_decode.py` to read them.
+using Trace = sonata::trace::Tracer<32, 1>;
 using namespace CHERI;
 using namespace sonata::lcd;
 using SonataPwm = SonataPulseWidthModulation::General;
+using sonata::ksz8851::MacAddress;
 
 #define PWM_MAX_DUTY_CYCLE 255 // Max is 100%.
 
@@ -29,6 +38,10 @@ using SonataPwm = SonataPulseWidthModulation::General;
 // when applicable, writing to the display and polling for Ethernet packets.
 #define DELTA_TIME_MSEC 80
 
+// How many updates of the main loop there are between each report of the
+// counts of received frames.
+#define RECEIVE_REPORT_UPDATES 50
+
 // This is what we define the highest possible acceleration value to be,
 // and thus the highest speed that we can give to the car. This is a linear
 // mapping under PWM but is unlikely to be accurate to the car itself.
@@ -55,6 +68,25 @@ using SonataPwm = SonataPulseWidthModulation::General;
 #define TEXT_DIMMED_COLOUR static_cast<Color>(0x8F8F8F)
 #define TEXT_DARK_COLOUR static_cast<Color>(0x808080)
 
+// The receiving board's own address, and the group that demo frames are sent
+// to. The MAC drops frames sent to any other address.
+static constexpr MacAddress ReceiverMac = AUTOMOTIVE_RECEIVER_MAC;
+static constexpr MacAddress GroupMac    = AUTOMOTIVE_GROUP_MAC;
+
+// Counts of the frames that have been received, which show how much of the
+// traffic on the network is filtered out by the MAC before reaching software.
+struct ReceiveCounters
+{
+	// Frames of the demo, which are given to the demo.
+	uint32_t accepted;
+	// Frames that passed the MAC's filtering, but aren't frames of the demo.
+	uint32_t rejected;
+	// Frames that were dropped by the MAC's filtering.
+	uint32_t filtered;
+	// Frames that passed the MAC's filtering since its counters were read.
+	uint32_t passedSinceRead;
+};
+
 // A struct to store information of the car, used in both operating modes.
 struct CarInfo
 {
@@ -64,17 +96,18 @@ struct CarInfo
 };
 
 // Driver structs/classes
-EthernetDevice           *ethernet;
-SonataLcd                *lcd;
-volatile SonataGpioBoard *gpio;
+EthernetDevice *ethernet;
+SonataLcd      *lcd;
 
 // Sets the operating mode that the demo is running in. Default is passthrough.
 DemoMode operatingMode = DemoModePassthrough;
 
+ReceiveCounters receiveCounters = {0, 0, 0, 0};
+
 /**
- * A function for busy-waiting whilst also constantly polling for the joystick
- * to be pressed. If the joystick is pressed at any time, it means that the
- * current car state values should be reset.
+ * A function for sleeping whilst also waiting for the joystick to be pressed.
+ * If the joystick is pressed at any time, it means that the current car state
+ * values should be reset.
  *
  * `endTime` is the cycle/time that should be waited until.
  * `flagReset` is a boolean outparameter that will be set true if the joystick
@@ -84,32 +117,65 @@ DemoMode operatingMode = DemoModePassthrough;
  */
 uint64_t wait_with_input(const uint64_t EndTime, bool *flagReset)
 {
-	uint64_t currentTime = rdcycle64();
-	while (currentTime < EndTime)
+	constexpr uint32_t CyclesPerMillisecond = CPU_TIMER_HZ / 1000;
+	uint64_t           currentTime          = rdcycle64();
+	if (currentTime < EndTime)
 	{
+		*flagReset |= gpio_input_wait_for_press(
+		  (EndTime - currentTime) / CyclesPerMillisecond,
+		  SonataGpioBoard::JoystickDirection::Pressed);
 		currentTime = rdcycle64();
-		*flagReset |= gpio->read_joystick().is_pressed();
 	}
 	return currentTime;
 }
 
+/**
+ * Checks whether a received frame is a frame of the demo, by its destination
+ * and EtherType. The MAC filters multicast frames by a hash of their
+ * destination, so frames to other groups with the same hash get through it.
+ */
+static bool is_demo_frame(const EthernetDevice::Frame &frame)
+{
+	if (frame.length <= sizeof(EthernetHeader))
+	{
+		return false;
+	}
+	bool toGroup    = true;
+	bool toReceiver = true;
+	for (uint32_t i = 0; i < GroupMac.size(); i++)
+	{
+		toGroup &= frame.buffer[i] == GroupMac[i];
+		toReceiver &= frame.buffer[i] == ReceiverMac[i];
+	}
+	const uint16_t EtherType = (frame.buffer[12] << 8) | frame.buffer[13];
+	return (toGroup || toReceiver) && EtherType == AUTOMOTIVE_ETHERTYPE;
+}
+
 /**
  * Polls for and attempts to receive an Ethernet frame for the purposes of the
- * automotive demo. This expects frames of a specified format, and does not
- * perform much validation on these frames.
+ * automotive demo. Frames that aren't frames of the demo are counted and
+ * dropped, but the demo's frames are otherwise not validated much.
  *
  * `carInfo` is the model car's information, to be updated with packet data.
  */
 void receive_ethernet_frame(CarInfo *carInfo)
 {
 	// Poll for a frame
-	Debug::log("Polling for ethernet frame...");
+	Trace::event<"Polling for ethernet frame">();
 	std::optional<EthernetDevice::Frame> maybeFrame = ethernet->receive_frame();
 	if (!maybeFrame.has_value())
 	{
 		return;
 	}
-	Debug::log("Received a frame with some value!");
+	receiveCounters.passedSinceRead++;
+	if (!is_demo_frame(*maybeFrame))
+	{
+		receiveCounters.rejected++;
+		Trace::event<"Rejected a frame of length {}">(maybeFrame->length);
+		return;
+	}
+	receiveCounters.accepted++;
+	Trace::event<"Received a frame">();
 
 	// Parse the Ethernet Header information into the frame
 	DemoFrame frame;
@@ -130,7 +196,6 @@ void receive_ethernet_frame(CarInfo *carInfo)
 			operatingMode   = frame.data.mode;
 			Debug::log("Received a mode frame with mode {}",
 			           static_cast<unsigned int>(operatingMode));
-			lcd->clean(BACKGROUND_COLOUR);
 			break;
 
 		case FramePedalData:
@@ -149,8 +214,8 @@ void receive_ethernet_frame(CarInfo *carInfo)
 				carInfo->braking |=
 				  (static_cast<uint64_t>(frame.data.pedalData[i + 8])) << shift;
 			}
-			Debug::log("Received a pedal data frame with acceleration {}",
-			           static_cast<unsigned int>(carInfo->acceleration));
+			Trace::event<"Pedal data: acceleration {}, braking {}">(
+			  carInfo->acceleration, carInfo->braking);
 			break;
 
 		default:
@@ -159,6 +224,26 @@ void receive_ethernet_frame(CarInfo *carInfo)
 	}
 }
 
+/**
+ * Adds the frames that the MAC has filtered out since this was last called to
+ * the receive counters, and then reports the counters. Frames are counted by
+ * the MAC as they arrive, before filtering, so those that were filtered out
+ * are those that arrived but weren't passed on to software.
+ */
+void report_receive_counters()
+{
+	const uint32_t Arrived = sonata::ksz8851::received_counts_read().total();
+	if (Arrived > receiveCounters.passedSinceRead)
+	{
+		receiveCounters.filtered += Arrived - receiveCounters.passedSinceRead;
+	}
+	receiveCounters.passedSinceRead = 0;
+	Debug::log("Received frames: {} accepted, {} rejected, {} filtered",
+	           receiveCounters.accepted,
+	           receiveCounters.rejected,
+	           receiveCounters.filtered);
+}
+
 /**
  * Signals the car with a speed value corresponding to the current value of
  * `carInfo->speed`. This speed is compared with the defined speed ranges
@@ -248,108 +333,8 @@ void update_speed_estimate(CarInfo *carInfo)
 	}
 }
 
-// Stores information about a given segment in a Seven Segment display.
-struct Segment
-{
-	Point pos;
-	bool  vertical;
-};
-
-// Defines the seven segments of a seven-segment display, with a hardcoded size
-// where each segment is 5x15.
-static const Segment SevenSegments[7] = {
-  {{5, 0}, false},  // A         ## <-- A
-  {{0, 5}, true},   // B    B-> #  #
-  {{20, 5}, true},  // C        #  # <- C
-  {{5, 20}, false}, // D         ## <-- D
-  {{0, 25}, true},  // E    E-> #  #
-  {{20, 25}, true}, // F        #  # <- F
-  {{5, 40}, false}, // G         ## <-- G
-};
-
-// Defines the seven-segment representation of all digits 0 through 9 as
-// bytes with each bit corresponding to a segment in sequence.
-static const uint8_t NumberSevenSegments[10] = {
-  0b01110111, // 0 = A,B,C,E,F,G
-  0b00100100, // 1 = C,F
-  0b01011101, // 2 = A,C,D,E,G
-  0b01101101, // 3 = A,C,D,F,G
-  0b00101110, // 4 = B,C,D,F
-  0b01101011, // 5 = A,B,D,F,G
-  0b01111011, // 6 = A,B,D,E,F,G
-  0b00100101, // 7 = A,C,F
-  0b01111111, // 8 = A,B,C,D,E,F,G
-  0b01101111, // 9 = A,B,C,D,F,G
-};
-
-/**
- * Displays a seven segment number on the LCD display.
- *
- * `pos` is the top-left corner of the seven segment number to draw.
- * `colour` is the colour to draw the enabled segments in.
- * `background_colour` is the colour to draw the disabled segments in.
- * `segments` is a byte, where each bit being set to 1 corresponds to one of
- * the corresponding 7 segments being enabled. The MSB does nothing. Segment
- * definitions are based on positions in the `SevenSEgments` array.
- */
-void display_seven_segment_digit(Point   pos,
-                                 Color   colour,
-                                 Color   backgroundColour,
-                                 uint8_t segments)
-{
-	for (uint8_t segmentNum = 0; segmentNum < 7; ++segmentNum)
-	{
-		const Segment Info     = SevenSegments[segmentNum];
-		const Point   Position = {pos.x + Info.pos.x, pos.y + Info.pos.y};
-		const Size    RectSize = {(Info.vertical) ? 5u : 15u,
-                               (Info.vertical) ? 15u : 5u};
-		Color rectColour = backgroundColour;
-		if (segments & (1u << segmentNum))
-		{
-			rectColour = colour;
-		}
-		Rect segmentRect = Rect::from_point_and_size(Position, RectSize);
-		lcd->fill_rect(segmentRect, rectColour);
-	}
-}
-
-/**
- * Displays a speedometer as a 3-digit seven segment number on the LCD display.
- *
- * `pos` is the top-left corner of the speedometer to draw.
- * `colour` is the colour to draw the speedometer in.
- * `inactiveColour` is the colour to draw inactive speedometer segments in.
- * `carSpeed` is the current speed information to display on the speedometer.
- */
-void display_speedometer(Point    pos,
-                         Color    colour,
-                         Color    inactiveColour,
-                         uint64_t carSpeed)
-{
-	const uint32_t Speed     = MIN(carSpeed, 999);
-	const uint32_t Digits[3] = {
-	  Speed % 10, (Speed / 10) % 10, (Speed / 100) % 10};
-
-	// Find the first (leading) non-zero number for formatting.
-	size_t firstNonZero = 0;
-	for (size_t i = 3; i > 0; --i)
-	{
-		if (Digits[i - 1] != 0)
-		{
-			firstNonZero = i - 1;
-			break;
-		}
-	}
-
-	bool drawEmptyNum = false;
-	for (size_t i = 0; i < 3; i++)
-	{
-		Point   numPos   = {pos.x + 70 - 35 * i, pos.y};
-		uint8_t segments = drawEmptyNum ? 0 : NumberSevenSegments[Digits[i]];
-		display_seven_segment_digit(numPos, colour, inactiveColour, segments);
-		drawEmptyNum |= (i >= firstNonZero); // Remove leading 0s
-	}
-}
+// The speedometer, which is a 3-digit seven-segment number.
+using Speedometer = SevenSegmentDisplay<3>;
 
 /**
  * Updates the state of the demo for a single frame, performing actions specific
@@ -357,26 +342,17 @@ void display_speedometer(Point    pos,
  * passing the acceleration to the speed, and updating the LCD accordingly.
  *
  * `carInfo` is simply the state of the car at the current time.
- * `centre` is the centre of the LCD screen, to use for displaying.
+ * `speedometer` is the widget that shows the car's speed.
  */
-void update_demo_passthrough(CarInfo *carInfo, Point centre)
+void update_demo_passthrough(CarInfo *carInfo, Speedometer *speedometer)
 {
 	// Directly pass through acceleration to speed.
 	carInfo->speed = carInfo->acceleration;
-	Debug::log("Current acceleration is {}", carInfo->acceleration);
-
-	// Draw speed information to the LCD
-	const Point LabelPos = {centre.x - 18, centre.y - 50};
-	lcd->draw_str(LabelPos,
-	              "Speed",
-	              BACKGROUND_COLOUR,
-	              TEXT_BRIGHT_COLOUR,
-	              Font::LucidaConsole_10pt);
-	const Color SpeedColor = (carInfo->speed >= 50) ? Color::Red : Color::White;
-	display_speedometer({centre.x - 48, centre.y - 30},
-	                    SpeedColor,
-	                    SEGMENT_OFF_COLOUR,
-	                    carInfo->speed);
+	Trace::event<"Current acceleration is {}">(carInfo->acceleration);
+
+	// Update the speed information, which is drawn to the LCD if it changed
+	speedometer->set_color((carInfo->speed >= 50) ? Color::Red : Color::White);
+	speedometer->set(MIN(carInfo->speed, 999));
 }
 
 /**
@@ -386,25 +362,21 @@ void update_demo_passthrough(CarInfo *carInfo, Point centre)
  * LCD accordingly.
  *
  * `carInfo` is simply the state of the car at the current time.
- * `centre` is the centre of the LCD screen, to use for displaying.
+ * `acceleration` is the widget that shows the car's acceleration.
+ * `speedometer` is the widget that shows the car's speed.
  */
-void update_demo_simulation(CarInfo *carInfo, Point centre)
+void update_demo_simulation(CarInfo         *carInfo,
+                            NumericField<5> *acceleration,
+                            Speedometer     *speedometer)
 {
 	update_speed_estimate(carInfo);
 
-	// Format the current acceleration into a string for display
-	char accelerationStr[50];
-	memcpy(accelerationStr, "Acceleration: ", 14);
-	size_t_to_str_base10(
-	  &accelerationStr[14], static_cast<size_t>(carInfo->acceleration), 0, 10);
-
-	// Display acceleration & speed information to the LCD
-	Color accelerationColor =
-	  (carInfo->acceleration > 100) ? Color::Red : TEXT_DIMMED_COLOUR;
-	const Point AccelerationLabelPos = {centre.x - 70, centre.y - 56};
-	const Point SpeedLabelPos        = {centre.x - 20, centre.y - 36};
-	const Point SpeedometerPos       = {centre.x - 48, centre.y - 18};
-	Color       speedColor           = TEXT_BRIGHT_COLOUR;
+	// Update the acceleration & speed information, which is drawn to the LCD
+	// if it changed
+	acceleration->set_color((carInfo->acceleration > 100) ? Color::Red
+	                                                      : TEXT_DIMMED_COLOUR);
+	acceleration->set(MIN(carInfo->acceleration, 99999));
+	Color speedColor = TEXT_BRIGHT_COLOUR;
 	if (65 < carInfo->speed & carInfo->speed < 75)
 	{
 		speedColor = Color::Green;
@@ -413,18 +385,8 @@ void update_demo_simulation(CarInfo *carInfo, Point centre)
 	{
 		speedColor = Color::Red;
 	}
-	lcd->draw_str(AccelerationLabelPos,
-	              accelerationStr,
-	              BACKGROUND_COLOUR,
-	              accelerationColor,
-	              Font::LucidaConsole_10pt);
-	lcd->draw_str(SpeedLabelPos,
-	              "Speed:",
-	              BACKGROUND_COLOUR,
-	              TEXT_BRIGHT_COLOUR,
-	              Font::LucidaConsole_10pt);
-	display_speedometer(
-	  SpeedometerPos, speedColor, SEGMENT_OFF_COLOUR, carInfo->speed);
+	speedometer->set_color(speedColor);
+	speedometer->set(MIN(carInfo->speed, 999));
 }
 
 /**
@@ -439,35 +401,89 @@ void update_demo_simulation(CarInfo *carInfo, Point centre)
 	// Initialise car info struct to store car parameters.
 	CarInfo carInfo = {.acceleration = 0, .braking = 0, .speed = 0};
 
-	// Calculate LCD information
-	const Size  DisplaySize   = lcd->resolution();
-	const Point Centre        = {DisplaySize.width / 2, DisplaySize.height / 2};
-	const Point ResetLabelPos = {Centre.x - 55, Centre.y + 42};
+	// Lay out the widgets shown in each operating mode. They are only drawn
+	// again when the values they show change.
+	const Size  DisplaySize = lcd->resolution();
+	const Point Centre      = {DisplaySize.width / 2, DisplaySize.height / 2};
+
+	Label resetLabel(
+	  Rect::from_point_and_size({Centre.x - 55, Centre.y + 42}, {112, 8}),
+	  "Press the joystick to reset!",
+	  BACKGROUND_COLOUR,
+	  TEXT_DARK_COLOUR,
+	  Font::M3x6_16pt);
+
+	Label passthroughSpeedLabel(
+	  Rect::from_point_and_size({Centre.x - 18, Centre.y - 50}, {36, 12}),
+	  "Speed",
+	  BACKGROUND_COLOUR,
+	  TEXT_BRIGHT_COLOUR,
+	  Font::LucidaConsole_10pt);
+	Speedometer passthroughSpeedometer(
+	  {Centre.x - 48, Centre.y - 30}, Color::White, SEGMENT_OFF_COLOUR);
+	Compositor passthrough{
+	  resetLabel, passthroughSpeedLabel, passthroughSpeedometer};
+
+	NumericField<5> acceleration(
+	  Rect::from_point_and_size({Centre.x - 70, Centre.y - 56}, {120, 12}),
+	  "Acceleration: ",
+	  0,
+	  BACKGROUND_COLOUR,
+	  TEXT_DIMMED_COLOUR,
+	  Font::LucidaConsole_10pt);
+	Label simulationSpeedLabel(
+	  Rect::from_point_and_size({Centre.x - 20, Centre.y - 36}, {42, 12}),
+	  "Speed:",
+	  BACKGROUND_COLOUR,
+	  TEXT_BRIGHT_COLOUR,
+	  Font::LucidaConsole_10pt);
+	Speedometer simulationSpeedometer(
+	  {Centre.x - 48, Centre.y - 18}, TEXT_BRIGHT_COLOUR, SEGMENT_OFF_COLOUR);
+	Compositor simulation{
+	  resetLabel, acceleration, simulationSpeedLabel, simulationSpeedometer};
+	DemoMode shownMode = operatingMode;
 
 	// Pre-compute timing information to control the demo speed.
 	constexpr uint32_t CyclesPerMillisecond = CPU_TIMER_HZ / 1000;
 	constexpr uint32_t WaitTime = DELTA_TIME_MSEC * CyclesPerMillisecond;
 	uint64_t           prevTime = rdcycle64();
+	uint32_t           updates  = 0;
 
 	// Main loop, updates each frame.
 	while (true)
 	{
 		receive_ethernet_frame(&carInfo);
 		pwm_signal_car(&carInfo);
-		lcd->draw_str(ResetLabelPos,
-		              "Press the joystick to reset!",
-		              BACKGROUND_COLOUR,
-		              TEXT_DARK_COLOUR,
-		              Font::M3x6_16pt);
+
+		// Clear the LCD when the operation mode changes, so that the new
+		// mode's widgets are all drawn again
+		if (operatingMode != shownMode)
+		{
+			lcd->clean(BACKGROUND_COLOUR);
+			passthrough.invalidate();
+			simulation.invalidate();
+			shownMode = operatingMode;
+		}
 
 		// Update according to the operation mode, and display to LCD
 		if (operatingMode == DemoModeSimulated)
 		{
-			update_demo_simulation(&carInfo, Centre);
+			update_demo_simulation(
+			  &carInfo, &acceleration, &simulationSpeedometer);
+			simulation.render(*lcd);
 		}
 		else
 		{ // Default to passthrough mode
-			update_demo_passthrough(&carInfo, Centre);
+			update_demo_passthrough(&carInfo, &passthroughSpeedometer);
+			passthrough.render(*lcd);
+		}
+
+		// Write out this frame's trace events before waiting for the next one.
+		Trace::flush();
+		if (++updates == RECEIVE_REPORT_UPDATES)
+		{
+			report_receive_counters();
+			updates = 0;
 		}
 
 		// Check whether to reset the car's state using GPIO joystick input
@@ -483,7 +499,8 @@ void update_demo_simulation(CarInfo *carInfo, Point centre)
 /**
  * The thread entry point for the receiving part of the automotive demo.
  * Initialises relevant Ethernet, LCD and GPIO drivers, and starts the
- * main infinite loop.
+ * main infinite loop. The MAC is set to only receive frames sent to the
+ * receiving board or to the demo's multicast group.
  *
  * If `AUTOMOTIVE_WAIT_FOR_ETHERNET` is defined, then the receiving board
  * of the demo will not progress to its main loop until a good physical
@@ -493,7 +510,8 @@ void update_demo_simulation(CarInfo *carInfo, Point centre)
 {
 	// Initialise ethernet driver for use via callback
 	ethernet = new EthernetDevice();
-	ethernet->mac_address_set({0x01, 0x23, 0x45, 0x67, 0x89, 0xAB});
+	ethernet->mac_address_set(ReceiverMac);
+	sonata::ksz8851::filter_received_frames(&GroupMac, 1);
 #ifdef AUTOMOTIVE_WAIT_FOR_ETHERNET
 	while (!ethernet->phy_link_status())
 	{
@@ -501,10 +519,9 @@ void update_demo_simulation(CarInfo *carInfo, Point centre)
 	}
 #endif // AUTOMOTIVE_WAIT_FOR_ETHERNET
 
-	// Initialise the LCD & GPIO drivers
+	// Initialise the LCD driver
 	lcd = new SonataLcd();
 	lcd->clean(BACKGROUND_COLOUR);
-	gpio = MMIO_CAPABILITY(SonataGpioBoard, gpio_board);
 
 	// Start the main loop
 	main_demo_loop();
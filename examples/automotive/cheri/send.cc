@@ -9,12 +9,15 @@
 #include <string.h>
 #include <thread.h>
 
+#include "../../../libraries/gpio_input.hh"
 #include "../../../libraries/lcd.hh"
 #include "../../snake/cherry_bitmap.h"
 
 #include "../lib/analogue_pedal.h"
 #include "../lib/automotive_common.h"
 #include "../lib/automotive_menu.h"
+#include "../lib/automotive_platform.h"
+#include "../lib/automotive_profile.h"
 #include "../lib/digital_pedal.h"
 #include "../lib/joystick_pedal.h"
 #include "../lib/no_pedal.h"
@@ -33,6 +36,17 @@ using namespace sonata::lcd;
 #define PEDAL_MIN_ANALOGUE 310
 #define PEDAL_MAX_ANALOGUE 1700
 
+// The time between each update of the demos, in cycles.
+static constexpr uint64_t WaitTime = 120 * (CPU_TIMER_HZ / 1000);
+
+// The instrumented build is its own compartment, so that it can be linked into
+// a separate firmware image from the same sources.
+#ifdef AUTOMOTIVE_INSTRUMENT
+#define SEND_COMPARTMENT "automotive_profile"
+#else
+#define SEND_COMPARTMENT "automotive_send"
+#endif
+
 #define BACKGROUND_COLOR Color::Black
 #define TEXT_COLOUR Color::White
 #define ERROR_COLOUR Color::Red
@@ -54,20 +68,17 @@ SonataAdc      *adc;
 SonataLcd      *lcd;
 
 /**
- * A very simplified and non-compliant version of vsprintf, which manually
- * handles formatting %u formatting specifiers provided in the format string
- * with the given arguments. This allows debug logging callbacks from both
- * legacy and CHERIoT to use the same string formatting interface.
+ * Formats a string, filling in each %u formatting specifier in the format
+ * string with the unsigned integer returned by the next call of `next_arg`.
  *
  * `buffer` is the buffer to write to. It is assumed that the size of this
  * buffer is large enough - no validation occurs.
  * `format` is the formatting string, potentially containing %u specifiers.
- * `args` is the variable list of unsigned integer arguments to format into
- * the string.
  *
  * Returns the actual length of the final formatted string.
  */
-size_t vsprintf(char *buffer, const char *format, va_list args)
+template<typename NextArg>
+size_t format_str(char *buffer, const char *format, NextArg &&next_arg)
 {
 	size_t      strLen      = 0;
 	const char *currentChar = format;
@@ -75,7 +86,7 @@ size_t vsprintf(char *buffer, const char *format, va_list args)
 	{
 		if (currentChar[0] == '%' && currentChar[1] == 'u')
 		{
-			size_t argVal = va_arg(args, unsigned int);
+			size_t argVal = next_arg();
 			size_t_to_str_base10(&buffer[strLen], argVal, 0, 0);
 			while (buffer[strLen] != '\0')
 			{
@@ -97,6 +108,27 @@ size_t vsprintf(char *buffer, const char *format, va_list args)
 	return strLen;
 }
 
+/**
+ * A very simplified and non-compliant version of vsprintf, which manually
+ * handles formatting %u formatting specifiers provided in the format string
+ * with the given arguments. This allows debug logging callbacks from both
+ * legacy and CHERIoT to use the same string formatting interface.
+ *
+ * `buffer` is the buffer to write to. It is assumed that the size of this
+ * buffer is large enough - no validation occurs.
+ * `format` is the formatting string, potentially containing %u specifiers.
+ * `args` is the variable list of unsigned integer arguments to format into
+ * the string.
+ *
+ * Returns the actual length of the final formatted string.
+ */
+size_t vsprintf(char *buffer, const char *format, va_list args)
+{
+	return format_str(buffer, format, [&]() -> unsigned int {
+		return va_arg(args, unsigned int);
+	});
+}
+
 /**
  * A function that writes a string to the UART console, based on a provided
  * format string and a list of arguments to format into that string. The
@@ -192,8 +224,9 @@ void update_cheri_error_handling()
 	  {Centre.x - 65, Centre.y + 40},
 	  {Centre.x - 20, Centre.y + 50},
 	};
-	const Point CherryPos      = {Centre.x + 20, Centre.y + 50};
-	const Rect CherryImageRect = Rect::from_point_and_size(CherryPos, {10, 10});
+	const Point  CherryPos    = {Centre.x + 20, Centre.y + 50};
+	const Sprite CherrySprite = {
+	  {10, 10}, cherryImage10x10, Color565(Color::Black)};
 
 	lcd->draw_str(StringPos[0],
 	              "Unexpected CHERI capability violation!",
@@ -204,7 +237,35 @@ void update_cheri_error_handling()
 	              BACKGROUND_COLOR,
 	              PROTECT_COLOUR);
 	lcd->draw_str(StringPos[2], "by CHERI.", BACKGROUND_COLOR, PROTECT_COLOUR);
-	lcd->draw_image_rgb565(CherryImageRect, cherryImage10x10);
+	lcd->draw_sprite(CherryPos, CherrySprite, BACKGROUND_COLOR);
+}
+
+/**
+ * Draws an already formatted string to the LCD display, converting the
+ * library's font and colours to the LCD driver's.
+ */
+static void draw_formatted_str(uint32_t    x,
+                               uint32_t    y,
+                               LcdFont     font,
+                               const char *str,
+                               uint32_t    backgroundColour,
+                               uint32_t    textColour)
+{
+	Font stringFont;
+	switch (font)
+	{
+		case LucidaConsole_10pt:
+			stringFont = Font::LucidaConsole_10pt;
+			break;
+		case LucidaConsole_12pt:
+			stringFont = Font::LucidaConsole_12pt;
+			break;
+		default:
+			stringFont = Font::M3x6_16pt;
+	}
+	const Color BgColor = static_cast<Color>(backgroundColour);
+	const Color FgColor = static_cast<Color>(textColour);
+	lcd->draw_str({x, y}, str, BgColor, FgColor, stringFont);
 }
 
 /**
@@ -238,21 +299,7 @@ void lcd_draw_str(void       *handle,
 	vsprintf(buffer, format, args);
 	va_end(args);
 
-	Font stringFont;
-	switch (font)
-	{
-		case LucidaConsole_10pt:
-			stringFont = Font::LucidaConsole_10pt;
-			break;
-		case LucidaConsole_12pt:
-			stringFont = Font::LucidaConsole_12pt;
-			break;
-		default:
-			stringFont = Font::M3x6_16pt;
-	}
-	const Color BgColor = static_cast<Color>(backgroundColour);
-	const Color FgColor = static_cast<Color>(textColour);
-	lcd->draw_str({x, y}, buffer, BgColor, FgColor, stringFont);
+	draw_formatted_str(x, y, font, buffer, backgroundColour, textColour);
 }
 
 /**
@@ -309,15 +356,56 @@ void lcd_draw_img(void          *handle,
  * A callback function used to read the GPIO joystick state.
  *
  * Returns the current joystick state as a byte, where each of the
- * 5 least significant bits corresponds to a given joystick input.
+ * 5 least significant bits corresponds to a given joystick input. Inputs
+ * that were pressed since the last read are included even if they have
+ * since been released, so that short taps between reads aren't missed.
  */
 uint8_t read_joystick()
 {
-	auto     gpio = MMIO_CAPABILITY(SonataGpioBoard, gpio_board);
-	uint16_t raw;
-	auto     value = gpio->read_joystick();
-	memcpy(&raw, &value, 2);
-	return raw >> 8;
+	uint32_t       joystick = gpio_input_state();
+	Timeout        noWait{0};
+	GpioInputEvent event;
+	while (gpio_input_wait(&noWait, &event) == 0)
+	{
+		if (event.kind == GpioInputEventKind::Press)
+		{
+			joystick |= event.input;
+		}
+	}
+	return joystick & SonataGpioBoard::Inputs::Joystick;
+}
+
+/**
+ * A callback function used to wait for the joystick to move, which sleeps
+ * until the GPIO input compartment has an event or until `EndTime`, the
+ * cycle count to wait until, and then reads the joystick as `read_joystick`
+ * does. `UINT64_MAX` waits for an event alone.
+ */
+uint8_t wait_joystick(const uint64_t EndTime)
+{
+	uint32_t ticks = UnlimitedTimeout;
+	if (EndTime != UINT64_MAX)
+	{
+		const uint64_t Now = rdcycle64();
+		ticks              = 0;
+		if (EndTime > Now)
+		{
+			const uint64_t Milliseconds =
+			  (EndTime - Now) / (CPU_TIMER_HZ / 1000);
+			// Round up to the next tick, so that the wait doesn't end just
+			// before `EndTime` and then spin until it passes.
+			ticks = MS_TO_TICKS(Milliseconds) + 1;
+		}
+	}
+	Timeout        timeout{ticks};
+	GpioInputEvent event;
+	uint8_t        joystick = 0;
+	if (gpio_input_wait(&timeout, &event) == 0 &&
+	    event.kind == GpioInputEventKind::Press)
+	{
+		joystick = event.input & SonataGpioBoard::Inputs::Joystick;
+	}
+	return joystick | read_joystick();
 }
 
 /**
@@ -410,6 +498,180 @@ void send_ethernet_frame(const uint8_t *buffer, uint16_t length)
 	delete[] frameBuf;
 }
 
+#ifdef AUTOMOTIVE_INSTRUMENT
+/*
+ * The callbacks that replace the board's inputs with the library's scripted
+ * ones when profiling, so that every demo runs to the end without anyone at
+ * the board, including in the simulator. Frames aren't waited for, and aren't
+ * sent, as the profile doesn't need a receiving board or an Ethernet link.
+ */
+
+uint64_t profile_wait(const uint64_t EndTime)
+{
+	return EndTime;
+}
+
+void profile_loop()
+{
+	update_cheri_error_handling();
+	profile_script_next_frame();
+}
+
+void profile_start()
+{
+	reset_error_seen_and_shown();
+	profile_script_start();
+}
+
+uint8_t profile_joystick_read()
+{
+	return read_joystick() | profile_script_joystick();
+}
+
+uint32_t profile_analogue_pedal_read()
+{
+	return profile_script_analogue_pedal();
+}
+
+void profile_ethernet_transmit(const uint8_t *buffer, uint16_t length) {}
+
+static constexpr auto WaitCallback              = profile_wait;
+static constexpr auto LoopCallback              = profile_loop;
+static constexpr auto StartCallback             = profile_start;
+static constexpr auto JoystickReadCallback      = profile_joystick_read;
+static constexpr auto AnaloguePedalReadCallback = profile_analogue_pedal_read;
+static constexpr auto EthernetTransmitCallback  = profile_ethernet_transmit;
+#else
+static constexpr auto WaitCallback              = wait;
+static constexpr auto LoopCallback              = update_cheri_error_handling;
+static constexpr auto StartCallback             = reset_error_seen_and_shown;
+static constexpr auto JoystickReadCallback      = read_joystick;
+static constexpr auto AnaloguePedalReadCallback = read_pedal_analogue;
+static constexpr auto EthernetTransmitCallback  = send_ethernet_frame;
+#endif // AUTOMOTIVE_INSTRUMENT
+
+#ifdef AUTOMOTIVE_STATIC_PLATFORM
+/*
+ * The platform functions that the automotive library is bound to at link
+ * time, which call the drivers directly rather than through `callbacks`.
+ * The formatted output functions take two integers rather than variable
+ * arguments, and format into a buffer that only needs to be as long as the
+ * library's longest string or profile report line.
+ */
+
+/**
+ * Formats a string with at most two %u formatting specifiers, which are
+ * filled in with `first` and `second`.
+ */
+static size_t
+format_two(char *buffer, const char *format, uint32_t first, uint32_t second)
+{
+	const uint32_t Args[2] = {first, second};
+	size_t         next    = 0;
+	return format_str(
+	  buffer, format, [&]() { return next < 2 ? Args[next++] : 0u; });
+}
+
+void platform_uart_format(const char *format, uint32_t first, uint32_t second)
+{
+	char buffer[256];
+	format_two(buffer, format, first, second);
+	Debug::log("{}", static_cast<const char *>(buffer));
+}
+
+uint64_t platform_wait(uint64_t endTime)
+{
+	return WaitCallback(endTime);
+}
+
+uint64_t platform_wait_time()
+{
+	return WaitTime;
+}
+
+uint64_t platform_time()
+{
+	return rdcycle64();
+}
+
+uint64_t platform_cycles()
+{
+	return rdcycle64();
+}
+
+void platform_loop()
+{
+	LoopCallback();
+}
+
+void platform_start()
+{
+	StartCallback();
+}
+
+uint8_t platform_joystick_read()
+{
+	return JoystickReadCallback();
+}
+
+uint8_t platform_joystick_wait(uint64_t endTime)
+{
+	return wait_joystick(endTime);
+}
+
+bool platform_digital_pedal_read()
+{
+	return read_pedal_digital();
+}
+
+uint32_t platform_analogue_pedal_read()
+{
+	return AnaloguePedalReadCallback();
+}
+
+void platform_ethernet_transmit(const uint8_t *buffer, uint16_t length)
+{
+	EthernetTransmitCallback(buffer, length);
+}
+
+void platform_lcd_format(uint32_t    x,
+                         uint32_t    y,
+                         LcdFont     font,
+                         const char *format,
+                         uint32_t    backgroundColour,
+                         uint32_t    textColour,
+                         uint32_t    first,
+                         uint32_t    second)
+{
+	char buffer[256];
+	format_two(buffer, format, first, second);
+	draw_formatted_str(x, y, font, buffer, backgroundColour, textColour);
+}
+
+void platform_lcd_clean(uint32_t color)
+{
+	lcd->clean(static_cast<Color>(color));
+}
+
+void platform_lcd_fill_rect(uint32_t x,
+                            uint32_t y,
+                            uint32_t w,
+                            uint32_t h,
+                            uint32_t color)
+{
+	lcd_fill_rect(lcd, x, y, w, h, color);
+}
+
+void platform_lcd_draw_img_rgb565(uint32_t       x,
+                                  uint32_t       y,
+                                  uint32_t       w,
+                                  uint32_t       h,
+                                  const uint8_t *data)
+{
+	lcd_draw_img(lcd, x, y, w, h, data);
+}
+#endif // AUTOMOTIVE_STATIC_PLATFORM
+
 /**
  * A CHERI Compartment Error handler for the CHERIoT sending firmware.
  * Upon an error occuring in the compartment, the `mtval` is extracted
@@ -512,23 +774,46 @@ __attribute__((
 	}
 }
 
+/**
+ * Runs each of the demos in turn with the scripted inputs, timing their tasks
+ * and the callbacks that they make, and then sends the report of the times
+ * via UART.
+ */
+void run_profile()
+{
+	write_to_uart("Automotive profile started");
+	init_no_pedal_demo_mem(&memTaskOne, &memTaskTwo);
+	run_no_pedal_demo(rdcycle64());
+	init_joystick_demo_mem(&memTaskOne, &memTaskTwo);
+	run_joystick_demo(rdcycle64());
+	init_digital_pedal_demo_mem(&memTaskOne, &memTaskTwo);
+	run_digital_pedal_demo(rdcycle64());
+	init_analogue_pedal_demo_mem(&memAnalogueTaskOne, &memAnalogueTaskTwo);
+	run_analogue_pedal_demo(rdcycle64());
+	profile_report();
+	write_to_uart("Automotive profile finished");
+}
+
 /**
  * The thread entry point for the sending (buggy) part of the automotive
  * demo. Initialises relevant Ethernet, LCD and ADC drivers, sets the
  * callback functions to be used by the demo library, and then starts
- * the main infinite loop.
+ * the main infinite loop. The instrumented build only needs the LCD, and
+ * profiles the demos instead.
  */
-void __cheri_compartment("automotive_send") entry()
+void __cheri_compartment(SEND_COMPARTMENT) entry()
 {
 	// Initialise the LCD driver and calculate display information
-	lcd               = new SonataLcd();
-	Size  displaySize = lcd->resolution();
-	Point centre      = {displaySize.width / 2, displaySize.height / 2};
+	lcd              = new SonataLcd();
+	Size displaySize = lcd->resolution();
 	lcd->clean(BACKGROUND_COLOR);
 
+#ifndef AUTOMOTIVE_INSTRUMENT
+	Point centre = {displaySize.width / 2, displaySize.height / 2};
+
 	// Initialise Ethernet driver for use via callback
 	ethernet = new EthernetDevice();
-	ethernet->mac_address_set();
+	ethernet->mac_address_set(AUTOMOTIVE_SENDER_MAC);
 
 	// Wait until a good physical ethernet link to start the demo
 	if (!ethernet->phy_link_status())
@@ -557,21 +842,25 @@ void __cheri_compartment("automotive_send") entry()
 	SonataAdc::ClockDivider adcClockDivider =
 	  (CPU_TIMER_HZ / SonataAdc::MinClockFrequencyHz) / 2;
 	adc = new SonataAdc(adcClockDivider, SonataAdc::PowerDownMode::None);
+#endif // AUTOMOTIVE_INSTRUMENT
 
-	// Adapt the common automotive library for CHERIoT drivers
-	constexpr uint32_t CyclesPerMillisecond = CPU_TIMER_HZ / 1000;
+	// Adapt the common automotive library for CHERIoT drivers. When it is
+	// bound to them at link time, only the LCD information is needed.
 	init_lcd(displaySize.width, displaySize.height);
+#ifndef AUTOMOTIVE_STATIC_PLATFORM
 	init_callbacks({
 	  .uart_send           = write_to_uart,
-	  .wait                = wait,
-	  .waitTime            = 120 * CyclesPerMillisecond,
+	  .wait                = WaitCallback,
+	  .waitTime            = WaitTime,
 	  .time                = rdcycle64,
-	  .loop                = update_cheri_error_handling,
-	  .start               = reset_error_seen_and_shown,
-	  .joystick_read       = read_joystick,
+	  .cycles              = rdcycle64,
+	  .loop                = LoopCallback,
+	  .start               = StartCallback,
+	  .joystick_read       = JoystickReadCallback,
+	  .joystick_wait       = wait_joystick,
 	  .digital_pedal_read  = read_pedal_digital,
-	  .analogue_pedal_read = read_pedal_analogue,
-	  .ethernet_transmit   = send_ethernet_frame,
+	  .analogue_pedal_read = AnaloguePedalReadCallback,
+	  .ethernet_transmit   = EthernetTransmitCallback,
 	  .lcd =
 	    {
 	      .lcd             = lcd,
@@ -581,9 +870,15 @@ void __cheri_compartment("automotive_send") entry()
 	      .draw_img_rgb565 = lcd_draw_img,
 	    },
 	});
+#endif // AUTOMOTIVE_STATIC_PLATFORM
 
+#ifdef AUTOMOTIVE_INSTRUMENT
+	// Profile the demos rather than letting the user choose them
+	run_profile();
+#else
 	// Begin the main demo loop
 	main_demo_loop();
+#endif // AUTOMOTIVE_INSTRUMENT
 
 	// Driver cleanup
 	delete lcd;
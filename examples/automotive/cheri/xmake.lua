@@ -1,9 +1,18 @@
 -- Copyright lowRISC Contributors.
 -- SPDX-License-Identifier: Apache-2.0
 
+-- Binds the automotive library to the CHERIoT drivers at link time, rather
+-- than through its callbacks, in the sending firmware.
+option("automotive_static_platform")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Bind the automotive library to the platform at link time")
+    add_defines("AUTOMOTIVE_STATIC_PLATFORM")
+
 -- Compartments used for the automotive demo firmware
 compartment("automotive_send")
-    add_deps("lcd", "debug")
+    add_deps("lcd", "debug", "gpio_input")
+    add_options("automotive_static_platform")
     add_files(
         "../lib/automotive_common.c", 
         "../lib/automotive_menu.c", 
@@ -14,14 +23,31 @@ compartment("automotive_send")
     )
     add_files("send.cc")
 
+-- The sending firmware's instrumented build, which profiles the demos with
+-- scripted inputs and reports the times of their tasks and callbacks.
+compartment("automotive_profile")
+    add_deps("lcd", "debug", "gpio_input")
+    add_options("automotive_static_platform")
+    add_defines("AUTOMOTIVE_INSTRUMENT")
+    add_files(
+        "../lib/automotive_common.c",
+        "../lib/automotive_menu.c",
+        "../lib/automotive_profile.c",
+        "../lib/no_pedal.c",
+        "../lib/joystick_pedal.c",
+        "../lib/digital_pedal.c",
+        "../lib/analogue_pedal.c"
+    )
+    add_files("send.cc")
+
 compartment("automotive_receive")
-    add_deps("lcd", "debug")
+    add_deps("lcd", "debug", "gpio_input", "ksz8851")
     add_files("../lib/automotive_common.c")
     add_files("receive.cc")
 
 -- Automotive demo: Sending Firmware (1st board) (CHERIoT version)
 firmware("automotive_demo_send_cheriot")
-    add_deps("freestanding", "automotive_send")
+    add_deps("freestanding", "automotive_send", "gpio_input")
     on_load(function(target)
         target:values_set("board", "$(board)")
         target:values_set("threads", {
@@ -31,6 +57,38 @@ firmware("automotive_demo_send_cheriot")
                 entry_point = "entry",
                 stack_size = 0x1000,
                 trusted_stack_frames = 3
+            },
+            {
+                compartment = "gpio_input",
+                priority = 3,
+                entry_point = "gpio_input_run",
+                stack_size = 0x300,
+                trusted_stack_frames = 1
+            }
+        }, {expand = false})
+    end)
+    after_link(convert_to_uf2)
+
+-- Automotive demo: Profile of the sending firmware (CHERIoT version), which
+-- can be run in the simulator
+firmware("automotive_profile_cheriot")
+    add_deps("freestanding", "automotive_profile", "gpio_input")
+    on_load(function(target)
+        target:values_set("board", "$(board)")
+        target:values_set("threads", {
+            {
+                compartment = "automotive_profile",
+                priority = 2,
+                entry_point = "entry",
+                stack_size = 0x1000,
+                trusted_stack_frames = 3
+            },
+            {
+                compartment = "gpio_input",
+                priority = 3,
+                entry_point = "gpio_input_run",
+                stack_size = 0x300,
+                trusted_stack_frames = 1
             }
         }, {expand = false})
     end)
@@ -38,7 +96,7 @@ firmware("automotive_demo_send_cheriot")
 
 -- Automotive Demo: Receiving Firmware (2nd board)
 firmware("automotive_demo_receive")
-    add_deps("freestanding", "automotive_receive")
+    add_deps("freestanding", "automotive_receive", "gpio_input")
     on_load(function(target)
         target:values_set("board", "$(board)")
         target:values_set("threads", {
@@ -48,6 +106,13 @@ firmware("automotive_demo_receive")
                 entry_point = "entry",
                 stack_size = 0x1000,
                 trusted_stack_frames = 5
+            },
+            {
+                compartment = "gpio_input",
+                priority = 3,
+                entry_point = "gpio_input_run",
+                stack_size = 0x300,
+                trusted_stack_frames = 1
             }
         }, {expand = false})
     end)
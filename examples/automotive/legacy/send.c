@@ -11,6 +11,7 @@
 #include "../lib/analogue_pedal.h"
 #include "../lib/automotive_common.h"
 #include "../lib/automotive_menu.h"
+#include "../lib/automotive_profile.h"
 #include "../lib/digital_pedal.h"
 #include "../lib/joystick_pedal.h"
 #include "../lib/no_pedal.h"
@@ -86,6 +87,22 @@ uint64_t wait(const uint64_t EndTime)
 	return currentTime;
 }
 
+/**
+ * A callback function used to read the CPU's 64-bit cycle counter, reading
+ * the upper half again in case the lower half overflowed in between.
+ */
+uint64_t read_cycles()
+{
+	uint32_t upper, lower, upperAgain;
+	do
+	{
+		__asm__ volatile("csrr %0, mcycleh" : "=r"(upper));
+		__asm__ volatile("csrr %0, mcycle" : "=r"(lower));
+		__asm__ volatile("csrr %0, mcycleh" : "=r"(upperAgain));
+	} while (upper != upperAgain);
+	return ((uint64_t)upper << 32) | lower;
+}
+
 /**
  * A callback function used to read the GPIO joystick state.
  *
@@ -97,6 +114,27 @@ uint8_t read_joystick()
 	return ((uint8_t)(read_gpio(GPIO_IN_DBNC_AM) >> 8u) & 0x1f);
 }
 
+/**
+ * A callback function used to wait for the joystick to move, until `EndTime`
+ * relative to `get_elapsed_time`. The GPIO can't raise interrupts, so the
+ * core sleeps until the next interrupt, such as the timer's tick, and then
+ * reads the joystick again, until it differs from when this last returned.
+ *
+ * Returns the current joystick state, as `read_joystick` does.
+ */
+uint8_t wait_joystick(const uint64_t EndTime)
+{
+	static uint8_t lastJoystick = 0;
+	uint8_t        joystick     = read_joystick();
+	while (joystick == lastJoystick && get_elapsed_time() < EndTime)
+	{
+		__asm__ volatile("wfi");
+		joystick = read_joystick();
+	}
+	lastJoystick = joystick;
+	return joystick;
+}
+
 /**
  * A callback function used to read the pedal input as a digital value,
  * when the pedal is plugged into the mikroBUS INT pin under header P7.
@@ -180,6 +218,42 @@ void send_ethernet_frame(const uint8_t *buffer, uint16_t length)
 	}
 }
 
+#ifdef AUTOMOTIVE_INSTRUMENT
+/*
+ * The callbacks that replace the board's inputs with the library's scripted
+ * ones when profiling, so that every demo runs to the end without anyone at
+ * the board, including in the simulator. Frames aren't waited for, and aren't
+ * sent, as the profile doesn't need a receiving board or an Ethernet link.
+ */
+
+uint64_t profile_wait(const uint64_t EndTime)
+{
+	return EndTime;
+}
+
+void profile_loop()
+{
+	profile_script_next_frame();
+}
+
+void profile_start()
+{
+	profile_script_start();
+}
+
+uint8_t profile_joystick_read()
+{
+	return read_joystick() | profile_script_joystick();
+}
+
+uint32_t profile_analogue_pedal_read()
+{
+	return profile_script_analogue_pedal();
+}
+
+void profile_ethernet_transmit(const uint8_t *buffer, uint16_t length) {}
+#endif // AUTOMOTIVE_INSTRUMENT
+
 // Initialise memory for the tasks used in the automotive demo library code.
 // We use linker script sections to ensure that memory is contiguous in the
 // worst conceivable way, such that an overwrite to the task two array by
@@ -246,11 +320,32 @@ void main_demo_loop()
 	}
 }
 
+/**
+ * Runs each of the demos in turn with the scripted inputs, timing their tasks
+ * and the callbacks that they make, and then sends the report of the times
+ * via UART.
+ */
+void run_profile()
+{
+	write_to_uart("Automotive profile started\n");
+	init_no_pedal_demo_mem(&memTaskOne, &memTaskTwo);
+	run_no_pedal_demo(get_elapsed_time());
+	init_joystick_demo_mem(&memTaskOne, &memTaskTwo);
+	run_joystick_demo(get_elapsed_time());
+	init_digital_pedal_demo_mem(&memTaskOne, &memTaskTwo);
+	run_digital_pedal_demo(get_elapsed_time());
+	init_analogue_pedal_demo_mem(&memAnalogueTaskOne, &memAnalogueTaskTwo);
+	run_analogue_pedal_demo(get_elapsed_time());
+	profile_report();
+	write_to_uart("Automotive profile finished\n");
+}
+
 /**
  * The thread entry point for the sending (buggy) part of the automotive
  * demo. Initialises relevant Ethernet, LCD, UART, PLIC, SPI, ADC and
  * timer drivers, sets the callback functions to be used by the demo
- * library, and then starts the main infinite loop.
+ * library, and then starts the main infinite loop. The instrumented build
+ * doesn't set up Ethernet or the ADC, and profiles the demos instead.
  */
 int main()
 {
@@ -272,6 +367,8 @@ int main()
 	spi_init(&lcdSpi, LCD_SPI, LcdSpiSpeedHz);
 	lcd_init(&lcdSpi, lcd_bl, &lcd, &lcdInterface);
 	lcd_clean(&lcd, BACKGROUND_COLOUR);
+
+#ifndef AUTOMOTIVE_INSTRUMENT
 	const LCD_Point Centre = {lcd.parent.width / 2, lcd.parent.height / 2};
 
 	// Initialise Ethernet support for use via callback
@@ -316,17 +413,44 @@ int main()
 	// Initialise the ADC driver for use via callback
 	AdcClockDivider divider = (SYSCLK_FREQ / ADC_MIN_CLCK_FREQ);
 	adc_init(&adc, ADC_FROM_BASE_ADDR(ADC_BASE), divider);
+#endif // AUTOMOTIVE_INSTRUMENT
 
 	// Adapt the common automotive library for legacy drivers
 	init_lcd(lcd.parent.width, lcd.parent.height);
+#ifdef AUTOMOTIVE_INSTRUMENT
+	init_callbacks((AutomotiveCallbacks){
+	  .uart_send           = write_to_uart,
+	  .wait                = profile_wait,
+	  .waitTime            = 120,
+	  .time                = get_elapsed_time,
+	  .cycles              = read_cycles,
+	  .loop                = profile_loop,
+	  .start               = profile_start,
+	  .joystick_read       = profile_joystick_read,
+	  .joystick_wait       = wait_joystick,
+	  .digital_pedal_read  = read_pedal_digital,
+	  .analogue_pedal_read = profile_analogue_pedal_read,
+	  .ethernet_transmit   = profile_ethernet_transmit,
+	  .lcd =
+	    {
+	      .lcd             = &lcd,
+	      .draw_str        = lcd_draw_str,
+	      .clean           = lcd_clean,
+	      .fill_rect       = lcd_fill_rect,
+	      .draw_img_rgb565 = lcd_draw_img,
+	    },
+	});
+#else
 	init_callbacks((AutomotiveCallbacks){
 	  .uart_send           = write_to_uart,
 	  .wait                = wait,
 	  .waitTime            = 120,
 	  .time                = get_elapsed_time,
+	  .cycles              = read_cycles,
 	  .loop                = null_callback,
 	  .start               = null_callback,
 	  .joystick_read       = read_joystick,
+	  .joystick_wait       = wait_joystick,
 	  .digital_pedal_read  = read_pedal_digital,
 	  .analogue_pedal_read = read_pedal_analogue,
 	  .ethernet_transmit   = send_ethernet_frame,
@@ -339,6 +463,7 @@ int main()
 	      .draw_img_rgb565 = lcd_draw_img,
 	    },
 	});
+#endif // AUTOMOTIVE_INSTRUMENT
 
 	// Verify that, for the purpose of a reproducible error in our demo, task
 	// one and task two have been assigned contiguous memories as required.
@@ -350,8 +475,13 @@ int main()
 	assert((uint32_t)&memAnalogueTaskTwo + sizeof(memAnalogueTaskTwo) ==
 	       (uint32_t)&memAnalogueTaskOne);
 
+#ifdef AUTOMOTIVE_INSTRUMENT
+	// Profile the demos rather than letting the user choose them
+	run_profile();
+#else
 	// Begin the main demo loop
 	main_demo_loop();
+#endif // AUTOMOTIVE_INSTRUMENT
 
 	// Driver cleanup
 	timer_disable();
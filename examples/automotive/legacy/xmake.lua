@@ -19,7 +19,29 @@ target("automotive_lib")
     )
     add_deps("legacy_drivers")
 
+-- The automotive library, instrumented to profile the demos
+target("automotive_profile_lib")
+    set_kind("static")
+    add_defines("AUTOMOTIVE_INSTRUMENT")
+    add_files(
+        "../lib/automotive_common.c",
+        "../lib/automotive_menu.c",
+        "../lib/automotive_profile.c",
+        "../lib/no_pedal.c",
+        "../lib/joystick_pedal.c",
+        "../lib/digital_pedal.c",
+        "../lib/analogue_pedal.c"
+    )
+    add_deps("legacy_drivers")
+
 -- Automotive demo: Sending Firmware (1st board) (non-CHERIoT version)
 legacy_firmware("automotive_demo_send_legacy")
     add_deps("lcd_st7735_lib_am", "automotive_lib", "legacy_drivers")
     add_files("send.c")
+
+-- Automotive demo: Profile of the sending firmware (non-CHERIoT version),
+-- which can be run in the simulator
+legacy_firmware("automotive_profile_legacy")
+    add_deps("lcd_st7735_lib_am", "automotive_profile_lib", "legacy_drivers")
+    add_defines("AUTOMOTIVE_INSTRUMENT")
+    add_files("send.c")
@@ -6,6 +6,7 @@
 
 #include "analogue_pedal.h"
 #include "automotive_common.h"
+#include "automotive_platform.h"
 #include "sound_icon.h"
 
 // Pointers to memory that has been allocated for use by the system.
@@ -52,10 +53,8 @@ static uint64_t lerp_green_to_red(uint32_t portion, uint32_t segments)
  */
 static void outline_volume_bar(uint32_t x, uint32_t y, uint32_t maxVolume)
 {
-	callbacks.lcd.fill_rect(
-	  callbacks.lcd.lcd, x, y, 7 + maxVolume * 6, 13, RGBColorWhite);
-	callbacks.lcd.fill_rect(
-	  callbacks.lcd.lcd, x + 2, y + 2, 3 + maxVolume * 6, 9, RGBColorBlack);
+	platform_lcd_fill_rect(x, y, 7 + maxVolume * 6, 13, RGBColorWhite);
+	platform_lcd_fill_rect(x + 2, y + 2, 3 + maxVolume * 6, 9, RGBColorBlack);
 }
 
 /**
@@ -72,12 +71,11 @@ static void draw_volume_bar(uint32_t x, uint32_t y, uint32_t maxVolume)
 {
 	for (uint32_t i = 0; i < maxVolume; ++i)
 	{
-		callbacks.lcd.fill_rect(callbacks.lcd.lcd,
-		                        x + 4 + (i * 6),
-		                        y + 4,
-		                        5,
-		                        5,
-		                        taskTwoMem->framebuffer[i]);
+		platform_lcd_fill_rect(x + 4 + (i * 6),
+		                       y + 4,
+		                       5,
+		                       5,
+		                       taskTwoMem->framebuffer[i]);
 	}
 }
 
@@ -91,15 +89,15 @@ static void draw_volume_bar(uint32_t x, uint32_t y, uint32_t maxVolume)
 static void analogue_task_one()
 {
 	// Transmit the previously measured pedal information to the car.
-	callbacks.uart_send("Sending pedal data: acceleration=%u, braking=%u.\n",
-	                    (unsigned int)taskOneMem->acceleration,
-	                    (unsigned int)taskOneMem->braking);
+	platform_uart_send("Sending pedal data: acceleration=%u, braking=%u.\n",
+	                   (unsigned int)taskOneMem->acceleration,
+	                   (unsigned int)taskOneMem->braking);
 	const uint64_t FrameData[2] = {taskOneMem->acceleration,
 	                               taskOneMem->braking};
 	send_data_frame(FrameData, FixedDemoHeader, 2);
 
 	// Read the next pedal information to send via callback.
-	taskOneMem->acceleration = callbacks.analogue_pedal_read();
+	taskOneMem->acceleration = platform_analogue_pedal_read();
 }
 
 /**
@@ -118,7 +116,7 @@ static void analogue_task_one()
 bool analogue_task_two()
 {
 	// Control the volume bar via joystick input
-	uint8_t joystick = callbacks.joystick_read();
+	uint8_t joystick = platform_joystick_read();
 	if (joystick_in_direction(joystick, Up) && taskTwoMem->volume > 0)
 	{
 		taskTwoMem->volume -= 1;
@@ -150,13 +148,13 @@ bool analogue_task_two()
  * as is necessary.
  *
  * `initTime` is the time that `run_analogue_pedal_demo` was called at,
- * relative to the times returned by `callbacks.wait`.
+ * relative to the times returned by `platform_wait`.
  */
 void run_analogue_pedal_demo(uint64_t initTime)
 {
 	// Start the demo in passthrough mode.
-	callbacks.uart_send("Automotive demo started!\n");
-	callbacks.start();
+	platform_uart_send("Automotive demo started!\n");
+	platform_start();
 	send_mode_frame(FixedDemoHeader, DemoModePassthrough);
 
 	// Initialise values in memory
@@ -166,72 +164,74 @@ void run_analogue_pedal_demo(uint64_t initTime)
 
 	// Draw static LCD graphics, and populate the frame buffer with colours for
 	// the initial volume bar.
-	callbacks.lcd.draw_img_rgb565(
-	  callbacks.lcd.lcd, 11, 30, 15, 11, soundIconImg15x11);
+	platform_lcd_draw_img_rgb565(11, 30, 15, 11, soundIconImg15x11);
 	outline_volume_bar(10, 45, 20);
 	for (uint32_t i = 0; i < 20; ++i)
 	{
 		taskTwoMem->framebuffer[i] =
 		  (i < taskTwoMem->volume) ? lerp_green_to_red(i, 21) : 0;
 	}
-	callbacks.lcd.draw_str(callbacks.lcd.lcd,
-	                       10,
-	                       60,
-	                       LucidaConsole_10pt,
-	                       "Exceed max volume",
-	                       RGBColorBlack,
-	                       RGBColorDarkGrey);
-	callbacks.lcd.draw_str(callbacks.lcd.lcd,
-	                       10,
-	                       75,
-	                       LucidaConsole_10pt,
-	                       "for a bug!",
-	                       RGBColorBlack,
-	                       RGBColorDarkGrey);
-	callbacks.lcd.draw_str(callbacks.lcd.lcd,
-	                       10,
-	                       12,
-	                       M3x6_16pt,
-	                       "Press the joystick to end the demo.",
-	                       RGBColorBlack,
-	                       RGBColorDarkerGrey);
+	platform_lcd_draw_str(10,
+	                      60,
+	                      LucidaConsole_10pt,
+	                      "Exceed max volume",
+	                      RGBColorBlack,
+	                      RGBColorDarkGrey);
+	platform_lcd_draw_str(10,
+	                      75,
+	                      LucidaConsole_10pt,
+	                      "for a bug!",
+	                      RGBColorBlack,
+	                      RGBColorDarkGrey);
+	platform_lcd_draw_str(10,
+	                      12,
+	                      M3x6_16pt,
+	                      "Press the joystick to end the demo.",
+	                      RGBColorBlack,
+	                      RGBColorDarkerGrey);
 
 	// Call task one and task two sequentially in a loop until the user
 	// selects to quit the demo by pressing the joystick.
-	uint64_t prevTime     = initTime;
-	bool     stillRunning = true;
+	uint64_t   prevTime      = initTime;
+	bool       stillRunning  = true;
+	TaskCycles taskOneCycles = {0, 0, ProbeAnalogueTaskOne};
+	TaskCycles taskTwoCycles = {0, 0, ProbeAnalogueTaskTwo};
 	while (stillRunning)
 	{
+		uint64_t taskStart = platform_cycles();
 		analogue_task_one();
+		task_cycles_add(&taskOneCycles, taskStart);
+		taskStart = platform_cycles();
 		analogue_task_two();
+		task_cycles_add(&taskTwoCycles, taskStart);
 
 		// Draw the volume bar to the screen each frame using the framebuffer
 		uint32_t labelColor =
 		  (taskTwoMem->volume > 20) ? RGBColorRed : RGBColorWhite;
-		callbacks.lcd.draw_str(callbacks.lcd.lcd,
-		                       33,
-		                       30,
-		                       LucidaConsole_10pt,
-		                       "Volume: %u/%u ",
-		                       RGBColorBlack,
-		                       labelColor,
-		                       (unsigned int)taskTwoMem->volume,
-		                       20u);
+		platform_lcd_draw_str(33,
+		                      30,
+		                      LucidaConsole_10pt,
+		                      "Volume: %u/%u ",
+		                      RGBColorBlack,
+		                      labelColor,
+		                      (unsigned int)taskTwoMem->volume,
+		                      20u);
 		draw_volume_bar(10, 45, 20);
 
 		const bool EnoughTimePassed =
-		  prevTime > (initTime + callbacks.waitTime * 5);
+		  prevTime > (initTime + platform_wait_time() * 5);
 		const bool JoystickPressed =
-		  joystick_in_direction(callbacks.joystick_read(), Pressed);
+		  joystick_in_direction(platform_joystick_read(), Pressed);
 		if (EnoughTimePassed && JoystickPressed)
 		{
 			stillRunning = false;
-			callbacks.uart_send("Manually ended demo by pressing joystick.");
+			platform_uart_send("Manually ended demo by pressing joystick.");
 		}
 
-		prevTime = callbacks.wait(prevTime + callbacks.waitTime);
-		callbacks.loop();
+		prevTime = platform_wait(prevTime + platform_wait_time());
+		platform_loop();
 	}
 
-	callbacks.uart_send("Automotive demo ended!\n");
+	report_task_cycles(&taskOneCycles, &taskTwoCycles);
+	platform_uart_send("Automotive demo ended!\n");
 }
@@ -7,6 +7,7 @@
 #include <stdint.h>
 
 #include "automotive_common.h"
+#include "automotive_platform.h"
 
 // Globals to store display size information for ease of use
 LcdSize lcdSize, lcdCentre;
@@ -16,13 +17,13 @@ AutomotiveCallbacks callbacks;
 
 /**
  * The fixed Ethernet frame header that is used in the automotive demo. This
- * ensures that all frames sent are broadcast frames, from the MAC source
- * address of 3A:30:25:24:FE:7A, with a type of 0806.
+ * ensures that all frames sent are sent to the demo's multicast group, from
+ * the sending board's MAC address, with the demo's EtherType.
  */
 const EthernetHeader FixedDemoHeader = {
-  {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
-  {0x3a, 0x30, 0x25, 0x24, 0xfe, 0x7a},
-  {0x08, 0x06},
+  AUTOMOTIVE_GROUP_MAC,
+  AUTOMOTIVE_SENDER_MAC,
+  {AUTOMOTIVE_ETHERTYPE >> 8, AUTOMOTIVE_ETHERTYPE & 0xFF},
 };
 
 /**
@@ -90,7 +91,7 @@ void send_data_frame(const uint64_t *data,
 		}
 	}
 	// Call the relevant callback to transmit the frame
-	callbacks.ethernet_transmit(frameBuf, frameLen);
+	platform_ethernet_transmit(frameBuf, frameLen);
 }
 
 /**
@@ -112,5 +113,38 @@ void send_mode_frame(EthernetHeader header, DemoMode mode)
 	// Write the "Demo Mode" type and selected mode into the frame, and send.
 	frameBuf[frameLen++] = FrameDemoMode;
 	frameBuf[frameLen++] = mode;
-	callbacks.ethernet_transmit(frameBuf, frameLen);
+	platform_ethernet_transmit(frameBuf, frameLen);
+}
+
+/**
+ * Adds a run of a task, which started at `startCycles`, to the cycles spent
+ * running it.
+ */
+void task_cycles_add(TaskCycles *taskCycles, uint64_t startCycles)
+{
+	const uint64_t Cycles = platform_cycles() - startCycles;
+	taskCycles->total += Cycles;
+	taskCycles->runs++;
+#ifdef AUTOMOTIVE_INSTRUMENT
+	profile_record(taskCycles->probe, Cycles);
+#endif // AUTOMOTIVE_INSTRUMENT
+}
+
+/**
+ * Reports the average cycles that each of a demo's two tasks took to run,
+ * via UART.
+ */
+void report_task_cycles(const TaskCycles *taskOne, const TaskCycles *taskTwo)
+{
+	const TaskCycles *Tasks[2] = {taskOne, taskTwo};
+	for (uint32_t i = 0; i < 2; ++i)
+	{
+		if (Tasks[i]->runs == 0)
+		{
+			continue;
+		}
+		platform_uart_send("Task %u took %u cycles on average.\n",
+		                   (unsigned int)(i + 1),
+		                   (unsigned int)(Tasks[i]->total / Tasks[i]->runs));
+	}
 }
@@ -6,6 +6,7 @@
 #define AUTOMOTIVE_COMMON_H
 
 #include "../../common/types.h"
+#include "automotive_profile.h"
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -19,6 +20,19 @@ enum JoystickDir
 	Right   = 1 << 4,
 };
 
+// The EtherType of the automotive demo's frames. This is the first of the
+// EtherTypes that IEEE 802 sets aside for local experiments, so no other
+// protocol's frames use it.
+#define AUTOMOTIVE_ETHERTYPE 0x88B5
+
+// The locally administered MAC addresses used by the automotive demo. Frames
+// are sent from the sending board's unicast address to a multicast group, so
+// that the receiving board can filter out all other traffic in hardware,
+// apart from frames sent to its own unicast address.
+#define AUTOMOTIVE_SENDER_MAC {0x3a, 0x30, 0x25, 0x24, 0xfe, 0x7a}
+#define AUTOMOTIVE_RECEIVER_MAC {0x3a, 0x30, 0x25, 0x24, 0xfe, 0x7b}
+#define AUTOMOTIVE_GROUP_MAC {0x3b, 0x30, 0x25, 0x24, 0xfe, 0x7a}
+
 // Minimal Ethernet Header for sending frames
 typedef struct EthernetHeader
 {
@@ -138,12 +152,19 @@ typedef struct AutomotiveCallbacks
 	uint64_t waitTime;
 	// A function that returns the current time as a 64-bit integer.
 	uint64_t (*time)();
+	// A function that returns the CPU's cycle count, to time the tasks with.
+	uint64_t (*cycles)();
 	// A callback that is called at the end of every update/frame
 	void (*loop)();
 	// A callback that is called once at the start of the demo
 	void (*start)();
 	// A function that reads the joystick information via GPIO
 	uint8_t (*joystick_read)(); // NOLINT
+	// A function that waits until the joystick information may have changed,
+	// or until the given time, relative to times received from the `time`
+	// callback, and then reads it as `joystick_read` does. It should sleep
+	// rather than spin where it can, and `UINT64_MAX` waits for input alone.
+	uint8_t (*joystick_wait)(uint64_t endTime); // NOLINT
 	// A function that reads the pedal, as a digital (Boolean) value.
 	bool (*digital_pedal_read)(); // NOLINT
 	// A function that reads the pedal, as an analogue value.
@@ -173,6 +194,18 @@ typedef struct TaskTwo
 	uint64_t write[100];
 } TaskTwo;
 
+/**
+ * The cycles spent running one of a demo's tasks, so that the average time
+ * that each task takes can be reported at the end of the demo. Each run is
+ * also recorded as `probe` when the library is instrumented.
+ */
+typedef struct TaskCycles
+{
+	uint64_t     total;
+	uint32_t     runs;
+	ProfileProbe probe;
+} TaskCycles;
+
 // Externs to be set when initialising the automotive demo library.
 extern LcdSize              lcdSize, lcdCentre;
 extern AutomotiveCallbacks  callbacks;
@@ -189,6 +222,9 @@ extern "C"
 	                     EthernetHeader  header,
 	                     uint16_t        length);
 	void send_mode_frame(EthernetHeader header, DemoMode mode);
+	void task_cycles_add(TaskCycles *taskCycles, uint64_t startCycles);
+	void report_task_cycles(const TaskCycles *taskOne,
+	                        const TaskCycles *taskTwo);
 #ifdef __cplusplus
 }
 #endif //__cplusplus
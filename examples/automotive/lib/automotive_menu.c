@@ -8,6 +8,15 @@
 #include "./cursor.h"
 #include "automotive_common.h"
 #include "automotive_menu.h"
+#include "automotive_platform.h"
+
+// The number of demos that can be selected from the menu.
+#define MENU_OPTIONS 4
+
+// The updates, of `waitTime` each, that a direction must be held for before
+// the cursor starts to move on its own, and then between each of its moves.
+#define MENU_REPEAT_DELAY_UPDATES 3
+#define MENU_REPEAT_INTERVAL_UPDATES 1
 
 /**
  * Perform differential drawing on the "cursor" / "option select" icon in order
@@ -22,28 +31,38 @@
 static void
 fill_option_select_rects(uint8_t prev, uint8_t current, bool cursorImg)
 {
-	callbacks.lcd.fill_rect(callbacks.lcd.lcd,
-	                        lcdCentre.x - 64,
-	                        lcdCentre.y - 22 + prev * 20,
-	                        5,
-	                        5,
-	                        RGBColorBlack);
+	platform_lcd_fill_rect(lcdCentre.x - 64,
+	                       lcdCentre.y - 22 + prev * 20,
+	                       5,
+	                       5,
+	                       RGBColorBlack);
 	if (cursorImg)
 	{
-		callbacks.lcd.draw_img_rgb565(callbacks.lcd.lcd,
-		                              lcdCentre.x - 64,
-		                              lcdCentre.y - 22 + current * 20,
-		                              5,
-		                              5,
-		                              cursorImg5x5);
+		platform_lcd_draw_img_rgb565(lcdCentre.x - 64,
+		                             lcdCentre.y - 22 + current * 20,
+		                             5,
+		                             5,
+		                             cursorImg5x5);
 		return;
 	}
-	callbacks.lcd.fill_rect(callbacks.lcd.lcd,
-	                        lcdCentre.x - 64,
-	                        lcdCentre.y - 22 + current * 20,
-	                        5,
-	                        5,
-	                        RGBColorWhite);
+	platform_lcd_fill_rect(lcdCentre.x - 64,
+	                       lcdCentre.y - 22 + current * 20,
+	                       5,
+	                       5,
+	                       RGBColorWhite);
+}
+
+/**
+ * Returns the option that the cursor moves to from `option` when the joystick
+ * is moved in `direction`.
+ */
+static uint8_t option_after_move(uint8_t option, enum JoystickDir direction)
+{
+	if (direction == Right)
+	{
+		return (option == 0) ? (MENU_OPTIONS - 1) : (option - 1);
+	}
+	return (option + 1) % MENU_OPTIONS;
 }
 
 /**
@@ -51,67 +70,93 @@ fill_option_select_rects(uint8_t prev, uint8_t current, bool cursorImg)
  * for drawing the menu to the LCD, and also contains the logic for
  * navigating the menu and selecting a demo.
  *
+ * The menu sleeps in the `joystick_wait` callback until the joystick moves,
+ * and moves the cursor as soon as it does. A direction that is held moves the
+ * cursor again after `MENU_REPEAT_DELAY_UPDATES` updates, and then every
+ * `MENU_REPEAT_INTERVAL_UPDATES` updates until it is released. Only the two
+ * cursor cells that change are redrawn.
+ *
  * Returns a `DemoApplication` that has been selected by the user.
  * It is not possible to not select an application (i.e. "quit").
  */
 DemoApplication select_demo()
 {
 	// Display static menu information to the LCD
-	callbacks.lcd.clean(callbacks.lcd.lcd, RGBColorBlack);
-	callbacks.lcd.draw_str(callbacks.lcd.lcd,
-	                       lcdCentre.x - 60,
-	                       lcdCentre.y - 50,
-	                       LucidaConsole_12pt,
-	                       "Select Demo",
-	                       RGBColorBlack,
-	                       RGBColorWhite);
-	const char *demoOptions[] = {
+	platform_lcd_clean(RGBColorBlack);
+	platform_lcd_draw_str(lcdCentre.x - 60,
+	                      lcdCentre.y - 50,
+	                      LucidaConsole_12pt,
+	                      "Select Demo",
+	                      RGBColorBlack,
+	                      RGBColorWhite);
+	const char *demoOptions[MENU_OPTIONS] = {
 	  "[1] Analogue",
 	  "[2] Digital",
 	  "[3] Joystick",
 	  "[4] No pedal",
 	};
-	for (uint8_t i = 0; i < 4; i++)
+	for (uint8_t i = 0; i < MENU_OPTIONS; i++)
 	{
-		callbacks.lcd.draw_str(callbacks.lcd.lcd,
-		                       lcdCentre.x - 55,
-		                       lcdCentre.y - 25 + i * 20,
-		                       LucidaConsole_10pt,
-		                       demoOptions[i],
-		                       RGBColorBlack,
-		                       RGBColorDarkerGrey);
+		platform_lcd_draw_str(lcdCentre.x - 55,
+		                      lcdCentre.y - 25 + i * 20,
+		                      LucidaConsole_10pt,
+		                      demoOptions[i],
+		                      RGBColorBlack,
+		                      RGBColorDarkerGrey);
 	}
-	const uint8_t NumOptions = 4;
 
 	// Demo menu input & selection logic
-	uint8_t    prevOption = 0, currentOption = 0;
-	const bool CursorImg      = true;
-	bool       optionSelected = false;
-	fill_option_select_rects(prevOption, currentOption, CursorImg);
-	callbacks.uart_send("Waiting for user input in the main menu...\n");
-	while (!optionSelected)
+	uint8_t    currentOption = 0;
+	const bool CursorImg     = true;
+	fill_option_select_rects(currentOption, currentOption, CursorImg);
+	platform_uart_send("Waiting for user input in the main menu...\n");
+
+	// Inputs that are already held, such as the press that ended the last
+	// demo, are ignored until they are released.
+	uint8_t          held       = platform_joystick_read();
+	enum JoystickDir repeating  = 0;
+	uint64_t         repeatTime = UINT64_MAX;
+	while (true)
 	{
-		prevOption                  = currentOption;
-		const uint8_t JoystickInput = callbacks.joystick_read();
-		if (joystick_in_direction(JoystickInput, Right))
+		const uint8_t Joystick  = platform_joystick_wait(repeatTime);
+		const uint8_t NewInputs = Joystick & ~held;
+		held                    = Joystick;
+		if (joystick_in_direction(NewInputs, Pressed))
 		{
-			currentOption =
-			  (currentOption == 0) ? (NumOptions - 1) : (currentOption - 1);
-			fill_option_select_rects(prevOption, currentOption, CursorImg);
-			callbacks.wait(callbacks.time() + callbacks.waitTime * 2);
+			break;
 		}
-		else if (joystick_in_direction(JoystickInput, Left))
+
+		enum JoystickDir direction;
+		if (joystick_in_direction(NewInputs, Right) ||
+		    joystick_in_direction(NewInputs, Left))
+		{
+			direction  = joystick_in_direction(NewInputs, Right) ? Right : Left;
+			repeating  = direction;
+			repeatTime = platform_time() +
+			             platform_wait_time() * MENU_REPEAT_DELAY_UPDATES;
+		}
+		else if (repeating != 0 && joystick_in_direction(Joystick, repeating))
 		{
-			currentOption = (currentOption + 1) % NumOptions;
-			fill_option_select_rects(prevOption, currentOption, CursorImg);
-			callbacks.wait(callbacks.time() + callbacks.waitTime * 2);
+			if (platform_time() < repeatTime)
+			{
+				continue;
+			}
+			direction  = repeating;
+			repeatTime = platform_time() +
+			             platform_wait_time() * MENU_REPEAT_INTERVAL_UPDATES;
 		}
-		else if (joystick_in_direction(JoystickInput, Pressed))
+		else
 		{
-			optionSelected = true;
+			repeating  = 0;
+			repeatTime = UINT64_MAX;
+			continue;
 		}
+
+		const uint8_t PrevOption = currentOption;
+		currentOption            = option_after_move(currentOption, direction);
+		fill_option_select_rects(PrevOption, currentOption, CursorImg);
 	}
 
-	callbacks.lcd.clean(callbacks.lcd.lcd, RGBColorBlack);
+	platform_lcd_clean(RGBColorBlack);
 	return (DemoApplication)currentOption;
 }
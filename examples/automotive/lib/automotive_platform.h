@@ -0,0 +1,225 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AUTOMOTIVE_PLATFORM_H
+#define AUTOMOTIVE_PLATFORM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "automotive_common.h"
+#include "automotive_profile.h"
+
+/*
+ * The functions that the automotive demos use to reach the platform's
+ * hardware.
+ *
+ * By default, each of these calls the matching function of the `callbacks`
+ * given to `init_callbacks`, so that the library can be bound to a platform
+ * at run time. When `AUTOMOTIVE_STATIC_PLATFORM` is defined, they are
+ * instead functions that the firmware must define, which are bound at link
+ * time and called directly. The formatted output functions then take exactly
+ * two unsigned integers to format, rather than variable arguments, with
+ * those that aren't given set to 0.
+ *
+ * When `AUTOMOTIVE_INSTRUMENT` is also defined, the calls to the callbacks are
+ * timed for `automotive_profile.h`. The functions that are bound at link time
+ * aren't timed by the library, as they're called directly.
+ */
+
+/*
+ * Pads the arguments to a formatted output function to two integers. Any
+ * more would be dropped, so the macros that use these check the number of
+ * arguments with `AUTOMOTIVE_ARG_COUNT` first, which counts up to ten.
+ */
+#define AUTOMOTIVE_PAD_UART(format, first, second, ...) format, first, second
+#define AUTOMOTIVE_PAD_LCD(x, y, font, format, bg, fg, first, second, ...)    \
+	x, y, font, format, bg, fg, first, second
+#define AUTOMOTIVE_ARG_COUNT(...)                                              \
+	AUTOMOTIVE_ARG_COUNT_(__VA_ARGS__, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define AUTOMOTIVE_ARG_COUNT_(a, b, c, d, e, f, g, h, i, j, count, ...) count
+#ifdef __cplusplus
+#define AUTOMOTIVE_STATIC_ASSERT static_assert
+#else
+#define AUTOMOTIVE_STATIC_ASSERT _Static_assert
+#endif //__cplusplus
+
+#ifdef AUTOMOTIVE_STATIC_PLATFORM
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif //__cplusplus
+	void     platform_uart_format(const char *format,
+	                              uint32_t    first,
+	                              uint32_t    second);
+	uint64_t platform_wait(uint64_t endTime);
+	uint64_t platform_wait_time();
+	uint64_t platform_time();
+	uint64_t platform_cycles();
+	void     platform_loop();
+	void     platform_start();
+	uint8_t  platform_joystick_read();
+	uint8_t  platform_joystick_wait(uint64_t endTime);
+	bool     platform_digital_pedal_read();
+	uint32_t platform_analogue_pedal_read();
+	void     platform_ethernet_transmit(const uint8_t *buffer, uint16_t length);
+	void     platform_lcd_format(uint32_t    x, // NOLINT
+	                             uint32_t    y,
+	                             LcdFont     font,
+	                             const char *format,
+	                             uint32_t    backgroundColour,
+	                             uint32_t    textColour,
+	                             uint32_t    first,
+	                             uint32_t    second);
+	void     platform_lcd_clean(uint32_t color);
+	void     platform_lcd_fill_rect(uint32_t x, // NOLINT
+	                                uint32_t y,
+	                                uint32_t w,
+	                                uint32_t h,
+	                                uint32_t color);
+	void     platform_lcd_draw_img_rgb565(uint32_t       x, // NOLINT
+	                                      uint32_t       y,
+	                                      uint32_t       w,
+	                                      uint32_t       h,
+	                                      const uint8_t *data);
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+
+#define platform_uart_send(...)                                                \
+	do                                                                         \
+	{                                                                          \
+		AUTOMOTIVE_STATIC_ASSERT(                                              \
+		  AUTOMOTIVE_ARG_COUNT(__VA_ARGS__) <= 3,                              \
+		  "platform_uart_send formats at most two integers");                  \
+		platform_uart_format(AUTOMOTIVE_PAD_UART(__VA_ARGS__, 0, 0, 0));       \
+	} while (0)
+#define platform_lcd_draw_str(...)                                             \
+	do                                                                         \
+	{                                                                          \
+		AUTOMOTIVE_STATIC_ASSERT(                                              \
+		  AUTOMOTIVE_ARG_COUNT(__VA_ARGS__) <= 8,                              \
+		  "platform_lcd_draw_str formats at most two integers");               \
+		platform_lcd_format(AUTOMOTIVE_PAD_LCD(__VA_ARGS__, 0, 0, 0));         \
+	} while (0)
+
+#else // AUTOMOTIVE_STATIC_PLATFORM
+
+#ifdef AUTOMOTIVE_INSTRUMENT
+// Times a call to a callback, as the probe `probe`.
+#define AUTOMOTIVE_PROFILED(probe, call)                                       \
+	do                                                                         \
+	{                                                                          \
+		const uint64_t ProfileStart = callbacks.cycles();                      \
+		call;                                                                  \
+		profile_record(probe, callbacks.cycles() - ProfileStart);              \
+	} while (0)
+#else
+#define AUTOMOTIVE_PROFILED(probe, call) call
+#endif // AUTOMOTIVE_INSTRUMENT
+
+#define platform_uart_send(...)                                                \
+	AUTOMOTIVE_PROFILED(ProbeUartSend, callbacks.uart_send(__VA_ARGS__))
+#define platform_lcd_draw_str(...)                                             \
+	AUTOMOTIVE_PROFILED(ProbeLcdDrawStr,                                       \
+	                    callbacks.lcd.draw_str(callbacks.lcd.lcd, __VA_ARGS__))
+
+static inline uint64_t platform_wait(uint64_t endTime)
+{
+	return callbacks.wait(endTime);
+}
+
+static inline uint64_t platform_wait_time()
+{
+	return callbacks.waitTime;
+}
+
+static inline uint64_t platform_time()
+{
+	return callbacks.time();
+}
+
+static inline uint64_t platform_cycles()
+{
+	return callbacks.cycles();
+}
+
+static inline void platform_loop()
+{
+	AUTOMOTIVE_PROFILED(ProbeLoop, callbacks.loop());
+}
+
+static inline void platform_start()
+{
+	AUTOMOTIVE_PROFILED(ProbeStart, callbacks.start());
+}
+
+static inline uint8_t platform_joystick_read()
+{
+	uint8_t joystick;
+	AUTOMOTIVE_PROFILED(ProbeJoystickRead,
+	                    joystick = callbacks.joystick_read());
+	return joystick;
+}
+
+static inline uint8_t platform_joystick_wait(uint64_t endTime)
+{
+	return callbacks.joystick_wait(endTime);
+}
+
+static inline bool platform_digital_pedal_read()
+{
+	bool pedal;
+	AUTOMOTIVE_PROFILED(ProbeDigitalPedalRead,
+	                    pedal = callbacks.digital_pedal_read());
+	return pedal;
+}
+
+static inline uint32_t platform_analogue_pedal_read()
+{
+	uint32_t pedal;
+	AUTOMOTIVE_PROFILED(ProbeAnaloguePedalRead,
+	                    pedal = callbacks.analogue_pedal_read());
+	return pedal;
+}
+
+static inline void platform_ethernet_transmit(const uint8_t *buffer,
+                                              uint16_t       length)
+{
+	AUTOMOTIVE_PROFILED(ProbeEthernetTransmit,
+	                    callbacks.ethernet_transmit(buffer, length));
+}
+
+static inline void platform_lcd_clean(uint32_t color)
+{
+	AUTOMOTIVE_PROFILED(ProbeLcdClean,
+	                    callbacks.lcd.clean(callbacks.lcd.lcd, color));
+}
+
+static inline void platform_lcd_fill_rect(uint32_t x, // NOLINT
+                                          uint32_t y,
+                                          uint32_t w,
+                                          uint32_t h,
+                                          uint32_t color)
+{
+	AUTOMOTIVE_PROFILED(
+	  ProbeLcdFillRect,
+	  callbacks.lcd.fill_rect(callbacks.lcd.lcd, x, y, w, h, color));
+}
+
+static inline void platform_lcd_draw_img_rgb565(uint32_t       x, // NOLINT
+                                                uint32_t       y,
+                                                uint32_t       w,
+                                                uint32_t       h,
+                                                const uint8_t *data)
+{
+	AUTOMOTIVE_PROFILED(
+	  ProbeLcdDrawImg,
+	  callbacks.lcd.draw_img_rgb565(callbacks.lcd.lcd, x, y, w, h, data));
+}
+
+#endif // AUTOMOTIVE_STATIC_PLATFORM
+
+#endif // AUTOMOTIVE_PLATFORM_H
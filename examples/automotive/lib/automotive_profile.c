@@ -0,0 +1,263 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "analogue_pedal.h"
+#include "automotive_platform.h"
+#include "automotive_profile.h"
+
+// The number of histogram buckets, where bucket `i` counts the times that
+// took from 2^i up to 2^(i+1) cycles.
+#define PROFILE_BUCKETS 32
+
+// The most buckets that are reported on each line, to keep lines short.
+#define BUCKETS_PER_LINE 6
+
+/**
+ * The times that have been recorded for one probe.
+ */
+typedef struct ProfileHistogram
+{
+	uint32_t count;
+	uint32_t minCycles;
+	uint32_t maxCycles;
+	uint64_t totalCycles;
+	uint32_t buckets[PROFILE_BUCKETS];
+} ProfileHistogram;
+
+// The name that each probe is reported with, in the order of `ProfileProbe`.
+static const char *const ProbeNames[ProbeCount] = {
+  "task.no_pedal.one",
+  "task.no_pedal.two",
+  "task.joystick.one",
+  "task.joystick.two",
+  "task.digital.one",
+  "task.digital.two",
+  "task.analogue.one",
+  "task.analogue.two",
+  "callback.uart_send",
+  "callback.loop",
+  "callback.start",
+  "callback.joystick_read",
+  "callback.digital_pedal_read",
+  "callback.analogue_pedal_read",
+  "callback.ethernet_transmit",
+  "callback.lcd.draw_str",
+  "callback.lcd.clean",
+  "callback.lcd.fill_rect",
+  "callback.lcd.draw_img_rgb565",
+};
+
+static ProfileHistogram histograms[ProbeCount];
+
+// The frames of the current demo that have been run, for the scripted inputs.
+static uint32_t scriptFrame = 0;
+
+// Set while the report is being sent, so that the UART callbacks that send it
+// aren't recorded.
+static bool reporting = false;
+
+/**
+ * Records that a run of `probe` took `cycles` cycles.
+ */
+void profile_record(ProfileProbe probe, uint64_t cycles)
+{
+	if (reporting || probe >= ProbeCount)
+	{
+		return;
+	}
+	ProfileHistogram *histogram = &histograms[probe];
+
+	const uint32_t Cycles = cycles > UINT32_MAX ? UINT32_MAX : (uint32_t)cycles;
+	uint32_t       bucket = 0;
+	while (bucket < PROFILE_BUCKETS - 1 && (Cycles >> (bucket + 1)) != 0)
+	{
+		bucket++;
+	}
+	if (histogram->count == 0 || Cycles < histogram->minCycles)
+	{
+		histogram->minCycles = Cycles;
+	}
+	if (Cycles > histogram->maxCycles)
+	{
+		histogram->maxCycles = Cycles;
+	}
+	histogram->count++;
+	histogram->totalCycles += Cycles;
+	histogram->buckets[bucket]++;
+}
+
+/**
+ * Appends `str` to the line being built in `line`, at `*length`.
+ */
+static void append_str(char *line, size_t *length, const char *str)
+{
+	while (*str != '\0')
+	{
+		line[(*length)++] = *str++;
+	}
+	line[*length] = '\0';
+}
+
+/**
+ * Appends ` key=value` to the line being built in `line`, at `*length`.
+ */
+static void
+append_value(char *line, size_t *length, const char *key, uint64_t value)
+{
+	char    digits[20];
+	uint8_t digitCount = 0;
+	do
+	{
+		digits[digitCount++] = '0' + (value % 10);
+		value /= 10;
+	} while (value != 0);
+
+	append_str(line, length, " ");
+	append_str(line, length, key);
+	append_str(line, length, "=");
+	while (digitCount > 0)
+	{
+		line[(*length)++] = digits[--digitCount];
+	}
+	line[*length] = '\0';
+}
+
+/**
+ * Sends the histogram of every probe that has been run via UART. Each probe
+ * is reported as a line of the form:
+ *
+ * profile name=task.joystick.one count=... cycles_min=... cycles_mean=...
+ * cycles_max=...
+ *
+ * followed by one or more lines of its histogram's buckets that aren't empty,
+ * where `log2_N` is the count of times from 2^N up to 2^(N+1) cycles:
+ *
+ * profile_hist name=task.joystick.one log2_12=... log2_13=...
+ *
+ * The lines are built here rather than with the UART callback's formatting,
+ * which only supports unsigned integers, and contain no format specifiers.
+ */
+void profile_report()
+{
+	reporting = true;
+	char   line[192];
+	size_t length;
+	for (uint32_t probe = 0; probe < ProbeCount; ++probe)
+	{
+		const ProfileHistogram *Histogram = &histograms[probe];
+		if (Histogram->count == 0)
+		{
+			continue;
+		}
+		length = 0;
+		append_str(line, &length, "profile name=");
+		append_str(line, &length, ProbeNames[probe]);
+		append_value(line, &length, "count", Histogram->count);
+		append_value(line, &length, "cycles_min", Histogram->minCycles);
+		append_value(line,
+		             &length,
+		             "cycles_mean",
+		             Histogram->totalCycles / Histogram->count);
+		append_value(line, &length, "cycles_max", Histogram->maxCycles);
+		append_str(line, &length, "\n");
+		platform_uart_send(line);
+
+		uint32_t onLine = 0;
+		for (uint32_t bucket = 0; bucket < PROFILE_BUCKETS; ++bucket)
+		{
+			if (Histogram->buckets[bucket] == 0)
+			{
+				continue;
+			}
+			if (onLine == 0)
+			{
+				length = 0;
+				append_str(line, &length, "profile_hist name=");
+				append_str(line, &length, ProbeNames[probe]);
+			}
+			char key[8] = "log2_";
+			key[5]      = '0' + bucket / 10;
+			key[6]      = '0' + bucket % 10;
+			append_value(line, &length, key, Histogram->buckets[bucket]);
+			if (++onLine == BUCKETS_PER_LINE)
+			{
+				append_str(line, &length, "\n");
+				platform_uart_send(line);
+				onLine = 0;
+			}
+		}
+		if (onLine != 0)
+		{
+			append_str(line, &length, "\n");
+			platform_uart_send(line);
+		}
+	}
+	reporting = false;
+}
+
+/**
+ * Discards every recorded time.
+ */
+void profile_reset()
+{
+	for (uint32_t probe = 0; probe < ProbeCount; ++probe)
+	{
+		histograms[probe] = (ProfileHistogram){0};
+	}
+}
+
+/**
+ * Starts the scripted inputs from the first frame, at the start of a demo.
+ */
+void profile_script_start()
+{
+	scriptFrame = 0;
+}
+
+/**
+ * Moves the scripted inputs on to the next frame, at the end of each frame.
+ */
+void profile_script_next_frame()
+{
+	scriptFrame++;
+}
+
+/**
+ * Returns the scripted joystick input for the current frame. The joystick is
+ * moved right and then left again every four frames, which changes the
+ * joystick demo's acceleration, but never up or down, which would trigger the
+ * demos' bugs. It is pressed once `PROFILE_FRAMES` frames have run, to end
+ * the demo.
+ */
+uint8_t profile_script_joystick()
+{
+	if (scriptFrame >= PROFILE_FRAMES)
+	{
+		return Pressed;
+	}
+	switch (scriptFrame % 4)
+	{
+		case 0:
+			return Right;
+		case 2:
+			return Left;
+		default:
+			return 0;
+	}
+}
+
+/**
+ * Returns the scripted analogue pedal input for the current frame, which
+ * ramps up across the pedal's range and then starts again.
+ */
+uint32_t profile_script_analogue_pedal()
+{
+	const uint32_t Range =
+	  DEMO_ACCELERATION_PEDAL_MAX - DEMO_ACCELERATION_PEDAL_MIN;
+	return DEMO_ACCELERATION_PEDAL_MIN + (scriptFrame * 4) % (Range + 1);
+}
@@ -0,0 +1,70 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AUTOMOTIVE_PROFILE_H
+#define AUTOMOTIVE_PROFILE_H
+
+#include <stdint.h>
+
+/*
+ * Profiling of the automotive demos, for comparing the cost of their tasks and
+ * of the platform's callbacks between firmwares.
+ *
+ * When the library is compiled with `AUTOMOTIVE_INSTRUMENT` defined, each run
+ * of a demo's tasks and each call of a callback is timed with the `cycles`
+ * callback, and a histogram of the times is kept for each of the probes below.
+ * `profile_report` sends the histograms via UART in the same format from every
+ * firmware, which `scripts/compare_profiles.py` compares. Without
+ * `AUTOMOTIVE_INSTRUMENT`, nothing is timed or kept.
+ *
+ * So that the demos can be profiled without anyone at the board, or in the
+ * simulator, the `profile_script_*` functions give scripted inputs for the
+ * firmware's callbacks to return, which end each demo after
+ * `PROFILE_FRAMES` frames.
+ */
+
+// The number of frames that each demo is run for when profiling.
+#define PROFILE_FRAMES 64
+
+// The tasks and callbacks that are timed.
+typedef enum ProfileProbe
+{
+	ProbeNoPedalTaskOne = 0,
+	ProbeNoPedalTaskTwo,
+	ProbeJoystickTaskOne,
+	ProbeJoystickTaskTwo,
+	ProbeDigitalTaskOne,
+	ProbeDigitalTaskTwo,
+	ProbeAnalogueTaskOne,
+	ProbeAnalogueTaskTwo,
+	ProbeUartSend,
+	ProbeLoop,
+	ProbeStart,
+	ProbeJoystickRead,
+	ProbeDigitalPedalRead,
+	ProbeAnaloguePedalRead,
+	ProbeEthernetTransmit,
+	ProbeLcdDrawStr,
+	ProbeLcdClean,
+	ProbeLcdFillRect,
+	ProbeLcdDrawImg,
+	ProbeCount,
+} ProfileProbe;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif //__cplusplus
+	void     profile_record(ProfileProbe probe, uint64_t cycles);
+	void     profile_report();
+	void     profile_reset();
+	void     profile_script_start();
+	void     profile_script_next_frame();
+	uint8_t  profile_script_joystick();
+	uint32_t profile_script_analogue_pedal();
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+
+#endif // AUTOMOTIVE_PROFILE_H
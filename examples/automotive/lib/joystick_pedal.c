@@ -5,6 +5,7 @@
 #include <stdbool.h>
 
 #include "automotive_common.h"
+#include "automotive_platform.h"
 #include "joystick_pedal.h"
 
 // Pointers to the memory that has been allocated for use by the system
@@ -41,26 +42,25 @@ void init_joystick_demo_mem(TaskOne *taskOne, TaskTwo *taskTwo)
 static void joystick_task_one()
 {
 	// Display speed information to the LCD
-	callbacks.lcd.draw_str(callbacks.lcd.lcd,
-	                       10,
-	                       45,
-	                       LucidaConsole_10pt,
-	                       "Current speed: %u   ",
-	                       RGBColorBlack,
-	                       RGBColorWhite,
-	                       (unsigned int)taskOneMem->acceleration);
+	platform_lcd_draw_str(10,
+	                      45,
+	                      LucidaConsole_10pt,
+	                      "Current speed: %u   ",
+	                      RGBColorBlack,
+	                      RGBColorWhite,
+	                      (unsigned int)taskOneMem->acceleration);
 
 	// Transmit the previously measured pedal information to the car.
-	callbacks.uart_send("Sending pedal data: acceleration=%u, braking=%u.\n",
-	                    (unsigned int)taskOneMem->acceleration,
-	                    (unsigned int)taskOneMem->braking);
+	platform_uart_send("Sending pedal data: acceleration=%u, braking=%u.\n",
+	                   (unsigned int)taskOneMem->acceleration,
+	                   (unsigned int)taskOneMem->braking);
 	const uint64_t FrameData[2] = {taskOneMem->acceleration,
 	                               taskOneMem->braking};
 	send_data_frame(FrameData, FixedDemoHeader, 2);
 
 	// Read the next pedal information to send - in this case checking for
 	// any joystick inputs and modifying the acceleration accordingly.
-	uint8_t joystick = callbacks.joystick_read();
+	uint8_t joystick = platform_joystick_read();
 	if (joystick_in_direction(joystick, Right) && taskOneMem->acceleration < 99)
 	{
 		taskOneMem->acceleration += 1;
@@ -87,9 +87,9 @@ bool joystick_task_two()
 {
 	// Determine based on joystick input whether the user wishes to
 	// manually trigger the bug in this demo or not.
-	uint8_t    joystick = callbacks.joystick_read();
+	uint8_t    joystick = platform_joystick_read();
 	const bool EnoughTimePassed =
-	  callbacks.time() > (lastInputTime + 3 * callbacks.waitTime);
+	  platform_time() > (lastInputTime + 3 * platform_wait_time());
 	const bool JoystickMoved = joystick_in_direction(joystick, Up) ||
 	                           joystick_in_direction(joystick, Down);
 	if (EnoughTimePassed && JoystickMoved)
@@ -99,19 +99,18 @@ bool joystick_task_two()
 		{ // When untriggering the bug, we reset speed to allow re-use
 			taskOneMem->acceleration = 15;
 		}
-		lastInputTime = callbacks.time();
-		callbacks.uart_send("Manually triggering/untriggering bug.");
+		lastInputTime = platform_time();
+		platform_uart_send("Manually triggering/untriggering bug.");
 	}
 
 	// Display bug status information to the LCD
 	const char *bugStr = isBugged ? "Bug triggered" : "Not triggered";
-	callbacks.lcd.draw_str(callbacks.lcd.lcd,
-	                       10,
-	                       10,
-	                       LucidaConsole_10pt,
-	                       bugStr,
-	                       RGBColorBlack,
-	                       RGBColorGrey);
+	platform_lcd_draw_str(10,
+	                      10,
+	                      LucidaConsole_10pt,
+	                      bugStr,
+	                      RGBColorBlack,
+	                      RGBColorGrey);
 
 	// If flagged to be bugged, use an out-of-bounds index
 	uint32_t index = 99;
@@ -137,13 +136,13 @@ bool joystick_task_two()
  * as is necessary.
  *
  * `initTime` is the time that `run_joystick_demo` was called at, relative
- * to the times returned by `callbacks.wait`.
+ * to the times returned by `platform_wait`.
  */
 void run_joystick_demo(uint64_t initTime)
 {
 	// Start the demo in passthrough mode
-	callbacks.uart_send("Automotive demo started!\n");
-	callbacks.start();
+	platform_uart_send("Automotive demo started!\n");
+	platform_start();
 	send_mode_frame(FixedDemoHeader, DemoModePassthrough);
 
 	// Initialise the car with 15 acceleration, to be changed.
@@ -155,50 +154,54 @@ void run_joystick_demo(uint64_t initTime)
 	isBugged = false;
 
 	// Draw static demo operation/usage information to the LCD
-	callbacks.lcd.draw_str(callbacks.lcd.lcd,
-	                       10,
-	                       62,
-	                       M3x6_16pt,
-	                       "Joystick up/down to change speed",
-	                       RGBColorBlack,
-	                       RGBColorDarkGrey);
-	callbacks.lcd.draw_str(callbacks.lcd.lcd,
-	                       10,
-	                       27,
-	                       M3x6_16pt,
-	                       "Joystick left/right to trigger bug",
-	                       RGBColorBlack,
-	                       RGBColorDarkGrey);
-	callbacks.lcd.draw_str(callbacks.lcd.lcd,
-	                       10,
-	                       80,
-	                       M3x6_16pt,
-	                       "Press the joystick to end the demo.",
-	                       RGBColorBlack,
-	                       RGBColorDarkerGrey);
+	platform_lcd_draw_str(10,
+	                      62,
+	                      M3x6_16pt,
+	                      "Joystick up/down to change speed",
+	                      RGBColorBlack,
+	                      RGBColorDarkGrey);
+	platform_lcd_draw_str(10,
+	                      27,
+	                      M3x6_16pt,
+	                      "Joystick left/right to trigger bug",
+	                      RGBColorBlack,
+	                      RGBColorDarkGrey);
+	platform_lcd_draw_str(10,
+	                      80,
+	                      M3x6_16pt,
+	                      "Press the joystick to end the demo.",
+	                      RGBColorBlack,
+	                      RGBColorDarkerGrey);
 
 	// Call task one and task two sequentially in a loop until the
 	// user selects to quit the demo by pressing the joystick.
-	uint64_t prevTime     = initTime;
-	bool     stillRunning = true;
+	uint64_t   prevTime      = initTime;
+	bool       stillRunning  = true;
+	TaskCycles taskOneCycles = {0, 0, ProbeJoystickTaskOne};
+	TaskCycles taskTwoCycles = {0, 0, ProbeJoystickTaskTwo};
 	while (stillRunning)
 	{
+		uint64_t taskStart = platform_cycles();
 		joystick_task_one();
+		task_cycles_add(&taskOneCycles, taskStart);
+		taskStart = platform_cycles();
 		joystick_task_two();
+		task_cycles_add(&taskTwoCycles, taskStart);
 
 		const bool EnoughTimePassed =
-		  prevTime > (initTime + callbacks.waitTime * 5);
+		  prevTime > (initTime + platform_wait_time() * 5);
 		const bool JoystickPressed =
-		  joystick_in_direction(callbacks.joystick_read(), Pressed);
+		  joystick_in_direction(platform_joystick_read(), Pressed);
 		if (EnoughTimePassed && JoystickPressed)
 		{
 			stillRunning = false;
-			callbacks.uart_send("Manually ended demo by pressing joystick.");
+			platform_uart_send("Manually ended demo by pressing joystick.");
 		}
 
-		prevTime = callbacks.wait(prevTime + callbacks.waitTime);
-		callbacks.loop();
+		prevTime = platform_wait(prevTime + platform_wait_time());
+		platform_loop();
 	}
 
-	callbacks.uart_send("Automotive demo ended!\n");
+	report_task_cycles(&taskOneCycles, &taskTwoCycles);
+	platform_uart_send("Automotive demo ended!\n");
 }
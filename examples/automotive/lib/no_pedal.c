@@ -4,6 +4,8 @@
 
 #include <stdbool.h>
 
+#include "automotive_common.h"
+#include "automotive_platform.h"
 #include "no_pedal.h"
 
 // Pointers to the memory that has been allocated for use by the system
@@ -37,9 +39,9 @@ void init_no_pedal_demo_mem(TaskOne *taskOne, TaskTwo *taskTwo)
  */
 static void no_pedal_task_one()
 {
-	callbacks.uart_send("Sending pedal data: acceleration=%u, braking=%u.\n",
-	                    (unsigned int)taskOneMem->acceleration,
-	                    (unsigned int)taskOneMem->braking);
+	platform_uart_send("Sending pedal data: acceleration=%u, braking=%u.\n",
+	                   (unsigned int)taskOneMem->acceleration,
+	                   (unsigned int)taskOneMem->braking);
 	const uint64_t FrameData[2] = {taskOneMem->acceleration,
 	                               taskOneMem->braking};
 	send_data_frame(FrameData, FixedDemoHeader, 2);
@@ -67,25 +69,23 @@ bool no_pedal_task_two()
 		resetCounter = false;
 	}
 	counter += 1;
-	callbacks.uart_send("task_two, count = %u\n", (unsigned int)counter);
+	platform_uart_send("task_two, count = %u\n", (unsigned int)counter);
 
 	// Draw simple pseudocode explaining the bug to the LCD
-	callbacks.lcd.draw_str(callbacks.lcd.lcd,
-	                       5,
-	                       25,
-	                       LucidaConsole_10pt,
-	                       "int i = %u;",
-	                       RGBColorBlack,
-	                       RGBColorGrey,
-	                       (unsigned int)counter);
+	platform_lcd_draw_str(5,
+	                      25,
+	                      LucidaConsole_10pt,
+	                      "int i = %u;",
+	                      RGBColorBlack,
+	                      RGBColorGrey,
+	                      (unsigned int)counter);
 	uint32_t textColor = (counter >= 100) ? RGBColorRed : RGBColorGrey;
-	callbacks.lcd.draw_str(callbacks.lcd.lcd,
-	                       5,
-	                       55,
-	                       LucidaConsole_10pt,
-	                       "  arr[i] = 1000;",
-	                       RGBColorBlack,
-	                       textColor);
+	platform_lcd_draw_str(5,
+	                      55,
+	                      LucidaConsole_10pt,
+	                      "  arr[i] = 1000;",
+	                      RGBColorBlack,
+	                      textColor);
 
 	// The buggy line of code implementing task two - this should be a "<" check
 	// to be within the `write` array bounds, but the "<=" comparison check
@@ -104,13 +104,13 @@ bool no_pedal_task_two()
  * as is necessary.
  *
  * `initTime` is the time that `run_no_pedal_demo` was called at, relative
- * to the times returned by `callbacks.wait`.
+ * to the times returned by `platform_wait`.
  */
 void run_no_pedal_demo(uint64_t initTime)
 {
 	// Start the demo in passthrough mode
-	callbacks.uart_send("Automotive demo started!\n");
-	callbacks.start();
+	platform_uart_send("Automotive demo started!\n");
+	platform_start();
 	send_mode_frame(FixedDemoHeader, DemoModePassthrough);
 
 	// Initialise the car with 15 acceleration, to be overwritten.
@@ -120,37 +120,41 @@ void run_no_pedal_demo(uint64_t initTime)
 	resetCounter             = true;
 
 	// Draw pseudocode display information to the LCD.
-	callbacks.lcd.draw_str(callbacks.lcd.lcd,
-	                       5,
-	                       10,
-	                       LucidaConsole_10pt,
-	                       "int arr[100];",
-	                       RGBColorBlack,
-	                       RGBColorGrey);
-	callbacks.lcd.draw_str(callbacks.lcd.lcd,
-	                       5,
-	                       40,
-	                       LucidaConsole_10pt,
-	                       "if (i <= 100) {",
-	                       RGBColorBlack,
-	                       RGBColorGrey);
-	callbacks.lcd.draw_str(callbacks.lcd.lcd,
-	                       5,
-	                       70,
-	                       LucidaConsole_10pt,
-	                       "}",
-	                       RGBColorBlack,
-	                       RGBColorGrey);
+	platform_lcd_draw_str(5,
+	                      10,
+	                      LucidaConsole_10pt,
+	                      "int arr[100];",
+	                      RGBColorBlack,
+	                      RGBColorGrey);
+	platform_lcd_draw_str(5,
+	                      40,
+	                      LucidaConsole_10pt,
+	                      "if (i <= 100) {",
+	                      RGBColorBlack,
+	                      RGBColorGrey);
+	platform_lcd_draw_str(5,
+	                      70,
+	                      LucidaConsole_10pt,
+	                      "}",
+	                      RGBColorBlack,
+	                      RGBColorGrey);
 
 	// Call task one and task two sequentially in a loop for 175 iterations.
-	uint64_t prevTime = initTime;
+	uint64_t   prevTime      = initTime;
+	TaskCycles taskOneCycles = {0, 0, ProbeNoPedalTaskOne};
+	TaskCycles taskTwoCycles = {0, 0, ProbeNoPedalTaskTwo};
 	for (uint32_t i = 0; i < 175; i++)
 	{
+		uint64_t taskStart = platform_cycles();
 		no_pedal_task_one();
+		task_cycles_add(&taskOneCycles, taskStart);
+		taskStart = platform_cycles();
 		no_pedal_task_two();
-		prevTime = callbacks.wait(prevTime + callbacks.waitTime);
-		callbacks.loop();
+		task_cycles_add(&taskTwoCycles, taskStart);
+		prevTime = platform_wait(prevTime + platform_wait_time());
+		platform_loop();
 	}
 
-	callbacks.uart_send("Automotive demo ended!\n");
+	report_task_cycles(&taskOneCycles, &taskTwoCycles);
+	platform_uart_send("Automotive demo ended!\n");
 }
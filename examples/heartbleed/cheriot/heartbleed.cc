@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <thread.h>
 
+#include "../../../libraries/gpio_input.hh"
 #include "../../../libraries/lcd.hh"
 #include <platform-gpio.hh>
 
@@ -16,94 +17,42 @@ using namespace CHERI;
 using namespace sonata::lcd;
 SonataLcd *lcd = nullptr;
 
-constexpr bool     DebugDemo          = true;
-constexpr uint32_t LengthScrollMillis = 150u;
-constexpr Color    BackgroundColor    = Color::Black;
-constexpr Color    ForegroundColor    = Color::White;
+constexpr bool  DebugDemo       = true;
+constexpr Color BackgroundColor = Color::Black;
+constexpr Color ForegroundColor = Color::White;
 
 using Debug             = ConditionalDebug<DebugDemo, "Heartbleed">;
 using JoystickDirection = SonataGpioBoard::JoystickDirection;
 using JoystickValue     = SonataGpioBoard::JoystickValue;
 
 /**
- * @brief Busy waits for a given amount of time, constantly polling for any
- * joystick input and recording it to avoid inputs being eaten between
- * frames. This will only avoid inputs being eaten if the joystick did not
- * move on the previous invocation of this function. This produces behaviour
- * where holding the joystick ends when letting go of the joystick, but a
- * single small tap between frames will be recorded.
+ * @brief Sleeps until the joystick is pressed, or held long enough to repeat,
+ * in any direction. Presses are queued by the GPIO input compartment, so a
+ * single small tap is recorded however short it is.
  *
- * @param milliseconds The time to wait for in milliseconds.
- * @param gpio The Sonata GPIO driver to use for I/O operations.
- * @param onlyFirst True if this should only record the first joystick input,
- * False if it should record all (OR them together).
- * @param consecutive True if this should avoid eating inputs on consecutive
- * inputs in the same direction, False if it should only poll for the first
- * movement in a direction.
- * @return The joystick state that was read.
+ * @return The joystick input that was pressed or repeated.
  */
-JoystickValue wait_with_input(uint32_t                  milliseconds,
-                              volatile SonataGpioBoard *gpio,
-                              bool                      onlyFirst,
-                              bool                      consecutive)
+JoystickValue wait_for_input()
 {
-	static JoystickDirection prevDirection =
-	  static_cast<JoystickDirection>(0x0);
-
-	const uint32_t    CyclesPerMillisecond = CPU_TIMER_HZ / 1000;
-	const uint32_t    Cycles        = milliseconds * CyclesPerMillisecond;
-	const uint64_t    Start         = rdcycle64();
-	uint64_t          end           = Start + Cycles;
-	uint64_t          current       = Start;
-	JoystickDirection joystickInput = static_cast<JoystickDirection>(0x0);
-	while (end > current)
-	{
-		if (onlyFirst && !joystickInput)
-		{
-			joystickInput = static_cast<JoystickDirection>(
-			  gpio->input & SonataGpioBoard::Inputs::Joystick);
-		}
-		else if (!onlyFirst)
-		{
-			joystickInput = static_cast<JoystickDirection>(
-			  (gpio->input & SonataGpioBoard::Inputs::Joystick) |
-			  static_cast<uint32_t>(joystickInput));
-		}
-		current = rdcycle64();
-	}
-
-	// If this is the first invocation in which the joystick was held in this
-	// direction (i.e. a 'tap' or the start of a hold), or the `consecutive`
-	// setting is set, use the polled input to avoid inputs being eaten.
-	// If the `consecutive` setting is False and we previously moved in this
-	// direction, use only the GPIO read at the end of waiting.
-	JoystickDirection retDirection;
-	if (!consecutive && (static_cast<uint32_t>(prevDirection) &
-	                     static_cast<uint32_t>(joystickInput)))
-	{
-		retDirection = static_cast<JoystickDirection>(
-		  gpio->input & SonataGpioBoard::Inputs::Joystick);
-	}
-	else
+	Timeout        forever{UnlimitedTimeout};
+	GpioInputEvent event;
+	while (gpio_input_wait(&forever, &event) != 0 ||
+	       event.kind == GpioInputEventKind::Release)
 	{
-		retDirection = joystickInput;
 	}
-	prevDirection = joystickInput;
-	return {retDirection};
+	return {static_cast<JoystickDirection>(event.input)};
 };
 
 /**
- * @brief Waits for `LengthScrollMillis` while polling constantly for user
- * input on the joystick. Uses joystick up/down movements to control the
- * size of the request length, and detects pressed to submit the "heartbeat"
- * request.
+ * @brief Waits for user input on the joystick. Uses joystick up/down
+ * movements to control the size of the request length, repeating while they
+ * are held, and detects pressed to submit the "heartbeat" request.
  *
- * @param gpio The Sonata GPIO driver to use for I/O operations
  * @param current A param/outparam storing the current response length, which
  * will be updated to store the new response length if it changes.
  * @return Whether to submit the response or not (true = submit).
  */
-bool length_joystick_control(volatile SonataGpioBoard *gpio, size_t *current)
+bool length_joystick_control(size_t *current)
 {
 	constexpr JoystickDirection IncreaseDirection =
 	  static_cast<JoystickDirection>(JoystickDirection::Up |
@@ -113,7 +62,7 @@ bool length_joystick_control(volatile SonataGpioBoard *gpio, size_t *current)
 	                                 JoystickDirection::Left);
 	constexpr size_t SizeLimit = 256;
 
-	auto joystickInput = wait_with_input(LengthScrollMillis, gpio, true, false);
+	auto joystickInput = wait_for_input();
 	if (joystickInput.is_direction_pressed(IncreaseDirection))
 	{
 		if (!joystickInput.is_direction_pressed(DecreaseDirection))
@@ -169,12 +118,9 @@ void initial_lcd_write(SonataLcd *lcd)
  * @brief Display the request length integer to the LCD.
  *
  * @param lcd The Sonata LCD Driver
- * @param gpio The Sonata GPIO driver to use for I/O operations
  * @param request_length The request length to display
  */
-void draw_request_length(SonataLcd                *lcd,
-                         volatile SonataGpioBoard *gpio,
-                         size_t                    request_length)
+void draw_request_length(SonataLcd *lcd, size_t request_length)
 {
 	constexpr size_t ReqLenStrLen = 15u;
 	char             req_len_s[ReqLenStrLen];
@@ -189,24 +135,22 @@ void draw_request_length(SonataLcd                *lcd,
  * to submit the request.
  *
  * @param lcd The Sonata LCD Driver
- * @param gpio The Sonata GPIO driver to use for I/O operations
  * @param request_length An out parameter containing the initial request
  * length, and to which the final request length will be written.
  */
-void get_request_length(SonataLcd                *lcd,
-                        volatile SonataGpioBoard *gpio,
-                        size_t                   *request_length)
+void get_request_length(SonataLcd *lcd, size_t *request_length)
 {
 	// Initial draw
-	draw_request_length(lcd, gpio, *request_length);
+	draw_request_length(lcd, *request_length);
 
 	// Get user input
 	Debug::log("Waiting for user input on the joystick...");
+	gpio_input_flush();
 	bool inputSubmitted = false;
 	while (!inputSubmitted)
 	{
 		size_t prev_length = *request_length;
-		inputSubmitted     = length_joystick_control(gpio, request_length);
+		inputSubmitted     = length_joystick_control(request_length);
 		if (*request_length == prev_length)
 		{
 			continue; // Only re-draw when changed
@@ -216,7 +160,7 @@ void get_request_length(SonataLcd                *lcd,
 		              BackgroundColor,
 		              ForegroundColor,
 		              Font::M5x7_16pt);
-		draw_request_length(lcd, gpio, *request_length);
+		draw_request_length(lcd, *request_length);
 	}
 
 	Debug::log("Heartbeat submitted with length {}", (int)(*request_length));
@@ -226,11 +170,11 @@ void get_request_length(SonataLcd                *lcd,
  * @brief This function mocks the network and show the package on the lcd
  * instead.
  *
- * @param lcd A handle to Sonata's LCD
- * @param package The package to be sent.
- * @param len The length of the package .
+ * @param handle A handle to Sonata's LCD
+ * @param segments The segments of the package to be sent.
+ * @param count The number of segments.
  */
-void network_send(void *handle, const char *package, size_t len)
+void network_send(void *handle, const IoVec *segments, size_t count)
 {
 	constexpr uint32_t CharsPerLine = 29;
 	SonataLcd         *lcd          = (SonataLcd *)handle;
@@ -239,36 +183,41 @@ void network_send(void *handle, const char *package, size_t len)
 	lcd->fill_rect({w_border, 50, 160 - w_border, 128}, Color::Grey);
 
 	// Break the result message into several lines if it is too long to fit on
-	// one line.
-	char        line_content[CharsPerLine + 1];
-	const char *cursor      = package;
-	size_t      line_length = 0u;
-	size_t      line_num    = 0u;
-	while (len-- != 0)
+	// one line. Each segment is read in place.
+	char   line_content[CharsPerLine + 1];
+	size_t line_length = 0u;
+	size_t line_num    = 0u;
+	for (const IoVec *segment = segments; segment != segments + count;
+	     segment++)
 	{
-		if (*cursor == 0)
+		const char *cursor = segment->base;
+		size_t      len    = segment->len;
+		while (len-- != 0)
 		{
-			line_content[line_length++] = '`';
-		}
-		else if (isprint((int)(*cursor)) == 0)
-		{
-			line_content[line_length++] = '%';
-		}
-		else
-		{
-			line_content[line_length++] = *cursor;
-		}
-		cursor++;
-		if (line_length == CharsPerLine)
-		{
-			line_content[line_length] = '\0';
-			lcd->draw_str({5, 55 + 10 * line_num},
-			              line_content,
-			              Color::Grey,
-			              Color::Black,
-			              Font::M5x7_16pt);
-			line_length = 0;
-			line_num++;
+			if (*cursor == 0)
+			{
+				line_content[line_length++] = '`';
+			}
+			else if (isprint((int)(*cursor)) == 0)
+			{
+				line_content[line_length++] = '%';
+			}
+			else
+			{
+				line_content[line_length++] = *cursor;
+			}
+			cursor++;
+			if (line_length == CharsPerLine)
+			{
+				line_content[line_length] = '\0';
+				lcd->draw_str({5, 55 + 10 * line_num},
+				              line_content,
+				              Color::Grey,
+				              Color::Black,
+				              Font::M5x7_16pt);
+				line_length = 0;
+				line_num++;
+			}
 		}
 	}
 	// Write the final line containing the remainder of the message.
@@ -322,9 +271,6 @@ compartment_error_handler(ErrorState *frame, size_t mcause, size_t mtval)
 	size_t w_border = 2;
 	lcd->fill_rect({w_border, 50, 160 - w_border, 128}, Color::Grey);
 
-	// Initialise GPIO driver to interact with the Joystick
-	auto gpio = MMIO_CAPABILITY(SonataGpioBoard, gpio_board);
-
 	size_t req_len = 8;
 	while (true)
 	{
@@ -339,7 +285,7 @@ compartment_error_handler(ErrorState *frame, size_t mcause, size_t mtval)
 		initial_lcd_write(lcd);
 
 		// Wait for the request.
-		get_request_length(lcd, gpio, &req_len);
+		get_request_length(lcd, &req_len);
 
 		const char *result =
 		  run_query("SELECT name FROM animal WHERE can_fly=yes LIMIT 1");
@@ -3,12 +3,12 @@
 
 -- Compartments used for the automotive demo firmware
 compartment("heartbleed")
-    add_deps("lcd", "debug", "string")
+    add_deps("lcd", "debug", "string", "gpio_input")
     add_files("heartbleed.cc", "../common.c")
 
 -- CHERIoT version of Heartbleed Demo Firmware
 firmware("heartbleed_cheriot")
-    add_deps("freestanding", "heartbleed")
+    add_deps("freestanding", "heartbleed", "gpio_input")
     on_load(function(target)
         target:values_set("board", "$(board)")
         target:values_set("threads", {
@@ -18,6 +18,13 @@ firmware("heartbleed_cheriot")
                 entry_point = "entry",
                 stack_size = 0x800,
                 trusted_stack_frames = 2
+            },
+            {
+                compartment = "gpio_input",
+                priority = 3,
+                entry_point = "gpio_input_run",
+                stack_size = 0x300,
+                trusted_stack_frames = 1
             }
         }, {expand = false})
     end)
@@ -46,12 +46,18 @@ static const char *json =
 
 	void heartbleed(void *handle, const char *buffer, size_t len)
 	{
-		const size_t headerLen = 7u;
-		char         package[headerLen + len + 1];
-		memcpy(package, "{Resp: ", headerLen);
-		memcpy(&package[headerLen], buffer, len);
-		package[headerLen + len] = '\0';
-		network_send(handle, package, sizeof(package));
+		// The payload is sent straight from `buffer` without being copied. On
+		// CHERIoT, the sink reads it through `buffer`'s capability, so an
+		// over-long `len` traps there rather than leaking what follows.
+		static const char ResponseHeader[] = "{Resp: ";
+		static const char Terminator[]     = "";
+
+		const IoVec Response[] = {
+		  {ResponseHeader, sizeof(ResponseHeader) - 1},
+		  {buffer, len},
+		  {Terminator, sizeof(Terminator)},
+		};
+		network_send(handle, Response, sizeof(Response) / sizeof(Response[0]));
 	}
 
 	void size_t_to_str_base10(char *buffer, size_t num)
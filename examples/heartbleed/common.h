@@ -11,7 +11,26 @@ extern "C"
 {
 #endif //__cplusplus
 
-	extern void network_send(void *handle, const char *package, size_t len);
+	/**
+	 * A segment of a response, pointing into memory owned by the caller.
+	 */
+	typedef struct IoVec
+	{
+		const char *base;
+		size_t      len;
+	} IoVec;
+
+	/**
+	 * @brief Sends a response made up of `count` segments, in order. The
+	 * segments are read where they are, rather than being gathered into a
+	 * single buffer first.
+	 *
+	 * @param handle The handle passed to `heartbleed`.
+	 * @param segments The segments of the response.
+	 * @param count The number of segments.
+	 */
+	extern void
+	network_send(void *handle, const IoVec *segments, size_t count);
 
 	/**
 	 * @brief Run a query and allocate a buffer with the response, the buffer
@@ -24,8 +43,8 @@ extern "C"
 	char *run_query(const char *query);
 
 	/**
-	 * @brief Format the response package, the buffer is copied to the response
-	 * package based on the length, if larger than the buffer, sensitive
+	 * @brief Send the response package, which is a header followed by `len`
+	 * bytes of the buffer. If `len` is larger than the buffer, sensitive
 	 * information can be leaked throught the network.
 	 *
 	 * This function requires that the caller implements the function
@@ -34,9 +53,7 @@ extern "C"
 	 * @param handle A pointer to a handle that will be forward to the
 	 * network_send.
 	 * @param buffer The buffer to be sent.
-	 * @param buffer_size The size of the buffer.
-	 * @return A heap-allocated copy of the message. Simulates a response
-	 * packet.
+	 * @param len The number of bytes of the buffer to send.
 	 */
 	void heartbleed(void *handle, const char *buffer, size_t len);
 
@@ -218,11 +218,11 @@ void get_request_length(St7735Context *lcd, size_t *request_length)
  * @brief This function mocks the network and show the package on the lcd
  * instead.
  *
- * @param lcd A handle to Sonata's LCD
- * @param package The package to be sent.
- * @param len The length of the package .
+ * @param handle A handle to Sonata's LCD
+ * @param segments The segments of the package to be sent.
+ * @param count The number of segments.
  */
-void network_send(void *handle, const char *package, size_t len)
+void network_send(void *handle, const IoVec *segments, size_t count)
 {
 	const uint32_t CharsPerLine = 29u;
 	St7735Context *lcd          = (St7735Context *)handle;
@@ -234,34 +234,39 @@ void network_send(void *handle, const char *package, size_t len)
 	  lcd, 0, 50, lcd->parent.width, lcd->parent.height - 50, TextAreaBgColor);
 
 	// Break the result message into several lines if it is too long to fit on
-	// one line.
-	char        line_content[CharsPerLine + 1];
-	const char *cursor      = package;
-	size_t      line_length = 0u;
-	size_t      line_num    = 0u;
-	while (len-- != 0)
+	// one line. Each segment is read in place.
+	char   line_content[CharsPerLine + 1];
+	size_t line_length = 0u;
+	size_t line_num    = 0u;
+	for (const IoVec *segment = segments; segment != segments + count;
+	     segment++)
 	{
-		if (isprint((int)(*cursor)) == 0)
-		{
-			line_content[line_length++] = '%';
-		}
-		else
-		{
-			line_content[line_length++] = *cursor;
-		}
-		cursor++;
-		if (line_length == CharsPerLine)
+		const char *cursor = segment->base;
+		size_t      len    = segment->len;
+		while (len-- != 0)
 		{
-			line_content[line_length] = '\0';
-			lcd_draw_str(lcd,
-			             1,
-			             55 + 10 * line_num,
-			             M5x7_16pt,
-			             line_content,
-			             TextAreaBgColor,
-			             TextAreaFgColor);
-			line_length = 0;
-			line_num++;
+			if (isprint((int)(*cursor)) == 0)
+			{
+				line_content[line_length++] = '%';
+			}
+			else
+			{
+				line_content[line_length++] = *cursor;
+			}
+			cursor++;
+			if (line_length == CharsPerLine)
+			{
+				line_content[line_length] = '\0';
+				lcd_draw_str(lcd,
+				             1,
+				             55 + 10 * line_num,
+				             M5x7_16pt,
+				             line_content,
+				             TextAreaBgColor,
+				             TextAreaFgColor);
+				line_length = 0;
+				line_num++;
+			}
 		}
 	}
 	// Write the final line containing the remainder of the message.
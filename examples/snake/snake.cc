@@ -9,6 +9,7 @@
 #include <thread.h>
 #include <vector>
 
+#include "../../libraries/gpio_input.hh"
 #include "../../libraries/lcd.hh"
 #include "cherry_bitmap.h"
 
@@ -16,7 +17,6 @@ using Debug = ConditionalDebug<true, "Snake">;
 using namespace sonata::lcd;
 using namespace CHERI;
 using JoystickDirection = SonataGpioBoard::JoystickDirection;
-using JoystickValue     = SonataGpioBoard::JoystickValue;
 
 // Control game speed
 static constexpr uint32_t MillisecondsPerFrame = 400;
@@ -156,10 +156,9 @@ class SnakeGame
 	 * @brief Displays the "start game" menu, waiting for an input and
 	 * initialising a random seed based on the first user input.
 	 *
-	 * @param gpio The Sonata GPIO driver to use for I/O operations.
 	 * @param lcd The LCD that will be drawn to.
 	 */
-	void wait_for_start(volatile SonataGpioBoard *gpio, SonataLcd *lcd)
+	void wait_for_start(SonataLcd *lcd)
 	{
 		Size  displaySize = lcd->resolution();
 		Point centre      = {displaySize.width / 2, displaySize.height / 2};
@@ -204,22 +203,18 @@ class SnakeGame
 			thread_millisecond_wait(StartMenuWaitMilliseconds);
 		}
 
-		// Busy-wait for a valid joystick input
-		bool waitingForInput = true;
-		while (waitingForInput)
+		// Sleep until a valid joystick press, ignoring any input from before
+		// the menu was shown
+		gpio_input_flush();
+		const uint32_t StartInputs =
+		  StartOnAnyInput ? AllJoystickDirections : JoystickDirection::Pressed;
+		Timeout        forever{UnlimitedTimeout};
+		GpioInputEvent event;
+		while (gpio_input_wait(&forever, &event) != 0 ||
+		       event.kind != GpioInputEventKind::Press ||
+		       (event.input & StartInputs) == 0)
 		{
-			thread_millisecond_wait(50);
-			auto joystickInput = gpio->read_joystick();
-			if (!StartOnAnyInput && joystickInput.is_pressed())
-			{
-				waitingForInput = false;
-			}
-			else if (StartOnAnyInput &&
-			         joystickInput.is_direction_pressed(AllJoystickDirections))
-			{
-				waitingForInput = false;
-			}
-		};
+		}
 		Debug::log("Input detected. Game starting...");
 
 		// Initialise Pseudo RNG based on cycle counter at time of first input
@@ -227,15 +222,13 @@ class SnakeGame
 	};
 
 	/**
-	 * @brief Reads the GPIO output to find the current joystick output, and
-	 * translates it into a relevant direction. Returns the previous direction
-	 * if no current output.
+	 * @brief Translates the joystick inputs into a relevant direction.
+	 * Returns the previous direction if no direction is held.
 	 *
-	 * @param gpio The Sonata GPIO driver to use for I/O operations.
+	 * @param joystickState The debounced joystick inputs to translate.
 	 */
-	Direction read_joystick(volatile SonataGpioBoard *gpio)
+	Direction read_joystick(uint32_t joystickState)
 	{
-		JoystickValue joystickState = gpio->read_joystick();
 		// The joystick can be in many possible directions - we check directions
 		// in order relative to the current direction so that input prioritises
 		// turning left/right over staying in the same direction. This avoids
@@ -264,7 +257,7 @@ class SnakeGame
 				continue; // Disallow moving in the opposite direction
 			}
 			uint8_t idx = (base + offset) % 4;
-			if (joystickState.is_direction_pressed(joystickStates[idx]))
+			if ((joystickState & joystickStates[idx]) != 0)
 			{
 				return directions[idx];
 			}
@@ -273,24 +266,21 @@ class SnakeGame
 	};
 
 	/**
-	 * @brief Busy waits for a given amount of time, constantly polling for any
-	 * joystick input and recording it to avoid inputs being eaten between
-	 * frames.
+	 * @brief Sleeps for a given amount of time, waking for each joystick
+	 * press to record it so that inputs aren't eaten between frames.
 	 *
 	 * @param milliseconds The time to wait for in milliseconds.
-	 * @param gpio The Sonata GPIO driver to use for I/O operations.
 	 */
-	void wait_with_input(uint32_t milliseconds, volatile SonataGpioBoard *gpio)
+	void wait_with_input(uint32_t milliseconds)
 	{
-		const uint32_t CyclesPerMillisecond = CPU_TIMER_HZ / 1000;
-		const uint32_t Cycles  = milliseconds * CyclesPerMillisecond;
-		const uint64_t Start   = rdcycle64();
-		uint64_t       end     = Start + Cycles;
-		uint64_t       current = Start;
-		while (end > current)
+		Timeout        timeout{MS_TO_TICKS(milliseconds)};
+		GpioInputEvent event;
+		while (gpio_input_wait(&timeout, &event) == 0)
 		{
-			lastSeenDirection = read_joystick(gpio);
-			current           = rdcycle64();
+			if (event.kind == GpioInputEventKind::Press)
+			{
+				lastSeenDirection = read_joystick(event.inputs);
+			}
 		}
 	};
 
@@ -401,7 +391,8 @@ class SnakeGame
 	/**
 	 * @brief Draw a cherry (fruit) at a given tile position. If TILE_SIZE is
 	 * either 10x10 or 5x5 and USE_CHERRY_IMAGE is set then this will attempt to
-	 * display a relevant bitmap; otherwise it will draw a green rectangle.
+	 * display a relevant bitmap, with its black background transparent;
+	 * otherwise it will draw a green rectangle.
 	 *
 	 * @param lcd The LCD that will be drawn to.
 	 * @param position The integer tile position (x, y) to draw at.
@@ -411,11 +402,17 @@ class SnakeGame
 		Rect tileRect = get_tile_rect(position);
 		if (UseCherryImage && TileSize.height == 10 && TileSize.width == 10)
 		{
-			lcd->draw_image_rgb565(tileRect, cherryImage10x10);
+			const Sprite Cherry = {
+			  TileSize, cherryImage10x10, Color565(Color::Black)};
+			lcd->draw_sprite(
+			  {tileRect.left, tileRect.top}, Cherry, BackgroundColor);
 		}
 		else if (UseCherryImage && TileSize.height == 5 && TileSize.width == 5)
 		{
-			lcd->draw_image_rgb565(tileRect, cherryImage5x5);
+			const Sprite Cherry = {
+			  TileSize, cherryImage5x5, Color565(Color::Black)};
+			lcd->draw_sprite(
+			  {tileRect.left, tileRect.top}, Cherry, BackgroundColor);
 		}
 		else
 		{
@@ -459,9 +456,9 @@ class SnakeGame
 	 * @param position The integer tile position (x, y) to draw at.
 	 * @return true if the game is still active, false if the game is over.
 	 */
-	bool update_game_state(volatile SonataGpioBoard *gpio, SonataLcd *lcd)
+	bool update_game_state(SonataLcd *lcd)
 	{
-		currentDirection = read_joystick(gpio);
+		currentDirection = read_joystick(gpio_input_state());
 
 		int8_t dx, dy;
 		switch (currentDirection)
@@ -540,10 +537,9 @@ class SnakeGame
 	 * @brief Runs the main game loop, updating the snake's movement and drawing
 	 * new information to the display, and regulates update/frame timing.
 	 *
-	 * @param gpio The Sonata GPIO driver to use for I/O operations
 	 * @param lcd The LCD that will be drawn to.
 	 */
-	void main_game_loop(volatile SonataGpioBoard *gpio, SonataLcd *lcd)
+	void main_game_loop(SonataLcd *lcd)
 	{
 		const uint32_t CyclesPerMillisecond = CPU_TIMER_HZ / 1000;
 		uint64_t       currentTime          = rdcycle64();
@@ -571,11 +567,11 @@ class SnakeGame
 			if (elapsedTimeMilliseconds < frameTime)
 			{
 				uint64_t remainingTime = frameTime - elapsedTimeMilliseconds;
-				wait_with_input(remainingTime, gpio);
+				wait_with_input(remainingTime);
 			}
 			currentTime = rdcycle64();
 
-			gameStillActive = update_game_state(gpio, lcd);
+			gameStillActive = update_game_state(lcd);
 
 			if (errorSeen)
 			{
@@ -601,14 +597,13 @@ class SnakeGame
 	/**
 	 * @brief Plays a game of snake using the stored state as settings.
 	 *
-	 * @param gpio The Sonata GPIO driver to use for I/O operations.
 	 * @param lcd The LCD that will be drawn to.
 	 */
-	void run_game(volatile SonataGpioBoard *gpio, SonataLcd *lcd)
+	void run_game(SonataLcd *lcd)
 	{
-		wait_for_start(gpio, lcd);
+		wait_for_start(lcd);
 		initialise_game();
-		main_game_loop(gpio, lcd);
+		main_game_loop(lcd);
 		free_game_space();
 		isFirstGame = false;
 	};
@@ -674,14 +669,13 @@ compartment_error_handler(ErrorState *frame, size_t mcause, size_t mtval)
 // Thread entry point.
 void __cheri_compartment("snake") snake()
 {
-	auto gpio = MMIO_CAPABILITY(SonataGpioBoard, gpio_board);
-	auto lcd  = SonataLcd();
+	auto lcd = SonataLcd();
 	Debug::log("Detected display resolution: {} {}",
 	           static_cast<int>(lcd.resolution().width),
 	           static_cast<int>(lcd.resolution().height));
 	SnakeGame game = SnakeGame(&lcd);
 	while (true)
 	{
-		game.run_game(gpio, &lcd);
+		game.run_game(&lcd);
 	}
 }
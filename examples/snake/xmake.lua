@@ -2,11 +2,11 @@
 -- SPDX-License-Identifier: Apache-2.0
 
 compartment("snake") 
-  add_deps("lcd", "debug")
+  add_deps("lcd", "debug", "gpio_input")
   add_files("snake.cc")
 
 firmware("snake_demo")
-    add_deps("freestanding", "snake")
+    add_deps("freestanding", "snake", "gpio_input")
     on_load(function(target)
         target:values_set("board", "$(board)")
         target:values_set("threads", {
@@ -16,6 +16,13 @@ firmware("snake_demo")
                 entry_point = "snake",
                 stack_size = 0x1000,
                 trusted_stack_frames = 2
+            },
+            {
+                compartment = "gpio_input",
+                priority = 3,
+                entry_point = "gpio_input_run",
+                stack_size = 0x300,
+                trusted_stack_frames = 1
             }
         }, {expand = false})
     end)
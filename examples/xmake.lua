@@ -17,7 +17,7 @@ includes("all", "snake", "automotive", "heartbleed")
 
 -- A simple demo using only devices on the Sonata board
 firmware("sonata_simple_demo")
-    add_deps("freestanding", "led_walk_raw", "echo", "lcd_test", "rgbled_lerp")
+    add_deps("freestanding", "led_walk_raw", "echo", "lcd_test", "rgbled_lerp", "rgbled_animation")
     on_load(function(target)
         target:values_set("board", "$(board)")
         target:values_set("threads", {
@@ -47,15 +47,78 @@ firmware("sonata_simple_demo")
                 priority = 2,
                 entry_point = "lerp_rgbleds",
                 stack_size = 0x200,
+                trusted_stack_frames = 2
+            },
+            {
+                compartment = "rgbled_animation",
+                priority = 3,
+                entry_point = "rgbled_animation_run",
+                stack_size = 0x300,
                 trusted_stack_frames = 1
             }
         }, {expand = false})
     end)
     after_link(convert_to_uf2)
 
+-- The simple demo with its CPU load shown as bars on the LCD, in place of the
+-- LCD test, and printed over the UART. Build it with `--cpu_accounting=y
+-- --scheduler-accounting=y` for the threads to report their cycles. The
+-- threads have the stack and trusted stack frames to call the cpu_accounting
+-- compartment, which calls the scheduler in turn.
+firmware("sonata_load_demo")
+    add_deps("freestanding", "led_walk_raw", "echo", "rgbled_lerp", "rgbled_animation", "cpu_accounting", "cpu_load")
+    on_load(function(target)
+        target:values_set("board", "$(board)")
+        target:values_set("threads", {
+            {
+                compartment = "led_walk_raw",
+                priority = 2,
+                entry_point = "start_walking",
+                stack_size = 0x300,
+                trusted_stack_frames = 3
+            },
+            {
+                compartment = "echo",
+                priority = 1,
+                entry_point = "entry_point",
+                stack_size = 0x300,
+                trusted_stack_frames = 3
+            },
+            {
+                compartment = "rgbled_lerp",
+                priority = 2,
+                entry_point = "lerp_rgbleds",
+                stack_size = 0x300,
+                trusted_stack_frames = 4
+            },
+            {
+                compartment = "rgbled_animation",
+                priority = 3,
+                entry_point = "rgbled_animation_run",
+                stack_size = 0x300,
+                trusted_stack_frames = 3
+            },
+            {
+                compartment = "cpu_load",
+                priority = 2,
+                entry_point = "cpu_load_display",
+                stack_size = 0x1000,
+                trusted_stack_frames = 3
+            },
+            {
+                compartment = "cpu_load",
+                priority = 2,
+                entry_point = "cpu_load_print",
+                stack_size = 0x800,
+                trusted_stack_frames = 3
+            }
+        }, {expand = false})
+    end)
+    after_link(convert_to_uf2)
+
 -- A simple demo using only devices on the Sonata XL board
 firmware("sonata_xl_simple_demo")
-    add_deps("freestanding", "led_walk_raw", "echo", "lcd_test_xl", "rgbled_lerp")
+    add_deps("freestanding", "led_walk_raw", "echo", "lcd_test_xl", "rgbled_lerp", "rgbled_animation")
     on_load(function(target)
         target:values_set("board", "$(board)")
         target:values_set("threads", {
@@ -76,7 +139,7 @@ firmware("sonata_xl_simple_demo")
             {
                 compartment = "lcd_test_xl",
                 priority = 2,
-                entry_point = "lcd_test_xl",
+                entry_point = "lcd_test",
                 stack_size = 0x1000,
                 trusted_stack_frames = 1
             },
@@ -85,6 +148,13 @@ firmware("sonata_xl_simple_demo")
                 priority = 2,
                 entry_point = "lerp_rgbleds",
                 stack_size = 0x200,
+                trusted_stack_frames = 2
+            },
+            {
+                compartment = "rgbled_animation",
+                priority = 3,
+                entry_point = "rgbled_animation_run",
+                stack_size = 0x300,
                 trusted_stack_frames = 1
             }
         }, {expand = false})
@@ -123,7 +193,7 @@ firmware("sonata_demo_everything")
                 priority = 2,
                 entry_point = "run",
                 stack_size = 0x300,
-                trusted_stack_frames = 1
+                trusted_stack_frames = 3
             }
         }, {expand = false})
     end)
@@ -131,7 +201,7 @@ firmware("sonata_demo_everything")
 
 -- Demo that does proximity test as well as LCD screen, etc for demos.
 firmware("sonata_proximity_demo")
-    add_deps("freestanding", "led_walk_raw", "echo", "lcd_test", "proximity_sensor_example")
+    add_deps("freestanding", "led_walk_raw", "echo", "lcd_test", "proximity_sensor_example", "rgbled_animation")
     on_load(function(target)
         target:values_set("board", "$(board)")
         target:values_set("threads", {
@@ -160,7 +230,21 @@ firmware("sonata_proximity_demo")
                 compartment = "proximity_sensor_example",
                 priority = 2,
                 entry_point = "run",
+                stack_size = 0x400,
+                trusted_stack_frames = 3
+            },
+            {
+                compartment = "proximity_sensor_example",
+                priority = 2,
+                entry_point = "display",
                 stack_size = 0x1000,
+                trusted_stack_frames = 3
+            },
+            {
+                compartment = "rgbled_animation",
+                priority = 3,
+                entry_point = "rgbled_animation_run",
+                stack_size = 0x300,
                 trusted_stack_frames = 1
             }
         }, {expand = false})
@@ -168,7 +252,7 @@ firmware("sonata_proximity_demo")
     after_link(convert_to_uf2)
 
 firmware("proximity_test")
-    add_deps("freestanding", "proximity_sensor_example")
+    add_deps("freestanding", "proximity_sensor_example", "rgbled_animation")
     on_load(function(target)
         target:values_set("board", "$(board)")
         target:values_set("threads", {
@@ -176,7 +260,21 @@ firmware("proximity_test")
                 compartment = "proximity_sensor_example",
                 priority = 2,
                 entry_point = "run",
+                stack_size = 0x400,
+                trusted_stack_frames = 3
+            },
+            {
+                compartment = "proximity_sensor_example",
+                priority = 2,
+                entry_point = "display",
                 stack_size = 0x1000,
+                trusted_stack_frames = 3
+            },
+            {
+                compartment = "rgbled_animation",
+                priority = 3,
+                entry_point = "rgbled_animation_run",
+                stack_size = 0x300,
                 trusted_stack_frames = 1
             }
         }, {expand = false})
@@ -186,7 +284,7 @@ firmware("proximity_test")
 
 -- Demo that uses a Sense HAT's LED Matrix
 firmware("sense_hat_leds")
-    add_deps("freestanding", "led_walk_raw", "lcd_test", "rgbled_lerp", "sense_hat_demo")
+    add_deps("freestanding", "led_walk_raw", "lcd_test", "rgbled_lerp", "sense_hat_demo", "rgbled_animation", "gpio_input")
     on_load(function(target)
         target:values_set("board", "$(board)")
         target:values_set("threads", {
@@ -209,13 +307,27 @@ firmware("sense_hat_leds")
                 priority = 2,
                 entry_point = "lerp_rgbleds",
                 stack_size = 0x200,
-                trusted_stack_frames = 1
+                trusted_stack_frames = 2
             },
             {
                 compartment = "sense_hat_demo",
                 priority = 2,
                 entry_point = "test",
                 stack_size = 0x1000,
+                trusted_stack_frames = 3
+            },
+            {
+                compartment = "rgbled_animation",
+                priority = 3,
+                entry_point = "rgbled_animation_run",
+                stack_size = 0x300,
+                trusted_stack_frames = 1
+            },
+            {
+                compartment = "gpio_input",
+                priority = 3,
+                entry_point = "gpio_input_run",
+                stack_size = 0x300,
                 trusted_stack_frames = 1
             }
         }, {expand = false})
@@ -224,7 +336,7 @@ firmware("sense_hat_leds")
 
 -- Demo that does proximity test as well as LCD screen, etc for demos.
 firmware("leds_and_lcd")
-    add_deps("freestanding", "led_walk_raw", "lcd_test", "rgbled_lerp")
+    add_deps("freestanding", "led_walk_raw", "lcd_test", "rgbled_lerp", "rgbled_animation")
     on_load(function(target)
         target:values_set("board", "$(board)")
         target:values_set("threads", {
@@ -247,6 +359,13 @@ firmware("leds_and_lcd")
                 priority = 2,
                 entry_point = "lerp_rgbleds",
                 stack_size = 0x200,
+                trusted_stack_frames = 2
+            },
+            {
+                compartment = "rgbled_animation",
+                priority = 3,
+                entry_point = "rgbled_animation_run",
+                stack_size = 0x300,
                 trusted_stack_frames = 1
             }
         }, {expand = false})
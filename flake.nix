@@ -96,6 +96,24 @@
         }
         // commonSoftwareBuildAttributes);
 
+      sonata-benchmarks = pkgs.stdenvNoCC.mkDerivation ({
+          name = "sonata-benchmarks";
+          src = fileset.toSource {
+            root = ./.;
+            fileset = fileset.unions [
+              ./benchmarks
+              ./common.lua
+              ./cheriot-rtos
+              ./libraries
+              ./third_party
+              ./examples/automotive
+              ./examples/common
+            ];
+          };
+          buildPhase = "xmake -P ./benchmarks/";
+        }
+        // commonSoftwareBuildAttributes);
+
       sonata-examples = pkgs.stdenvNoCC.mkDerivation ({
           name = "sonata-examples";
           src = fileset.toSource {
@@ -151,6 +169,41 @@
         installPhase = "mkdir $out";
       };
 
+      tests-host = pkgs.stdenv.mkDerivation {
+        name = "tests-host";
+        src = fileset.toSource {
+          root = ./.;
+          fileset = fileset.unions [
+            ./tests/host
+            ./libraries
+            ./third_party
+            ./examples/automotive/lib
+            ./examples/common
+          ];
+        };
+        buildInputs = [lrPkgs.xmake];
+        buildPhase = "xmake -P ./tests/host/";
+        doCheck = true;
+        checkPhase = ''
+          xmake run -P ./tests/host/ host_tests
+          xmake run -P ./tests/host/ host_benchmarks
+        '';
+        installPhase = "mkdir $out";
+      };
+
+      tests-scripts = pkgs.stdenvNoCC.mkDerivation {
+        name = "tests-scripts";
+        src = fileset.toSource {
+          root = ./.;
+          fileset = ./scripts;
+        };
+        nativeBuildInputs = [(pkgs.python3.withPackages (pyPkg: [pyPkg.pyserial]))];
+        dontBuild = true;
+        doCheck = true;
+        checkPhase = "python3 -m unittest discover -s scripts -p '*_test.py'";
+        installPhase = "mkdir $out";
+      };
+
       lint-python = pkgs.writeShellApplication {
         name = "lint-python";
         runtimeInputs = with pkgs; [
@@ -165,7 +218,7 @@
       };
 
       lint-cpp = let
-        srcGlob = "{examples/**/*.{h,cc},exercises/**/*.{hh,cc},{libraries,tests}/*.{cc,hh}}";
+        srcGlob = "{examples/**/*.{h,cc},exercises/**/*.{hh,cc},{benchmarks,libraries}/*.{cc,hh},tests/**/*.{cc,hh,h}}";
       in
         pkgs.writeShellApplication {
           name = "lint-cpp";
@@ -218,12 +271,13 @@
           sonata-exercises
           sonata-examples
           sonata-tests
+          sonata-benchmarks
           sonata-software-documentation
           sonata-automotive-demo-legacy-component
           sonata-heartbleed-demo-legacy-component
           ;
       };
-      checks = {inherit tests-simulator;};
+      checks = {inherit tests-simulator tests-host tests-scripts;};
       apps = builtins.listToAttrs (map (program: {
         inherit (program) name;
         value = {
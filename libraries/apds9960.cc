@@ -0,0 +1,128 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "apds9960.hh"
+
+using sonata::i2c::Register;
+using sonata::i2c::Step;
+
+namespace
+{
+	namespace Registers
+	{
+		constexpr uint8_t Enable         = 0x80;
+		constexpr uint8_t WaitTime       = 0x83;
+		constexpr uint8_t LowLimit       = 0x89;
+		constexpr uint8_t HighLimit      = 0x8B;
+		constexpr uint8_t Persist        = 0x8C;
+		constexpr uint8_t Pulses         = 0x8E;
+		constexpr uint8_t Control        = 0x8F;
+		constexpr uint8_t ProximityClear = 0xE5;
+
+		constexpr Register<uint8_t> Id{0x92};
+		constexpr Register<uint8_t> Status{0x93};
+		constexpr Register<uint8_t> Proximity{0x9C};
+	} // namespace Registers
+
+	/// Bits of the ENABLE register.
+	constexpr uint8_t PowerOn                  = 1 << 0;
+	constexpr uint8_t ProximityEnable          = 1 << 2;
+	constexpr uint8_t WaitEnable               = 1 << 3;
+	constexpr uint8_t ProximityInterruptEnable = 1 << 5;
+
+	/// The proximity interrupt bit of the STATUS register.
+	constexpr uint8_t ProximityInterrupt = 1 << 5;
+
+	constexpr uint8_t ExpectedId = 0xAB;
+} // namespace
+
+SealedI2cDevice __cheri_libcall Apds9960::open_sensor(uint8_t  bus,
+                                                      uint32_t speedKhz)
+{
+	SealedI2cDevice handle;
+	if (i2c_device_open(&handle, bus, Address, speedKhz, I2cPriority::Normal) !=
+	    0)
+	{
+		Debug::log("Failed to open the sensor on bus {}", bus);
+		return nullptr;
+	}
+	return handle;
+}
+
+bool Apds9960::set_window(uint8_t proximity)
+{
+	const uint8_t Low =
+	  proximity > config.hysteresis ? proximity - config.hysteresis : 0;
+	const uint8_t High = proximity < UINT8_MAX - config.hysteresis
+	                       ? proximity + config.hysteresis
+	                       : UINT8_MAX;
+	return device.write(Registers::LowLimit, Low) &&
+	       device.write(Registers::HighLimit, High);
+}
+
+bool __cheri_libcall Apds9960::init()
+{
+	if (handle == nullptr)
+	{
+		return false;
+	}
+	uint8_t id;
+	if (!device.read(Registers::Id, &id))
+	{
+		Debug::log("Failed to read the sensor ID");
+		return false;
+	}
+	if (id != ExpectedId)
+	{
+		Debug::log("Sensor ID was not expected value of {}, saw {}",
+		           ExpectedId,
+		           id);
+		return false;
+	}
+
+	const uint8_t Persistence = config.persistence < 15 ? config.persistence
+	                                                    : 15;
+	const uint8_t Enabled =
+	  PowerOn | ProximityEnable | WaitEnable | ProximityInterruptEnable;
+
+	// Disable everything and wait for all engines to go idle, configure
+	// proximity sensing with a window around nothing being near, so that the
+	// interrupt isn't raised until something is, then wait for power on.
+	// Steps are ordered so that consecutive registers share a transaction.
+	const Step Init[] = {
+	  {Registers::Enable, 0, 25},
+	  {Registers::WaitTime, config.waitTime},
+	  {Registers::LowLimit, 0},
+	  {Registers::HighLimit, config.hysteresis},
+	  {Registers::Persist, static_cast<uint8_t>(Persistence << 4)},
+	  {Registers::Pulses, config.pulses},
+	  {Registers::Control, config.control},
+	  {Registers::Enable, Enabled, 10},
+	};
+	device.forget();
+	if (!device.run(Init))
+	{
+		Debug::log("Failed to configure the sensor");
+		return false;
+	}
+	return true;
+}
+
+bool __cheri_libcall Apds9960::interrupt_pending()
+{
+	uint8_t status;
+	return device.read(Registers::Status, &status) &&
+	       (status & ProximityInterrupt) != 0;
+}
+
+bool __cheri_libcall Apds9960::acknowledge(uint8_t *proximity)
+{
+	if (!device.read(Registers::Proximity, proximity) ||
+	    !set_window(*proximity))
+	{
+		Debug::log("Failed to read the proximity");
+		return false;
+	}
+	// Writing the address alone clears the proximity interrupt.
+	return device.write(Registers::ProximityClear, nullptr, 0);
+}
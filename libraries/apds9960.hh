@@ -0,0 +1,115 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+/*
+ * A driver for the proximity sensor of the APDS9960 proximity, gesture and
+ * colour sensor (https://www.adafruit.com/product/3595).
+ *
+ * Rather than being read at a fixed rate, the sensor is given a window around
+ * its last reading and raises its interrupt once the proximity has been
+ * outside of that window for several measurements in a row. Nothing needs to
+ * be read over I2C until that happens, so the bus is left idle while nothing
+ * moves in front of the sensor.
+ *
+ * The interrupt is an active low, open drain `INT` pin on the sensor's
+ * breakout board. Sonata's GPIO can't raise an interrupt for it, so it should
+ * be wired to a GPIO input and checked with a cheap read of that input. If it
+ * isn't wired, `interrupt_pending` reads the sensor's status register
+ * instead, which still costs a single I2C transaction.
+ *
+ * The sensor is reached through the I2C bus compartment, so other devices on
+ * its bus can be used alongside it.
+ */
+
+#include "i2c_bus.hh"
+#include <debug.hh>
+#include <stdint.h>
+
+class Apds9960
+{
+	private:
+	/// Flag set when we're debugging this driver.
+	static constexpr bool DebugApds9960 = true;
+
+	/// Helper for conditional debug logs and assertions.
+	using Debug = ConditionalDebug<DebugApds9960, "APDS9960">;
+
+	public:
+	/// The sensor's I2C address.
+	static constexpr uint8_t Address = 0x39;
+
+	struct Config
+	{
+		/// The value of the CONTROL register, which sets the proximity gain.
+		uint8_t control = 0x0c;
+		/// The value of the PPULSE register, which sets the LED pulses.
+		uint8_t pulses = 0x04;
+		/**
+		 * The value of the WTIME register, which sets the time between
+		 * measurements to `(256 - waitTime) * 2.78` ms.
+		 */
+		uint8_t waitTime = 0xEE;
+		/**
+		 * The number of measurements in a row, up to 15, that must be
+		 * outside of the window before the interrupt is raised.
+		 */
+		uint8_t persistence = 2;
+		/// How far the proximity can move from the last reading unreported.
+		uint8_t hysteresis = 8;
+	};
+
+	/// Opens the sensor on I2C bus `bus`, to be run at `speedKhz`.
+	Apds9960(uint8_t bus, uint32_t speedKhz, Config config)
+	  : handle(open_sensor(bus, speedKhz)), device(handle), config(config)
+	{
+	}
+
+	Apds9960(uint8_t bus, uint32_t speedKhz)
+	  : Apds9960(bus, speedKhz, Config{})
+	{
+	}
+
+	~Apds9960()
+	{
+		if (handle != nullptr)
+		{
+			i2c_device_close(handle);
+		}
+	}
+
+	Apds9960(const Apds9960 &)            = delete;
+	Apds9960 &operator=(const Apds9960 &) = delete;
+
+	/**
+	 * Checks the sensor's ID and starts proximity measurements, with the
+	 * interrupt enabled. Returns false if the sensor couldn't be opened or
+	 * set up.
+	 */
+	bool __cheri_libcall init();
+
+	/**
+	 * Reads the sensor's status register and returns true if the proximity
+	 * interrupt is raised. For use when the `INT` pin isn't wired to Sonata.
+	 */
+	bool __cheri_libcall interrupt_pending();
+
+	/**
+	 * Reads the proximity into `proximity`, centres the window on it, and
+	 * clears the interrupt. Returns false if the sensor couldn't be accessed.
+	 */
+	bool __cheri_libcall acknowledge(uint8_t *proximity);
+
+	private:
+	SealedI2cDevice handle;
+	/// The configuration registers, from ENABLE to CONTROL, are shadowed.
+	sonata::i2c::ShadowedDevice<0x80, 16, sonata::i2c::SharedTarget> device;
+	Config                                                           config;
+
+	/// Opens the sensor, returning null if it couldn't be opened.
+	static SealedI2cDevice __cheri_libcall open_sensor(uint8_t  bus,
+	                                                   uint32_t speedKhz);
+
+	bool set_window(uint8_t proximity);
+};
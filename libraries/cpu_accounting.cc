@@ -0,0 +1,94 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "cpu_accounting.hh"
+#include <cheri.hh>
+#include <errno.h>
+#include <locks.hh>
+
+using namespace CHERI;
+using sonata::cpu_accounting::Ledger;
+
+namespace
+{
+	/// Protects the other state.
+	FlagLock lock;
+	Ledger   ledger;
+
+	/**
+	 * Copies the caller's `name` to `copy`, truncating it. No more is read
+	 * than the capability's bounds allow, so a name that isn't terminated
+	 * within them is cut off there rather than faulting. This is done
+	 * before the lock is taken, so that a bad name can't fault holding it.
+	 * Returns false if `name` can't be read.
+	 */
+	bool name_take(const char *name, char (&copy)[CpuAccountingNameLength])
+	{
+		if (!check_pointer<PermissionSet{Permission::Load}, false>(name, 1))
+		{
+			return false;
+		}
+		const Capability Name{name};
+		const size_t     Length =
+		  std::min<size_t>(CpuAccountingNameLength - 1,
+		                   Name.top() - static_cast<ptraddr_t>(Name.address()));
+		size_t i = 0;
+		for (; i < Length && name[i] != '\0'; i++)
+		{
+			copy[i] = name[i];
+		}
+		copy[i] = '\0';
+		return true;
+	}
+} // namespace
+
+int cpu_accounting_thread_sample(const char *name)
+{
+	// The scheduler is asked first, so that the time taken here is counted
+	// next time rather than this time.
+	const uint64_t Cycles = cpu_accounting_thread_cycles();
+	char           copy[CpuAccountingNameLength];
+	if (!name_take(name, copy))
+	{
+		return -EINVAL;
+	}
+	LockGuard guard{lock};
+	return ledger.thread_sample(thread_id_get(), copy, Cycles) ? 0 : -EINVAL;
+}
+
+int cpu_accounting_compartment_add(const char *name, uint64_t cycles)
+{
+	char copy[CpuAccountingNameLength];
+	if (!name_take(name, copy))
+	{
+		return -EINVAL;
+	}
+	LockGuard guard{lock};
+	return ledger.compartment_add(copy, cycles) ? 0 : -ENOSPC;
+}
+
+int cpu_accounting_snapshot(CpuAccountingSnapshot *snapshot)
+{
+	if (!check_pointer<PermissionSet{Permission::Store}, false>(
+	      snapshot, sizeof(CpuAccountingSnapshot)))
+	{
+		return -EINVAL;
+	}
+	CpuAccountingSnapshot copy;
+	{
+		LockGuard guard{lock};
+		ledger.snapshot(&copy);
+	}
+	copy.cycles = rdcycle64();
+#ifdef SCHEDULER_ACCOUNTING
+	copy.idleCycles    = thread_elapsed_cycles_idle();
+	copy.cyclesCounted = true;
+#else
+	copy.idleCycles    = 0;
+	copy.cyclesCounted = false;
+#endif
+	// The snapshot is copied out once the lock is released, in case the
+	// caller's buffer faults.
+	*snapshot = copy;
+	return 0;
+}
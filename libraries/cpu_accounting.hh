@@ -0,0 +1,341 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+/*
+ * The CPU accounting compartment, which adds up the cycles used by each thread
+ * and each compartment so that the threads that keep the CPU busy, such as
+ * those that busy-wait, can be found.
+ *
+ * When the RTOS is built with `--scheduler-accounting=y`, the scheduler
+ * counts the cycles that each thread has run for, and those that the idle
+ * thread has run for, but a thread can only read its own count. Threads
+ * therefore report theirs with `cpu_accounting_sample`, usually once each
+ * time around their main loop, and cycles spent in a compartment on behalf of
+ * any thread are reported with a `CpuAccountingScope`. Both do nothing unless
+ * the firmware is built with `--cpu_accounting=y`, so they can be left in.
+ *
+ * `cpu_accounting_snapshot` copies out everything reported so far, and
+ * `sonata::cpu_accounting::load_between` turns two snapshots into the load
+ * over the time between them. The busy cycles that no thread reported are
+ * counted as unreported: a thread that spins without getting back to its
+ * loop doesn't report, so it shows up there, while its samples stop.
+ *
+ * Without scheduler accounting, only the samples are counted, which still
+ * shows how often each thread goes around its loop.
+ */
+
+#include <algorithm>
+#include <compartment.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread.h>
+
+/// The threads whose cycles can be reported, by their ID.
+static constexpr size_t CpuAccountingMaxThreads = 8;
+/// The compartments whose cycles can be reported.
+static constexpr size_t CpuAccountingMaxCompartments = 8;
+/// The longest name kept, with its terminator.
+static constexpr size_t CpuAccountingNameLength = 20;
+
+/// The cycles reported by a thread or for a compartment.
+struct CpuAccountingEntry
+{
+	/// The name it was reported under, which is empty if it hasn't been.
+	char name[CpuAccountingNameLength];
+	/// The cycles reported.
+	uint64_t cycles;
+	/// The times that it has been reported.
+	uint32_t samples;
+};
+
+/// Everything reported to the compartment, when the snapshot was taken.
+struct CpuAccountingSnapshot
+{
+	/// The cycle counter.
+	uint64_t cycles;
+	/// The cycles that the idle thread has run for.
+	uint64_t idleCycles;
+	/// Whether the scheduler counts cycles, so that `idleCycles` and the
+	/// cycles of the entries are meaningful.
+	bool cyclesCounted;
+	/// The threads, by their ID less one.
+	CpuAccountingEntry threads[CpuAccountingMaxThreads];
+	/// The compartments, in the order that they were first reported.
+	CpuAccountingEntry compartments[CpuAccountingMaxCompartments];
+};
+
+/**
+ * Records that the calling thread, named `name`, has run for the cycles that
+ * the scheduler has counted for it. Returns 0 on success, or `-EINVAL` if the
+ * thread's ID is too large to be kept.
+ */
+__cheri_compartment("cpu_accounting") int cpu_accounting_thread_sample(
+  const char *name);
+
+/**
+ * Adds `cycles` to those of the compartment `name`. Returns 0 on success, or
+ * `-ENOSPC` if every compartment entry is taken by another name.
+ */
+__cheri_compartment("cpu_accounting") int cpu_accounting_compartment_add(
+  const char *name,
+  uint64_t    cycles);
+
+/**
+ * Copies everything reported so far to `snapshot`. Returns 0 on success or
+ * `-EINVAL` for an invalid pointer.
+ */
+__cheri_compartment("cpu_accounting") int cpu_accounting_snapshot(
+  CpuAccountingSnapshot *snapshot);
+
+/**
+ * Returns the cycles that the calling thread has run for, or 0 if the
+ * scheduler doesn't count them.
+ */
+inline uint64_t cpu_accounting_thread_cycles()
+{
+#ifdef SCHEDULER_ACCOUNTING
+	return thread_elapsed_cycles_current();
+#else
+	return 0;
+#endif
+}
+
+/**
+ * Reports the calling thread's cycles under `name`, if CPU accounting is
+ * built in.
+ */
+inline void cpu_accounting_sample(const char *name)
+{
+#ifdef CPU_ACCOUNTING
+	cpu_accounting_thread_sample(name);
+#endif
+}
+
+/**
+ * Adds the cycles that the calling thread runs for while this is in scope to
+ * those of the compartment `name`, if CPU accounting is built in. Only the
+ * thread's own cycles are counted, so it isn't charged for other threads
+ * that run while it waits.
+ */
+class CpuAccountingScope
+{
+#ifdef CPU_ACCOUNTING
+	const char *name;
+	uint64_t    start;
+#endif
+
+	public:
+	explicit CpuAccountingScope(const char *name)
+#ifdef CPU_ACCOUNTING
+	  : name(name), start(cpu_accounting_thread_cycles())
+#endif
+	{
+	}
+
+	~CpuAccountingScope()
+	{
+#ifdef CPU_ACCOUNTING
+		cpu_accounting_compartment_add(name,
+		                               cpu_accounting_thread_cycles() - start);
+#endif
+	}
+
+	CpuAccountingScope(const CpuAccountingScope &)            = delete;
+	CpuAccountingScope &operator=(const CpuAccountingScope &) = delete;
+};
+
+namespace sonata::cpu_accounting
+{
+	/// Returns whether `entry` is named `name`, as truncated when kept.
+	inline bool name_matches(const CpuAccountingEntry &entry, const char *name)
+	{
+		for (size_t i = 0; i < CpuAccountingNameLength - 1; i++)
+		{
+			if (entry.name[i] != name[i])
+			{
+				return false;
+			}
+			if (name[i] == '\0')
+			{
+				return true;
+			}
+		}
+		return true;
+	}
+
+	/// Names `entry` `name`, truncating it to fit.
+	inline void name_copy(CpuAccountingEntry *entry, const char *name)
+	{
+		size_t i = 0;
+		for (; i < CpuAccountingNameLength - 1 && name[i] != '\0'; i++)
+		{
+			entry->name[i] = name[i];
+		}
+		entry->name[i] = '\0';
+	}
+
+	/// The cycles reported to the compartment.
+	class Ledger
+	{
+		CpuAccountingEntry threads[CpuAccountingMaxThreads]           = {};
+		CpuAccountingEntry compartments[CpuAccountingMaxCompartments] = {};
+
+		public:
+		/**
+		 * Records that the thread `threadId`, named `name`, has run for
+		 * `cycles` in all. IDs start from 1. Returns false if `threadId` is
+		 * out of range.
+		 */
+		bool thread_sample(uint16_t threadId, const char *name, uint64_t cycles)
+		{
+			if (threadId == 0 || threadId > CpuAccountingMaxThreads)
+			{
+				return false;
+			}
+			CpuAccountingEntry &entry = threads[threadId - 1];
+			name_copy(&entry, name);
+			entry.cycles = cycles;
+			entry.samples++;
+			return true;
+		}
+
+		/**
+		 * Adds `cycles` to those of the compartment `name`, taking a new
+		 * entry the first time it's seen. Returns false if there is none
+		 * left.
+		 */
+		bool compartment_add(const char *name, uint64_t cycles)
+		{
+			for (CpuAccountingEntry &entry : compartments)
+			{
+				if (entry.name[0] == '\0')
+				{
+					name_copy(&entry, name);
+				}
+				else if (!name_matches(entry, name))
+				{
+					continue;
+				}
+				entry.cycles += cycles;
+				entry.samples++;
+				return true;
+			}
+			return false;
+		}
+
+		/// Copies the entries to `snapshot`.
+		void snapshot(CpuAccountingSnapshot *snapshot) const
+		{
+			for (size_t i = 0; i < CpuAccountingMaxThreads; i++)
+			{
+				snapshot->threads[i] = threads[i];
+			}
+			for (size_t i = 0; i < CpuAccountingMaxCompartments; i++)
+			{
+				snapshot->compartments[i] = compartments[i];
+			}
+		}
+	};
+
+	/// The share of the CPU taken by a thread or compartment.
+	struct Share
+	{
+		/// In thousandths of the cycles between the snapshots.
+		uint32_t permille;
+		/// The times that it was reported between the snapshots.
+		uint32_t samples;
+	};
+
+	/// The load on the CPU between two snapshots.
+	struct Load
+	{
+		/// The cycles between the snapshots.
+		uint64_t cycles;
+		/// Whether the scheduler counts cycles, without which only the
+		/// samples are meaningful.
+		bool cyclesCounted;
+		/// The share of the cycles that weren't spent idle.
+		uint32_t busyPermille;
+		/// The share of the cycles that were busy but no thread reported.
+		uint32_t unreportedPermille;
+		Share    threads[CpuAccountingMaxThreads];
+		Share    compartments[CpuAccountingMaxCompartments];
+	};
+
+	/// Returns `part` in thousandths of `whole`, up to a thousand.
+	inline uint32_t permille(uint64_t part, uint64_t whole)
+	{
+		if (whole == 0)
+		{
+			return 0;
+		}
+		if (part >= whole)
+		{
+			return 1000;
+		}
+		return static_cast<uint32_t>(part * 1000 / whole);
+	}
+
+	/**
+	 * Returns the share of the CPU that a thread reported in `after` since
+	 * `before`. Nothing is counted the first time that a thread reports, as
+	 * its count covers all the time before then.
+	 */
+	inline Share thread_share(const CpuAccountingEntry &before,
+	                          const CpuAccountingEntry &after,
+	                          uint64_t                  cycles)
+	{
+		if (before.samples == 0 || after.cycles < before.cycles)
+		{
+			return {0, 0};
+		}
+		return {permille(after.cycles - before.cycles, cycles),
+		        after.samples - before.samples};
+	}
+
+	/**
+	 * Returns the load on the CPU between `before` and `after`.
+	 *
+	 * Threads report their cycles at their own times rather than when the
+	 * snapshots are taken, so a thread's share is only as up to date as its
+	 * last report, and a share of the unreported cycles may belong to a
+	 * thread that is about to report them.
+	 */
+	inline Load load_between(const CpuAccountingSnapshot &before,
+	                         const CpuAccountingSnapshot &after)
+	{
+		Load load          = {};
+		load.cycles        = after.cycles - before.cycles;
+		load.cyclesCounted = after.cyclesCounted;
+		const uint64_t Idle =
+		  std::min(after.idleCycles - before.idleCycles, load.cycles);
+		const uint64_t Busy = after.cyclesCounted ? load.cycles - Idle : 0;
+		load.busyPermille   = permille(Busy, load.cycles);
+
+		uint64_t reported = 0;
+		for (size_t i = 0; i < CpuAccountingMaxThreads; i++)
+		{
+			const CpuAccountingEntry &Before = before.threads[i];
+			const CpuAccountingEntry &After  = after.threads[i];
+			load.threads[i] = thread_share(Before, After, load.cycles);
+			if (load.threads[i].samples != 0)
+			{
+				reported += After.cycles - Before.cycles;
+			}
+		}
+		load.unreportedPermille =
+		  Busy > reported ? permille(Busy - reported, load.cycles) : 0;
+		for (size_t i = 0; i < CpuAccountingMaxCompartments; i++)
+		{
+			const CpuAccountingEntry &Before = before.compartments[i];
+			const CpuAccountingEntry &After  = after.compartments[i];
+			load.compartments[i] = {
+			  permille(After.cycles - Before.cycles, load.cycles),
+			  After.samples - Before.samples,
+			};
+		}
+		return load;
+	}
+} // namespace sonata::cpu_accounting
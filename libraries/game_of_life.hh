@@ -0,0 +1,293 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Conway's Game of Life on bitboards.
+ *
+ * An 8x8 tile of the world is held in a single `Board`, with the cell at
+ * column `x` and row `y` in bit `y * 8 + x`, which is the order the Sense HAT
+ * LED matrix takes its pixels in. The next generation of a tile is computed
+ * for all 64 cells at once: the eight neighbour boards are built with shifts
+ * and then summed with bitwise full adders.
+ *
+ * A single tile can be stepped on its own, with the cells beyond its edges
+ * either dead or wrapped around to the opposite edge. `World` joins tiles
+ * into a larger world and `World::viewport` cuts an 8x8 window out of it at
+ * any position, for scrolling a large world across the LED matrix.
+ */
+namespace sonata::game_of_life
+{
+	using Board = uint64_t;
+
+	/// The width and height of a tile in cells.
+	static constexpr size_t TileSize = 8;
+
+	static constexpr Board FirstColumn = 0x0101010101010101;
+	static constexpr Board LastColumn  = FirstColumn << (TileSize - 1);
+
+	constexpr Board cell(size_t x, size_t y)
+	{
+		return Board{1} << (y * TileSize + x);
+	}
+
+	constexpr bool is_alive(Board board, size_t x, size_t y)
+	{
+		return (board & cell(x, y)) != 0;
+	}
+
+	/**
+	 * Builds a board from eight rows, with the leftmost cell of each row in
+	 * the row's most significant bit, so that patterns read naturally when
+	 * written in binary.
+	 */
+	constexpr Board from_rows(const uint8_t (&rows)[TileSize])
+	{
+		Board board = 0;
+		for (size_t y = 0; y < TileSize; y++)
+		{
+			for (size_t x = 0; x < TileSize; x++)
+			{
+				if ((rows[y] >> (TileSize - 1 - x)) & 1)
+				{
+					board |= cell(x, y);
+				}
+			}
+		}
+		return board;
+	}
+
+	namespace internal
+	{
+		/*
+		 * Each of these returns the board holding, for every cell, the state
+		 * of the neighbour in one direction. Cells on the edge take their
+		 * neighbour from the adjacent tile.
+		 */
+
+		constexpr Board from_above(Board centre, Board above)
+		{
+			return (centre << TileSize) | (above >> (TileSize * 7));
+		}
+
+		constexpr Board from_below(Board centre, Board below)
+		{
+			return (centre >> TileSize) | (below << (TileSize * 7));
+		}
+
+		constexpr Board from_left(Board centre, Board left)
+		{
+			return ((centre << 1) & ~FirstColumn) |
+			       ((left >> (TileSize - 1)) & FirstColumn);
+		}
+
+		constexpr Board from_right(Board centre, Board right)
+		{
+			return ((centre >> 1) & ~LastColumn) |
+			       ((right << (TileSize - 1)) & LastColumn);
+		}
+
+		struct Sum
+		{
+			Board low;
+			Board high;
+		};
+
+		constexpr Sum full_add(Board a, Board b, Board c)
+		{
+			return {a ^ b ^ c, (a & b) | (c & (a ^ b))};
+		}
+	} // namespace internal
+
+	/**
+	 * Computes the next generation of the centre tile of a 3x3 block of
+	 * tiles, indexed `[row][column]`.
+	 */
+	constexpr Board step(const Board (&tiles)[3][3])
+	{
+		using namespace internal;
+		const Board Centre = tiles[1][1];
+
+		// The rows above and below each cell, for the three tile columns.
+		const Board AboveLeft  = from_above(tiles[1][0], tiles[0][0]);
+		const Board Above      = from_above(Centre, tiles[0][1]);
+		const Board AboveRight = from_above(tiles[1][2], tiles[0][2]);
+		const Board BelowLeft  = from_below(tiles[1][0], tiles[2][0]);
+		const Board Below      = from_below(Centre, tiles[2][1]);
+		const Board BelowRight = from_below(tiles[1][2], tiles[2][2]);
+
+		const Board Adjacent[8] = {
+		  from_left(Above, AboveLeft),
+		  Above,
+		  from_right(Above, AboveRight),
+		  from_left(Centre, tiles[1][0]),
+		  from_right(Centre, tiles[1][2]),
+		  from_left(Below, BelowLeft),
+		  Below,
+		  from_right(Below, BelowRight),
+		};
+
+		// Count the live neighbours of every cell as a three bit number, with
+		// a count of eight wrapping to zero, which doesn't change the result.
+		const Sum First  = full_add(Adjacent[0], Adjacent[1], Adjacent[2]);
+		const Sum Second = full_add(Adjacent[3], Adjacent[4], Adjacent[5]);
+		const Sum Third  = full_add(Adjacent[6], Adjacent[7], 0);
+		const Sum Ones   = full_add(First.low, Second.low, Third.low);
+		const Sum Twos   = full_add(First.high, Second.high, Third.high);
+		const Sum Carry  = full_add(Twos.low, Ones.high, 0);
+
+		const Board Fours = Twos.high ^ Carry.high;
+
+		// A cell is alive with three neighbours, or with two if it already
+		// was.
+		return Carry.low & ~Fours & (Ones.low | Centre);
+	}
+
+	/**
+	 * Computes the next generation of a single tile. If `wrap` is set, the
+	 * tile is a torus, otherwise the cells beyond its edges are dead.
+	 */
+	constexpr Board step(Board board, bool wrap = false)
+	{
+		const Board Edge = wrap ? board : 0;
+
+		const Board Tiles[3][3] = {
+		  {Edge, Edge, Edge},
+		  {Edge, board, Edge},
+		  {Edge, Edge, Edge},
+		};
+		return step(Tiles);
+	}
+
+	/**
+	 * A world made of `Width` by `Height` tiles. If `wrap` is set, the world
+	 * is a torus, otherwise the cells beyond its edges are dead.
+	 *
+	 * Both the current and next generations are kept, so stepping the world
+	 * doesn't need any stack space or copying.
+	 */
+	template<size_t Width, size_t Height>
+	class World
+	{
+		static_assert(Width > 0 && Height > 0);
+
+		static constexpr ptrdiff_t Columns = Width;
+		static constexpr ptrdiff_t Rows    = Height;
+
+		Board  generations[2][Height][Width] = {};
+		size_t current                       = 0;
+		bool   wrap;
+
+		/**
+		 * Returns the tile at the given tile coordinates, which may be one
+		 * tile outside the world.
+		 */
+		Board tile(ptrdiff_t column, ptrdiff_t row) const
+		{
+			if (column < 0 || column >= Columns || row < 0 || row >= Rows)
+			{
+				if (!wrap)
+				{
+					return 0;
+				}
+				column = (column + Width) % Width;
+				row    = (row + Height) % Height;
+			}
+			return generations[current][row][column];
+		}
+
+		public:
+		static constexpr size_t CellsWide = Width * TileSize;
+		static constexpr size_t CellsHigh = Height * TileSize;
+
+		constexpr World(bool wrap = true) : wrap(wrap) {}
+
+		bool is_alive(size_t x, size_t y) const
+		{
+			return game_of_life::is_alive(
+			  generations[current][y / TileSize][x / TileSize],
+			  x % TileSize,
+			  y % TileSize);
+		}
+
+		void set(size_t x, size_t y, bool alive)
+		{
+			Board      &tile = generations[current][y / TileSize][x / TileSize];
+			const Board Cell = cell(x % TileSize, y % TileSize);
+			tile             = alive ? (tile | Cell) : (tile & ~Cell);
+		}
+
+		/// Places an 8x8 pattern with its top left corner at a tile corner.
+		void set_tile(size_t column, size_t row, Board board)
+		{
+			generations[current][row][column] = board;
+		}
+
+		void clear()
+		{
+			for (auto &row : generations[current])
+			{
+				for (Board &board : row)
+				{
+					board = 0;
+				}
+			}
+		}
+
+		/// Advances the whole world by one generation.
+		void step()
+		{
+			const size_t Next = current ^ 1;
+			for (ptrdiff_t row = 0; row < Rows; row++)
+			{
+				for (ptrdiff_t column = 0; column < Columns; column++)
+				{
+					Board tiles[3][3];
+					for (ptrdiff_t y = -1; y <= 1; y++)
+					{
+						for (ptrdiff_t x = -1; x <= 1; x++)
+						{
+							tiles[y + 1][x + 1] = tile(column + x, row + y);
+						}
+					}
+					generations[Next][row][column] = game_of_life::step(tiles);
+				}
+			}
+			current = Next;
+		}
+
+		/**
+		 * Returns the 8x8 window of the world with its top left corner at
+		 * cell (`left`, `top`). Positions are taken modulo the size of the
+		 * world if it wraps, and cells outside of the world are dead if it
+		 * doesn't.
+		 */
+		Board viewport(size_t left, size_t top) const
+		{
+			const size_t Shift  = left % TileSize;
+			Board        window = 0;
+			for (size_t y = 0; y < TileSize; y++)
+			{
+				const size_t CellY = top + y;
+				if (!wrap && CellY >= CellsHigh)
+				{
+					break;
+				}
+				const ptrdiff_t Row      = (CellY / TileSize) % Height;
+				const ptrdiff_t Column   = left / TileSize;
+				const size_t    RowShift = (CellY % TileSize) * TileSize;
+				// Join the row of this tile and the next, then take the eight
+				// cells that are in the window.
+				const uint32_t Cells =
+				  ((tile(Column, Row) >> RowShift) & 0xFF) |
+				  (((tile(Column + 1, Row) >> RowShift) & 0xFF) << TileSize);
+				window |= Board{(Cells >> Shift) & 0xFF} << (y * TileSize);
+			}
+			return window;
+		}
+	};
+} // namespace sonata::game_of_life
@@ -0,0 +1,113 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "gpio_input.hh"
+#include <cheri.hh>
+#include <debug.hh>
+#include <errno.h>
+#include <futex.h>
+#include <locks.hh>
+#include <platform-gpio.hh>
+
+using namespace CHERI;
+using sonata::gpio_input::EventQueue;
+using sonata::gpio_input::InputTracker;
+using sonata::gpio_input::SampleMsec;
+
+/// Expose debugging features for this compartment when needed.
+using Debug = ConditionalDebug<false, "GPIO input">;
+
+/// The inputs that are watched for events.
+static constexpr uint32_t WatchedInputs = SonataGpioBoard::Inputs::Joystick;
+/// The most events that can be waiting to be taken.
+static constexpr size_t QueueLength = 16;
+
+namespace
+{
+	/// Protects the other state.
+	FlagLock                lock;
+	InputTracker            tracker;
+	EventQueue<QueueLength> queue;
+	/// Incremented when an event is queued, for waiters to wait on.
+	uint32_t produced = 0;
+
+	/// Queues an event from the tracker.
+	void push(const GpioInputEvent &event)
+	{
+		if (queue.push(event))
+		{
+			produced++;
+		}
+	}
+} // namespace
+
+int gpio_input_wait(Timeout *timeout, GpioInputEvent *event)
+{
+	if (!check_timeout_pointer(timeout) ||
+	    !check_pointer<PermissionSet{Permission::Store}, false>(
+	      event, sizeof(GpioInputEvent)))
+	{
+		return -EINVAL;
+	}
+	while (true)
+	{
+		GpioInputEvent next;
+		bool           found = false;
+		uint32_t       seen;
+		{
+			LockGuard guard{lock};
+			seen  = produced;
+			found = queue.pop(&next);
+		}
+		// The event is copied out once the lock is released, in case the
+		// caller's buffer faults.
+		if (found)
+		{
+			*event = next;
+			return 0;
+		}
+		if (!timeout->may_block())
+		{
+			return -ETIMEDOUT;
+		}
+		futex_timed_wait(timeout, &produced, seen);
+	}
+}
+
+int gpio_input_flush()
+{
+	LockGuard guard{lock};
+	queue.clear();
+	return 0;
+}
+
+uint32_t gpio_input_state()
+{
+	LockGuard guard{lock};
+	return tracker.state();
+}
+
+[[noreturn]] void __cheri_compartment("gpio_input") gpio_input_run()
+{
+	auto gpio = MMIO_CAPABILITY(SonataGpioBoard, gpio_board);
+	while (true)
+	{
+		const uint32_t Raw = gpio->input & WatchedInputs;
+		uint32_t       before;
+		uint32_t       after;
+		{
+			LockGuard guard{lock};
+			before = produced;
+			tracker.sample(Raw, rdcycle64(), push);
+			after = produced;
+		}
+		if (after != before)
+		{
+			Debug::log("Queued {} events, {} dropped so far",
+			           static_cast<int>(after - before),
+			           static_cast<int>(queue.dropped()));
+			futex_wake(&produced, UINT32_MAX);
+		}
+		thread_millisecond_wait(SampleMsec);
+	}
+}
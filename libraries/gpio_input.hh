@@ -0,0 +1,283 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+/*
+ * The GPIO input compartment, which watches Sonata's joystick and turns its
+ * movements into a queue of events for other compartments.
+ *
+ * The compartment's `gpio_input_run` thread samples the GPIO inputs at a
+ * fixed rate, as they can't raise interrupts, and debounces them. Each
+ * debounced change becomes a press or release event, and an input that is
+ * held becomes a hold event and then repeat events at a steady rate, as keys
+ * on a keyboard do. Events are queued until they are taken with
+ * `gpio_input_wait`, which blocks until there is one, so callers can sleep
+ * until there is input rather than polling for it, and short presses between
+ * polls aren't lost.
+ *
+ * There is a single queue, so only one compartment should take events at a
+ * time. Any compartment can read the debounced inputs.
+ */
+
+#include <compartment.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread.h>
+#include <tick_macros.h>
+
+enum class GpioInputEventKind : uint8_t
+{
+	Press,
+	Release,
+	/// The input has been held down for a while.
+	Hold,
+	/// The input is still held, sent at a steady rate after `Hold`.
+	Repeat,
+};
+
+struct GpioInputEvent
+{
+	/// The cycle count when the event was seen.
+	uint64_t cycles;
+	/// The GPIO input bit that the event is for.
+	uint32_t input;
+	/// All of the debounced inputs when the event was seen.
+	uint32_t inputs;
+
+	GpioInputEventKind kind;
+};
+
+/**
+ * Takes the oldest event from the queue into `event`, waiting for up to
+ * `timeout` for one if the queue is empty. Returns 0 on success,
+ * `-ETIMEDOUT` if no event came in time, or `-EINVAL` for invalid arguments.
+ */
+__cheri_compartment("gpio_input") int gpio_input_wait(Timeout        *timeout,
+                                                      GpioInputEvent *event);
+
+/// Discards the queued events, such as those from before a prompt was shown.
+__cheri_compartment("gpio_input") int gpio_input_flush();
+
+/// Returns the debounced inputs, with a set bit for each input held down.
+__cheri_compartment("gpio_input") uint32_t gpio_input_state();
+
+/// The thread that samples the inputs.
+[[noreturn]] void __cheri_compartment("gpio_input") gpio_input_run();
+
+/**
+ * Waits for up to `milliseconds` for any of `inputs` to be pressed, returning
+ * true if one was. Other events are discarded.
+ */
+inline bool gpio_input_wait_for_press(uint32_t milliseconds, uint32_t inputs)
+{
+	Timeout        timeout{MS_TO_TICKS(milliseconds)};
+	GpioInputEvent event;
+	while (gpio_input_wait(&timeout, &event) == 0)
+	{
+		if (event.kind == GpioInputEventKind::Press &&
+		    (event.input & inputs) != 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+namespace sonata::gpio_input
+{
+	/// The time between samples of the inputs.
+	static constexpr uint32_t SampleMsec = 10;
+	/// The number of samples in a row that an input must hold a value for.
+	static constexpr size_t DebounceSamples = 3;
+	/// The samples that an input is held for before `Hold` is sent.
+	static constexpr uint32_t HoldSamples = 50;
+	/// The samples between each `Repeat` while an input is held.
+	static constexpr uint32_t RepeatSamples = 10;
+
+	/**
+	 * Debounces up to 32 inputs at once. An input changes once it has held
+	 * its new value for `Samples` samples in a row.
+	 */
+	template<size_t Samples>
+	class Debouncer
+	{
+		uint32_t history[Samples] = {};
+		size_t   next             = 0;
+		uint32_t stable           = 0;
+
+		public:
+		/// Adds a sample of the inputs and returns the debounced inputs.
+		uint32_t sample(uint32_t raw)
+		{
+			history[next] = raw;
+			next          = (next + 1) % Samples;
+
+			uint32_t allSet = UINT32_MAX;
+			uint32_t anySet = 0;
+			for (uint32_t past : history)
+			{
+				allSet &= past;
+				anySet |= past;
+			}
+			stable = (stable | allSet) & anySet;
+			return stable;
+		}
+	};
+
+	/// Turns samples of the inputs into events.
+	class InputTracker
+	{
+		Debouncer<DebounceSamples> debouncer;
+		uint32_t                   current = 0;
+		/// The samples that each input has been held for.
+		uint32_t heldSamples[32] = {};
+
+		public:
+		/// Returns the debounced inputs.
+		uint32_t state() const
+		{
+			return current;
+		}
+
+		/**
+		 * Adds a sample of the inputs, taken at `cycles`, and calls `emit`
+		 * with each event that it causes.
+		 */
+		template<typename Emit>
+		void sample(uint32_t raw, uint64_t cycles, Emit &&emit)
+		{
+			const uint32_t Next     = debouncer.sample(raw);
+			const uint32_t Released = current & ~Next;
+			current                 = Next;
+			for (uint32_t bits = Next | Released; bits != 0; bits &= bits - 1)
+			{
+				const uint32_t     Bit   = __builtin_ctz(bits);
+				const uint32_t     Input = 1u << Bit;
+				GpioInputEventKind kind;
+				if ((Released & Input) != 0)
+				{
+					kind             = GpioInputEventKind::Release;
+					heldSamples[Bit] = 0;
+				}
+				else if (heldSamples[Bit]++ == 0)
+				{
+					kind = GpioInputEventKind::Press;
+				}
+				else if (heldSamples[Bit] == HoldSamples)
+				{
+					kind = GpioInputEventKind::Hold;
+				}
+				else if (heldSamples[Bit] > HoldSamples &&
+				         (heldSamples[Bit] - HoldSamples) % RepeatSamples == 0)
+				{
+					kind = GpioInputEventKind::Repeat;
+				}
+				else
+				{
+					continue;
+				}
+				emit(GpioInputEvent{cycles, Input, Next, kind});
+			}
+		}
+	};
+
+	/**
+	 * A queue of up to `Length` events. When it is full, holds and repeats
+	 * are dropped before presses and releases, so that short presses aren't
+	 * lost to a held input.
+	 */
+	template<size_t Length>
+	class EventQueue
+	{
+		GpioInputEvent events[Length];
+		size_t         head          = 0;
+		size_t         queued        = 0;
+		uint32_t       droppedEvents = 0;
+
+		/// Returns the queued event `index` places from the oldest.
+		GpioInputEvent &at(size_t index)
+		{
+			return events[(head + index) % Length];
+		}
+
+		/**
+		 * Makes room for a new `event` in a full queue, returning false if
+		 * it should be dropped instead.
+		 */
+		bool make_room(const GpioInputEvent &event)
+		{
+			if (event.kind == GpioInputEventKind::Hold ||
+			    event.kind == GpioInputEventKind::Repeat)
+			{
+				return false;
+			}
+			// Drop the oldest hold or repeat, keeping the order of the
+			// events after it, or the oldest event if there are none.
+			size_t drop = 0;
+			for (size_t i = 0; i < queued; i++)
+			{
+				if (at(i).kind == GpioInputEventKind::Hold ||
+				    at(i).kind == GpioInputEventKind::Repeat)
+				{
+					drop = i;
+					break;
+				}
+			}
+			for (size_t i = drop; i + 1 < queued; i++)
+			{
+				at(i) = at(i + 1);
+			}
+			queued--;
+			return true;
+		}
+
+		public:
+		/// Returns the number of queued events.
+		size_t size() const
+		{
+			return queued;
+		}
+
+		/// Returns the number of events dropped because the queue was full.
+		uint32_t dropped() const
+		{
+			return droppedEvents;
+		}
+
+		/// Queues `event`, returning false if it was dropped.
+		bool push(const GpioInputEvent &event)
+		{
+			if (queued == Length)
+			{
+				droppedEvents++;
+				if (!make_room(event))
+				{
+					return false;
+				}
+			}
+			at(queued++) = event;
+			return true;
+		}
+
+		/// Takes the oldest event into `event`, returning false if empty.
+		bool pop(GpioInputEvent *event)
+		{
+			if (queued == 0)
+			{
+				return false;
+			}
+			*event = events[head];
+			head   = (head + 1) % Length;
+			queued--;
+			return true;
+		}
+
+		/// Discards the queued events.
+		void clear()
+		{
+			head   = 0;
+			queued = 0;
+		}
+	};
+} // namespace sonata::gpio_input
@@ -0,0 +1,323 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "i2c_bus.hh"
+#include <algorithm>
+#include <cheri.hh>
+#include <debug.hh>
+#include <errno.h>
+#include <futex.h>
+#include <locks.hh>
+#include <platform-i2c.hh>
+#include <thread.h>
+#include <timeout.hh>
+#include <token.h>
+
+using namespace CHERI;
+
+/// Expose debugging features for this compartment when needed.
+using Debug = ConditionalDebug<false, "I2C bus">;
+
+static constexpr size_t BusCount      = 2;
+static constexpr size_t PriorityCount = 3;
+
+/// The unsealed contents of a device handle.
+struct I2cDevice
+{
+	uint8_t     bus;
+	uint8_t     address;
+	uint32_t    speedKhz;
+	I2cPriority priority;
+};
+
+namespace
+{
+	struct Bus
+	{
+		/// Protects the other fields.
+		FlagLock lock;
+		/// Set while a transfer has the bus.
+		bool busy;
+		/// The thread whose transfer has the bus, while it's busy.
+		uint16_t owner;
+		/// The number of transfers waiting at each priority.
+		uint32_t waiting[PriorityCount];
+		/// Incremented when the bus is released, for waiters to wait on.
+		uint32_t released;
+		/// The open devices, with a bit for each 7-bit address.
+		uint32_t openDevices[4];
+		uint32_t openCount;
+		uint32_t speedKhz;
+		uint64_t statisticsStart;
+
+		I2cBusStatistics statistics;
+	};
+
+	Bus buses[BusCount];
+} // namespace
+
+/**
+ * Get a token key for use sealing device handles.
+ */
+static auto key()
+{
+	static auto key = token_key_new();
+	return key;
+}
+
+static volatile OpenTitanI2c *controller(uint8_t bus)
+{
+	if (bus == 0)
+	{
+		return MMIO_CAPABILITY(OpenTitanI2c, i2c0);
+	}
+	return MMIO_CAPABILITY(OpenTitanI2c, i2c1);
+}
+
+static const I2cDevice *unseal(SealedI2cDevice device)
+{
+	return token_unseal(key(), Sealed<I2cDevice>{device});
+}
+
+/**
+ * Sets up a controller when the first device on its bus is opened.
+ */
+static void init_controller(volatile OpenTitanI2c *i2c, uint32_t speedKhz)
+{
+	/* Increase the reliability of the Sense HAT I2C against controller halts
+	in case the I2C Controller gets into a bad state while loading demos. */
+	i2c->control = i2c->control & ~(OpenTitanI2c::ControlEnableHost |
+	                                OpenTitanI2c::ControlEnableTarget);
+	if (i2c->interrupt_is_asserted(OpenTitanI2c::Interrupt::ControllerHalt))
+	{
+		i2c->reset_controller_events();
+	}
+
+	/* Initialise the I2C controller as normal. */
+	i2c->reset_fifos();
+	i2c->host_mode_set();
+	i2c->speed_set(speedKhz);
+}
+
+/**
+ * Waits until nothing has the bus and nothing of a higher priority is
+ * waiting for it, then takes it.
+ */
+static void acquire(Bus &bus, size_t priority)
+{
+	bool queued = false;
+	while (true)
+	{
+		uint32_t released;
+		{
+			LockGuard guard{bus.lock};
+			bool      higherWaiting = false;
+			for (size_t higher = priority + 1; higher < PriorityCount; higher++)
+			{
+				higherWaiting |= bus.waiting[higher] != 0;
+			}
+			if (!bus.busy && !higherWaiting)
+			{
+				if (queued)
+				{
+					bus.waiting[priority]--;
+					bus.statistics.queueDepth--;
+				}
+				bus.busy  = true;
+				bus.owner = thread_id_get();
+				return;
+			}
+			if (!queued)
+			{
+				queued = true;
+				bus.waiting[priority]++;
+				bus.statistics.queueDepth++;
+				bus.statistics.maxQueueDepth = std::max(
+				  bus.statistics.maxQueueDepth, bus.statistics.queueDepth);
+			}
+			released = bus.released;
+		}
+		futex_wait(&bus.released, released);
+	}
+}
+
+/**
+ * Gives up the bus and wakes the transfers waiting for it. Only the bytes of
+ * transfers that succeeded are counted.
+ */
+static void
+release(Bus &bus, uint64_t busyCycles, size_t bytes, bool succeeded)
+{
+	{
+		LockGuard guard{bus.lock};
+		bus.busy = false;
+		bus.released++;
+		bus.statistics.busyCycles += busyCycles;
+		bus.statistics.transfers++;
+		if (succeeded)
+		{
+			bus.statistics.bytesTransferred += bytes;
+		}
+		else
+		{
+			bus.statistics.failedTransfers++;
+		}
+	}
+	futex_wake(&bus.released, UINT32_MAX);
+}
+
+/**
+ * Releases any bus held by a thread that faults in this compartment, such as
+ * on a caller's buffer that is freed during its transfer, so that the other
+ * compartments on the bus aren't left waiting for it forever. The transfer
+ * counts as failed. No lock is held while a caller's memory is touched, so
+ * taking one here can't deadlock.
+ */
+extern "C" ErrorRecoveryBehaviour
+compartment_error_handler(ErrorState *frame, size_t mcause, size_t mtval)
+{
+	for (Bus &bus : buses)
+	{
+		bool held;
+		{
+			LockGuard guard{bus.lock};
+			held = bus.busy && bus.owner == thread_id_get();
+		}
+		if (held)
+		{
+			Debug::log("Releasing a bus after a fault during a transfer");
+			release(bus, 0, 0, false);
+		}
+	}
+	return ErrorRecoveryBehaviour::ForceUnwind;
+}
+
+int i2c_device_open(SealedI2cDevice *device,
+                    uint8_t          busIndex,
+                    uint8_t          address,
+                    uint32_t         speedKhz,
+                    I2cPriority      priority)
+{
+	if (busIndex >= BusCount || address > 0x7F || speedKhz == 0 ||
+	    static_cast<size_t>(priority) >= PriorityCount ||
+	    !check_pointer<PermissionSet{Permission::Store,
+	                                 Permission::LoadStoreCapability},
+	                   false>(device))
+	{
+		return -EINVAL;
+	}
+
+	auto [unsealed, sealed] =
+	  blocking_forever<token_allocate<I2cDevice>>(MALLOC_CAPABILITY, key());
+	if (!sealed.is_valid())
+	{
+		return -ENOMEM;
+	}
+	*unsealed = {busIndex, address, speedKhz, priority};
+
+	Bus           &bus = buses[busIndex];
+	const uint32_t Bit = 1u << (address % 32);
+	{
+		LockGuard guard{bus.lock};
+		if ((bus.openDevices[address / 32] & Bit) == 0)
+		{
+			bus.openDevices[address / 32] |= Bit;
+			if (bus.openCount++ == 0)
+			{
+				init_controller(controller(busIndex), speedKhz);
+				bus.speedKhz        = speedKhz;
+				bus.statisticsStart = rdcycle64();
+			}
+			*device = sealed.get();
+			return 0;
+		}
+	}
+	Debug::log("Device {} on bus {} is already open", address, busIndex);
+	token_obj_destroy(MALLOC_CAPABILITY, key(), sealed.get());
+	return -EBUSY;
+}
+
+int i2c_device_close(SealedI2cDevice device)
+{
+	const I2cDevice *unsealed = unseal(device);
+	if (unsealed == nullptr)
+	{
+		return -EINVAL;
+	}
+	Bus &bus = buses[unsealed->bus];
+	{
+		LockGuard guard{bus.lock};
+		bus.openDevices[unsealed->address / 32] &=
+		  ~(1u << (unsealed->address % 32));
+		bus.openCount--;
+	}
+	token_obj_destroy(MALLOC_CAPABILITY, key(), device);
+	return 0;
+}
+
+int i2c_transfer(SealedI2cDevice device,
+                 const uint8_t  *write,
+                 size_t          writeLength,
+                 uint8_t        *read,
+                 size_t          readLength)
+{
+	const I2cDevice *unsealed = unseal(device);
+	if (unsealed == nullptr ||
+	    (writeLength > 0 &&
+	     !check_pointer<PermissionSet{Permission::Load}, false>(
+	       write, writeLength)) ||
+	    (readLength > 0 &&
+	     !check_pointer<PermissionSet{Permission::Store}, false>(read,
+	                                                            readLength)))
+	{
+		return -EINVAL;
+	}
+
+	Bus &bus = buses[unsealed->bus];
+	acquire(bus, static_cast<size_t>(unsealed->priority));
+
+	const uint64_t Start = rdcycle64();
+	auto           i2c   = controller(unsealed->bus);
+	if (bus.speedKhz != unsealed->speedKhz)
+	{
+		i2c->speed_set(unsealed->speedKhz);
+		bus.speedKhz = unsealed->speedKhz;
+	}
+	const bool Succeeded =
+	  sonata::i2c::Controller(i2c, unsealed->address)
+	    .transfer(write, writeLength, read, readLength);
+
+	release(bus, rdcycle64() - Start, writeLength + readLength, Succeeded);
+	return Succeeded ? 0 : -EIO;
+}
+
+int i2c_bus_statistics(uint8_t           busIndex,
+                       I2cBusStatistics *statistics,
+                       bool              reset)
+{
+	if (busIndex >= BusCount ||
+	    !check_pointer<PermissionSet{Permission::Store}, false>(
+	      statistics, sizeof(I2cBusStatistics)))
+	{
+		return -EINVAL;
+	}
+	Bus             &bus = buses[busIndex];
+	I2cBusStatistics copy;
+	{
+		LockGuard      guard{bus.lock};
+		const uint64_t Now = rdcycle64();
+		copy               = bus.statistics;
+		copy.elapsedCycles = Now - bus.statisticsStart;
+		if (reset)
+		{
+			const uint32_t QueueDepth = bus.statistics.queueDepth;
+			bus.statistics            = {};
+			bus.statistics.queueDepth = QueueDepth;
+			bus.statisticsStart       = Now;
+		}
+	}
+	// The statistics are copied out once the lock is released, in case the
+	// caller's buffer faults.
+	*statistics = copy;
+	return 0;
+}
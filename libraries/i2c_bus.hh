@@ -0,0 +1,110 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+/*
+ * The I2C bus compartment, which owns Sonata's I2C controllers and shares
+ * them between the compartments that use I2C devices.
+ *
+ * Compartments open a handle for each device they use, which is sealed so
+ * that it can only be used through this compartment. Only one handle can be
+ * open for a device at a time, so two demos in one firmware can't drive the
+ * same device. Each transfer holds the bus from start to stop, so transfers
+ * from different compartments are never interleaved. When several are
+ * waiting for a bus, the one with the highest priority goes next, and the
+ * bus is set to each device's speed before its transfer.
+ *
+ * Each bus counts the cycles it spends busy and the transfers waiting for
+ * it, which `i2c_bus_statistics` reports.
+ */
+
+#include "i2c_device.hh"
+#include <compartment.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct I2cDevice;
+typedef CHERI_SEALED(I2cDevice *) SealedI2cDevice;
+
+/// The order in which waiting transfers are given the bus.
+enum class I2cPriority : uint8_t
+{
+	Low,
+	Normal,
+	High,
+};
+
+struct I2cBusStatistics
+{
+	/// Cycles since the statistics were last reset.
+	uint64_t elapsedCycles;
+	/// Cycles during which a transfer had the bus.
+	uint64_t busyCycles;
+	uint32_t transfers;
+	uint32_t failedTransfers;
+	uint32_t bytesTransferred;
+	/// The number of transfers waiting for the bus.
+	uint32_t queueDepth;
+	/// The most transfers that have been waiting for the bus at once.
+	uint32_t maxQueueDepth;
+};
+
+/**
+ * Opens the device at `address` on I2C bus `bus`, which it will be run at
+ * `speedKhz` for, and stores the handle in `device`. Returns 0 on success,
+ * `-EBUSY` if the device is already open, or `-EINVAL` for invalid arguments.
+ */
+__cheri_compartment("i2c_bus") int i2c_device_open(SealedI2cDevice *device,
+                                                   uint8_t          bus,
+                                                   uint8_t          address,
+                                                   uint32_t         speedKhz,
+                                                   I2cPriority      priority);
+
+/// Closes a device handle, so that the device can be opened again.
+__cheri_compartment("i2c_bus") int i2c_device_close(SealedI2cDevice device);
+
+/**
+ * Writes `writeLength` bytes to the device and then reads `readLength` bytes,
+ * with a repeated start between the two. Either may be empty. Returns 0 on
+ * success, `-EIO` if the device didn't respond, or `-EINVAL` for invalid
+ * arguments.
+ */
+__cheri_compartment("i2c_bus") int i2c_transfer(SealedI2cDevice device,
+                                                const uint8_t  *write,
+                                                size_t          writeLength,
+                                                uint8_t        *read,
+                                                size_t          readLength);
+
+/**
+ * Copies the statistics of I2C bus `bus` into `statistics`, and resets them
+ * if `reset` is set.
+ */
+__cheri_compartment("i2c_bus") int i2c_bus_statistics(
+  uint8_t           bus,
+  I2cBusStatistics *statistics,
+  bool              reset);
+
+namespace sonata::i2c
+{
+	/// A device opened through the I2C bus compartment.
+	class SharedTarget
+	{
+		SealedI2cDevice handle;
+
+		public:
+		constexpr SharedTarget(SealedI2cDevice handle) : handle(handle) {}
+
+		bool transfer(const uint8_t *write,
+		              size_t         writeLength,
+		              uint8_t       *read,
+		              size_t         readLength) const
+		{
+			return i2c_transfer(handle, write, writeLength, read, readLength) ==
+			       0;
+		}
+	};
+
+	template<typename RegisterAddress = uint8_t>
+	using SharedDevice = Device<RegisterAddress, SharedTarget>;
+} // namespace sonata::i2c
@@ -0,0 +1,345 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <platform-i2c.hh>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <thread.h>
+#include <type_traits>
+
+/**
+ * Register-level access to devices on an I2C bus.
+ *
+ * A `Device` is a target on an I2C bus, reached either directly through a
+ * `Controller` or, from compartments that share a bus, through the I2C bus
+ * compartment with a `SharedTarget` from `i2c_bus.hh`. Registers are read in
+ * a single transfer, with a repeated start between sending the register
+ * address and reading the data, and several consecutive registers can be
+ * read at once. `Register` describes a register holding a
+ * multi-byte value, so that callers don't assemble values byte by byte.
+ *
+ * Init sequences are lists of `Step`s, which `Device::run` sends back to
+ * back, joining writes to consecutive registers into a single transaction.
+ * This relies on the device incrementing its register address after each
+ * byte, as register-mapped I2C devices do. `ShadowedDevice` also remembers
+ * the values written to a range of registers and skips writes that wouldn't
+ * change them.
+ */
+namespace sonata::i2c
+{
+	enum class ByteOrder
+	{
+		BigEndian,
+		LittleEndian,
+	};
+
+	/// A register, or consecutive registers, holding a value of type `T`.
+	template<typename T, ByteOrder Order = ByteOrder::BigEndian>
+	struct Register
+	{
+		static_assert(sizeof(T) <= sizeof(uint32_t));
+
+		uint8_t address;
+
+		static T decode(const uint8_t (&bytes)[sizeof(T)])
+		{
+			uint32_t value = 0;
+			for (size_t i = 0; i < sizeof(T); i++)
+			{
+				const size_t Byte =
+				  Order == ByteOrder::BigEndian ? i : sizeof(T) - 1 - i;
+				value = (value << 8) | bytes[Byte];
+			}
+			return static_cast<T>(value);
+		}
+
+		static void encode(T value, uint8_t (&bytes)[sizeof(T)])
+		{
+			uint32_t raw = static_cast<uint32_t>(value);
+			for (size_t i = 0; i < sizeof(T); i++)
+			{
+				const size_t Byte =
+				  Order == ByteOrder::BigEndian ? sizeof(T) - 1 - i : i;
+				bytes[Byte] = raw & 0xFF;
+				raw >>= 8;
+			}
+		}
+	};
+
+	/**
+	 * A write of a single 8-bit register in an init sequence, followed by a
+	 * wait of `waitMsec` milliseconds for the device to act on it.
+	 */
+	struct Step
+	{
+		uint8_t  reg;
+		uint8_t  value;
+		uint16_t waitMsec = 0;
+	};
+
+	/**
+	 * The target at `address` on an I2C controller that the caller owns.
+	 */
+	class Controller
+	{
+		volatile OpenTitanI2c *bus;
+		uint8_t                address;
+
+		public:
+		constexpr Controller(volatile OpenTitanI2c *bus, uint8_t address)
+		  : bus(bus), address(address)
+		{
+		}
+
+		/**
+		 * Writes `writeLength` bytes and then reads `readLength` bytes, with
+		 * a repeated start between the two. Either may be empty.
+		 */
+		bool transfer(const uint8_t *write,
+		              size_t         writeLength,
+		              uint8_t       *read,
+		              size_t         readLength) const
+		{
+			// Skip the stop when a read follows so that it begins with a
+			// repeated start.
+			const bool SkipStop = readLength > 0;
+			if (writeLength > 0 &&
+			    !bus->blocking_write(address, write, writeLength, SkipStop))
+			{
+				return false;
+			}
+			return readLength == 0 ||
+			       bus->blocking_read(address, read, readLength);
+		}
+	};
+
+	/**
+	 * A device reached through `Target`, with register addresses of type
+	 * `RegisterAddress`, which are sent most significant byte first.
+	 */
+	template<typename RegisterAddress = uint8_t, typename Target = Controller>
+	class Device
+	{
+		protected:
+		static constexpr size_t AddressBytes = sizeof(RegisterAddress);
+
+		Target target;
+
+		static void encode_address(RegisterAddress reg, uint8_t *bytes)
+		{
+			for (size_t i = 0; i < AddressBytes; i++)
+			{
+				bytes[i] = (reg >> ((AddressBytes - 1 - i) * 8)) & 0xFF;
+			}
+		}
+
+		/**
+		 * Sends the steps that `skip` doesn't reject, joining those for
+		 * consecutive registers into one write. `skip` is asked about the
+		 * steps in order, and is asked only once about each step it lets
+		 * through.
+		 */
+		template<typename Skip>
+		bool run_steps(const Step *steps, size_t count, Skip &&skip) const
+		{
+			static_assert(AddressBytes == 1,
+			              "Init sequences are for 8-bit register addresses");
+			size_t i = 0;
+			while (i < count)
+			{
+				if (skip(steps[i]))
+				{
+					i++;
+					continue;
+				}
+				uint8_t buffer[1 + MaxWriteBytes];
+				size_t  length = 0;
+				buffer[0]      = steps[i].reg;
+				do
+				{
+					buffer[1 + length++] = steps[i++].value;
+				} while (i < count && length < MaxWriteBytes &&
+				         steps[i - 1].waitMsec == 0 &&
+				         steps[i].reg == steps[i - 1].reg + 1 &&
+				         !skip(steps[i]));
+				if (!target.transfer(buffer, 1 + length, nullptr, 0))
+				{
+					return false;
+				}
+				if (steps[i - 1].waitMsec != 0)
+				{
+					thread_millisecond_wait(steps[i - 1].waitMsec);
+				}
+			}
+			return true;
+		}
+
+		public:
+		/// The most bytes of data that a single write can send.
+		static constexpr size_t MaxWriteBytes = 16;
+
+		constexpr Device(Target target) : target(target) {}
+
+		constexpr Device(volatile OpenTitanI2c *bus, uint8_t address)
+		    requires std::is_same_v<Target, Controller>
+		  : target(bus, address)
+		{
+		}
+
+		/**
+		 * Reads `length` bytes from the registers starting at `reg`, in a
+		 * single transaction.
+		 */
+		bool read(RegisterAddress reg, uint8_t *data, size_t length) const
+		{
+			uint8_t prefix[AddressBytes];
+			encode_address(reg, prefix);
+			return target.transfer(prefix, AddressBytes, data, length);
+		}
+
+		/**
+		 * Writes `length` bytes to the registers starting at `reg`, in a
+		 * single transaction. With no data, only the register address is
+		 * sent, which some devices take as a command.
+		 */
+		bool
+		write(RegisterAddress reg, const uint8_t *data, size_t length) const
+		{
+			if (length > MaxWriteBytes)
+			{
+				return false;
+			}
+			uint8_t buffer[AddressBytes + MaxWriteBytes];
+			encode_address(reg, buffer);
+			if (length > 0)
+			{
+				memcpy(buffer + AddressBytes, data, length);
+			}
+			return target.transfer(buffer, AddressBytes + length, nullptr, 0);
+		}
+
+		template<typename T, ByteOrder Order>
+		bool read(Register<T, Order> reg, T *value) const
+		{
+			uint8_t bytes[sizeof(T)];
+			if (!read(reg.address, bytes, sizeof(T)))
+			{
+				return false;
+			}
+			*value = Register<T, Order>::decode(bytes);
+			return true;
+		}
+
+		template<typename T, ByteOrder Order>
+		bool write(Register<T, Order> reg, T value) const
+		{
+			uint8_t bytes[sizeof(T)];
+			Register<T, Order>::encode(value, bytes);
+			return write(reg.address, bytes, sizeof(T));
+		}
+
+		/**
+		 * Sends an init sequence. Stops and returns false at the first write
+		 * that isn't acknowledged.
+		 */
+		template<size_t N>
+		bool run(const Step (&steps)[N]) const
+		{
+			return run_steps(steps, N, [](const Step &) { return false; });
+		}
+	};
+
+	/**
+	 * A device with 8-bit register addresses that remembers the values last
+	 * written to registers `First` to `First + Count - 1`, and skips writes
+	 * of the values they already hold. Only shadow registers that the device
+	 * doesn't change itself.
+	 */
+	template<uint8_t First, size_t Count, typename Target = Controller>
+	class ShadowedDevice : public Device<uint8_t, Target>
+	{
+		using Base = Device<uint8_t, Target>;
+
+		static_assert(First + Count <= 0x100);
+
+		uint8_t values[Count] = {};
+		bool    known[Count]  = {};
+
+		static bool shadowed(uint8_t reg)
+		{
+			return reg >= First && static_cast<size_t>(reg - First) < Count;
+		}
+
+		bool holds(uint8_t reg, uint8_t value) const
+		{
+			return shadowed(reg) && known[reg - First] &&
+			       values[reg - First] == value;
+		}
+
+		void remember(uint8_t reg, uint8_t value)
+		{
+			if (shadowed(reg))
+			{
+				values[reg - First] = value;
+				known[reg - First]  = true;
+			}
+		}
+
+		public:
+		using Base::Base;
+		using Base::write;
+
+		/// Writes a single register, unless it already holds `value`.
+		bool write(uint8_t reg, uint8_t value)
+		{
+			if (holds(reg, value))
+			{
+				return true;
+			}
+			if (!Base::write(reg, &value, 1))
+			{
+				forget();
+				return false;
+			}
+			remember(reg, value);
+			return true;
+		}
+
+		/**
+		 * Sends an init sequence, leaving out the writes that wouldn't
+		 * change a register.
+		 */
+		template<size_t N>
+		bool run(const Step (&steps)[N])
+		{
+			// Each step is remembered as it's let through, so a later step
+			// is compared against the value that the sequence leaves.
+			auto skip = [&](const Step &step) {
+				if (holds(step.reg, step.value))
+				{
+					return true;
+				}
+				remember(step.reg, step.value);
+				return false;
+			};
+			if (!Base::run_steps(steps, N, skip))
+			{
+				forget();
+				return false;
+			}
+			return true;
+		}
+
+		/// Forgets the shadowed values, such as after the device is reset.
+		void forget()
+		{
+			for (bool &isKnown : known)
+			{
+				isKnown = false;
+			}
+		}
+	};
+} // namespace sonata::i2c
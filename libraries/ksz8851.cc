@@ -0,0 +1,129 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ksz8851.hh"
+#include <cheri.hh>
+#include <platform-spi.hh>
+
+using namespace sonata::ksz8851;
+
+template<typename T>
+using Cap = CHERI::Capability<T>;
+
+using EthernetSpi = SonataSpi::EthernetMac;
+
+/**
+ * Helper. Returns a pointer to the SPI device that the MAC is attached to.
+ */
+[[nodiscard, gnu::always_inline]] static inline Cap<volatile EthernetSpi> spi()
+{
+	return MMIO_CAPABILITY(EthernetSpi, spi_ethmac);
+}
+
+// The chip select of the MAC on its SPI bus, which is active low.
+static constexpr uint32_t EthernetCsBit = 1u << 0;
+
+// The opcodes of the MAC's SPI commands for accessing its registers.
+static constexpr uint8_t RegisterReadOpcode  = 0b00;
+static constexpr uint8_t RegisterWriteOpcode = 0b01;
+
+// The fields of the Indirect Access Control Register (IACR).
+static constexpr uint16_t IndirectReadEnable = 1 << 12;
+static constexpr uint16_t MibCounterTable    = 0b11 << 10;
+
+/**
+ * Selects the MAC on its SPI bus, or deselects it.
+ */
+static void select(bool selected)
+{
+	spi()->chipSelects = selected ? (spi()->chipSelects & ~EthernetCsBit)
+	                              : (spi()->chipSelects | EthernetCsBit);
+}
+
+/**
+ * Sends the command to access the register `reg`, selecting the MAC. Its two
+ * bytes hold the opcode, which of the four bytes of the register's 32-bit word
+ * are accessed, and the word's address.
+ */
+static void command_send(uint8_t opcode, Register reg)
+{
+	const uint8_t Offset     = static_cast<uint8_t>(reg);
+	const uint8_t ByteEnable = (Offset & 0x2) == 0 ? 0b0011 : 0b1100;
+	const uint8_t Command[2] = {
+	  static_cast<uint8_t>((opcode << 6) | (ByteEnable << 2) | (Offset >> 6)),
+	  static_cast<uint8_t>((Offset << 2) & 0b11110000),
+	};
+	select(true);
+	spi()->blocking_write(Command, sizeof(Command));
+}
+
+namespace sonata::ksz8851
+{
+	uint16_t register_read(Register reg)
+	{
+		uint8_t value[2];
+		command_send(RegisterReadOpcode, reg);
+		spi()->blocking_read(value, sizeof(value));
+		select(false);
+		return value[0] | (value[1] << 8);
+	}
+
+	void register_write(Register reg, uint16_t value)
+	{
+		const uint8_t Value[2] = {static_cast<uint8_t>(value),
+		                          static_cast<uint8_t>(value >> 8)};
+		command_send(RegisterWriteOpcode, reg);
+		spi()->blocking_write(Value, sizeof(Value));
+		spi()->wait_idle();
+		select(false);
+	}
+
+	uint32_t mib_counter_read(MibCounter counter)
+	{
+		register_write(Register::IndirectAccessControl,
+		               IndirectReadEnable | MibCounterTable |
+		                 static_cast<uint8_t>(counter));
+		const uint32_t Low  = register_read(Register::IndirectAccessDataLow);
+		const uint32_t High = register_read(Register::IndirectAccessDataHigh);
+		return Low | (High << 16);
+	}
+
+	void filter_received_frames(const MacAddress *groups, size_t count)
+	{
+		uint16_t hashTable[4] = {0, 0, 0, 0};
+		for (size_t i = 0; i < count; ++i)
+		{
+			const uint8_t Hash = multicast_hash(groups[i]);
+			hashTable[Hash >> 4] |= 1 << (Hash & 0xF);
+		}
+		register_write(Register::MulticastHashTable0, hashTable[0]);
+		register_write(Register::MulticastHashTable1, hashTable[1]);
+		register_write(Register::MulticastHashTable2, hashTable[2]);
+		register_write(Register::MulticastHashTable3, hashTable[3]);
+
+		// Unicast frames must match the MAC's address exactly, and multicast
+		// frames must match the hash table. Everything else is dropped.
+		uint16_t control = register_read(Register::ReceiveControl1);
+		control &= ~(ReceiveControl1::AllEnable |
+		             ReceiveControl1::InverseFiltering |
+		             ReceiveControl1::BroadcastEnable |
+		             ReceiveControl1::MulticastEnable |
+		             ReceiveControl1::MulticastAddressFiltering);
+		control |= ReceiveControl1::UnicastEnable |
+		           ReceiveControl1::PhysicalAddressFiltering;
+		if (count > 0)
+		{
+			control |= ReceiveControl1::MulticastEnable;
+		}
+		register_write(Register::ReceiveControl1, control);
+	}
+
+	ReceivedCounts received_counts_read()
+	{
+		return {
+		  .unicast   = mib_counter_read(MibCounter::ReceiveUnicast),
+		  .multicast = mib_counter_read(MibCounter::ReceiveMulticast),
+		  .broadcast = mib_counter_read(MibCounter::ReceiveBroadcast),
+		};
+	}
+} // namespace sonata::ksz8851
@@ -0,0 +1,131 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Direct access to the registers of the KSZ8851 Ethernet MAC, for the
+ * features that the RTOS's Ethernet driver doesn't expose, such as its receive
+ * address filtering and its MIB counters.
+ *
+ * These share the MAC's SPI bus with the driver, so must only be used from the
+ * thread that uses the driver, and after the driver has set the MAC up.
+ */
+namespace sonata::ksz8851
+{
+	using MacAddress = std::array<uint8_t, 6>;
+
+	/// The registers used here, by their offset.
+	enum class Register : uint8_t
+	{
+		ReceiveControl1        = 0x74,
+		MulticastHashTable0    = 0xA0,
+		MulticastHashTable1    = 0xA2,
+		MulticastHashTable2    = 0xA4,
+		MulticastHashTable3    = 0xA6,
+		IndirectAccessControl  = 0xC8,
+		IndirectAccessDataLow  = 0xD0,
+		IndirectAccessDataHigh = 0xD2,
+		Port1MiiBasicControl   = 0xE4,
+	};
+
+	/// The fields of the Receive Control Register 1 (RXCR1).
+	namespace ReceiveControl1
+	{
+		static constexpr uint16_t Enable                    = 1 << 0;
+		static constexpr uint16_t InverseFiltering          = 1 << 1;
+		static constexpr uint16_t AllEnable                 = 1 << 4;
+		static constexpr uint16_t UnicastEnable             = 1 << 5;
+		static constexpr uint16_t MulticastEnable           = 1 << 6;
+		static constexpr uint16_t BroadcastEnable           = 1 << 7;
+		static constexpr uint16_t MulticastAddressFiltering = 1 << 8;
+		static constexpr uint16_t PhysicalAddressFiltering  = 1 << 11;
+	} // namespace ReceiveControl1
+
+	/// The fields of the PHY's MII Basic Control Register (P1MBCR).
+	namespace Port1MiiBasicControl
+	{
+		static constexpr uint16_t ForceFullDuplex       = 1 << 8;
+		static constexpr uint16_t AutoNegotiationEnable = 1 << 12;
+		static constexpr uint16_t ForceSpeed100         = 1 << 13;
+		/// Loops transmitted frames back to the receiver inside the PHY.
+		static constexpr uint16_t LocalLoopback = 1 << 14;
+	} // namespace Port1MiiBasicControl
+
+	/// The MIB counters of frames that arrived at the MAC, by their index.
+	enum class MibCounter : uint8_t
+	{
+		ReceiveBroadcast = 0x0B,
+		ReceiveMulticast = 0x0C,
+		ReceiveUnicast   = 0x0D,
+	};
+
+	/// Reads the 16-bit register `reg`.
+	uint16_t register_read(Register reg);
+
+	/// Writes `value` to the 16-bit register `reg`.
+	void register_write(Register reg, uint16_t value);
+
+	/**
+	 * Reads the MIB counter `counter`, which the MAC clears as it's read.
+	 */
+	uint32_t mib_counter_read(MibCounter counter);
+
+	/**
+	 * Returns the bit of the MAC's 64-bit multicast hash table that frames
+	 * to `address` are filtered by, which is the top six bits of the
+	 * Ethernet CRC of the address.
+	 */
+	constexpr uint8_t multicast_hash(const MacAddress &Address)
+	{
+		constexpr uint32_t Polynomial = 0x04C11DB7;
+		uint32_t           crc        = 0xFFFFFFFF;
+		for (uint8_t octet : Address)
+		{
+			for (uint8_t bit = 0; bit < 8; ++bit, octet >>= 1)
+			{
+				const bool Carry = ((crc >> 31) ^ (octet & 1)) != 0;
+				crc <<= 1;
+				if (Carry)
+				{
+					crc ^= Polynomial;
+				}
+			}
+		}
+		return crc >> 26;
+	}
+
+	/**
+	 * Makes the MAC drop every received frame in hardware, except those sent
+	 * to its own (unicast) address and those sent to one of the multicast
+	 * `groups`. Broadcast frames are dropped.
+	 *
+	 * Multicast frames are matched by their hash, so frames to another group
+	 * with the same hash as one of `groups` are still received, and should
+	 * be checked for in software.
+	 */
+	void filter_received_frames(const MacAddress *groups, size_t count);
+
+	/// The frames that arrived at the MAC, before its address filtering.
+	struct ReceivedCounts
+	{
+		uint32_t unicast;
+		uint32_t multicast;
+		uint32_t broadcast;
+
+		uint32_t total() const
+		{
+			return unicast + multicast + broadcast;
+		}
+	};
+
+	/**
+	 * Reads the counts of the frames that have arrived at the MAC since they
+	 * were last read, including those that it then filtered out.
+	 */
+	ReceivedCounts received_counts_read();
+} // namespace sonata::ksz8851
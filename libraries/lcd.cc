@@ -8,13 +8,15 @@ template<typename T>
 using Cap = CHERI::Capability<T>;
 
 using namespace sonata::lcd;
+using sonata::lcd::internal::Panel;
+using sonata::lcd::internal::St7735Panel;
 using LcdPwm = SonataPulseWidthModulation::LcdBacklight;
 using LcdSpi = SonataSpi::Lcd;
 
 /**
  * Helper. Returns a pointer to the SPI device.
  */
-[[nodiscard, gnu::always_inline]] static Cap<volatile LcdSpi> spi()
+[[nodiscard, gnu::always_inline]] static inline Cap<volatile LcdSpi> spi()
 {
 	return MMIO_CAPABILITY(LcdSpi, spi_lcd);
 }
@@ -22,7 +24,7 @@ using LcdSpi = SonataSpi::Lcd;
 /**
  * Helper. Returns a pointer to the LCD's backlight PWM device.
  */
-[[nodiscard, gnu::always_inline]] static Cap<volatile LcdPwm> pwm_bl()
+[[nodiscard, gnu::always_inline]] static inline Cap<volatile LcdPwm> pwm_bl()
 {
 	return MMIO_CAPABILITY(LcdPwm, pwm_lcd);
 }
@@ -43,12 +45,432 @@ void set_chip_select(uint8_t chipSelect, bool value)
 	spi()->chipSelects =
 	  value ? (spi()->chipSelects | CsBit) : (spi()->chipSelects & ~CsBit);
 }
+
+/**
+ * Sends a command and its parameters to the LCD, outside of the driver, for
+ * the commands that it doesn't wrap.
+ */
+static void
+write_command(uint8_t command, const uint8_t *parameters, size_t length)
+{
+	set_chip_select(LcdCsPin, false);
+	set_chip_select(LcdDcPin, false);
+	set_chip_select(SpiOutEn, true);
+	spi()->blocking_write(&command, 1);
+	spi()->wait_idle();
+	set_chip_select(LcdDcPin, true);
+	spi()->blocking_write(parameters, length);
+	spi()->wait_idle();
+	set_chip_select(LcdCsPin, true);
+}
+
+/**
+ * Sends a command to the LCD, outside of the driver, and leaves the LCD
+ * selected with the SPI data line turned around, for its response to be read
+ * until `read_finish` is called.
+ */
+static void read_command(uint8_t command)
+{
+	set_chip_select(LcdCsPin, false);
+	set_chip_select(LcdDcPin, false);
+	set_chip_select(SpiOutEn, true);
+	spi()->blocking_write(&command, 1);
+	spi()->wait_idle();
+	set_chip_select(LcdDcPin, true);
+	set_chip_select(SpiOutEn, false);
+}
+
+/// Deselects the LCD after reading the response to `read_command`.
+static void read_finish()
+{
+	spi()->wait_idle();
+	set_chip_select(LcdCsPin, true);
+}
+
+/**
+ * Helper. Sets the window that pixels are written to and read from, in the
+ * controller's own addressing, without the driver's offset.
+ */
+static void raw_window_set(Rect rect)
+{
+	const uint8_t Columns[] = {static_cast<uint8_t>(rect.left >> 8),
+	                           static_cast<uint8_t>(rect.left),
+	                           static_cast<uint8_t>((rect.right - 1) >> 8),
+	                           static_cast<uint8_t>(rect.right - 1)};
+	const uint8_t Rows[]    = {static_cast<uint8_t>(rect.top >> 8),
+	                           static_cast<uint8_t>(rect.top),
+	                           static_cast<uint8_t>((rect.bottom - 1) >> 8),
+	                           static_cast<uint8_t>(rect.bottom - 1)};
+	write_command(Panel::ColumnAddressSet, Columns, sizeof(Columns));
+	write_command(Panel::RowAddressSet, Rows, sizeof(Rows));
+}
+
+/**
+ * Helper. Converts a rectangle to the driver's, which is given by its origin
+ * and size.
+ */
+static internal::LCD_rectangle driver_rect(Rect rect)
+{
+	return {
+	  {rect.left, rect.top}, rect.right - rect.left, rect.bottom - rect.top};
+}
+
+/**
+ * Helper. Draws `rect` in bands of whole rows that fit in a line of the
+ * panel's long side. Before each band is drawn, `fill` is called with the
+ * buffer to write the band's RGB565 to, the band's first row in `rect` and
+ * its number of rows. Returns false, without drawing anything, if a row of
+ * `rect` doesn't fit in the buffer.
+ */
+template<typename Fill>
+static bool draw_in_bands(Panel::Context *ctx, Rect rect, Fill &&fill)
+{
+	static_assert(Panel::Format == PixelFormat::Rgb565,
+	              "bands are drawn as RGB565");
+	static constexpr uint32_t BufferPixels =
+	  std::max(Panel::Resolution.width, Panel::Resolution.height);
+	alignas(4) uint8_t buffer[BufferPixels * 2];
+
+	const uint32_t Width = rect.right - rect.left;
+	if (Width > BufferPixels)
+	{
+		return false;
+	}
+	const uint32_t BandRows = BufferPixels / std::max<uint32_t>(Width, 1);
+	for (uint32_t top = rect.top; top < rect.bottom; top += BandRows)
+	{
+		const uint32_t Rows = std::min(BandRows, rect.bottom - top);
+		fill(buffer, top - rect.top, Rows);
+		Panel::draw_rgb565(
+		  ctx, {rect.left, top, rect.right, top + Rows}, buffer);
+	}
+	return true;
+}
+
+/**
+ * Helper. Draws `sprite` at `point`, in bands of rows, taking each of its
+ * transparent pixels from `background`, which is called with the pixel's row
+ * and column in the sprite and writes its RGB565 to the given two bytes.
+ */
+template<typename Background>
+static void draw_sprite_over(Panel::Context *ctx,
+                             Point           point,
+                             const Sprite   &sprite,
+                             Background    &&background)
+{
+	const Rect Area = Rect::from_point_and_size(point, sprite.size);
+	draw_in_bands(
+	  ctx, Area, [&](uint8_t *buffer, uint32_t firstRow, uint32_t rows) {
+		  for (uint32_t row = firstRow; row < firstRow + rows; row++)
+		  {
+			  const uint8_t *Pixels =
+			    &sprite.pixels[row * sprite.size.width * 2];
+			  for (uint32_t column = 0; column < sprite.size.width;
+			       column++, buffer += 2)
+			  {
+				  if (sprite.opaque(row, column))
+				  {
+					  buffer[0] = Pixels[column * 2];
+					  buffer[1] = Pixels[column * 2 + 1];
+				  }
+				  else
+				  {
+					  background(row, column, buffer);
+				  }
+			  }
+		  }
+	  });
+}
+
+/**
+ * Helper. Fills `rect` with `color`, sending its RGB565 to the panel as it is
+ * rather than through the driver's RGB888 fill. The band buffer only has the
+ * colour written to it once, as every band is the same.
+ */
+static void fill_rgb565(Panel::Context *ctx, Rect rect, Color565 color)
+{
+	if (rect.right <= rect.left || rect.bottom <= rect.top)
+	{
+		return;
+	}
+	const uint8_t High  = static_cast<uint8_t>(color.rgb565() >> 8);
+	const uint8_t Low   = static_cast<uint8_t>(color.rgb565());
+	uint32_t      ready = 0;
+
+	const auto Fill = [&](uint8_t *buffer, uint32_t, uint32_t rows) {
+		const uint32_t Pixels = rows * (rect.right - rect.left);
+		for (; ready < Pixels; ready++)
+		{
+			buffer[ready * 2]     = High;
+			buffer[ready * 2 + 1] = Low;
+		}
+	};
+	if (!draw_in_bands(ctx, rect, Fill))
+	{
+		Panel::fill_rect(ctx, rect, color.rgb888());
+	}
+}
+
 namespace sonata::lcd::internal
 {
 	using Debug = ConditionalDebug<true, "LCD">;
+
+	void St7735Panel::init(Context *ctx, LCD_Interface *lcdIntf)
+	{
+		lcd_st7735_init(ctx, lcdIntf);
+
+		// Detect the resolution configuration and workaround if misconfigured.
+		size_t w = 0, h = 0;
+		Result res = lcd_st7735_check_frame_buffer_resolution(ctx, &w, &h);
+		if (res.code != 0)
+		{
+			Debug::log("Warning: Unable to determine LCD offset. Try slower "
+			           "SPI clock.\r\n");
+		}
+		else if (w != Resolution.width)
+		{
+			lcd_st7735_set_frame_buffer_resolution(ctx, w, h);
+		}
+	}
+
+	void
+	St7735Panel::write_raw_rgb565(Context *ctx, Rect rect, const uint8_t *data)
+	{
+		const uint32_t Pixels =
+		  (rect.right - rect.left) * (rect.bottom - rect.top);
+		raw_window_set(rect);
+		write_command(MemoryWrite, data, Pixels * 2);
+	}
+
+	void St7735Panel::read_raw_rgb565(Context *ctx, Rect rect, uint8_t *data)
+	{
+		raw_window_set(rect);
+		read_command(MemoryRead);
+		// The controller sends a dummy byte and then three bytes a pixel,
+		// each holding a channel in its top bits, which are read a few
+		// pixels at a time.
+		uint8_t channels[16 * 3];
+		spi()->blocking_read(channels, 1);
+		uint32_t pixels = (rect.right - rect.left) * (rect.bottom - rect.top);
+		while (pixels > 0)
+		{
+			const uint32_t Count = std::min<uint32_t>(pixels, 16);
+			spi()->blocking_read(channels, Count * 3);
+			for (uint32_t i = 0; i < Count; i++, data += 2)
+			{
+				const uint8_t *Pixel  = &channels[i * 3];
+				const uint16_t Rgb565 = ((Pixel[0] >> 3) << 11) |
+				                        ((Pixel[1] >> 2) << 5) |
+				                        (Pixel[2] >> 3);
+				data[0] = static_cast<uint8_t>(Rgb565 >> 8);
+				data[1] = static_cast<uint8_t>(Rgb565);
+			}
+			pixels -= Count;
+		}
+		read_finish();
+	}
+
+	void St7735Panel::start(Context *ctx, LCD_Orientation rot)
+	{
+		lcd_st7735_startup(ctx);
+		lcd_st7735_set_orientation(ctx, rot);
+	}
+
+	void St7735Panel::clean(Context *ctx)
+	{
+		lcd_st7735_clean(ctx);
+	}
+
+	void St7735Panel::fill_rect(Context *ctx, Rect rect, uint32_t color)
+	{
+		lcd_st7735_fill_rectangle(ctx, driver_rect(rect), color);
+	}
+
+	void St7735Panel::draw_pixel(Context *ctx, Point point, uint32_t color)
+	{
+		lcd_st7735_draw_pixel(ctx, {point.x, point.y}, color);
+	}
+
+	void St7735Panel::draw_horizontal_line(Context *ctx,
+	                                       Point    start,
+	                                       uint32_t length,
+	                                       uint32_t color)
+	{
+		lcd_st7735_draw_horizontal_line(
+		  ctx, {{start.x, start.y}, length}, color);
+	}
+
+	void St7735Panel::draw_vertical_line(Context *ctx,
+	                                     Point    start,
+	                                     uint32_t length,
+	                                     uint32_t color)
+	{
+		lcd_st7735_draw_vertical_line(ctx, {{start.x, start.y}, length}, color);
+	}
+
+	void St7735Panel::draw_rgb565(Context *ctx, Rect rect, const uint8_t *data)
+	{
+		lcd_st7735_draw_rgb565(ctx, driver_rect(rect), data);
+	}
+
+	void St7735Panel::draw_bgr(Context *ctx, Rect rect, const uint8_t *data)
+	{
+		lcd_st7735_draw_bgr(ctx, driver_rect(rect), data);
+	}
+
+	void St7735Panel::draw_str(Context    *ctx,
+	                           Point       point,
+	                           const char *str,
+	                           const Font *font,
+	                           uint32_t    background,
+	                           uint32_t    foreground)
+	{
+		lcd_st7735_set_font(ctx, font);
+		lcd_st7735_set_font_colors(ctx, background, foreground);
+		lcd_st7735_puts(ctx, {point.x, point.y}, str);
+	}
+
+	void Shadow::follow(const uint8_t *data, size_t length)
+	{
+		if (pixels == nullptr)
+		{
+			return;
+		}
+		for (size_t i = 0; i < length; i++)
+		{
+			const uint8_t Byte = data[i];
+			if (!parameters)
+			{
+				command        = Byte;
+				parameterIndex = 0;
+				cursor         = {window.left, window.top};
+				continue;
+			}
+			const uint32_t Index = parameterIndex++;
+			if (command == Panel::ColumnAddressSet ||
+			    command == Panel::RowAddressSet)
+			{
+				// The window's first and last column or row, inclusive, as
+				// 16-bit addresses sent high byte first.
+				uint32_t *first = &window.left, *last = &window.right;
+				if (command == Panel::RowAddressSet)
+				{
+					first = &window.top;
+					last  = &window.bottom;
+				}
+				uint32_t &address = *(Index < 2 ? first : last);
+				address = Index % 2 == 0 ? Byte << 8 : address | Byte;
+			}
+			else if (command == Panel::MemoryWrite)
+			{
+				if (cursor.x < size.width && cursor.y < size.height)
+				{
+					pixels[(cursor.y * size.width + cursor.x) * 2 + Index % 2] =
+					  Byte;
+				}
+				// Pixels fill the window a row at a time, wrapping back to
+				// its top once it's full.
+				if (Index % 2 == 1)
+				{
+					if (cursor.x < window.right)
+					{
+						cursor.x++;
+					}
+					else
+					{
+						cursor.x = window.left;
+						cursor.y =
+						  cursor.y < window.bottom ? cursor.y + 1 : window.top;
+					}
+				}
+			}
+		}
+	}
+
+	/// The pixels of the pattern that each SPI clock divider is checked with.
+	static constexpr uint32_t CalibrationPixels = 32;
+	/// The times that a divider is checked, each with a different pattern.
+	static constexpr uint32_t CalibrationRounds = 4;
+
+	/**
+	 * Returns pixel `i` of the calibration pattern of round `round`, whose
+	 * bits alternate from pixel to pixel with a walking bit flipped in each
+	 * channel. Red and blue are the same, so the pattern reads back the same
+	 * whichever order the controller sends them in.
+	 */
+	static constexpr uint16_t calibration_pixel(uint32_t i, uint32_t round)
+	{
+		const uint32_t Step    = i + round;
+		const bool     Odd     = (Step % 2) != 0;
+		const uint16_t RedBlue = (Odd ? 0b10101 : 0b01010) ^ (1 << (Step % 5));
+		const uint16_t Green   = (Odd ? 0b010101 : 0b101010) ^ (1 << (i % 6));
+		return (RedBlue << 11) | (Green << 5) | RedBlue;
+	}
+
+	/**
+	 * Writes the calibration pattern to the panel with the SPI clock at
+	 * `divider`, and reads it back at the slowest divider, which the init
+	 * sequence has already read the panel at. The controller reads back more
+	 * slowly than it's written to, so this checks the clock that drawing
+	 * needs without being held back by reads. Returns true if every round
+	 * reads back intact.
+	 */
+	static bool spi_divider_check(Panel::Context *ctx, uint16_t divider)
+	{
+		const Rect Window = {0, 0, CalibrationPixels, 1};
+		uint8_t    pattern[CalibrationPixels * 2];
+		uint8_t    readBack[CalibrationPixels * 2];
+		for (uint32_t round = 0; round < CalibrationRounds; round++)
+		{
+			for (uint32_t i = 0; i < CalibrationPixels; i++)
+			{
+				const uint16_t Pixel = calibration_pixel(i, round);
+				pattern[i * 2]       = static_cast<uint8_t>(Pixel >> 8);
+				pattern[i * 2 + 1]   = static_cast<uint8_t>(Pixel);
+			}
+			spi()->init(false, false, true, divider);
+			Panel::write_raw_rgb565(ctx, Window, pattern);
+			spi()->init(false, false, true, Panel::SlowestDivider);
+			Panel::read_raw_rgb565(ctx, Window, readBack);
+			if (memcmp(pattern, readBack, sizeof(pattern)) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Finds the fastest SPI clock divider at which the panel reads back what
+	 * was written to it. The slowest is checked first, and if the panel
+	 * can't be read back even at that, as in the simulator, the others
+	 * aren't tried and the fastest divider is used unchecked.
+	 */
+	static SpiCalibration spi_calibrate(Panel::Context *ctx)
+	{
+		SpiCalibration calibration;
+		calibration.valid = true;
+		if (!spi_divider_check(ctx, Panel::SlowestDivider))
+		{
+			return calibration;
+		}
+		calibration.verified = true;
+		calibration.divider  = Panel::SlowestDivider;
+		for (uint16_t divider = 0; divider < Panel::SlowestDivider; divider++)
+		{
+			if (spi_divider_check(ctx, divider))
+			{
+				calibration.divider = divider;
+				break;
+			}
+		}
+		return calibration;
+	}
+
 	void __cheri_libcall lcd_init(LCD_Interface  *lcdIntf,
-	                              St7735Context  *ctx,
-	                              LCD_Orientation rot)
+	                              Panel::Context *ctx,
+	                              LCD_Orientation rot,
+	                              SpiCalibration *calibration)
 	{
 		// Set the initial state of the LCD control pins.
 		set_chip_select(LcdDcPin, false);
@@ -56,20 +478,21 @@ namespace sonata::lcd::internal
 		set_chip_select(LcdCsPin, false);
 
 		// Initialise SPI driver.
-		spi()->init(false, false, true, 2);
+		spi()->init(false, false, true, Panel::SlowestDivider);
 
 		// Reset LCD.
 		set_chip_select(LcdRstPin, false);
 		thread_millisecond_wait(150);
 		set_chip_select(LcdRstPin, true);
 
-		// Initialise LCD driverr.
-		lcdIntf->handle = nullptr;
+		// Initialise LCD driverr. The interface's handle is the shadow of the
+		// panel's memory, which follows everything that the driver sends.
 		lcdIntf->spi_write =
 		  [](void *handle, uint8_t *data, size_t len) -> uint32_t {
 			set_chip_select(SpiOutEn, true);
 			spi()->blocking_write(data, len);
 			spi()->wait_idle();
+			static_cast<Shadow *>(handle)->follow(data, len);
 			return len;
 		};
 		lcdIntf->spi_read =
@@ -83,38 +506,49 @@ namespace sonata::lcd::internal
 		  [](void *handle, bool csHigh, bool dcHigh) -> uint32_t {
 			set_chip_select(LcdCsPin, csHigh);
 			set_chip_select(LcdDcPin, dcHigh);
+			static_cast<Shadow *>(handle)->parameters = dcHigh;
 			return 0;
 		};
 		lcdIntf->timer_delay = [](void *handle, uint32_t ms) {
 			thread_millisecond_wait(ms);
 		};
-		lcd_st7735_init(ctx, lcdIntf);
+		Panel::init(ctx, lcdIntf);
 
-		// Detect the resolution configuration and workaround if misconfigured.
-		size_t w = 0, h = 0;
-		Result res = lcd_st7735_check_frame_buffer_resolution(ctx, &w, &h);
-		if (res.code != 0)
-		{
-			Debug::log("Warning: Unable to determine LCD offset. Try slower "
-			           "SPI clock.\r\n");
-		}
-		else if (w != 160)
+		// Re-configure the SPI driver at the fastest speed that the panel
+		// keeps up with, calibrating it unless that's been done already.
+		const bool Calibrate = !calibration->valid;
+		if (Calibrate)
 		{
-			lcd_st7735_set_frame_buffer_resolution(ctx, w, h);
+			*calibration = spi_calibrate(ctx);
 		}
+		spi()->init(false, false, true, calibration->divider);
 
-		// Re-configure the SPI driver at maximum speed.
-		spi()->init(false, false, true, 0);
-		lcd_st7735_startup(ctx);
+		// Start the panel in the given orentiation, and clear it.
+		Panel::start(ctx, rot);
+		const uint64_t Start = rdcycle64();
+		Panel::clean(ctx);
 
-		// Set the LCD orentiation.
-		lcd_st7735_set_orientation(ctx, rot);
-
-		lcd_st7735_clean(ctx);
+		if (Calibrate)
+		{
+			// The clear filled the screen, which gives the fill rate actually
+			// reached.
+			const Size     Screen = Panel::resolution(ctx);
+			const uint64_t Cycles = std::max<uint64_t>(rdcycle64() - Start, 1);
+			calibration->pixelsPerSecond = static_cast<uint32_t>(
+			  std::min<uint64_t>(uint64_t{Screen.width} * Screen.height *
+			                       CPU_TIMER_HZ / Cycles,
+			                     UINT32_MAX));
+			Debug::log("SPI clock at {} Hz (divider {}, {}), {} pixels/s",
+			           static_cast<int>(calibration->clock_hz()),
+			           static_cast<int>(calibration->divider),
+			           calibration->verified ? "checked" : "unchecked",
+			           static_cast<int>(calibration->pixelsPerSecond));
+		}
 	}
-	void __cheri_libcall lcd_destroy(LCD_Interface *lcdIntf, St7735Context *ctx)
+	void __cheri_libcall lcd_destroy(LCD_Interface  *lcdIntf,
+	                                 Panel::Context *ctx)
 	{
-		lcd_st7735_clean(ctx);
+		Panel::clean(ctx);
 		// Hold LCD in reset.
 		set_chip_select(LcdRstPin, false);
 		// Turn off backlight.
@@ -125,27 +559,27 @@ namespace sonata::lcd::internal
 void __cheri_libcall SonataLcd::clean()
 {
 	// Clean the display with a white rectangle.
-	lcd_st7735_clean(&ctx);
+	Panel::clean(&ctx);
 }
 
 void __cheri_libcall SonataLcd::clean(Color color)
 {
 	// Clean the display with a rectangle of the given colour
-	size_t w, h;
-	lcd_st7735_get_resolution(&ctx, &h, &w);
-	lcd_st7735_fill_rectangle(
-	  &ctx,
-	  {.origin = {.x = 0, .y = 0}, .width = w, .height = h},
-	  static_cast<uint32_t>(color));
+	Panel::fill_rect(&ctx,
+	                 Rect::from_point_and_size(Point::ORIGIN, resolution()),
+	                 static_cast<uint32_t>(color));
+}
+
+void __cheri_libcall SonataLcd::clean(Color565 color)
+{
+	fill_rgb565(
+	  &ctx, Rect::from_point_and_size(Point::ORIGIN, resolution()), color);
 }
 
 void __cheri_libcall SonataLcd::draw_image_rgb565(Rect           rect,
                                                   const uint8_t *data)
 {
-	internal::lcd_st7735_draw_rgb565(
-	  &ctx,
-	  {{rect.left, rect.top}, rect.right - rect.left, rect.bottom - rect.top},
-	  data);
+	Panel::draw_rgb565(&ctx, rect, data);
 }
 
 void __cheri_libcall SonataLcd::draw_str(Point       point,
@@ -177,17 +611,22 @@ void __cheri_libcall SonataLcd::draw_str(Point       point,
 		default:
 			internalFont = &internal::m3x6_16ptFont;
 	}
-	lcd_st7735_set_font(&ctx, internalFont);
-	lcd_st7735_set_font_colors(&ctx,
-	                           static_cast<uint32_t>(background),
-	                           static_cast<uint32_t>(foreground));
-	lcd_st7735_puts(&ctx, {point.x, point.y}, str);
+	Panel::draw_str(&ctx,
+	                point,
+	                str,
+	                internalFont,
+	                static_cast<uint32_t>(background),
+	                static_cast<uint32_t>(foreground));
 }
 
 void __cheri_libcall SonataLcd::draw_pixel(Point point, Color color)
 {
-	lcd_st7735_draw_pixel(
-	  &ctx, {point.x, point.y}, static_cast<uint32_t>(color));
+	Panel::draw_pixel(&ctx, point, static_cast<uint32_t>(color));
+}
+
+void __cheri_libcall SonataLcd::draw_pixel(Point point, Color565 color)
+{
+	fill_rgb565(&ctx, {point.x, point.y, point.x + 1, point.y + 1}, color);
 }
 
 void __cheri_libcall SonataLcd::draw_line(Point a, Point b, Color color)
@@ -196,15 +635,38 @@ void __cheri_libcall SonataLcd::draw_line(Point a, Point b, Color color)
 	{
 		uint32_t x1 = std::min(a.x, b.x);
 		uint32_t x2 = std::max(a.x, b.x);
-		lcd_st7735_draw_horizontal_line(
-		  &ctx, {{x1, a.y}, x2 - x1}, static_cast<uint32_t>(color));
+		Panel::draw_horizontal_line(
+		  &ctx, {x1, a.y}, x2 - x1, static_cast<uint32_t>(color));
 	}
 	else if (a.x == b.x)
 	{
 		uint32_t y1 = std::min(a.y, b.y);
 		uint32_t y2 = std::max(a.y, b.y);
-		lcd_st7735_draw_vertical_line(
-		  &ctx, {{a.x, y1}, y2 - y1}, static_cast<uint32_t>(color));
+		Panel::draw_vertical_line(
+		  &ctx, {a.x, y1}, y2 - y1, static_cast<uint32_t>(color));
+	}
+	else
+	{
+		// We currently only support horizontal and vertical lines.
+		panic();
+	}
+}
+
+void __cheri_libcall SonataLcd::draw_line(Point a, Point b, Color565 color)
+{
+	// The line covers the same pixels as the driver's, which are `length`
+	// from the start.
+	if (a.y == b.y)
+	{
+		const uint32_t X1 = std::min(a.x, b.x);
+		const uint32_t X2 = std::max(a.x, b.x);
+		fill_rgb565(&ctx, {X1, a.y, X2, a.y + 1}, color);
+	}
+	else if (a.x == b.x)
+	{
+		const uint32_t Y1 = std::min(a.y, b.y);
+		const uint32_t Y2 = std::max(a.y, b.y);
+		fill_rgb565(&ctx, {a.x, Y1, a.x + 1, Y2}, color);
 	}
 	else
 	{
@@ -215,16 +677,243 @@ void __cheri_libcall SonataLcd::draw_line(Point a, Point b, Color color)
 
 void __cheri_libcall SonataLcd::draw_image_bgr(Rect rect, const uint8_t *data)
 {
-	lcd_st7735_draw_bgr(
-	  &ctx,
-	  {{rect.left, rect.top}, rect.right - rect.left, rect.bottom - rect.top},
-	  data);
+	const uint32_t Width = rect.right - rect.left;
+	const auto     Convert =
+	  [&](uint8_t *buffer, uint32_t firstRow, uint32_t rows) {
+		  bgr888_to_rgb565(&data[firstRow * Width * 3], buffer, Width * rows);
+	  };
+	if (!draw_in_bands(&ctx, rect, Convert))
+	{
+		Panel::draw_bgr(&ctx, rect, data);
+	}
+}
+
+void __cheri_libcall SonataLcd::draw_sprite(Point         point,
+                                            const Sprite &sprite,
+                                            Color         background)
+{
+	draw_sprite(point, sprite, Color565(background));
+}
+
+void __cheri_libcall SonataLcd::draw_sprite(Point         point,
+                                            const Sprite &sprite,
+                                            Color565      background)
+{
+	const uint8_t High = static_cast<uint8_t>(background.rgb565() >> 8);
+	const uint8_t Low  = static_cast<uint8_t>(background.rgb565());
+	draw_sprite_over(
+	  &ctx, point, sprite, [&](uint32_t, uint32_t, uint8_t *pixel) {
+		  pixel[0] = High;
+		  pixel[1] = Low;
+	  });
+}
+
+void __cheri_libcall SonataLcd::draw_sprite(Point          point,
+                                            const Sprite  &sprite,
+                                            const uint8_t *background,
+                                            uint32_t       stride)
+{
+	draw_sprite_over(
+	  &ctx, point, sprite, [&](uint32_t row, uint32_t column, uint8_t *pixel) {
+		  const uint8_t *Under = &background[(row * stride + column) * 2];
+		  pixel[0]             = Under[0];
+		  pixel[1]             = Under[1];
+	  });
 }
 
 void __cheri_libcall SonataLcd::fill_rect(Rect rect, Color color)
 {
-	lcd_st7735_fill_rectangle(
-	  &ctx,
-	  {{rect.left, rect.top}, rect.right - rect.left, rect.bottom - rect.top},
-	  static_cast<uint32_t>(color));
+	Panel::fill_rect(&ctx, rect, static_cast<uint32_t>(color));
+}
+
+void __cheri_libcall SonataLcd::fill_rect(Rect rect, Color565 color)
+{
+	fill_rgb565(&ctx, rect, color);
+}
+
+void __cheri_libcall SonataLcd::scroll_area(uint32_t top, uint32_t height)
+{
+	const Size     Resolution = resolution();
+	const uint32_t Lines      = std::max(Resolution.width, Resolution.height);
+	const uint32_t Top        = std::min(top, Lines);
+	const uint32_t Height     = std::min(height, Lines - Top);
+	const uint32_t Bottom     = Lines - Top - Height;
+
+	const uint8_t Parameters[] = {static_cast<uint8_t>(Top >> 8),
+	                              static_cast<uint8_t>(Top),
+	                              static_cast<uint8_t>(Height >> 8),
+	                              static_cast<uint8_t>(Height),
+	                              static_cast<uint8_t>(Bottom >> 8),
+	                              static_cast<uint8_t>(Bottom)};
+	write_command(
+	  Panel::VerticalScrollDefinition, Parameters, sizeof(Parameters));
+	shadow.scrollTop    = Top;
+	shadow.scrollHeight = Height;
+}
+
+void __cheri_libcall SonataLcd::scroll_to(uint32_t line)
+{
+	const uint8_t Parameters[] = {static_cast<uint8_t>(line >> 8),
+	                              static_cast<uint8_t>(line)};
+	write_command(
+	  Panel::VerticalScrollStartAddress, Parameters, sizeof(Parameters));
+	shadow.scrollStart = line;
+}
+
+void __cheri_libcall SonataLcd::attach_shadow(uint8_t *framebuffer)
+{
+	shadow.pixels = framebuffer;
+	shadow.size   = resolution();
+}
+
+/**
+ * Helper. Copies the pixels of `rect`, in the panel's memory, from `shadow`
+ * if it holds a copy, or else by reading the panel back.
+ */
+static void memory_read(Panel::Context         *ctx,
+                        const internal::Shadow &shadow,
+                        uint16_t                divider,
+                        Rect                    rect,
+                        uint8_t                *data)
+{
+	if (shadow.pixels != nullptr)
+	{
+		const uint32_t RowBytes = (rect.right - rect.left) * 2;
+		for (uint32_t row = rect.top; row < rect.bottom; row++)
+		{
+			memcpy(data,
+			       &shadow.pixels[(row * shadow.size.width + rect.left) * 2],
+			       RowBytes);
+			data += RowBytes;
+		}
+		return;
+	}
+	// The panel is read back at the clock that it was brought up at, as it
+	// reads more slowly than it's written to.
+	spi()->init(false, false, true, Panel::SlowestDivider);
+	Panel::read_raw_rgb565(ctx, rect, data);
+	spi()->init(false, false, true, divider);
+}
+
+void __cheri_libcall SonataLcd::read_pixels(Rect rect, uint8_t *data)
+{
+	const Size Screen =
+	  shadow.pixels != nullptr ? shadow.size : resolution();
+	if (rect.left >= rect.right || rect.top >= rect.bottom ||
+	    rect.right > Screen.width || rect.bottom > Screen.height)
+	{
+		return;
+	}
+
+	// Lines run along the panel's long side, so they are rows in portrait
+	// and columns in landscape. Each run of lines shown from consecutive
+	// lines of memory is read at once.
+	const bool     Portrait = Screen.height > Screen.width;
+	const uint32_t Width    = rect.right - rect.left;
+	const uint32_t First    = Portrait ? rect.top : rect.left;
+	const uint32_t Last     = Portrait ? rect.bottom : rect.right;
+	for (uint32_t line = First; line < Last;)
+	{
+		const uint32_t Memory = shadow.line_shown(line);
+		uint32_t       end    = line + 1;
+		while (end < Last && shadow.line_shown(end) == Memory + (end - line))
+		{
+			end++;
+		}
+		const uint32_t MemoryEnd = Memory + (end - line);
+		if (Portrait)
+		{
+			memory_read(&ctx,
+			            shadow,
+			            calibration.divider,
+			            {rect.left, Memory, rect.right, MemoryEnd},
+			            &data[(line - rect.top) * Width * 2]);
+		}
+		else
+		{
+			for (uint32_t row = rect.top; row < rect.bottom; row++)
+			{
+				memory_read(
+				  &ctx,
+				  shadow,
+				  calibration.divider,
+				  {Memory, row, MemoryEnd, row + 1},
+				  &data[((row - rect.top) * Width + line - rect.left) * 2]);
+			}
+		}
+		line = end;
+	}
+}
+
+uint32_t __cheri_libcall SonataLcd::frame_crc()
+{
+	static constexpr uint32_t RowPixels =
+	  std::max(Panel::Resolution.width, Panel::Resolution.height);
+	const Size Screen = resolution();
+	uint8_t    row[RowPixels * 2];
+	uint32_t   crc = 0;
+	for (uint32_t y = 0; y < Screen.height; y++)
+	{
+		read_pixels({0, y, Screen.width, y + 1}, row);
+		crc = crc32(row, Screen.width * 2, crc);
+	}
+	return crc;
+}
+
+/**
+ * Helper. Writes `length` bytes as pairs of hexadecimal digits to `hex`,
+ * followed by a null.
+ */
+static void hex_write(char *hex, const uint8_t *bytes, size_t length)
+{
+	static constexpr char Digits[] = "0123456789abcdef";
+	for (size_t i = 0; i < length; i++)
+	{
+		*hex++ = Digits[bytes[i] >> 4];
+		*hex++ = Digits[bytes[i] & 0xF];
+	}
+	*hex = '\0';
+}
+
+void __cheri_libcall SonataLcd::report_frame(const char *name, bool dumpPixels)
+{
+	const Size     Screen     = resolution();
+	const uint32_t Crc        = frame_crc();
+	const uint8_t  CrcBytes[] = {static_cast<uint8_t>(Crc >> 24),
+	                             static_cast<uint8_t>(Crc >> 16),
+	                             static_cast<uint8_t>(Crc >> 8),
+	                             static_cast<uint8_t>(Crc)};
+	char           crcHex[sizeof(CrcBytes) * 2 + 1];
+	hex_write(crcHex, CrcBytes, sizeof(CrcBytes));
+	// Unsigned integers are logged in hexadecimal, so the sizes and
+	// positions are cast for the scripts that read them as decimal.
+	internal::Debug::log("lcd_frame name={} width={} height={} crc={}",
+	                     name,
+	                     static_cast<int>(Screen.width),
+	                     static_cast<int>(Screen.height),
+	                     static_cast<const char *>(crcHex));
+	if (!dumpPixels)
+	{
+		return;
+	}
+
+	// Each line holds a few pixels, to keep the lines and buffers short.
+	static constexpr uint32_t LinePixels = 32;
+	uint8_t                   pixels[LinePixels * 2];
+	char                      hex[sizeof(pixels) * 2 + 1];
+	for (uint32_t y = 0; y < Screen.height; y++)
+	{
+		for (uint32_t x = 0; x < Screen.width; x += LinePixels)
+		{
+			const uint32_t Count = std::min(LinePixels, Screen.width - x);
+			read_pixels({x, y, x + Count, y + 1}, pixels);
+			hex_write(hex, pixels, Count * 2);
+			internal::Debug::log(
+			  "lcd_frame_data name={} row={} column={} pixels={}",
+			  name,
+			  static_cast<int>(y),
+			  static_cast<int>(x),
+			  static_cast<const char *>(hex));
+		}
+	}
 }
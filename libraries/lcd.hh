@@ -1,10 +1,14 @@
 // Copyright lowRISC Contributors.
 // SPDX-License-Identifier: Apache-2.0
 
+#pragma once
+
 #include <algorithm>
 #include <cheri.hh>
+#include <concepts>
 #include <platform-pwm.hh>
 #include <platform-spi.hh>
+#include <string.h>
 #include <thread.h>
 #include <utility>
 
@@ -21,10 +25,6 @@ namespace sonata::lcd
 #include "core/m5x7_16pt.h"
 #include "st7735/lcd_st7735.h"
 		}
-		void __cheri_libcall lcd_init(LCD_Interface *,
-		                              St7735Context *,
-		                              LCD_Orientation);
-		void __cheri_libcall lcd_destroy(LCD_Interface *, St7735Context *);
 	} // namespace internal
 
 	struct Size
@@ -88,6 +88,165 @@ namespace sonata::lcd
 		Grey  = 0xAAAAAA,
 	};
 
+	/**
+	 * A colour in the panel's 16-bit format, with 5 bits of red, 6 of green
+	 * and 5 of blue. Converting a constant `Color` or RGB888 value happens at
+	 * compile time, so drawing with a constant `Color565` costs nothing to
+	 * convert.
+	 */
+	class Color565
+	{
+		uint16_t value;
+
+		public:
+		explicit constexpr Color565(uint16_t rgb565) : value(rgb565) {}
+
+		explicit constexpr Color565(Color color)
+		  : Color565(from_rgb888(static_cast<uint32_t>(color)))
+		{
+		}
+
+		/// Converts a 24-bit colour, of 8 bits each of red, green and blue.
+		static constexpr Color565 from_rgb888(uint32_t rgb)
+		{
+			return Color565(static_cast<uint16_t>(((rgb >> 8) & 0xF800) |
+			                                      ((rgb >> 5) & 0x07E0) |
+			                                      ((rgb >> 3) & 0x001F)));
+		}
+
+		constexpr uint16_t rgb565() const
+		{
+			return value;
+		}
+
+		/**
+		 * Expands the colour back to RGB888, repeating the top bits of each
+		 * component in its low bits, so that converting it back to RGB565
+		 * gives the same colour.
+		 */
+		constexpr uint32_t rgb888() const
+		{
+			const uint32_t Red   = (value >> 11) & 0x1F;
+			const uint32_t Green = (value >> 5) & 0x3F;
+			const uint32_t Blue  = value & 0x1F;
+			return (((Red << 3) | (Red >> 2)) << 16) |
+			       (((Green << 2) | (Green >> 4)) << 8) |
+			       ((Blue << 3) | (Blue >> 2));
+		}
+
+		constexpr bool operator==(const Color565 &) const = default;
+	};
+
+	/**
+	 * Converts `pixels` pixels of BGR888, as `SonataLcd::draw_image_bgr`
+	 * takes, to RGB565 sent high byte first, as `draw_image_rgb565` takes.
+	 *
+	 * Once `bgr` is word aligned, four pixels are converted at a time from
+	 * three words, with the components of each pixel masked out of the words
+	 * and two pixels packed into each word written, rather than a byte at a
+	 * time. Pixels before that, or all of them if `rgb565` wouldn't then be
+	 * word aligned, are converted one at a time.
+	 */
+	inline void
+	bgr888_to_rgb565(const uint8_t *bgr, uint8_t *rgb565, size_t pixels)
+	{
+		const auto Scalar = [&](size_t count) {
+			for (size_t i = 0; i < count; i++, bgr += 3, rgb565 += 2)
+			{
+				const uint16_t Pixel = ((bgr[2] & 0xF8) << 8) |
+				                       ((bgr[1] & 0xFC) << 3) | (bgr[0] >> 3);
+				rgb565[0] = static_cast<uint8_t>(Pixel >> 8);
+				rgb565[1] = static_cast<uint8_t>(Pixel);
+			}
+		};
+		// Swaps the bytes of the two pixels in `pair`, to send high first.
+		const auto HighFirst = [](uint32_t pair) {
+			return ((pair >> 8) & 0x00FF00FF) | ((pair << 8) & 0xFF00FF00);
+		};
+
+		// A pixel starts 3 bytes on from the last, so the pixels that are
+		// converted one at a time to align `bgr` are its misalignment.
+		const size_t Misaligned = reinterpret_cast<uintptr_t>(bgr) & 3;
+		if (pixels < 4 + Misaligned ||
+		    ((reinterpret_cast<uintptr_t>(rgb565) + 2 * Misaligned) & 3) != 0)
+		{
+			Scalar(pixels);
+			return;
+		}
+		Scalar(Misaligned);
+		pixels -= Misaligned;
+
+		for (; pixels >= 4; pixels -= 4, bgr += 12, rgb565 += 8)
+		{
+			// Little-endian words of b0 g0 r0 b1 | g1 r1 b2 g2 | r2 b3 g3 r3.
+			uint32_t in[3];
+			memcpy(in, __builtin_assume_aligned(bgr, 4), sizeof(in));
+			const uint32_t Pixel0 = ((in[0] >> 8) & 0xF800) |
+			                        ((in[0] >> 5) & 0x07E0) |
+			                        ((in[0] >> 3) & 0x1F);
+			const uint32_t Pixel1 = (in[1] & 0xF800) | ((in[1] << 3) & 0x07E0) |
+			                        (in[0] >> 27);
+			const uint32_t Pixel2 = ((in[2] << 8) & 0xF800) |
+			                        ((in[1] >> 21) & 0x07E0) |
+			                        ((in[1] >> 19) & 0x1F);
+			const uint32_t Pixel3 = ((in[2] >> 16) & 0xF800) |
+			                        ((in[2] >> 13) & 0x07E0) |
+			                        ((in[2] >> 11) & 0x1F);
+			const uint32_t Out[2] = {HighFirst(Pixel0 | (Pixel1 << 16)),
+			                         HighFirst(Pixel2 | (Pixel3 << 16))};
+			memcpy(__builtin_assume_aligned(rgb565, 4), Out, sizeof(Out));
+		}
+		Scalar(pixels);
+	}
+
+	/**
+	 * An RGB565 image, sent high byte first as `draw_image_rgb565` takes,
+	 * that has transparent pixels. Without a `mask`, the pixels of the `key`
+	 * colour are transparent. With one, it has a bit for each pixel, most
+	 * significant first and each row padded to whole bytes, that is set for
+	 * the pixels that are opaque.
+	 */
+	struct Sprite
+	{
+		Size           size;
+		const uint8_t *pixels;
+		Color565       key;
+		const uint8_t *mask = nullptr;
+
+		/// Returns true if the pixel at `column` of `row` is drawn.
+		bool opaque(uint32_t row, uint32_t column) const
+		{
+			if (mask != nullptr)
+			{
+				const uint32_t RowBytes = (size.width + 7) / 8;
+				return ((mask[row * RowBytes + column / 8] << (column % 8)) &
+				        0x80) != 0;
+			}
+			const uint8_t *Pixel = &pixels[(row * size.width + column) * 2];
+			return ((Pixel[0] << 8) | Pixel[1]) != key.rgb565();
+		}
+	};
+
+	/**
+	 * Returns the CRC-32 of `length` bytes of `data`, as Ethernet and zlib
+	 * compute it, carrying on from `crc`, the CRC of any bytes before them.
+	 */
+	constexpr uint32_t
+	crc32(const uint8_t *data, size_t length, uint32_t crc = 0)
+	{
+		constexpr uint32_t Polynomial = 0xEDB88320;
+		crc                           = ~crc;
+		for (size_t i = 0; i < length; i++)
+		{
+			crc ^= data[i];
+			for (uint8_t bit = 0; bit < 8; bit++)
+			{
+				crc = (crc >> 1) ^ ((crc & 1) != 0 ? Polynomial : 0);
+			}
+		}
+		return ~crc;
+	}
+
 	enum class Font
 	{
 		M3x6_16pt,          // NOLINT  Removing _ from these names can make them
@@ -96,34 +255,364 @@ namespace sonata::lcd
 		M5x7_16pt,
 	};
 
+	/// The layout of a pixel in a panel's memory.
+	enum class PixelFormat
+	{
+		/// 5 bits of red, 6 of green and 5 of blue, sent high byte first.
+		Rgb565,
+	};
+
+	/**
+	 * The SPI clock that the LCD is driven at, which is found when it's
+	 * brought up by trying each clock divider from the fastest and keeping the
+	 * first at which a test pattern written to the panel reads back intact.
+	 *
+	 * The LCD library can't keep state between `SonataLcd`s, so a compartment
+	 * that brings the LCD up more than once can keep this and pass it to each
+	 * `SonataLcd` after the first, which then skips the calibration.
+	 */
+	struct SpiCalibration
+	{
+		/// The SPI controller's half clock period, in system clock cycles,
+		/// less one.
+		uint16_t divider = 0;
+		/// Whether a calibration has been done, rather than none yet.
+		bool valid = false;
+		/**
+		 * Whether `divider` was checked by reading a test pattern back. If
+		 * the panel can't be read back at all, the fastest clock is used
+		 * unchecked.
+		 */
+		bool verified = false;
+		/// The pixels a second that filling the screen was measured at.
+		uint32_t pixelsPerSecond = 0;
+
+		/// Returns the frequency of the SPI clock, in hertz.
+		uint32_t clock_hz() const
+		{
+			return CPU_TIMER_HZ / (2 * (divider + 1));
+		}
+	};
+
+	namespace internal
+	{
+		/**
+		 * The panel trait for the ST7735 controller on Sonata's LCD.
+		 *
+		 * `SonataLcd` draws through a trait like this one, which gives a
+		 * controller's driver context, native resolution, pixel format and
+		 * commands, and wraps its init sequence and drawing. The trait is
+		 * picked at compile time with `SONATA_LCD_PANEL`, so another
+		 * controller can be supported by adding a trait for it, without any
+		 * dispatch at run time.
+		 */
+		struct St7735Panel
+		{
+			using Context = St7735Context;
+
+			/// The resolution in the panel's native, landscape, orientation.
+			static constexpr Size        Resolution = {160, 128};
+			static constexpr PixelFormat Format     = PixelFormat::Rgb565;
+
+			/// The commands that set the window that pixels are written to.
+			static constexpr uint8_t ColumnAddressSet = 0x2A;
+			static constexpr uint8_t RowAddressSet    = 0x2B;
+			static constexpr uint8_t MemoryWrite      = 0x2C;
+			static constexpr uint8_t MemoryRead       = 0x2E;
+			/// The slowest SPI clock divider tried when calibrating, which
+			/// the init sequence is run at.
+			static constexpr uint16_t SlowestDivider = 2;
+			/// The commands that set up and move vertical scrolling.
+			static constexpr uint8_t VerticalScrollDefinition   = 0x33;
+			static constexpr uint8_t VerticalScrollStartAddress = 0x37;
+
+			/**
+			 * Runs the controller's init sequence, which is done with the
+			 * SPI clock slowed down so that the panel can be read back.
+			 */
+			static void init(Context *ctx, LCD_Interface *lcdIntf);
+			/**
+			 * Writes RGB565 to `rect` and reads it back, in the controller's
+			 * own addressing, for calibrating the SPI clock before the
+			 * panel is started. The controller sends pixels back as 18-bit
+			 * colour, which is converted to RGB565.
+			 */
+			static void
+			write_raw_rgb565(Context *ctx, Rect rect, const uint8_t *data);
+			static void read_raw_rgb565(Context *ctx, Rect rect, uint8_t *data);
+			/**
+			 * Starts the panel once the SPI clock is at full speed. The
+			 * panel isn't cleared, which is left to the caller.
+			 */
+			static void start(Context *ctx, LCD_Orientation rot);
+
+			static Size resolution(const Context *ctx)
+			{
+				return {static_cast<uint32_t>(ctx->parent.width),
+				        static_cast<uint32_t>(ctx->parent.height)};
+			}
+
+			static void clean(Context *ctx);
+			static void fill_rect(Context *ctx, Rect rect, uint32_t color);
+			static void draw_pixel(Context *ctx, Point point, uint32_t color);
+			static void draw_horizontal_line(Context *ctx,
+			                                 Point    start,
+			                                 uint32_t length,
+			                                 uint32_t color);
+			static void draw_vertical_line(Context *ctx,
+			                               Point    start,
+			                               uint32_t length,
+			                               uint32_t color);
+			static void
+			draw_rgb565(Context *ctx, Rect rect, const uint8_t *data);
+			static void draw_bgr(Context *ctx, Rect rect, const uint8_t *data);
+			static void draw_str(Context    *ctx,
+			                     Point       point,
+			                     const char *str,
+			                     const Font *font,
+			                     uint32_t    background,
+			                     uint32_t    foreground);
+		};
+
+		/**
+		 * A copy of what's been written to the panel's memory, kept by
+		 * following the commands and pixels sent to it, so that frames can
+		 * be captured where the panel can't be read back, such as in the
+		 * simulator. Pixels are RGB565, high byte first, a row at a time,
+		 * in the coordinates that the driver draws in.
+		 */
+		struct Shadow
+		{
+			/// The copy, or null if no copy is kept.
+			uint8_t *pixels = nullptr;
+			Size     size   = {0, 0};
+			/// Whether the bytes being sent are parameters, not commands.
+			bool     parameters     = false;
+			uint8_t  command        = 0;
+			uint32_t parameterIndex = 0;
+			/**
+			 * The window being written to, whose right and bottom are its
+			 * last column and row, and the next pixel in it.
+			 */
+			Rect  window = {0, 0, 0, 0};
+			Point cursor = {0, 0};
+			/**
+			 * The panel's scrolling area, from line `scrollTop` for
+			 * `scrollHeight` lines, and the line of memory shown at its top.
+			 * These are kept whether or not there is a copy, as the panel
+			 * is read back in memory order too.
+			 */
+			uint32_t scrollTop    = 0;
+			uint32_t scrollHeight = 0;
+			uint32_t scrollStart  = 0;
+
+			/// Follows `length` bytes sent to the panel.
+			void follow(const uint8_t *data, size_t length);
+
+			/// Returns the line of memory shown at line `line` of the panel.
+			uint32_t line_shown(uint32_t line) const
+			{
+				if (line < scrollTop || line >= scrollTop + scrollHeight)
+				{
+					return line;
+				}
+				const uint32_t Start = std::max(scrollStart, scrollTop);
+				return scrollTop +
+				       (line - scrollTop + Start - scrollTop) % scrollHeight;
+			}
+		};
+
+		/**
+		 * The members that the library uses of a panel trait, which are
+		 * those of `St7735Panel`.
+		 */
+		template<typename T>
+		concept PanelTrait = requires(typename T::Context *ctx,
+		                              LCD_Interface       *lcdIntf,
+		                              LCD_Orientation      rot,
+		                              Rect                 rect,
+		                              Point                point,
+		                              const uint8_t       *source,
+		                              uint8_t             *destination,
+		                              const char          *str,
+		                              const Font          *font,
+		                              uint32_t             value) {
+			{ T::Resolution } -> std::convertible_to<Size>;
+			{ T::Format } -> std::convertible_to<PixelFormat>;
+			{ T::ColumnAddressSet } -> std::convertible_to<uint8_t>;
+			{ T::RowAddressSet } -> std::convertible_to<uint8_t>;
+			{ T::MemoryWrite } -> std::convertible_to<uint8_t>;
+			{ T::VerticalScrollDefinition } -> std::convertible_to<uint8_t>;
+			{ T::VerticalScrollStartAddress } -> std::convertible_to<uint8_t>;
+			{ T::SlowestDivider } -> std::convertible_to<uint16_t>;
+			T::init(ctx, lcdIntf);
+			T::write_raw_rgb565(ctx, rect, source);
+			T::read_raw_rgb565(ctx, rect, destination);
+			T::start(ctx, rot);
+			{ T::resolution(ctx) } -> std::convertible_to<Size>;
+			T::clean(ctx);
+			T::fill_rect(ctx, rect, value);
+			T::draw_pixel(ctx, point, value);
+			T::draw_horizontal_line(ctx, point, value, value);
+			T::draw_vertical_line(ctx, point, value, value);
+			T::draw_rgb565(ctx, rect, source);
+			T::draw_bgr(ctx, rect, source);
+			T::draw_str(ctx, point, str, font, value, value);
+		};
+
+#ifndef SONATA_LCD_PANEL
+#	define SONATA_LCD_PANEL St7735Panel
+#endif
+		/// The panel that `SonataLcd` drives.
+		using Panel = SONATA_LCD_PANEL;
+		static_assert(PanelTrait<Panel>,
+		              "SONATA_LCD_PANEL lacks members that the library uses");
+
+		void __cheri_libcall lcd_init(LCD_Interface *,
+		                              Panel::Context *,
+		                              LCD_Orientation,
+		                              SpiCalibration *);
+		void __cheri_libcall lcd_destroy(LCD_Interface *, Panel::Context *);
+	} // namespace internal
+
+	/**
+	 * Scales positions and sizes laid out for a reference resolution to the
+	 * resolution of the screen, so that one layout fits every panel. Images
+	 * aren't scaled, so they should be placed by their centre or a corner.
+	 */
+	class Layout
+	{
+		Size reference;
+		Size screen;
+
+		public:
+		constexpr Layout(Size reference, Size screen)
+		  : reference(reference), screen(screen)
+		{
+		}
+
+		constexpr uint32_t x(uint32_t x) const
+		{
+			return x * screen.width / reference.width;
+		}
+
+		constexpr uint32_t y(uint32_t y) const
+		{
+			return y * screen.height / reference.height;
+		}
+
+		constexpr Point at(Point point) const
+		{
+			return {x(point.x), y(point.y)};
+		}
+
+		constexpr Size scale(Size size) const
+		{
+			return {x(size.width), y(size.height)};
+		}
+
+		constexpr Rect scale(Rect rect) const
+		{
+			return {x(rect.left), y(rect.top), x(rect.right), y(rect.bottom)};
+		}
+	};
+
 	class SonataLcd
 	{
 		private:
+		using Panel = internal::Panel;
+
 		internal::LCD_Interface lcdIntf;
-		internal::St7735Context ctx;
+		Panel::Context          ctx;
+		SpiCalibration          calibration;
+		internal::Shadow        shadow;
 
 		public:
-		SonataLcd(internal::LCD_Orientation rot = internal::LCD_Rotate180)
+		/**
+		 * Brings the LCD up. If `cachedCalibration` holds a calibration,
+		 * its SPI clock is used, and otherwise the clock is calibrated and
+		 * the result written to it.
+		 */
+		SonataLcd(internal::LCD_Orientation rot = internal::LCD_Rotate180,
+		          SpiCalibration           *cachedCalibration = nullptr)
 		{
-			internal::lcd_init(&lcdIntf, &ctx, rot);
+			if (cachedCalibration != nullptr)
+			{
+				calibration = *cachedCalibration;
+			}
+			lcdIntf.handle = &shadow;
+			internal::lcd_init(&lcdIntf, &ctx, rot, &calibration);
+			if (cachedCalibration != nullptr)
+			{
+				*cachedCalibration = calibration;
+			}
 		}
 
 		Size resolution()
 		{
-			return {ctx.parent.width, ctx.parent.height};
+			return Panel::resolution(&ctx);
+		}
+
+		/// Returns the SPI clock that the LCD is driven at.
+		const SpiCalibration &spi_calibration() const
+		{
+			return calibration;
 		}
 
 		~SonataLcd()
 		{
 			internal::lcd_destroy(&lcdIntf, &ctx);
 		}
+
+		// The driver's interface points at `shadow`, so a copy would draw
+		// through the original's.
+		SonataLcd(const SonataLcd &)            = delete;
+		SonataLcd &operator=(const SonataLcd &) = delete;
+		/*
+		 * The drawing functions that take a `Color565` send it to the panel
+		 * as it is, in bands of rows, rather than converting it for the
+		 * driver. Text is only drawn with `Color`, as the driver's font
+		 * renderer takes RGB888.
+		 */
 		void __cheri_libcall clean();
 		void __cheri_libcall clean(Color color);
+		void __cheri_libcall clean(Color565 color);
 		void __cheri_libcall draw_pixel(Point point, Color color);
+		void __cheri_libcall draw_pixel(Point point, Color565 color);
 		void __cheri_libcall draw_line(Point a, Point b, Color color);
+		void __cheri_libcall draw_line(Point a, Point b, Color565 color);
+		/**
+		 * Draws an image of 3 bytes a pixel, in the order blue, green and
+		 * red. It is converted to the panel's format a band of rows at a
+		 * time with `bgr888_to_rgb565`.
+		 */
 		void __cheri_libcall draw_image_bgr(Rect rect, const uint8_t *data);
 		void __cheri_libcall draw_image_rgb565(Rect rect, const uint8_t *data);
+		/**
+		 * Draws `sprite` with its top left corner at `point`, with its
+		 * transparent pixels showing `background`. The sprite is composited
+		 * a band of rows at a time as it's sent to the panel, so it needn't
+		 * be copied for each background it's drawn over. Sprites can be as
+		 * wide as the panel's long side.
+		 */
+		void __cheri_libcall draw_sprite(Point         point,
+		                                 const Sprite &sprite,
+		                                 Color         background);
+		void __cheri_libcall draw_sprite(Point         point,
+		                                 const Sprite &sprite,
+		                                 Color565      background);
+		/**
+		 * Draws `sprite` over an RGB565 image, such as a copy of what is on
+		 * the screen, with its transparent pixels showing the image.
+		 * `background` is the image's pixel under the sprite's top left
+		 * corner, and `stride` is the number of pixels in a row of the image.
+		 */
+		void __cheri_libcall draw_sprite(Point          point,
+		                                 const Sprite  &sprite,
+		                                 const uint8_t *background,
+		                                 uint32_t       stride);
 		void __cheri_libcall fill_rect(Rect rect, Color color);
+		void __cheri_libcall fill_rect(Rect rect, Color565 color);
 		void __cheri_libcall draw_str(Point       point,
 		                              const char *str,
 		                              Color       background,
@@ -133,5 +622,46 @@ namespace sonata::lcd
 		                              Color       background,
 		                              Color       foreground,
 		                              Font        font);
+
+		/**
+		 * Sets the `height` lines of the panel from `top` to scroll in
+		 * hardware, leaving the lines above and below them fixed. Lines run
+		 * along the panel's long side, so they are rows of the screen in
+		 * portrait orientations and columns of it in landscape ones.
+		 */
+		void __cheri_libcall scroll_area(uint32_t top, uint32_t height);
+		/**
+		 * Shows the line of the LCD's memory `line` at the top of the
+		 * scrolling area, with the lines after it below and wrapping around
+		 * the area. Nothing is redrawn, so this costs only a command.
+		 */
+		void __cheri_libcall scroll_to(uint32_t line);
+
+		/**
+		 * Keeps a copy of everything drawn from now on in `framebuffer`,
+		 * which must hold the screen's pixels at 2 bytes a pixel and should
+		 * start cleared. Frames are then captured from the copy rather than
+		 * read back from the panel, which the simulator doesn't model.
+		 */
+		void __cheri_libcall attach_shadow(uint8_t *framebuffer);
+		/**
+		 * Captures the pixels of `rect` as RGB565, from the copy kept by
+		 * `attach_shadow` if there is one, or else by reading the panel's
+		 * memory back. The panel is read in its own addressing, which
+		 * matches the screen's unless its memory is larger than the screen.
+		 * The lines are those shown, following any scrolling. Nothing is
+		 * captured if `rect` isn't within the screen.
+		 */
+		void __cheri_libcall read_pixels(Rect rect, uint8_t *data);
+		/// Returns the CRC-32 of the screen's RGB565 pixels, row by row.
+		uint32_t __cheri_libcall frame_crc();
+		/**
+		 * Prints the screen's CRC over the UART as `lcd_frame name=<name>
+		 * width=<w> height=<h> crc=<hex>`, for golden-image checks by
+		 * `scripts/test_runner.py`. With `dumpPixels`, the frame follows as
+		 * `lcd_frame_data` lines of hex RGB565, which
+		 * `scripts/lcd_frames_to_png.py` converts to PNG.
+		 */
+		void __cheri_libcall report_frame(const char *name, bool dumpPixels);
 	};
 } // namespace sonata::lcd
@@ -0,0 +1,106 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "lcd.hh"
+#include <debug.hh>
+
+namespace sonata::lcd
+{
+	/**
+	 * A text console on a band of the LCD, which new lines are appended to
+	 * at the bottom, scrolling the older lines up.
+	 *
+	 * The lines are kept in the LCD's memory as a ring, and the ST7735's
+	 * hardware scrolling is moved on by a line as each one is added, so
+	 * appending a line draws only that line rather than every line of the
+	 * console. Hardware scrolling runs along the panel's long side, so it
+	 * only moves lines up the screen in portrait orientations, and the
+	 * console needs the LCD to be in one.
+	 */
+	class LcdConsole
+	{
+		SonataLcd &lcd;
+		uint32_t   top;
+		uint32_t   lines;
+		uint32_t   lineHeight;
+		uint32_t   width;
+		Color      background;
+		Color      foreground;
+		Font       font;
+		/// The line of the ring that the next line is written to.
+		uint32_t next = 0;
+
+		public:
+		/**
+		 * Sets up a console of `lines` lines, each `lineHeight` pixels
+		 * tall, from the `top` row of the screen, and clears it. The LCD
+		 * must be in a portrait orientation.
+		 */
+		LcdConsole(SonataLcd &lcd,
+		           uint32_t   top,
+		           uint32_t   lines,
+		           uint32_t   lineHeight,
+		           Color      background,
+		           Color      foreground,
+		           Font       font = Font::M5x7_16pt)
+		  : lcd(lcd),
+		    top(top),
+		    lines(std::max<uint32_t>(lines, 1)),
+		    lineHeight(lineHeight),
+		    width(lcd.resolution().width),
+		    background(background),
+		    foreground(foreground),
+		    font(font)
+		{
+			const Size Resolution = lcd.resolution();
+			ConditionalDebug<true, "LCD console">::Invariant(
+			  Resolution.height > Resolution.width,
+			  "The console needs the LCD in a portrait orientation");
+			lcd.fill_rect(area(), background);
+			lcd.scroll_area(top, this->lines * lineHeight);
+			lcd.scroll_to(top);
+		}
+
+		/// Puts the scrolling back as it was, so the screen isn't shifted.
+		~LcdConsole()
+		{
+			lcd.scroll_area(0, lcd.resolution().height);
+			lcd.scroll_to(0);
+		}
+
+		LcdConsole(const LcdConsole &)            = delete;
+		LcdConsole &operator=(const LcdConsole &) = delete;
+
+		/// The area of the screen that the console draws over.
+		Rect area() const
+		{
+			return {0, top, width, top + lines * lineHeight};
+		}
+
+		/**
+		 * Appends `text` as the bottom line of the console. Text that is
+		 * too long for the line is cut off by the LCD.
+		 */
+		void append(const char *text)
+		{
+			const uint32_t Row = top + next * lineHeight;
+			lcd.fill_rect({0, Row, width, Row + lineHeight}, background);
+			lcd.draw_str({2, Row}, text, background, foreground, font);
+			next = (next + 1) % lines;
+			// The line just written was the oldest, at the top of the
+			// scrolling area. Starting the area from the line after it moves
+			// it to the bottom.
+			lcd.scroll_to(top + next * lineHeight);
+		}
+
+		/// Clears the console's lines.
+		void clear()
+		{
+			lcd.fill_rect(area(), background);
+			next = 0;
+			lcd.scroll_to(top);
+		}
+	};
+} // namespace sonata::lcd
@@ -0,0 +1,601 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+/*
+ * Retained-mode widgets for the LCD.
+ *
+ * A widget knows the area of the LCD that it covers and the value that it
+ * shows. Setting a widget's value only marks it as damaged if the value
+ * changed, and rendering it draws only the parts that changed since it was
+ * last drawn: the segments of a seven-segment display that turned on or
+ * off, or the strip of a bar gauge between its old and new levels. A
+ * `Compositor` renders a screen's widgets once a frame, so the bytes sent to
+ * the LCD each frame grow with what changed rather than with the size of the
+ * screen.
+ */
+
+#include "lcd.hh"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <tuple>
+
+namespace sonata::lcd
+{
+	/// Tracks how much of a widget needs to be drawn again.
+	class Widget
+	{
+		protected:
+		enum class Damage : uint8_t
+		{
+			None,
+			/// Only the parts that changed need to be drawn.
+			Changed,
+			/// All of the widget needs to be drawn.
+			All,
+		};
+
+		Rect bounds;
+
+		/// Fills `rect`, which may be empty, with `color`.
+		static void fill(SonataLcd &lcd, Rect rect, Color color)
+		{
+			if (rect.right > rect.left && rect.bottom > rect.top)
+			{
+				lcd.fill_rect(rect, color);
+			}
+		}
+
+		/// Marks the widget as changed, unless it is already damaged more.
+		void changed()
+		{
+			if (damage == Damage::None)
+			{
+				damage = Damage::Changed;
+			}
+		}
+
+		/// Returns the damage to draw, leaving the widget undamaged.
+		Damage take_damage()
+		{
+			const Damage Taken = damage;
+			damage             = Damage::None;
+			return Taken;
+		}
+
+		private:
+		Damage damage = Damage::All;
+
+		public:
+		constexpr Widget(Rect bounds) : bounds(bounds) {}
+
+		/// The area of the LCD that the widget draws over.
+		Rect area() const
+		{
+			return bounds;
+		}
+
+		bool is_damaged() const
+		{
+			return damage != Damage::None;
+		}
+
+		/// Marks all of the widget to be drawn, such as after a clear.
+		void invalidate()
+		{
+			damage = Damage::All;
+		}
+	};
+
+	/// A line of text, which the caller keeps alive while it is shown.
+	class Label : public Widget
+	{
+		const char *text;
+		Color       background;
+		Color       foreground;
+		Font        font;
+
+		public:
+		Label(Rect        bounds,
+		      const char *text,
+		      Color       background,
+		      Color       foreground,
+		      Font        font = Font::M5x7_16pt)
+		  : Widget(bounds),
+		    text(text),
+		    background(background),
+		    foreground(foreground),
+		    font(font)
+		{
+		}
+
+		void set_text(const char *newText)
+		{
+			if (newText != text && strcmp(newText, text) != 0)
+			{
+				invalidate();
+			}
+			text = newText;
+		}
+
+		void set_color(Color newForeground)
+		{
+			if (newForeground != foreground)
+			{
+				foreground = newForeground;
+				changed();
+			}
+		}
+
+		/// Draws the label if it was damaged, returning true if it was.
+		bool render(SonataLcd &lcd)
+		{
+			const Damage Drawn = take_damage();
+			if (Drawn == Damage::None)
+			{
+				return false;
+			}
+			// Different text may be shorter, so the old text is cleared, but
+			// a change of colour is drawn over the same glyphs.
+			if (Drawn == Damage::All)
+			{
+				lcd.fill_rect(bounds, background);
+			}
+			lcd.draw_str({bounds.left, bounds.top},
+			             text,
+			             background,
+			             foreground,
+			             font);
+			return true;
+		}
+	};
+
+	/**
+	 * A number after a fixed prefix. The number is padded with spaces to
+	 * `Width` digits, so that a shorter number draws over the longer one
+	 * before it rather than the field being cleared first.
+	 */
+	template<size_t Width>
+	class NumericField : public Widget
+	{
+		static_assert(Width > 0 && Width <= 10);
+
+		static constexpr size_t Capacity = 32;
+
+		char     text[Capacity];
+		size_t   digitsStart;
+		uint32_t value;
+		Color    background;
+		Color    foreground;
+		Font     font;
+
+		/**
+		 * Writes `value` after the prefix, padded with spaces after it. A
+		 * value with more than `Width` digits is clamped to the largest
+		 * number that fits.
+		 */
+		void format()
+		{
+			uint64_t limit = 1;
+			for (size_t i = 0; i < Width; i++)
+			{
+				limit *= 10;
+			}
+			char     digits[10];
+			size_t   length    = 0;
+			uint32_t remaining = std::min<uint64_t>(value, limit - 1);
+			do
+			{
+				digits[length++] = '0' + remaining % 10;
+				remaining /= 10;
+			} while (remaining != 0);
+			for (size_t i = 0; i < Width; i++)
+			{
+				text[digitsStart + i] =
+				  i < length ? digits[length - 1 - i] : ' ';
+			}
+		}
+
+		public:
+		NumericField(Rect        bounds,
+		             const char *prefix,
+		             uint32_t    value,
+		             Color       background,
+		             Color       foreground,
+		             Font        font = Font::M5x7_16pt)
+		  : Widget(bounds),
+		    digitsStart(std::min(strlen(prefix), Capacity - Width - 1)),
+		    value(value),
+		    background(background),
+		    foreground(foreground),
+		    font(font)
+		{
+			memcpy(text, prefix, digitsStart);
+			text[digitsStart + Width] = '\0';
+			format();
+		}
+
+		void set(uint32_t newValue)
+		{
+			if (newValue != value)
+			{
+				value = newValue;
+				format();
+				changed();
+			}
+		}
+
+		void set_color(Color newForeground)
+		{
+			if (newForeground != foreground)
+			{
+				foreground = newForeground;
+				changed();
+			}
+		}
+
+		/// Draws the field if it was damaged, returning true if it was.
+		bool render(SonataLcd &lcd)
+		{
+			if (take_damage() == Damage::None)
+			{
+				return false;
+			}
+			lcd.draw_str({bounds.left, bounds.top},
+			             text,
+			             background,
+			             foreground,
+			             font);
+			return true;
+		}
+	};
+
+	/// A horizontal bar filled from the left in proportion to its value.
+	class BarGauge : public Widget
+	{
+		uint32_t maximum;
+		uint32_t value       = 0;
+		uint32_t shownPixels = 0;
+		Color    empty;
+		Color    filled;
+
+		uint32_t pixels() const
+		{
+			const uint64_t Width = bounds.right - bounds.left;
+			return static_cast<uint32_t>(Width * std::min(value, maximum) /
+			                             maximum);
+		}
+
+		public:
+		BarGauge(Rect bounds, uint32_t maximum, Color empty, Color filled)
+		  : Widget(bounds),
+		    maximum(maximum == 0 ? 1 : maximum),
+		    empty(empty),
+		    filled(filled)
+		{
+		}
+
+		void set(uint32_t newValue)
+		{
+			value = newValue;
+			if (pixels() != shownPixels)
+			{
+				changed();
+			}
+		}
+
+		void set_color(Color newFilled)
+		{
+			if (newFilled != filled)
+			{
+				filled = newFilled;
+				invalidate();
+			}
+		}
+
+		/**
+		 * Draws the gauge if it was damaged, returning true if it was. A
+		 * change of value only draws the strip between the old and new
+		 * levels.
+		 */
+		bool render(SonataLcd &lcd)
+		{
+			const Damage Drawn = take_damage();
+			if (Drawn == Damage::None)
+			{
+				return false;
+			}
+			const uint32_t Level    = bounds.left + pixels();
+			const uint32_t Previous = bounds.left + shownPixels;
+			if (Drawn == Damage::All)
+			{
+				fill(
+				  lcd, {bounds.left, bounds.top, Level, bounds.bottom}, filled);
+				fill(
+				  lcd, {Level, bounds.top, bounds.right, bounds.bottom}, empty);
+			}
+			else if (Level > Previous)
+			{
+				fill(lcd, {Previous, bounds.top, Level, bounds.bottom}, filled);
+			}
+			else
+			{
+				fill(lcd, {Level, bounds.top, Previous, bounds.bottom}, empty);
+			}
+			shownPixels = Level - bounds.left;
+			return true;
+		}
+	};
+
+	/**
+	 * A number shown on seven-segment digits, with leading zeros blanked.
+	 * Each digit is 25 by 45 pixels, made of segments 5 pixels thick, and
+	 * the digits are 35 pixels apart.
+	 */
+	template<size_t Digits>
+	class SevenSegmentDisplay : public Widget
+	{
+		static_assert(Digits > 0 && Digits <= 9);
+
+		/// The position of a segment within its digit.
+		struct Segment
+		{
+			uint8_t x;
+			uint8_t y;
+			bool    vertical;
+		};
+
+		static constexpr Segment Segments[7] = {
+		  {5, 0, false},  // A         ## <-- A
+		  {0, 5, true},   // B    B-> #  #
+		  {20, 5, true},  // C        #  # <- C
+		  {5, 20, false}, // D         ## <-- D
+		  {0, 25, true},  // E    E-> #  #
+		  {20, 25, true}, // F        #  # <- F
+		  {5, 40, false}, // G         ## <-- G
+		};
+
+		/// The segments that are on for each digit, a bit for each segment.
+		static constexpr uint8_t Numerals[10] = {
+		  0b01110111, // 0 = A,B,C,E,F,G
+		  0b00100100, // 1 = C,F
+		  0b01011101, // 2 = A,C,D,E,G
+		  0b01101101, // 3 = A,C,D,F,G
+		  0b00101110, // 4 = B,C,D,F
+		  0b01101011, // 5 = A,B,D,F,G
+		  0b01111011, // 6 = A,B,D,E,F,G
+		  0b00100101, // 7 = A,C,F
+		  0b01111111, // 8 = A,B,C,D,E,F,G
+		  0b01101111, // 9 = A,B,C,D,F,G
+		};
+
+		static constexpr uint32_t DigitSpacing = 35;
+
+		/// The segments to show, from the most significant digit.
+		uint8_t segments[Digits] = {};
+		/// The segments that were last drawn on.
+		uint8_t shown[Digits] = {};
+		Color   on;
+		Color   shownOn;
+		Color   off;
+
+		void fill_segment(SonataLcd &lcd, size_t digit, size_t segment)
+		{
+			const Segment &Info     = Segments[segment];
+			const uint32_t Left     = bounds.left + DigitSpacing * digit;
+			const Point    Position = {Left + Info.x, bounds.top + Info.y};
+			const Size     Area     = {Info.vertical ? 5u : 15u,
+			                           Info.vertical ? 15u : 5u};
+			lcd.fill_rect(Rect::from_point_and_size(Position, Area),
+			              (segments[digit] & (1u << segment)) != 0 ? on : off);
+		}
+
+		public:
+		SevenSegmentDisplay(Point origin, Color on, Color off)
+		  : Widget(Rect::from_point_and_size(
+		      origin,
+		      {DigitSpacing * (Digits - 1) + 25, 45})),
+		    on(on),
+		    shownOn(on),
+		    off(off)
+		{
+			set(0);
+		}
+
+		/// Shows `value`, clamped to the largest number that fits.
+		void set(uint32_t value)
+		{
+			uint32_t limit = 1;
+			for (size_t i = 0; i < Digits; i++)
+			{
+				limit *= 10;
+			}
+			uint32_t remaining = std::min(value, limit - 1);
+			for (size_t i = Digits; i > 0; i--)
+			{
+				const bool    Blank   = remaining == 0 && i != Digits;
+				const uint8_t Numeral = Blank ? 0 : Numerals[remaining % 10];
+				if (segments[i - 1] != Numeral)
+				{
+					segments[i - 1] = Numeral;
+					changed();
+				}
+				remaining /= 10;
+			}
+		}
+
+		void set_color(Color newOn)
+		{
+			if (newOn != on)
+			{
+				on = newOn;
+				changed();
+			}
+		}
+
+		/**
+		 * Draws the display if it was damaged, returning true if it was. A
+		 * change only draws the segments that turned on or off, or all of
+		 * the segments that are on if their colour changed.
+		 */
+		bool render(SonataLcd &lcd)
+		{
+			const Damage Drawn = take_damage();
+			if (Drawn == Damage::None)
+			{
+				return false;
+			}
+			const bool Recolored = on != shownOn;
+			for (size_t digit = 0; digit < Digits; digit++)
+			{
+				const uint8_t Redraw = Drawn == Damage::All ? 0x7F
+				                       : Recolored
+				                         ? segments[digit] | shown[digit]
+				                         : segments[digit] ^ shown[digit];
+				for (size_t segment = 0; segment < 7; segment++)
+				{
+					if ((Redraw & (1u << segment)) != 0)
+					{
+						fill_segment(lcd, digit, segment);
+					}
+				}
+				shown[digit] = segments[digit];
+			}
+			shownOn = on;
+			return true;
+		}
+	};
+
+	/**
+	 * A list of lines of text, one of which is selected and shown
+	 * highlighted. The caller keeps the lines alive while they are shown.
+	 */
+	class List : public Widget
+	{
+		static constexpr size_t MaxRows = 32;
+
+		const char *const *items;
+		size_t             count;
+		size_t             selected = 0;
+		/// The rows that need to be drawn again, a bit for each row.
+		uint32_t damagedRows = 0;
+		uint32_t rowHeight;
+		Color    background;
+		Color    foreground;
+		Color    highlight;
+		Font     font;
+
+		void draw_row(SonataLcd &lcd, size_t row)
+		{
+			const uint32_t Top = bounds.top + row * rowHeight;
+			const Color    Background =
+			  row == selected ? highlight : background;
+			lcd.fill_rect({bounds.left, Top, bounds.right, Top + rowHeight},
+			              Background);
+			lcd.draw_str({bounds.left + 2, Top + 1},
+			             items[row],
+			             Background,
+			             foreground,
+			             font);
+		}
+
+		public:
+		List(Rect               bounds,
+		     const char *const *items,
+		     size_t             count,
+		     uint32_t           rowHeight,
+		     Color              background,
+		     Color              foreground,
+		     Color              highlight,
+		     Font               font = Font::M5x7_16pt)
+		  : Widget(bounds),
+		    items(items),
+		    count(std::min(count, MaxRows)),
+		    rowHeight(rowHeight),
+		    background(background),
+		    foreground(foreground),
+		    highlight(highlight),
+		    font(font)
+		{
+		}
+
+		size_t selection() const
+		{
+			return selected;
+		}
+
+		/// Selects the row `row`, which only redraws the rows that changed.
+		void select(size_t row)
+		{
+			if (row < count && row != selected)
+			{
+				damagedRows |= (1u << selected) | (1u << row);
+				selected = row;
+				changed();
+			}
+		}
+
+		/// Draws the list if it was damaged, returning true if it was.
+		bool render(SonataLcd &lcd)
+		{
+			const Damage Drawn = take_damage();
+			if (Drawn == Damage::None)
+			{
+				return false;
+			}
+			if (Drawn == Damage::All)
+			{
+				lcd.fill_rect(bounds, background);
+				damagedRows = UINT32_MAX;
+			}
+			for (size_t row = 0; row < count; row++)
+			{
+				if ((damagedRows & (1u << row)) != 0)
+				{
+					draw_row(lcd, row);
+				}
+			}
+			damagedRows = 0;
+			return true;
+		}
+	};
+
+	/**
+	 * Renders a screen of widgets once a frame. Only damaged widgets are
+	 * drawn, and each only draws what changed.
+	 */
+	template<typename... Widgets>
+	class Compositor
+	{
+		std::tuple<Widgets &...> widgets;
+
+		public:
+		Compositor(Widgets &...widgets) : widgets(widgets...) {}
+
+		/// Marks all of the widgets to be drawn, such as after a clear.
+		void invalidate()
+		{
+			std::apply([](auto &...widget) { (widget.invalidate(), ...); },
+			           widgets);
+		}
+
+		/// Clears the LCD to `background` and marks the widgets to be drawn.
+		void clear(SonataLcd &lcd, Color background)
+		{
+			lcd.clean(background);
+			invalidate();
+		}
+
+		/// Draws the damaged widgets, returning how many were drawn.
+		size_t render(SonataLcd &lcd)
+		{
+			return std::apply(
+			  [&](auto &...widget) {
+				  return (size_t{0} + ... + widget.render(lcd));
+			  },
+			  widgets);
+		}
+	};
+} // namespace sonata::lcd
@@ -0,0 +1,141 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "rgbled_animation.hh"
+#include "cpu_accounting.hh"
+#include <cheri.hh>
+#include <errno.h>
+#include <futex.h>
+#include <locks.hh>
+#include <thread.h>
+
+using namespace CHERI;
+using sonata::rgbled::Animation;
+using sonata::rgbled::GammaTable;
+using sonata::rgbled::MaxKeyframes;
+
+/// The time between frames while an animation is playing.
+static constexpr uint32_t FrameMsec = 20;
+/// The level that full brightness is driven at, as the LEDs are dazzling.
+static constexpr uint8_t MaxLevel = 64;
+
+static constexpr GammaTable Gamma(MaxLevel);
+static constexpr size_t     LedCount = 2;
+
+namespace
+{
+	/// Protects the animations.
+	FlagLock  lock;
+	Animation animations[LedCount];
+	/// Incremented when an animation is posted, to wake the thread.
+	uint32_t posted = 0;
+} // namespace
+
+int rgbled_animate(SonataRgbLed          led,
+                   const RgbLedKeyframe *keyframes,
+                   size_t                count,
+                   bool                  loop)
+{
+	CpuAccountingScope accounting{"rgbled_animation"};
+	const size_t       Index = static_cast<size_t>(led);
+	if (Index >= LedCount || count > MaxKeyframes ||
+	    !check_pointer<PermissionSet{Permission::Load}, false>(
+	      keyframes, count * sizeof(RgbLedKeyframe)))
+	{
+		return -EINVAL;
+	}
+	// The keyframes are copied once, and then checked and played from the
+	// copy, so that the caller can't change them in between, such as to
+	// give a looping animation no duration.
+	RgbLedKeyframe copy[MaxKeyframes];
+	uint32_t       duration = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		copy[i] = keyframes[i];
+		duration += copy[i].durationMsec;
+	}
+	if (loop && duration == 0)
+	{
+		return -EINVAL;
+	}
+	{
+		LockGuard guard{lock};
+		animations[Index].start(copy, count, loop);
+		posted++;
+	}
+	futex_wake(&posted, 1);
+	return 0;
+}
+
+int rgbled_set(SonataRgbLed led, RgbLedColour colour, uint16_t fadeMsec)
+{
+	const RgbLedKeyframe Fade = {colour, fadeMsec, RgbLedEasing::Linear};
+	return rgbled_animate(led, &Fade, 1, false);
+}
+
+[[noreturn]] void __cheri_compartment("rgbled_animation")
+  rgbled_animation_run()
+{
+	const uint32_t CyclesPerMillisecond = CPU_TIMER_HZ / 1000;
+
+	auto rgbled = MMIO_CAPABILITY(SonataRgbLedController, rgbled);
+	rgbled->clear();
+
+	RgbLedColour shown[LedCount] = {};
+	uint64_t     lastFrame       = rdcycle64();
+	while (true)
+	{
+		cpu_accounting_sample("rgbled_animation");
+		const uint64_t Now = rdcycle64();
+		const uint32_t ElapsedMsec =
+		  static_cast<uint32_t>((Now - lastFrame) / CyclesPerMillisecond);
+		lastFrame += static_cast<uint64_t>(ElapsedMsec) * CyclesPerMillisecond;
+
+		RgbLedColour levels[LedCount];
+		bool         playing = false;
+		uint32_t     seen;
+		{
+			LockGuard guard{lock};
+			for (size_t i = 0; i < LedCount; i++)
+			{
+				levels[i] = Gamma(animations[i].advance(ElapsedMsec));
+				playing |= animations[i].running();
+			}
+			seen = posted;
+		}
+
+		// Only the LEDs that changed are written, and the controller is
+		// updated once for both.
+		bool changed = false;
+		for (size_t i = 0; i < LedCount; i++)
+		{
+			const RgbLedColour &Level = levels[i];
+			if (Level.red != shown[i].red || Level.green != shown[i].green ||
+			    Level.blue != shown[i].blue)
+			{
+				rgbled->rgb(static_cast<SonataRgbLed>(i),
+				            Level.red,
+				            Level.green,
+				            Level.blue);
+				shown[i] = Level;
+				changed  = true;
+			}
+		}
+		if (changed)
+		{
+			rgbled->update();
+		}
+
+		if (playing)
+		{
+			thread_millisecond_wait(FrameMsec);
+		}
+		else
+		{
+			// Nothing is playing, so sleep until an animation is posted and
+			// start timing it from then.
+			futex_wait(&posted, seen);
+			lastFrame = rdcycle64();
+		}
+	}
+}
@@ -0,0 +1,223 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+/*
+ * The RGB LED animation compartment, which owns Sonata's RGB LED controller
+ * and plays animations on its LEDs for other compartments.
+ *
+ * An animation is a sequence of keyframes, each of which fades an LED from
+ * its current colour to the keyframe's colour over the keyframe's duration,
+ * following an easing curve. Both LEDs are animated by the compartment's
+ * `rgbled_animation_run` thread, which sleeps until an animation is posted,
+ * then steps every running animation once a frame and sends the new colours
+ * to the controller with a single update. Colours are given in linear
+ * brightness and gamma corrected through a lookup table built at compile
+ * time, so that fades look even to the eye.
+ */
+
+#include <compartment.h>
+#include <platform-rgbctrl.hh>
+#include <stddef.h>
+#include <stdint.h>
+
+struct RgbLedColour
+{
+	uint8_t red;
+	uint8_t green;
+	uint8_t blue;
+};
+
+/// How a fade moves between colours over its duration.
+enum class RgbLedEasing : uint8_t
+{
+	/// Jumps to the new colour at the end of the fade.
+	Step,
+	Linear,
+	/// Starts slowly and speeds up.
+	EaseIn,
+	/// Starts quickly and slows down.
+	EaseOut,
+	/// Starts and ends slowly.
+	EaseInOut,
+};
+
+/// A fade to `colour` over `durationMsec` milliseconds.
+struct RgbLedKeyframe
+{
+	RgbLedColour colour;
+	uint16_t     durationMsec;
+	RgbLedEasing easing = RgbLedEasing::Linear;
+};
+
+/**
+ * Plays `count` keyframes on `led`, starting from the colour that it shows
+ * now and replacing any animation that is playing on it. If `loop` is set,
+ * the keyframes are played again from the first after the last, forever.
+ * Returns 0 on success or `-EINVAL` if there are more than
+ * `sonata::rgbled::MaxKeyframes` keyframes, or if a looping animation has
+ * no duration.
+ */
+__cheri_compartment("rgbled_animation") int rgbled_animate(
+  SonataRgbLed          led,
+  const RgbLedKeyframe *keyframes,
+  size_t                count,
+  bool                  loop);
+
+/// Fades `led` from the colour it shows now to `colour` over `fadeMsec`.
+__cheri_compartment("rgbled_animation") int rgbled_set(SonataRgbLed led,
+                                                       RgbLedColour colour,
+                                                       uint16_t fadeMsec);
+
+/// The thread that plays the animations.
+[[noreturn]] void __cheri_compartment("rgbled_animation")
+  rgbled_animation_run();
+
+namespace sonata::rgbled
+{
+	/// The most keyframes that an animation can have.
+	static constexpr size_t MaxKeyframes = 8;
+
+	/// Progress through a fade, as a fraction of `ProgressOne`.
+	using Progress = uint32_t;
+
+	static constexpr Progress ProgressOne = 1 << 16;
+
+	/// Applies `easing` to linear progress through a fade.
+	constexpr Progress ease(RgbLedEasing easing, Progress t)
+	{
+		const uint64_t T       = t;
+		const uint64_t Squared = (T * T) >> 16;
+		switch (easing)
+		{
+			case RgbLedEasing::Step:
+				return t < ProgressOne ? 0 : ProgressOne;
+			case RgbLedEasing::EaseIn:
+				return Squared;
+			case RgbLedEasing::EaseOut:
+				return ProgressOne -
+				       (((ProgressOne - T) * (ProgressOne - T)) >> 16);
+			case RgbLedEasing::EaseInOut:
+				// The smoothstep curve, 3t^2 - 2t^3.
+				return (Squared * (3 * ProgressOne - 2 * T)) >> 16;
+			case RgbLedEasing::Linear:
+			default:
+				return t;
+		}
+	}
+
+	/// Mixes `from` and `to`, `progress` of the way from one to the other.
+	constexpr RgbLedColour
+	mix(RgbLedColour from, RgbLedColour to, Progress progress)
+	{
+		auto channel = [=](uint8_t start, uint8_t end) {
+			const int32_t Change = static_cast<int32_t>(end) - start;
+			return static_cast<uint8_t>(
+			  start + ((Change * static_cast<int32_t>(progress)) >> 16));
+		};
+		return {channel(from.red, to.red),
+		        channel(from.green, to.green),
+		        channel(from.blue, to.blue)};
+	}
+
+	/// Maps linear brightness to the level to drive an LED at.
+	struct GammaTable
+	{
+		uint8_t levels[256];
+
+		/**
+		 * Builds the table for a gamma of about 2.2, approximated as
+		 * `(4x^2 + x^3) / 5`, with full brightness driven at `maxLevel`.
+		 */
+		constexpr GammaTable(uint8_t maxLevel) : levels()
+		{
+			constexpr uint64_t Divisor = 5ull * 255 * 255 * 255;
+			for (uint64_t x = 0; x < 256; x++)
+			{
+				const uint64_t Curve = 4 * 255 * x * x + x * x * x;
+				levels[x] = static_cast<uint8_t>(
+				  (Curve * maxLevel + Divisor / 2) / Divisor);
+			}
+		}
+
+		constexpr RgbLedColour operator()(RgbLedColour colour) const
+		{
+			return {levels[colour.red],
+			        levels[colour.green],
+			        levels[colour.blue]};
+		}
+	};
+
+	/// An animation playing on one LED.
+	class Animation
+	{
+		RgbLedKeyframe keyframes[MaxKeyframes] = {};
+		size_t         count                   = 0;
+		size_t         next                    = 0;
+		bool           loop                    = false;
+		/// The colour at the start of the current keyframe.
+		RgbLedColour from = {};
+		RgbLedColour now  = {};
+		/// Time spent in the current keyframe.
+		uint32_t elapsedMsec = 0;
+
+		public:
+		/**
+		 * Starts playing `keyframes` from the current colour. The caller
+		 * checks that there are at most `MaxKeyframes` of them.
+		 */
+		void start(const RgbLedKeyframe *newKeyframes,
+		           size_t                newCount,
+		           bool                  newLoop)
+		{
+			for (size_t i = 0; i < newCount; i++)
+			{
+				keyframes[i] = newKeyframes[i];
+			}
+			count       = newCount;
+			next        = 0;
+			loop        = newLoop;
+			from        = now;
+			elapsedMsec = 0;
+		}
+
+		/// Returns true until the last keyframe of the animation is reached.
+		bool running() const
+		{
+			return next < count;
+		}
+
+		RgbLedColour colour() const
+		{
+			return now;
+		}
+
+		/// Moves the animation on by `msec` and returns the new colour.
+		RgbLedColour advance(uint32_t msec)
+		{
+			elapsedMsec += msec;
+			while (running() && elapsedMsec >= keyframes[next].durationMsec)
+			{
+				elapsedMsec -= keyframes[next].durationMsec;
+				from = now = keyframes[next].colour;
+				if (++next == count && loop)
+				{
+					next = 0;
+				}
+			}
+			if (running())
+			{
+				const RgbLedKeyframe &Keyframe = keyframes[next];
+				const Progress        Linear =
+				  (elapsedMsec * ProgressOne) / Keyframe.durationMsec;
+				now = mix(from, Keyframe.colour, ease(Keyframe.easing, Linear));
+			}
+			else
+			{
+				elapsedMsec = 0;
+			}
+			return now;
+		}
+	};
+} // namespace sonata::rgbled
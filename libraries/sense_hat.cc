@@ -2,34 +2,15 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "sense_hat.hh"
-#include <cheri.hh>
-#include <platform-i2c.hh>
-
-using namespace CHERI;
 
 /**
- * Helper. Returns a pointer to the I2C device.
+ * Helper. Returns true if all of the colour's fields are in range.
  */
-[[nodiscard, gnu::always_inline]] static Capability<volatile OpenTitanI2c> i2c()
+static bool colour_in_range(SenseHat::Colour colour)
 {
-	return MMIO_CAPABILITY(OpenTitanI2c, i2c1);
-}
-
-void __cheri_libcall Internal::init_i2c()
-{
-	/* Increase the reliability of the Sense HAT I2C against controller halts
-	in case the I2C Controller gets into a bad state while loading demos. */
-	i2c()->control = i2c()->control & ~(OpenTitanI2c::ControlEnableHost |
-	                                    OpenTitanI2c::ControlEnableTarget);
-	if (i2c()->interrupt_is_asserted(OpenTitanI2c::Interrupt::ControllerHalt))
-	{
-		i2c()->reset_controller_events();
-	}
-
-	/* Initialise the I2C controller as normal. */
-	i2c()->reset_fifos();
-	i2c()->host_mode_set();
-	i2c()->speed_set(100);
+	return colour.red <= SenseHat::Colour::MaxRedValue &&
+	       colour.green <= SenseHat::Colour::MaxGreenValue &&
+	       colour.blue <= SenseHat::Colour::MaxBlueValue;
 }
 
 bool __cheri_libcall SenseHat::set_pixels(Colour pixels8x8[64])
@@ -70,5 +51,36 @@ bool __cheri_libcall SenseHat::set_pixels(Colour pixels8x8[64])
 			writeBuffer[i++] = pixels8x8[index].blue;
 		}
 	}
-	return i2c()->blocking_write(0x46u, writeBuffer, sizeof(writeBuffer), true);
+	return i2c_transfer(device, writeBuffer, sizeof(writeBuffer), nullptr, 0) ==
+	       0;
+}
+
+bool __cheri_libcall SenseHat::set_pixels(uint64_t pixels8x8,
+                                          Colour   on,
+                                          Colour   off)
+{
+	if (!colour_in_range(on) || !colour_in_range(off))
+	{
+		Debug::log("Colour exceeds the maximum value.");
+		return false;
+	}
+	uint8_t  writeBuffer[1 + 64 * 3];
+	uint32_t i       = 0u;
+	writeBuffer[i++] = 0x00u; // Address
+	for (uint8_t row = 0u; row < 8u; row++)
+	{
+		// Each row is sent as its red values, then green, then blue.
+		const uint8_t RowBits = static_cast<uint8_t>(pixels8x8 >> (row * 8u));
+		for (uint8_t column = 0u; column < 8u; column++)
+		{
+			const Colour &Pixel = ((RowBits >> column) & 1u) ? on : off;
+
+			writeBuffer[i + column]       = Pixel.red;
+			writeBuffer[i + 8u + column]  = Pixel.green;
+			writeBuffer[i + 16u + column] = Pixel.blue;
+		}
+		i += 24u;
+	}
+	return i2c_transfer(device, writeBuffer, sizeof(writeBuffer), nullptr, 0) ==
+	       0;
 }
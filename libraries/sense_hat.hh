@@ -5,6 +5,9 @@
  * A driver used for writing to the Raspberry Pi Sense HAT LED Matrix
  * via an I2C connection.
  *
+ * The Sense HAT is reached through the I2C bus compartment, so it can share
+ * its bus with other devices, and only one `SenseHat` can be open at a time.
+ *
  * Warning: Aborting the I2C transaction (e.g. resetting the FPGA, switching
  * software slot or bitstream) can cause the in-progress I2C transaction which
  * is writing the entire framebuffer to be interrupted. This can leave the I2C
@@ -16,15 +19,11 @@
  * plan to switch software slots / bitstreams regularly.
  */
 
+#include "i2c_bus.hh"
 #include <algorithm>
 #include <debug.hh>
 #include <utility>
 
-namespace Internal
-{
-	void __cheri_libcall init_i2c();
-} // namespace Internal
-
 class SenseHat
 {
 	private:
@@ -53,16 +52,38 @@ class SenseHat
 		uint8_t blue;
 	} __attribute__((packed));
 
+	/// The I2C bus that the Sense HAT is connected to.
+	static constexpr uint8_t Bus = 1;
+	/// The I2C address of the Sense HAT's LED matrix controller.
+	static constexpr uint8_t Address = 0x46;
+
 	/**
-	 * A constructor for the Sense HAT driver. Initialises the I2C controller
-	 * that will communicate with the Sense HAT's I2C Controller to write to
-	 * its LED Matrix.
+	 * A constructor for the Sense HAT driver. Opens the Sense HAT's I2C
+	 * Controller, which will be written to to set its LED Matrix. If it
+	 * can't be opened, such as when another `SenseHat` is using it, setting
+	 * pixels will fail.
 	 */
 	SenseHat()
 	{
-		Internal::init_i2c();
+		if (i2c_device_open(&device, Bus, Address, 100, I2cPriority::Normal) !=
+		    0)
+		{
+			Debug::log("Failed to open the Sense HAT");
+			device = nullptr;
+		}
+	}
+
+	~SenseHat()
+	{
+		if (device != nullptr)
+		{
+			i2c_device_close(device);
+		}
 	}
 
+	SenseHat(const SenseHat &)            = delete;
+	SenseHat &operator=(const SenseHat &) = delete;
+
 	/**
 	 * Set the values of all pixels in the 8x8 LED Matrix on the Sense HAT
 	 * via an I2C connection. Will block until the entire array has been
@@ -70,4 +91,15 @@ class SenseHat
 	 * all of row 1, then all of row 2, etc.)
 	 */
 	bool __cheri_libcall set_pixels(Colour pixels8x8[64]);
+
+	/**
+	 * Set all pixels in the 8x8 LED Matrix to one of two colours. Bit
+	 * `row * 8 + column` of `pixels8x8` selects `on` for a pixel when set and
+	 * `off` when clear. This avoids building an array of colours for
+	 * monochrome images, such as bitboards.
+	 */
+	bool __cheri_libcall set_pixels(uint64_t pixels8x8, Colour on, Colour off);
+
+	private:
+	SealedI2cDevice device = nullptr;
 };
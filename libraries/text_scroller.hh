@@ -0,0 +1,125 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Scrolling text for small displays, such as the Sense HAT LED matrix.
+ *
+ * A string is compiled once into a stream of columns, each a byte with the
+ * pixel in row `y` in bit `y`. Glyphs are given proportional widths while
+ * compiling: each glyph ends after its first empty column, which becomes the
+ * gap before the next glyph, or after `MaxGlyphWidth` columns. Spaces are
+ * always `MaxGlyphWidth` columns wide.
+ *
+ * Each frame of scrolling is then a window of the stream, which moves along
+ * by one column a frame. `ColumnStream::board` and `slide` give the window as
+ * a bitboard for the LED matrix, in the same layout as
+ * `SenseHat::set_pixels(uint64_t, Colour, Colour)` takes.
+ *
+ * Glyphs are read through a callable `glyphRows(c, row)`, which returns row
+ * `row` (0 to 7) of character `c` with its leftmost column in bit 0, as the
+ * display driver's fonts store them. If the callable can be used in constant
+ * expressions, so can the stream, and literal strings can be compiled at
+ * compile time.
+ */
+namespace sonata::text_scroller
+{
+	/// A column of pixels, with the pixel in row `y` in bit `y`.
+	using Column = uint8_t;
+
+	/// The widest a glyph can be, in columns, including the gap after it.
+	static constexpr size_t MaxGlyphWidth = 7;
+
+	/**
+	 * Returns the column as a column of a bitboard, with row `y` in bit
+	 * `y * 8`.
+	 */
+	constexpr uint64_t spread(Column column)
+	{
+		uint64_t board = 0;
+		for (size_t y = 0; y < 8; y++)
+		{
+			board |= static_cast<uint64_t>((column >> y) & 1) << (y * 8);
+		}
+		return board;
+	}
+
+	/**
+	 * Moves an 8x8 bitboard left by one column and puts `next` in the
+	 * rightmost column.
+	 */
+	constexpr uint64_t slide(uint64_t board, Column next)
+	{
+		constexpr uint64_t LastColumn = 0x8080808080808080;
+		return ((board >> 1) & ~LastColumn) | (spread(next) << 7);
+	}
+
+	/**
+	 * A string compiled into at most `Capacity` columns. Text that doesn't fit
+	 * is cut off.
+	 */
+	template<size_t Capacity>
+	class ColumnStream
+	{
+		Column columns[Capacity] = {};
+		size_t length            = 0;
+
+		public:
+		template<typename GlyphRows>
+		constexpr ColumnStream(const char *text, GlyphRows &&glyphRows)
+		{
+			for (; *text != '\0' && length < Capacity; text++)
+			{
+				const char Character = *text;
+				for (size_t x = 0; x < MaxGlyphWidth && length < Capacity; x++)
+				{
+					Column column = 0;
+					for (size_t y = 0; y < 8; y++)
+					{
+						column |= ((glyphRows(Character, y) >> x) & 1) << y;
+					}
+					columns[length++] = column;
+					// The first empty column ends the glyph.
+					if (column == 0 && Character != ' ')
+					{
+						break;
+					}
+				}
+			}
+		}
+
+		/// The number of columns in the stream.
+		constexpr size_t size() const
+		{
+			return length;
+		}
+
+		/**
+		 * Returns the column at `index`, which wraps around to the start of
+		 * the stream so that the text repeats.
+		 */
+		constexpr Column column(size_t index) const
+		{
+			return length == 0 ? 0 : columns[index % length];
+		}
+
+		/**
+		 * Returns the 8x8 window with its leftmost column at `offset` as a
+		 * bitboard. Use `slide` to move an existing window along by a column
+		 * more cheaply.
+		 */
+		constexpr uint64_t board(size_t offset) const
+		{
+			uint64_t window = 0;
+			for (size_t x = 0; x < 8; x++)
+			{
+				window |= spread(column(offset + x)) << x;
+			}
+			return window;
+		}
+	};
+} // namespace sonata::text_scroller
@@ -0,0 +1,248 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cheri.hh>
+#include <platform-uart.hh>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread.h>
+#include <type_traits>
+
+/**
+ * A compact binary event trace.
+ *
+ * Call sites name their format string as a template argument, so the
+ * identifier of each event is computed at compile time and only the
+ * identifier, a cycle count timestamp and up to `MaxArguments` 32-bit
+ * arguments are recorded. Records are buffered in a ring per thread and
+ * written to the UART as framed binary when `flush()` is called, away from
+ * any timing critical code. `scripts/trace_decode.py` finds the format strings
+ * in the source tree and turns the UART stream back into readable text.
+ *
+ * ```
+ * using Trace = sonata::trace::Tracer<>;
+ * Trace::event<"Frame of type {} received">(type);
+ * ...
+ * Trace::flush();
+ * ```
+ *
+ * The rings are global variables of the template, so this must be used from a
+ * compartment rather than from a library.
+ */
+namespace sonata::trace
+{
+	/// The maximum number of arguments that can be attached to an event.
+	static constexpr size_t MaxArguments = 4;
+
+	/// The two bytes that start every record on the wire.
+	static constexpr uint8_t SyncByte0 = 0xA5;
+	static constexpr uint8_t SyncByte1 = 0x5A;
+
+	/**
+	 * A format string passed as a template argument. The `{}` placeholders
+	 * are replaced with arguments in decimal, and `{x}` in hexadecimal, by the
+	 * decoder.
+	 */
+	template<size_t N>
+	struct FormatString
+	{
+		char value[N];
+
+		constexpr FormatString(const char (&str)[N])
+		{
+			for (size_t i = 0; i < N; i++)
+			{
+				value[i] = str[i];
+			}
+		}
+
+		/**
+		 * The identifier of the format string, a 32-bit FNV-1a hash of its
+		 * characters excluding the null terminator. The decoder computes the
+		 * same hash over the strings it finds in the source.
+		 */
+		constexpr uint32_t id() const
+		{
+			uint32_t hash = 0x811c9dc5;
+			for (size_t i = 0; i + 1 < N; i++)
+			{
+				hash ^= static_cast<uint8_t>(value[i]);
+				hash *= 0x01000193;
+			}
+			return hash;
+		}
+	};
+
+	/// The event emitted by `flush` when records were overwritten.
+	static constexpr FormatString DroppedFormat{"trace: {} records dropped"};
+
+	/// A single buffered event.
+	struct Record
+	{
+		uint32_t id;
+		uint32_t timestamp;
+		uint16_t thread;
+		uint8_t  argumentCount;
+		uint32_t arguments[MaxArguments];
+	};
+
+	/**
+	 * The trace buffers of a compartment.
+	 *
+	 * `Capacity` is the number of records held per thread and must be a power
+	 * of two; when a ring is full the oldest record is overwritten and counted
+	 * as dropped. `MaxThreads` must be at least the number of threads in the
+	 * firmware that trace through this compartment, as each thread writes to
+	 * its own ring without locking.
+	 */
+	template<size_t Capacity = 32, size_t MaxThreads = 8>
+	class Tracer
+	{
+		static_assert((Capacity & (Capacity - 1)) == 0,
+		              "The trace capacity must be a power of two");
+
+		struct Ring
+		{
+			Record   records[Capacity];
+			uint32_t head;
+			uint32_t tail;
+			uint32_t dropped;
+		};
+
+		static inline Ring rings[MaxThreads];
+
+		static Ring &ring()
+		{
+			return rings[thread_id_get() % MaxThreads];
+		}
+
+		template<typename T>
+		static constexpr uint32_t to_word(T value)
+		{
+			if constexpr (std::is_enum_v<T>)
+			{
+				return static_cast<uint32_t>(
+				  static_cast<std::underlying_type_t<T>>(value));
+			}
+			else
+			{
+				return static_cast<uint32_t>(value);
+			}
+		}
+
+		static void record(uint32_t       id,
+		                   const uint32_t *arguments,
+		                   uint8_t         argumentCount)
+		{
+			Ring &current = ring();
+			if (current.head - current.tail == Capacity)
+			{
+				current.tail++;
+				current.dropped++;
+			}
+			Record &entry       = current.records[current.head % Capacity];
+			entry.id            = id;
+			entry.timestamp     = static_cast<uint32_t>(rdcycle64());
+			entry.thread        = thread_id_get();
+			entry.argumentCount = argumentCount;
+			for (uint8_t i = 0; i < argumentCount; i++)
+			{
+				entry.arguments[i] = arguments[i];
+			}
+			current.head++;
+		}
+
+		static size_t
+		put(uint8_t *buffer, size_t offset, uint32_t value, size_t bytes)
+		{
+			for (size_t i = 0; i < bytes; i++)
+			{
+				buffer[offset++] = static_cast<uint8_t>(value >> (8 * i));
+			}
+			return offset;
+		}
+
+		/**
+		 * Writes a record to the UART. The frame is the sync bytes, the length
+		 * of the body, the body and an 8-bit sum of the body's bytes. The body
+		 * holds the thread ID (16 bits), format ID, timestamp and arguments
+		 * (32 bits each), all little endian.
+		 */
+		static void write(volatile OpenTitanUart *uart, const Record &entry)
+		{
+			uint8_t body[2 + 4 + 4 + 4 * MaxArguments];
+			size_t  length = put(body, 0, entry.thread, 2);
+			length         = put(body, length, entry.id, 4);
+			length         = put(body, length, entry.timestamp, 4);
+			for (uint8_t i = 0; i < entry.argumentCount; i++)
+			{
+				length = put(body, length, entry.arguments[i], 4);
+			}
+
+			uint8_t checksum = 0;
+			uart->blocking_write(static_cast<char>(SyncByte0));
+			uart->blocking_write(static_cast<char>(SyncByte1));
+			uart->blocking_write(static_cast<char>(length));
+			for (size_t i = 0; i < length; i++)
+			{
+				checksum += body[i];
+				uart->blocking_write(static_cast<char>(body[i]));
+			}
+			uart->blocking_write(static_cast<char>(checksum));
+		}
+
+		public:
+		/**
+		 * Records an event in the calling thread's ring. This only copies the
+		 * arguments and reads the cycle counter, so it is cheap enough to call
+		 * from timing sensitive code.
+		 */
+		template<FormatString Format, typename... Args>
+		static void event(Args... args)
+		{
+			static_assert(sizeof...(Args) <= MaxArguments,
+			              "Too many arguments for a trace event");
+			constexpr uint32_t Id = Format.id();
+			if constexpr (sizeof...(Args) == 0)
+			{
+				record(Id, nullptr, 0);
+			}
+			else
+			{
+				const uint32_t Arguments[] = {to_word(args)...};
+				record(Id, Arguments, sizeof...(Args));
+			}
+		}
+
+		/**
+		 * Writes the records buffered by the calling thread to the UART and
+		 * empties its ring. If records were overwritten since the last flush, a
+		 * record noting how many is written first.
+		 */
+		static void flush()
+		{
+			auto  uart    = MMIO_CAPABILITY(OpenTitanUart, uart);
+			Ring &current = ring();
+			if (current.dropped != 0)
+			{
+				// Stamp the note with the time of the oldest surviving record,
+				// which is where the gap in the trace is.
+				Record dropped;
+				dropped.id = DroppedFormat.id();
+				dropped.timestamp =
+				  current.records[current.tail % Capacity].timestamp;
+				dropped.thread        = thread_id_get();
+				dropped.argumentCount = 1;
+				dropped.arguments[0]  = current.dropped;
+				write(uart, dropped);
+				current.dropped = 0;
+			}
+			for (; current.tail != current.head; current.tail++)
+			{
+				write(uart, current.records[current.tail % Capacity]);
+			}
+		}
+	};
+} // namespace sonata::trace
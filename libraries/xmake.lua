@@ -14,6 +14,46 @@ library("lcd")
   "../third_party/display_drivers/src/", {public = true}
   )
 
+compartment("i2c_bus")
+  set_default(false)
+  add_deps("debug")
+  add_files("i2c_bus.cc")
+
+library("ksz8851")
+  set_default(false)
+  add_files("ksz8851.cc")
+
+compartment("gpio_input")
+  set_default(false)
+  add_files("gpio_input.cc")
+
+compartment("rgbled_animation")
+  set_default(false)
+  add_options("cpu_accounting")
+  if has_config("cpu_accounting") then
+    add_deps("cpu_accounting")
+  end
+  add_files("rgbled_animation.cc")
+
 library("sense_hat")
   set_default(false)
+  add_deps("i2c_bus")
   add_files("sense_hat.cc")
+
+library("apds9960")
+  set_default(false)
+  add_deps("i2c_bus")
+  add_files("apds9960.cc")
+
+-- Builds in the threads' reports of the cycles that they use, which are
+-- added up by the cpu_accounting compartment. Their cycles are only counted
+-- when the RTOS is also built with `--scheduler-accounting=y`.
+option("cpu_accounting")
+  set_default(false)
+  set_showmenu(true)
+  set_description("Report the CPU cycles used by each thread and compartment")
+  add_defines("CPU_ACCOUNTING")
+
+compartment("cpu_accounting")
+  set_default(false)
+  add_files("cpu_accounting.cc")
@@ -0,0 +1,177 @@
+# Copyright lowRISC Contributors.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Automotive Profile Comparison
+
+This script compares the profiles of the automotive demos reported by two
+firmware builds, such as `automotive_profile_legacy` and
+`automotive_profile_cheriot`, from their UART logs.
+
+Each firmware reports a `profile name=... key=value` line for each task and
+callback that it timed, followed by `profile_hist name=... log2_N=count` lines
+of the histogram of those times. For each probe reported by either firmware,
+the count, mean and approximate median of both are printed side by side, along
+with the ratio of the second firmware's median to the first's.
+"""
+
+import argparse
+import json
+import re
+import sys
+from pathlib import Path
+
+PROFILE_PATTERN = re.compile(r"\bprofile name=(\S+)((?: \w+=\d+)+)")
+HISTOGRAM_PATTERN = re.compile(
+    r"\bprofile_hist name=(\S+)((?: log2_\d+=\d+)+)"
+)
+ANSI_ESCAPE_PATTERN = re.compile(r"\x1b\[[0-9;]*m")
+
+Profile = dict[str, dict[str, int | dict[int, int]]]
+
+
+def parse_log(path: Path) -> Profile:
+    """Collects the profile of each probe reported in a UART log.
+
+    The summary values of a probe are kept in its entry by key, and its
+    histogram under `buckets`, from each bucket's power of two to its count.
+    If a probe is reported more than once, such as when the log holds several
+    runs, the last report of each value is kept.
+    """
+    profile: Profile = {}
+    with path.open(errors="replace") as log:
+        for raw_line in log:
+            line = ANSI_ESCAPE_PATTERN.sub("", raw_line)
+            if match := PROFILE_PATTERN.search(line):
+                values = profile.setdefault(match.group(1), {"buckets": {}})
+                for pair in match.group(2).split():
+                    key, value = pair.split("=")
+                    values[key] = int(value)
+            elif match := HISTOGRAM_PATTERN.search(line):
+                values = profile.setdefault(match.group(1), {"buckets": {}})
+                buckets = values["buckets"]
+                assert isinstance(buckets, dict)
+                for pair in match.group(2).split():
+                    key, value = pair.split("=")
+                    buckets[int(key.removeprefix("log2_"))] = int(value)
+    return profile
+
+
+def median_cycles(buckets: dict[int, int]) -> int | None:
+    """Approximates the median of a histogram of times.
+
+    The median is taken to be the middle of the bucket that it falls in,
+    which for bucket `N` is halfway between 2^N and 2^(N+1) cycles.
+    """
+    total = sum(buckets.values())
+    if total == 0:
+        return None
+    seen = 0
+    for bucket in sorted(buckets):
+        seen += buckets[bucket]
+        if seen * 2 >= total:
+            return (3 << bucket) // 2
+    return None
+
+
+def summarise(
+    values: dict[str, int | dict[int, int]] | None,
+) -> dict[str, int]:
+    """Gives the count, mean and approximate median of a probe's profile."""
+    if values is None:
+        return {}
+    summary = {
+        key: value
+        for key, value in values.items()
+        if isinstance(value, int) and key in ("count", "cycles_mean")
+    }
+    buckets = values.get("buckets")
+    if isinstance(buckets, dict) and (median := median_cycles(buckets)):
+        summary["cycles_median"] = median
+    return summary
+
+
+def format_value(summary: dict[str, int], key: str) -> str:
+    """Formats a value of a summary, or a dash if it is missing."""
+    return str(summary[key]) if key in summary else "-"
+
+
+def compare(
+    first: Profile, second: Profile, labels: tuple[str, str]
+) -> dict[str, dict[str, dict[str, int] | float]]:
+    """Prints a table comparing two profiles, and returns the comparison."""
+    columns = ("count", "cycles_mean", "cycles_median")
+    header = ["probe"]
+    for label in labels:
+        header += [f"{label} {column}" for column in columns]
+    header.append("median ratio")
+    rows = [header]
+
+    comparison: dict[str, dict[str, dict[str, int] | float]] = {}
+    for name in sorted(first.keys() | second.keys()):
+        summaries = (summarise(first.get(name)), summarise(second.get(name)))
+        row = [name]
+        for summary in summaries:
+            row += [format_value(summary, column) for column in columns]
+        entry: dict[str, dict[str, int] | float] = {
+            labels[0]: summaries[0],
+            labels[1]: summaries[1],
+        }
+        medians = [summary.get("cycles_median") for summary in summaries]
+        if medians[0] and medians[1]:
+            ratio = medians[1] / medians[0]
+            entry["median_ratio"] = ratio
+            row.append(f"{ratio:.2f}")
+        else:
+            row.append("-")
+        comparison[name] = entry
+        rows.append(row)
+
+    widths = [max(len(row[i]) for row in rows) for i in range(len(header))]
+    for row in rows:
+        cells = [row[0].ljust(widths[0])]
+        cells += [
+            cell.rjust(width)
+            for cell, width in zip(row[1:], widths[1:], strict=True)
+        ]
+        print("  ".join(cells))
+    return comparison
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument(
+        "first", type=Path, help="The UART log of the first firmware."
+    )
+    parser.add_argument(
+        "second", type=Path, help="The UART log of the second firmware."
+    )
+    parser.add_argument(
+        "--labels",
+        nargs=2,
+        default=("legacy", "cheriot"),
+        help="The names to give the two firmwares in the comparison.",
+    )
+    parser.add_argument(
+        "--json-output",
+        type=Path,
+        help="Write the comparison to this JSON file.",
+    )
+    args = parser.parse_args()
+
+    profiles = []
+    for path in (args.first, args.second):
+        if not path.exists():
+            print(f"'{path}' doesn't exist.")
+            sys.exit(2)
+        if not (profile := parse_log(path)):
+            print(f"No profile found in '{path}'.")
+            sys.exit(1)
+        profiles.append(profile)
+
+    comparison = compare(profiles[0], profiles[1], tuple(args.labels))
+    if args.json_output:
+        args.json_output.write_text(json.dumps(comparison, indent=2) + "\n")
+
+
+if __name__ == "__main__":
+    main()
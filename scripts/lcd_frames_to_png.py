@@ -0,0 +1,156 @@
+# Copyright lowRISC Contributors.
+# SPDX-License-Identifier: Apache-2.0
+
+"""LCD Frame Converter
+
+This script converts the LCD frames dumped in a UART log to PNG images, so
+that they can be looked at or compared with golden images.
+
+`SonataLcd::report_frame` prints a `lcd_frame name=... width=... height=...
+crc=...` line for each frame, which may be followed by `lcd_frame_data
+name=... row=... column=... pixels=...` lines holding the frame's pixels as
+hexadecimal RGB565, high byte first. Each frame whose pixels were dumped is
+written to `<name>.png`, after checking its pixels against its CRC.
+"""
+
+import argparse
+import re
+import struct
+import sys
+import zlib
+from dataclasses import dataclass
+from pathlib import Path
+
+FRAME_PATTERN = re.compile(
+    r"\blcd_frame name=(\S+) width=(\d+) height=(\d+) crc=([0-9a-f]{8})"
+)
+DATA_PATTERN = re.compile(
+    r"\blcd_frame_data name=(\S+) row=(\d+) column=(\d+) "
+    r"pixels=([0-9a-f]+)"
+)
+ANSI_ESCAPE_PATTERN = re.compile(r"\x1b\[[0-9;]*m")
+PNG_SIGNATURE = b"\x89PNG\r\n\x1a\n"
+
+
+@dataclass
+class Frame:
+    """A frame reported over the UART, with its RGB565 pixels."""
+
+    width: int
+    height: int
+    crc: int
+    pixels: bytearray
+    dumped: bool = False
+
+
+def parse_log(path: Path) -> dict[str, Frame]:
+    """Collects the frames reported in a UART log, by name.
+
+    If a frame is reported more than once, such as when the log holds several
+    runs, the last report is kept.
+    """
+    frames: dict[str, Frame] = {}
+    with path.open(errors="replace") as log:
+        for raw_line in log:
+            line = ANSI_ESCAPE_PATTERN.sub("", raw_line)
+            if match := FRAME_PATTERN.search(line):
+                width, height = int(match.group(2)), int(match.group(3))
+                frames[match.group(1)] = Frame(
+                    width,
+                    height,
+                    int(match.group(4), 16),
+                    bytearray(width * height * 2),
+                )
+            elif (match := DATA_PATTERN.search(line)) and (
+                frame := frames.get(match.group(1))
+            ):
+                row, column = int(match.group(2)), int(match.group(3))
+                data = bytes.fromhex(match.group(4))
+                start = (row * frame.width + column) * 2
+                frame.pixels[start : start + len(data)] = data
+                frame.dumped = True
+    return frames
+
+
+def rgb565_to_rgb888(pixels: bytes) -> bytes:
+    """Expands RGB565 pixels to RGB888, replicating each channel's top bits
+    into its bottom bits so that white stays white."""
+    rgb = bytearray()
+    for (pixel,) in struct.iter_unpack(">H", pixels):
+        red, green, blue = pixel >> 11, (pixel >> 5) & 0x3F, pixel & 0x1F
+        rgb += bytes(
+            (
+                (red << 3) | (red >> 2),
+                (green << 2) | (green >> 4),
+                (blue << 3) | (blue >> 2),
+            )
+        )
+    return bytes(rgb)
+
+
+def png_chunk(kind: bytes, data: bytes) -> bytes:
+    """Encodes a PNG chunk, with its length and CRC."""
+    return (
+        struct.pack(">I", len(data))
+        + kind
+        + data
+        + struct.pack(">I", zlib.crc32(kind + data))
+    )
+
+
+def write_png(path: Path, frame: Frame) -> None:
+    """Writes a frame as an 8-bit RGB PNG."""
+    rgb = rgb565_to_rgb888(frame.pixels)
+    stride = frame.width * 3
+    # Each row starts with its filter type, which is none.
+    rows = b"".join(
+        b"\x00" + rgb[row * stride : (row + 1) * stride]
+        for row in range(frame.height)
+    )
+    header = struct.pack(">IIBBBBB", frame.width, frame.height, 8, 2, 0, 0, 0)
+    path.write_bytes(
+        PNG_SIGNATURE
+        + png_chunk(b"IHDR", header)
+        + png_chunk(b"IDAT", zlib.compress(rows))
+        + png_chunk(b"IEND", b"")
+    )
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", type=Path, help="The UART log to read.")
+    parser.add_argument(
+        "-o",
+        "--output-dir",
+        type=Path,
+        default=Path(),
+        help="The directory to write the PNG images to.",
+    )
+    args = parser.parse_args()
+
+    if not args.log.exists():
+        print(f"'{args.log}' doesn't exist.")
+        sys.exit(2)
+    frames = parse_log(args.log)
+    if not frames:
+        print(f"No frames found in '{args.log}'.")
+        sys.exit(1)
+
+    corrupt = False
+    args.output_dir.mkdir(parents=True, exist_ok=True)
+    for name, frame in sorted(frames.items()):
+        if not frame.dumped:
+            print(f"{name}: crc={frame.crc:08x}, pixels not dumped")
+            continue
+        if (crc := zlib.crc32(frame.pixels)) != frame.crc:
+            print(f"{name}: pixels have crc={crc:08x}, not {frame.crc:08x}")
+            corrupt = True
+        path = args.output_dir / f"{name}.png"
+        write_png(path, frame)
+        print(f"{name}: crc={frame.crc:08x}, written to '{path}'")
+    if corrupt:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
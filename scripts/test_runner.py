@@ -6,10 +6,22 @@
 This script watches the UART output of the sonata system running a test. When
 it encounters a recognised pass or fail message it will exit with the
 appropriate error code.
+
+It also collects the `bench name=... key=value` lines printed by the benchmark
+suite. These can be saved as JSON and compared against a baseline, in which
+case a benchmark that is slower than its baseline by more than its tolerance
+fails the run with a distinct return code.
+
+Likewise, it collects the `lcd_frame name=... crc=...` lines printed for
+rendered LCD frames. These can be compared against golden CRCs, in which case
+a frame that differs from its golden one fails the run with another distinct
+return code.
 """
 
 import argparse
+import json
 import os
+import re
 import shutil
 import sys
 import threading
@@ -19,12 +31,25 @@ from glob import glob
 from pathlib import Path
 from queue import Queue
 from subprocess import PIPE, Popen
-from typing import Generator
+from typing import Any, Generator
 
 import serial
 
-PASSED_MESSAGE: str = "All tests finished"
+PASSED_MESSAGES: tuple[str, ...] = (
+    "All tests finished",
+    "All benchmarks finished",
+    "Automotive profile finished",
+)
 FAILED_MESSAGE: str = "Test(s) Failed"
+BENCH_PATTERN = re.compile(
+    r"\bbench name=(\S+)((?: \w+=(?:0x[0-9a-f]+|\d+))+)"
+)
+FRAME_PATTERN = re.compile(r"\blcd_frame name=(\S+) .*\bcrc=([0-9a-f]{8})")
+ANSI_ESCAPE_PATTERN = re.compile(r"\x1b\[[0-9;]*m")
+DEFAULT_TOLERANCE: float = 0.05
+DEFAULT_BASELINE_METRICS: tuple[str, ...] = ("cycles_median",)
+HIGHER_IS_BETTER_SUFFIX: str = "_per_s"
+"""Metrics with this suffix are rates, so regress when they fall."""
 TICK_SECONDS: float = 0.01
 SONATA_DRIVE_GLOBS: tuple[str, ...] = ("/run/media/**/SONATA",)
 BAUD_RATE: int = 115200
@@ -40,6 +65,8 @@ class ReturnCode(IntEnum):
     TIMEOUT = 3
     SIMULATOR_DIED = 4
     FPGA_FILESYSEM_NOT_FOUND = 5
+    PERFORMANCE_REGRESSION = 6
+    FRAME_MISMATCH = 7
 
     def __str__(self) -> str:
         match self:
@@ -53,8 +80,12 @@ class ReturnCode(IntEnum):
                 return "tests timed out"
             case self.SIMULATOR_DIED:
                 return "simulator died unexpectedly"
-            case self.SIMULATOR_DIED:
+            case self.FPGA_FILESYSEM_NOT_FOUND:
                 return "a mounted fpga filesystem could not be found"
+            case self.PERFORMANCE_REGRESSION:
+                return "benchmarks regressed"
+            case self.FRAME_MISMATCH:
+                return "frames differ from their golden ones"
             case _:
                 raise NotImplementedError
 
@@ -63,6 +94,10 @@ return_code: Queue[ReturnCode] = Queue(maxsize=1)
 """This queue is used to return an error code from a thread to main."""
 main_finished = threading.Event()
 """The main finished event is used to inform thread that main has finished."""
+bench_results: dict[str, dict[str, int]] = {}
+"""The values reported by each benchmark, keyed by benchmark name."""
+frame_crcs: dict[str, str] = {}
+"""The CRC of each rendered LCD frame, in hexadecimal, keyed by frame name."""
 
 
 def find_sonata_drive() -> str:
@@ -89,6 +124,36 @@ class Config(argparse.Namespace):
             help="Seconds before timing out. Defaults to no timeout.",
         )
 
+        parser.add_argument(
+            "--bench-output",
+            type=Path,
+            help="Write the collected benchmark results to this JSON file.",
+        )
+        parser.add_argument(
+            "--baseline",
+            type=Path,
+            help="Compare benchmark results against this baseline JSON file.",
+        )
+        parser.add_argument(
+            "--update-baseline",
+            action="store_true",
+            help="Record the benchmark results in the baseline file, rather "
+            "than comparing against it.",
+        )
+
+        parser.add_argument(
+            "--golden-frames",
+            type=Path,
+            help="Compare the CRCs of rendered LCD frames against this JSON "
+            "file of golden CRCs.",
+        )
+        parser.add_argument(
+            "--update-golden-frames",
+            action="store_true",
+            help="Record the CRCs of the rendered LCD frames in the golden "
+            "frames file, rather than comparing against it.",
+        )
+
         subparsers = parser.add_subparsers(required=True)
 
         fpga_parser = subparsers.add_parser("fpga", help="Run test on FPGA")
@@ -123,6 +188,12 @@ class Config(argparse.Namespace):
             type=Path,
             help="The simulator boot stub location",
         )
+        sim_parser.add_argument(
+            "--launcher",
+            type=Path,
+            help="A script to start the simulator with, such as "
+            "scripts/run_sim.sh, which is passed the elf file.",
+        )
         sim_parser.add_argument(
             "--uart-log",
             type=Path,
@@ -133,7 +204,14 @@ class Config(argparse.Namespace):
         # Set the attributs of this object from the program arguments
         parser.parse_args(namespace=self)
 
-        if not self.fpga:
+        if self.update_baseline and not self.baseline:
+            print("--update-baseline requires --baseline")
+            exit(ReturnCode.BAD_INPUT)
+        if self.update_golden_frames and not self.golden_frames:
+            print("--update-golden-frames requires --golden-frames")
+            exit(ReturnCode.BAD_INPUT)
+
+        if not self.fpga and not self.launcher:
             if not self.simulator_binary:
                 self.simulator_binary: Path = Path(
                     str(binary)
@@ -147,11 +225,18 @@ class Config(argparse.Namespace):
                     print("No simulator boot stub found")
                     exit(ReturnCode.BAD_INPUT)
 
-        for path in (
-            (self.uf2_file, self.tty)
-            if self.fpga
-            else (self.simulator_binary, self.sim_boot_stub, self.elf_file)
-        ):
+        paths: list[Path | str]
+        if self.fpga:
+            paths = [self.uf2_file, self.tty]
+        elif self.launcher:
+            paths = [self.launcher, self.elf_file]
+        else:
+            paths = [self.simulator_binary, self.sim_boot_stub, self.elf_file]
+        if self.baseline and not self.update_baseline:
+            paths.append(self.baseline)
+        if self.golden_frames and not self.update_golden_frames:
+            paths.append(self.golden_frames)
+        for path in paths:
             if not os.path.exists(path):  # noqa: PTH110
                 print(f"'{path}' doesn't exist.")
                 exit(ReturnCode.BAD_INPUT)
@@ -162,13 +247,16 @@ def run_simulator(config: Config) -> None:
 
     The process is killed if `main_finished` is set.
     """
-    command = [
-        config.simulator_binary,
-        "-E",
-        config.sim_boot_stub,
-        "-E",
-        config.elf_file,
-    ]
+    if config.launcher:
+        command = [config.launcher.absolute(), config.elf_file]
+    else:
+        command = [
+            config.simulator_binary,
+            "-E",
+            config.sim_boot_stub,
+            "-E",
+            config.elf_file,
+        ]
     with Popen(command, stdout=PIPE, stderr=PIPE) as proc:
         while True:
             if (code := proc.poll()) is not None:
@@ -217,8 +305,13 @@ def watch_output(config: Config) -> None:
     lines = simulation_readlines() if not config.fpga else fpga_readlines()
     for line in lines:
         sys.stdout.write(line)
-        if PASSED_MESSAGE in line:
-            return_code.put(ReturnCode.TESTS_PASSED)
+        record_bench_line(line)
+        record_frame_line(line)
+        if any(message in line for message in PASSED_MESSAGES):
+            codes = (finish_benchmarks(config), finish_frames(config))
+            return_code.put(
+                next((code for code in codes if code), ReturnCode.TESTS_PASSED)
+            )
             break
         if FAILED_MESSAGE in line:
             return_code.put(ReturnCode.TESTS_FAILED)
@@ -226,6 +319,152 @@ def watch_output(config: Config) -> None:
         time.sleep(TICK_SECONDS)
 
 
+def parse_integer(value: str) -> int:
+    """Parses a value of a result line.
+
+    The benchmarks print their values in decimal, but the RTOS's debug log
+    prints unsigned integers in hexadecimal, so both are accepted.
+    """
+    if value.startswith("0x"):
+        return int(value, 16)
+    return int(value)
+
+
+def record_bench_line(line: str) -> None:
+    """Records the values of a benchmark result line, if it is one."""
+    if match := BENCH_PATTERN.search(ANSI_ESCAPE_PATTERN.sub("", line)):
+        values = bench_results.setdefault(match.group(1), {})
+        for pair in match.group(2).split():
+            key, value = pair.split("=")
+            values[key] = parse_integer(value)
+
+
+def record_frame_line(line: str) -> None:
+    """Records the CRC of a rendered LCD frame, if the line reports one."""
+    if match := FRAME_PATTERN.search(ANSI_ESCAPE_PATTERN.sub("", line)):
+        frame_crcs[match.group(1)] = match.group(2)
+
+
+def compare_to_baseline(
+    results: dict[str, dict[str, int]], baseline: dict[str, Any]
+) -> list[str]:
+    """Describes each benchmark value that regressed against the baseline.
+
+    Each benchmark in the baseline lists the values it is compared on and an
+    optional fractional `tolerance`, which defaults to the baseline's
+    `default_tolerance`.
+    """
+    default_tolerance = baseline.get("default_tolerance", DEFAULT_TOLERANCE)
+    regressions = []
+    for name, expected in baseline.get("benchmarks", {}).items():
+        tolerance = expected.get("tolerance", default_tolerance)
+        measured = results.get(name, {})
+        for metric, value in expected.items():
+            if metric == "tolerance":
+                continue
+            if metric not in measured:
+                regressions.append(f"{name}: {metric} was not reported")
+                continue
+            actual = measured[metric]
+            if metric.endswith(HIGHER_IS_BETTER_SUFFIX):
+                regressed = actual < value * (1 - tolerance)
+            else:
+                regressed = actual > value * (1 + tolerance)
+            if regressed:
+                regressions.append(
+                    f"{name}: {metric} is {actual}, the baseline is {value} "
+                    f"with a tolerance of {tolerance:.0%}"
+                )
+    return regressions
+
+
+def update_baseline(
+    results: dict[str, dict[str, int]], baseline: dict[str, Any]
+) -> dict[str, Any]:
+    """Records the results as the new baseline values.
+
+    Benchmarks keep the metrics they are already compared on and their
+    tolerances. New benchmarks are compared on their median cycle count and
+    any rates they report.
+    """
+    benchmarks = baseline.setdefault("benchmarks", {})
+    for name, measured in sorted(results.items()):
+        entry = benchmarks.setdefault(name, {})
+        metrics = [m for m in entry if m != "tolerance"] or [
+            m
+            for m in measured
+            if m in DEFAULT_BASELINE_METRICS
+            or m.endswith(HIGHER_IS_BETTER_SUFFIX)
+        ]
+        for metric in metrics:
+            if metric in measured:
+                entry[metric] = measured[metric]
+    return baseline
+
+
+def finish_benchmarks(config: Config) -> ReturnCode:
+    """Saves and checks the collected benchmark results, if requested."""
+    if config.bench_output:
+        config.bench_output.write_text(
+            json.dumps(bench_results, indent=2, sort_keys=True) + "\n"
+        )
+    if not config.baseline:
+        return ReturnCode.TESTS_PASSED
+
+    baseline: dict[str, Any] = (
+        json.loads(config.baseline.read_text())
+        if config.baseline.exists()
+        else {}
+    )
+    if config.update_baseline:
+        config.baseline.write_text(
+            json.dumps(update_baseline(bench_results, baseline), indent=2)
+            + "\n"
+        )
+        return ReturnCode.TESTS_PASSED
+
+    regressions = compare_to_baseline(bench_results, baseline)
+    for regression in regressions:
+        print(f"Regression: {regression}")
+    if regressions:
+        return ReturnCode.PERFORMANCE_REGRESSION
+    return ReturnCode.TESTS_PASSED
+
+
+def finish_frames(config: Config) -> ReturnCode:
+    """Checks the CRCs of the rendered LCD frames, if requested.
+
+    Frames without a golden CRC are reported but don't fail the run, and
+    neither do golden frames that weren't rendered, as not every firmware
+    renders every frame.
+    """
+    if not config.golden_frames:
+        return ReturnCode.TESTS_PASSED
+
+    golden: dict[str, str] = (
+        json.loads(config.golden_frames.read_text())
+        if config.golden_frames.exists()
+        else {}
+    )
+    if config.update_golden_frames:
+        golden.update(frame_crcs)
+        config.golden_frames.write_text(
+            json.dumps(golden, indent=2, sort_keys=True) + "\n"
+        )
+        return ReturnCode.TESTS_PASSED
+
+    mismatched = False
+    for name, crc in sorted(frame_crcs.items()):
+        if name not in golden:
+            print(f"Frame {name}: crc={crc} has no golden CRC")
+        elif golden[name] != crc:
+            print(f"Frame {name}: crc={crc}, the golden CRC is {golden[name]}")
+            mismatched = True
+    if mismatched:
+        return ReturnCode.FRAME_MISMATCH
+    return ReturnCode.TESTS_PASSED
+
+
 def watchdog(config: Config) -> None:
     """Sleeps for the configured time before triggering a timeout."""
     time.sleep(config.timeout)
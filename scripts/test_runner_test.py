@@ -0,0 +1,107 @@
+# Copyright lowRISC Contributors.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Tests of the result line parsing of test_runner.py.
+
+Run with `python3 -m unittest discover -s scripts -p '*_test.py'`.
+"""
+
+import unittest
+
+import test_runner
+
+# Lines as the RTOS's debug log prints them, with the coloured context name.
+DECIMAL_LINE = (
+    "\x1b[32;1mBenchmark\x1b[0m: bench name=lcd.clean iterations=16 "
+    "cycles_min=1843200 cycles_median=1843264 cycles_max=1850112 "
+    "instret_min=40960 instret_median=40960 instret_max=40961"
+)
+HEX_LINE = (
+    "\x1b[32;1mBenchmark\x1b[0m: bench name=lcd.clean iterations=0x10 "
+    "cycles_min=0x1c2000 cycles_median=0x1c2040 cycles_max=0x1c3b00 "
+    "instret_min=0xa000 instret_median=0xa000 instret_max=0xa001"
+)
+METRIC_LINE = (
+    "\x1b[32;1mBenchmark\x1b[0m: bench name=lcd.clean pixels_per_s=1234567"
+)
+
+# The lines of an Ethernet round trip benchmark in which two frames were lost.
+ETHERNET_LINES = (
+    "\x1b[32;1mBenchmark\x1b[0m: bench name=ethernet.loopback.poll.rtt.60 "
+    "iterations=14 cycles_min=11800 cycles_median=12345 cycles_max=13000 "
+    "instret_min=400 instret_median=401 instret_max=402",
+    "\x1b[32;1mBenchmark\x1b[0m: bench name=ethernet.loopback.poll.rtt.60 "
+    "rtt_ns=308625",
+    "\x1b[32;1mBenchmark\x1b[0m: bench name=ethernet.loopback.poll.rtt.60 "
+    "lost_frames=2",
+)
+
+
+class RecordBenchLineTest(unittest.TestCase):
+    def setUp(self) -> None:
+        test_runner.bench_results.clear()
+
+    def test_decimal_line(self) -> None:
+        test_runner.record_bench_line(DECIMAL_LINE)
+        test_runner.record_bench_line(METRIC_LINE)
+        self.assertEqual(
+            test_runner.bench_results["lcd.clean"],
+            {
+                "iterations": 16,
+                "cycles_min": 1843200,
+                "cycles_median": 1843264,
+                "cycles_max": 1850112,
+                "instret_min": 40960,
+                "instret_median": 40960,
+                "instret_max": 40961,
+                "pixels_per_s": 1234567,
+            },
+        )
+
+    def test_hex_line(self) -> None:
+        test_runner.record_bench_line(HEX_LINE)
+        test_runner.record_bench_line(DECIMAL_LINE.replace("clean", "fill"))
+        self.assertEqual(
+            test_runner.bench_results["lcd.clean"],
+            test_runner.bench_results["lcd.fill"],
+        )
+
+    def test_other_lines(self) -> None:
+        test_runner.record_bench_line("bench: no results here")
+        self.assertEqual(test_runner.bench_results, {})
+
+    def test_regression(self) -> None:
+        test_runner.record_bench_line(DECIMAL_LINE)
+        baseline = {"benchmarks": {"lcd.clean": {"cycles_median": 1600000}}}
+        self.assertEqual(
+            len(
+                test_runner.compare_to_baseline(
+                    test_runner.bench_results, baseline
+                )
+            ),
+            1,
+        )
+        baseline["benchmarks"]["lcd.clean"]["cycles_median"] = 1843264
+        self.assertEqual(
+            test_runner.compare_to_baseline(
+                test_runner.bench_results, baseline
+            ),
+            [],
+        )
+
+    def test_lost_frames(self) -> None:
+        for line in ETHERNET_LINES:
+            test_runner.record_bench_line(line)
+        results = test_runner.bench_results["ethernet.loopback.poll.rtt.60"]
+        self.assertEqual(results["cycles_median"], 12345)
+        self.assertEqual(results["rtt_ns"], 308625)
+        self.assertEqual(results["lost_frames"], 2)
+        baseline = test_runner.update_baseline(test_runner.bench_results, {})
+        self.assertEqual(
+            baseline["benchmarks"]["ethernet.loopback.poll.rtt.60"],
+            {"cycles_median": 12345},
+        )
+
+
+if __name__ == "__main__":
+    unittest.main()
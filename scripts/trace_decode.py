@@ -0,0 +1,258 @@
+# Copyright lowRISC Contributors.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Sonata Trace Decoder
+
+Turns the binary event records written by `libraries/trace.hh` back into
+readable log lines. The format strings are found by scanning the source tree
+for `event<"...">` call sites and hashing them the same way the firmware does.
+Any text written to the UART between records, such as `Debug::log` output, is
+passed through unchanged.
+"""
+
+import argparse
+import re
+import sys
+from collections.abc import Iterable, Iterator
+from dataclasses import dataclass
+from pathlib import Path
+from typing import BinaryIO
+
+SYNC: bytes = b"\xa5\x5a"
+HEADER_BYTES: int = 2 + 4 + 4
+SOURCE_SUFFIXES: tuple[str, ...] = (".cc", ".hh", ".cpp", ".h")
+DEFAULT_SOURCES: tuple[str, ...] = (
+    "benchmarks",
+    "examples",
+    "exercises",
+    "libraries",
+    "tests",
+)
+DROPPED_FORMAT: str = "trace: {} records dropped"
+"""Emitted by `Tracer::flush` and not written at any call site."""
+
+EVENT_PATTERN = re.compile(r'event\s*<\s*"((?:[^"\\]|\\.)*)"\s*>')
+PLACEHOLDER_PATTERN = re.compile(r"\{(x?)\}")
+BAUD_RATE: int = 921600
+
+
+def format_id(format_string: str) -> int:
+    """The 32-bit FNV-1a hash used as a format string's identifier."""
+    value = 0x811C9DC5
+    for byte in format_string.encode():
+        value ^= byte
+        value = (value * 0x01000193) & 0xFFFFFFFF
+    return value
+
+
+def unescape(literal: str) -> str:
+    """Interprets the escape sequences of a C string literal."""
+    return literal.encode().decode("unicode_escape")
+
+
+def collect_formats(roots: Iterable[Path]) -> dict[int, str]:
+    """Finds every trace format string in the given source directories."""
+    formats = {format_id(DROPPED_FORMAT): DROPPED_FORMAT}
+    for root in roots:
+        for path in sorted(root.rglob("*")):
+            if path.suffix not in SOURCE_SUFFIXES or not path.is_file():
+                continue
+            source = path.read_text(errors="replace")
+            for match in EVENT_PATTERN.finditer(source):
+                string = unescape(match.group(1))
+                identifier = format_id(string)
+                if formats.get(identifier, string) != string:
+                    print(
+                        f"warning: '{string}' in {path} has the same ID as "
+                        f"'{formats[identifier]}'",
+                        file=sys.stderr,
+                    )
+                formats[identifier] = string
+    return formats
+
+
+@dataclass
+class Event:
+    """A decoded trace record."""
+
+    thread: int
+    format_id: int
+    timestamp: int
+    arguments: list[int]
+
+
+def parse(chunks: Iterable[bytes]) -> Iterator[Event | str]:
+    """Splits a UART byte stream into trace records and lines of text.
+
+    Records are recognised by their sync bytes and checked against their
+    checksum. Bytes that don't form a valid record are treated as text.
+    """
+    buffer = bytearray()
+    text = bytearray()
+
+    def take_text(end: int) -> Iterator[str]:
+        text.extend(buffer[:end])
+        del buffer[:end]
+        while (newline := text.find(b"\n")) != -1:
+            yield text[: newline + 1].decode(errors="replace")
+            del text[: newline + 1]
+
+    for chunk in chunks:
+        buffer.extend(chunk)
+        while True:
+            start = buffer.find(SYNC)
+            if start == -1:
+                # Keep a trailing byte in case it starts the next sync.
+                yield from take_text(max(len(buffer) - 1, 0))
+                break
+            yield from take_text(start)
+            if len(buffer) < 3:
+                break
+            length = buffer[2]
+            if len(buffer) < 3 + length + 1:
+                break
+            body = bytes(buffer[3 : 3 + length])
+            checksum = buffer[3 + length]
+            if (
+                length < HEADER_BYTES
+                or (length - HEADER_BYTES) % 4 != 0
+                or sum(body) & 0xFF != checksum
+            ):
+                yield from take_text(1)
+                continue
+            del buffer[: 3 + length + 1]
+            yield Event(
+                thread=int.from_bytes(body[0:2], "little"),
+                format_id=int.from_bytes(body[2:6], "little"),
+                timestamp=int.from_bytes(body[6:10], "little"),
+                arguments=[
+                    int.from_bytes(body[i : i + 4], "little")
+                    for i in range(HEADER_BYTES, length, 4)
+                ],
+            )
+    text.extend(buffer)
+    if text:
+        yield text.decode(errors="replace")
+
+
+def render(event: Event, formats: dict[int, str]) -> str:
+    """Substitutes an event's arguments into its format string."""
+    string = formats.get(event.format_id)
+    if string is None:
+        arguments = ", ".join(str(a) for a in event.arguments)
+        return f"<unknown event {event.format_id:#010x}: {arguments}>"
+    arguments = iter(event.arguments)
+
+    def substitute(match: re.Match[str]) -> str:
+        value = next(arguments, None)
+        if value is None:
+            return match.group(0)
+        return f"{value:#x}" if match.group(1) else str(value)
+
+    return PLACEHOLDER_PATTERN.sub(substitute, string)
+
+
+class Timeline:
+    """Extends the 32-bit cycle count timestamps of each thread to 64 bits.
+
+    This relies on every thread flushing at least once per counter wrap.
+    A timestamp more than half the counter's range before the previous one
+    is taken to have wrapped.
+    """
+
+    def __init__(self) -> None:
+        self.last: dict[int, int] = {}
+        self.epoch: dict[int, int] = {}
+
+    def extend(self, event: Event) -> int:
+        epoch = self.epoch.get(event.thread, 0)
+        if self.last.get(event.thread, 0) - event.timestamp > 1 << 31:
+            epoch += 1 << 32
+            self.epoch[event.thread] = epoch
+        self.last[event.thread] = event.timestamp
+        return epoch + event.timestamp
+
+
+def read_file(stream: BinaryIO) -> Iterator[bytes]:
+    """Reads a file or pipe in chunks until it ends."""
+    while chunk := stream.read1(4096):
+        yield chunk
+
+
+def read_serial(tty: str, baud: int) -> Iterator[bytes]:
+    """Reads from a serial port forever."""
+    import serial
+
+    with serial.Serial(tty, baud, timeout=0.1) as uart:
+        while True:
+            if chunk := uart.read(4096):
+                yield chunk
+
+
+class Config(argparse.Namespace):
+    """Configuration of the trace decoder."""
+
+    def __init__(self) -> None:
+        parser = argparse.ArgumentParser()
+        parser.add_argument(
+            "input",
+            type=Path,
+            nargs="?",
+            help="A UART log to decode, such as the simulator's uart0.log. "
+            "Reads standard input if neither this nor --tty is given.",
+        )
+        parser.add_argument("--tty", type=str, help="A serial port to read")
+        parser.add_argument(
+            "--baud",
+            type=int,
+            default=BAUD_RATE,
+            help="The baud rate of the serial port",
+        )
+        parser.add_argument(
+            "-s",
+            "--source",
+            type=Path,
+            action="append",
+            help="A directory to search for format strings. "
+            "Defaults to the directories of this repository.",
+        )
+        parser.add_argument(
+            "--cpu-hz",
+            type=int,
+            help="Show timestamps in microseconds rather than cycles",
+        )
+        parser.parse_args(namespace=self)
+
+        if not self.source:
+            root = Path(__file__).resolve().parent.parent
+            self.source: list[Path] = [root / d for d in DEFAULT_SOURCES]
+
+
+def main(config: Config) -> None:
+    formats = collect_formats(p for p in config.source if p.is_dir())
+    timeline = Timeline()
+
+    if config.tty:
+        chunks = read_serial(config.tty, config.baud)
+    elif config.input:
+        chunks = read_file(config.input.open("rb"))
+    else:
+        chunks = read_file(sys.stdin.buffer)
+
+    for item in parse(chunks):
+        if isinstance(item, str):
+            sys.stdout.write(item)
+            continue
+        time = timeline.extend(item)
+        if config.cpu_hz:
+            stamp = f"{time * 1_000_000 // config.cpu_hz:>12}us"
+        else:
+            stamp = f"{time:>14}"
+        sys.stdout.write(
+            f"[{stamp} T{item.thread}] {render(item, formats)}\n"
+        )
+        sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main(Config())
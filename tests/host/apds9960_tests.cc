@@ -0,0 +1,140 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "apds9960_tests.hh"
+#include "../../libraries/apds9960.hh"
+#include "host_test.hh"
+#include <compartment.h>
+#include <platform-i2c.hh>
+#include <vector>
+
+using sonata::mock::Transaction;
+using sonata::test::check;
+
+static OpenTitanI2c *i2c()
+{
+	return MMIO_CAPABILITY(OpenTitanI2c, i2c0);
+}
+
+static void reset_i2c()
+{
+	*i2c() = OpenTitanI2c{};
+}
+
+/// Returns true if `bytes` were written to the sensor at some point.
+static bool was_written(std::vector<uint8_t> bytes)
+{
+	for (const Transaction &Transfer : i2c()->recorder.transactions)
+	{
+		if (Transfer.kind == Transaction::Kind::Write &&
+		    Transfer.target == Apds9960::Address && Transfer.data == bytes)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool init_test()
+{
+	reset_i2c();
+	i2c()->recorder.respond({0xAB});
+	Apds9960 sensor(0, 100);
+	return check(sensor.init(), "init succeeds") &&
+	       check(was_written({0x89, 0}) && was_written({0x8B, 8, 0x20}),
+	             "the window starts around nothing being near") &&
+	       check(was_written({0x8E, 0x04, 0x0C}),
+	             "consecutive registers are written together") &&
+	       check(i2c()->recorder.transactions.back().data ==
+	               std::vector<uint8_t>{0x80, 0x2D},
+	             "the proximity interrupt is enabled last");
+}
+
+static bool wrong_id_test()
+{
+	reset_i2c();
+	i2c()->recorder.respond({0x12});
+	Apds9960 sensor(0, 100);
+	return check(!sensor.init(), "init fails") &&
+	       check(!was_written({0x80, 0x2D}), "the sensor isn't enabled");
+}
+
+static bool absent_test()
+{
+	reset_i2c();
+	i2c()->absentAddresses.insert(Apds9960::Address);
+	Apds9960 sensor(0, 100);
+	uint8_t  proximity;
+	return check(!sensor.init(), "init fails") &&
+	       check(!sensor.acknowledge(&proximity), "acknowledge fails") &&
+	       check(!sensor.interrupt_pending(), "no interrupt is pending");
+}
+
+static bool interrupt_pending_test()
+{
+	reset_i2c();
+	i2c()->recorder.respond({0x20, 0x02});
+	Apds9960   sensor(0, 100);
+	const bool Raised    = sensor.interrupt_pending();
+	const bool NotRaised = !sensor.interrupt_pending();
+	return check(Raised, "the interrupt is seen in the status") &&
+	       check(NotRaised, "other status bits are ignored") &&
+	       check(i2c()->recorder.transactions.size() == 4,
+	             "each check is a single write and read");
+}
+
+static bool acknowledge_test()
+{
+	reset_i2c();
+	i2c()->recorder.respond({100, 250, 3});
+	Apds9960 sensor(0, 100);
+	uint8_t  proximity = 0;
+	if (!check(sensor.acknowledge(&proximity) && proximity == 100,
+	           "the proximity is read") ||
+	    !check(was_written({0x89, 92}) && was_written({0x8B, 108}),
+	           "the window is centred on the proximity") ||
+	    !check(i2c()->recorder.transactions.back().data ==
+	             std::vector<uint8_t>{0xE5},
+	           "the interrupt is cleared"))
+	{
+		return false;
+	}
+	i2c()->recorder.transactions.clear();
+	sensor.acknowledge(&proximity);
+	if (!check(was_written({0x89, 242}) && was_written({0x8B, 255}),
+	           "the window stops at the highest proximity"))
+	{
+		return false;
+	}
+	sensor.acknowledge(&proximity);
+	return check(was_written({0x89, 0}) && was_written({0x8B, 11}),
+	             "the window stops at the lowest proximity");
+}
+
+static bool unchanged_window_test()
+{
+	reset_i2c();
+	i2c()->recorder.respond({50, 50});
+	Apds9960 sensor(0, 100);
+	uint8_t  proximity = 0;
+	sensor.acknowledge(&proximity);
+	i2c()->recorder.transactions.clear();
+	sensor.acknowledge(&proximity);
+	return check(!was_written({0x89, 42}) && !was_written({0x8B, 58}),
+	             "an unchanged window isn't written again") &&
+	       check(i2c()->recorder.transactions.size() == 3,
+	             "only the proximity is read and the interrupt cleared");
+}
+
+bool apds9960_tests()
+{
+	const sonata::test::TestCase Tests[] = {
+	  {"APDS9960 init test", init_test},
+	  {"APDS9960 wrong ID test", wrong_id_test},
+	  {"APDS9960 absent test", absent_test},
+	  {"APDS9960 interrupt pending test", interrupt_pending_test},
+	  {"APDS9960 acknowledge test", acknowledge_test},
+	  {"APDS9960 unchanged window test", unchanged_window_test},
+	};
+	return sonata::test::run_tests(Tests);
+}
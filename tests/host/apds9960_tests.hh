@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Tests the APDS9960 proximity sensor driver against a mock I2C controller.
+bool apds9960_tests();
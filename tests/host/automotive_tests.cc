@@ -0,0 +1,336 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "automotive_tests.hh"
+#include "../../examples/automotive/lib/automotive_common.h"
+#include "../../examples/automotive/lib/automotive_menu.h"
+#include "../../examples/automotive/lib/no_pedal.h"
+#include "host_test.hh"
+#include <algorithm>
+#include <compartment.h>
+
+using sonata::mock::Ethernet;
+using sonata::mock::Transaction;
+using sonata::test::check;
+
+/// The length of the Ethernet header and frame type that start each frame.
+static constexpr size_t FramePreambleLength = sizeof(EthernetHeader) + 1;
+
+static Ethernet *ethernet()
+{
+	return MMIO_CAPABILITY(Ethernet, ethernet);
+}
+
+static void send_nothing(const char *format, ...) {}
+
+static uint64_t wait_until(const uint64_t EndTime)
+{
+	return EndTime;
+}
+
+static uint64_t time_zero()
+{
+	return 0;
+}
+
+static void do_nothing() {}
+
+static void record_frame(const uint8_t *buffer, uint16_t length)
+{
+	ethernet()->send_frame(buffer, length);
+}
+
+static void draw_nothing(void       *lcd,
+                         uint32_t    x,
+                         uint32_t    y,
+                         LcdFont     font,
+                         const char *format,
+                         uint32_t    backgroundColour,
+                         uint32_t    textColour,
+                         ...)
+{
+}
+
+/**
+ * Sets up callbacks that record transmitted frames, draw nothing and never
+ * wait.
+ */
+static void init_recording_callbacks()
+{
+	*ethernet() = Ethernet{};
+
+	AutomotiveCallbacks recordingCallbacks = {};
+	recordingCallbacks.uart_send           = send_nothing;
+	recordingCallbacks.wait                = wait_until;
+	recordingCallbacks.waitTime            = 1;
+	recordingCallbacks.time                = time_zero;
+	recordingCallbacks.cycles              = time_zero;
+	recordingCallbacks.loop                = do_nothing;
+	recordingCallbacks.start               = do_nothing;
+	recordingCallbacks.ethernet_transmit   = record_frame;
+	recordingCallbacks.lcd.draw_str        = draw_nothing;
+	init_callbacks(recordingCallbacks);
+}
+
+/**
+ * Reads the big-endian 64-bit value at `offset` in a frame.
+ */
+static uint64_t frame_value(const Transaction &Frame, size_t offset)
+{
+	uint64_t value = 0;
+	for (size_t i = 0; i < 8; i++)
+	{
+		value = (value << 8) | Frame.data[offset + i];
+	}
+	return value;
+}
+
+static bool joystick_test()
+{
+	const uint8_t Joystick = Up | Pressed;
+	return check(joystick_in_direction(Joystick, Up), "up is detected") &&
+	       check(joystick_in_direction(Joystick, Pressed),
+	             "pressed is detected") &&
+	       check(!joystick_in_direction(Joystick, Down),
+	             "down isn't detected");
+}
+
+static bool mode_frame_test()
+{
+	init_recording_callbacks();
+	send_mode_frame(FixedDemoHeader, DemoModeSimulated);
+
+	auto &frames = ethernet()->recorder.transactions;
+	if (!check(frames.size() == 1, "one frame is sent"))
+	{
+		return false;
+	}
+	const Transaction &Frame = frames[0];
+	return check(Frame.data.size() == FramePreambleLength + 1,
+	             "the frame holds one byte of data") &&
+	       check(std::equal(Frame.data.begin(),
+	                        Frame.data.begin() + sizeof(EthernetHeader),
+	                        reinterpret_cast<const uint8_t *>(
+	                          &FixedDemoHeader)),
+	             "the frame starts with the header") &&
+	       check(Frame.data[FramePreambleLength - 1] == FrameDemoMode,
+	             "the frame is a demo mode frame") &&
+	       check(Frame.data[FramePreambleLength] == DemoModeSimulated,
+	             "the mode is sent");
+}
+
+static bool data_frame_test()
+{
+	init_recording_callbacks();
+	const uint64_t Data[2] = {0x0123456789ABCDEF, 42};
+	send_data_frame(Data, FixedDemoHeader, 2);
+
+	auto &frames = ethernet()->recorder.transactions;
+	if (!check(frames.size() == 1, "one frame is sent"))
+	{
+		return false;
+	}
+	const Transaction &Frame = frames[0];
+	return check(Frame.data.size() == FramePreambleLength + 16,
+	             "the frame holds two 64-bit values") &&
+	       check(Frame.data[FramePreambleLength - 1] == FramePedalData,
+	             "the frame is a pedal data frame") &&
+	       check(frame_value(Frame, FramePreambleLength) == Data[0] &&
+	               frame_value(Frame, FramePreambleLength + 8) == Data[1],
+	             "the values are sent big-endian");
+}
+
+/**
+ * Runs the whole "No Pedal" demo, in which task two overflows its array into
+ * task one's memory, and checks that the overwritten acceleration is sent.
+ */
+static bool no_pedal_demo_test()
+{
+	init_recording_callbacks();
+	struct
+	{
+		TaskTwo taskTwo;
+		TaskOne taskOne;
+	} memory = {};
+	init_no_pedal_demo_mem(&memory.taskOne, &memory.taskTwo);
+	run_no_pedal_demo(0);
+
+	auto &frames = ethernet()->recorder.transactions;
+	if (!check(frames.size() == 1 + 175, "a frame is sent per iteration"))
+	{
+		return false;
+	}
+	return check(frames[0].data[FramePreambleLength - 1] == FrameDemoMode &&
+	               frames[0].data[FramePreambleLength] == DemoModePassthrough,
+	             "the demo starts in passthrough mode") &&
+	       check(frame_value(frames[1], FramePreambleLength) == 15,
+	             "the initial acceleration is sent") &&
+	       check(frame_value(frames.back(), FramePreambleLength) == 1000,
+	             "the overwritten acceleration is sent");
+}
+
+/// A change of the joystick's input at a time, for scripting the menu.
+struct JoystickStep
+{
+	uint64_t time;
+	uint8_t  joystick;
+};
+
+/// The scripted joystick and what the menu has done with it.
+static struct
+{
+	const JoystickStep *steps;
+	size_t              stepCount;
+	size_t              nextStep;
+	uint8_t             joystick;
+	uint64_t            time;
+	uint32_t            waits;
+	uint32_t            cursorDraws;
+	uint32_t            cursorClears;
+} menuScript;
+
+static uint64_t menu_time()
+{
+	return menuScript.time;
+}
+
+static uint8_t menu_joystick_read()
+{
+	return menuScript.joystick;
+}
+
+/**
+ * Moves time on to the next step of the script, or to `endTime` if that's
+ * sooner. Once the script runs out, the joystick is pressed, so that a menu
+ * that is still waiting always returns.
+ */
+static uint8_t menu_joystick_wait(uint64_t endTime)
+{
+	menuScript.waits++;
+	if (menuScript.nextStep == menuScript.stepCount)
+	{
+		menuScript.joystick = Pressed;
+	}
+	else if (menuScript.steps[menuScript.nextStep].time <= endTime)
+	{
+		const JoystickStep &Step = menuScript.steps[menuScript.nextStep++];
+		menuScript.time          = Step.time;
+		menuScript.joystick      = Step.joystick;
+	}
+	else
+	{
+		menuScript.time = endTime;
+	}
+	return menuScript.joystick;
+}
+
+static void clean_nothing(void *lcd, uint32_t color) {}
+
+static void count_cursor_clears(void    *lcd,
+                                uint32_t x,
+                                uint32_t y,
+                                uint32_t w,
+                                uint32_t h,
+                                uint32_t color)
+{
+	menuScript.cursorClears++;
+}
+
+static void count_cursor_draws(void          *lcd,
+                               uint32_t       x,
+                               uint32_t       y,
+                               uint32_t       w,
+                               uint32_t       h,
+                               const uint8_t *data)
+{
+	menuScript.cursorDraws++;
+}
+
+/**
+ * Runs the menu with the joystick starting at `joystick` and then following
+ * `steps`, with updates every 100 time units, and returns the demo that is
+ * selected.
+ */
+template<size_t N>
+static DemoApplication run_menu(const JoystickStep (&steps)[N],
+                                uint8_t joystick = 0)
+{
+	menuScript           = {};
+	menuScript.steps     = steps;
+	menuScript.stepCount = N;
+	menuScript.joystick  = joystick;
+
+	AutomotiveCallbacks menuCallbacks = {};
+	menuCallbacks.uart_send           = send_nothing;
+	menuCallbacks.waitTime            = 100;
+	menuCallbacks.time                = menu_time;
+	menuCallbacks.joystick_read       = menu_joystick_read;
+	menuCallbacks.joystick_wait       = menu_joystick_wait;
+	menuCallbacks.lcd.draw_str        = draw_nothing;
+	menuCallbacks.lcd.clean           = clean_nothing;
+	menuCallbacks.lcd.fill_rect       = count_cursor_clears;
+	menuCallbacks.lcd.draw_img_rgb565 = count_cursor_draws;
+	init_callbacks(menuCallbacks);
+	return select_demo();
+}
+
+static bool menu_select_test()
+{
+	// Down twice and up once, each released before it repeats, then select.
+	const JoystickStep Steps[] = {
+	  {10, Left},
+	  {20, 0},
+	  {30, Left},
+	  {40, 0},
+	  {50, Right},
+	  {60, 0},
+	  {70, Pressed},
+	};
+	return check(run_menu(Steps) == DemoDigitalPedal,
+	             "the second option is selected") &&
+	       check(menuScript.waits == 7, "the menu waits once per input") &&
+	       check(menuScript.cursorDraws == 1 + 3 &&
+	               menuScript.cursorClears == 1 + 3,
+	             "only the cursor is redrawn when it moves");
+}
+
+static bool menu_repeat_test()
+{
+	// Down is held for long enough to repeat twice, 300 after it's moved
+	// and then 100 after that.
+	const JoystickStep Steps[] = {
+	  {10, Left},
+	  {460, 0},
+	  {500, Pressed},
+	};
+	return check(run_menu(Steps) == DemoNoPedal,
+	             "a held direction repeats") &&
+	       check(menuScript.waits == 5,
+	             "the menu waits for each repeat rather than spinning");
+}
+
+static bool menu_held_press_test()
+{
+	// The press from the end of the last demo is still held at the start.
+	const JoystickStep Steps[] = {
+	  {10, Pressed | Left},
+	  {20, 0},
+	  {30, Pressed},
+	};
+	return check(run_menu(Steps, Pressed) == DemoDigitalPedal,
+	             "a press held from before the menu doesn't select");
+}
+
+bool automotive_tests()
+{
+	const sonata::test::TestCase Tests[] = {
+	  {"automotive joystick test", joystick_test},
+	  {"automotive mode frame test", mode_frame_test},
+	  {"automotive data frame test", data_frame_test},
+	  {"automotive no pedal demo test", no_pedal_demo_test},
+	  {"automotive menu select test", menu_select_test},
+	  {"automotive menu repeat test", menu_repeat_test},
+	  {"automotive menu held press test", menu_held_press_test},
+	};
+	return sonata::test::run_tests(Tests);
+}
@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Tests the automotive demo library with recording callbacks.
+bool automotive_tests();
@@ -0,0 +1,128 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "cpu_accounting_tests.hh"
+#include "../../libraries/cpu_accounting.hh"
+#include "host_test.hh"
+#include <string.h>
+
+using namespace sonata::cpu_accounting;
+using sonata::test::check;
+
+static bool ledger_test()
+{
+	Ledger ledger;
+	const bool Sampled = ledger.thread_sample(1, "first", 100) &&
+	                     ledger.thread_sample(3, "third", 300) &&
+	                     ledger.thread_sample(1, "first", 150);
+	const bool Rejected =
+	  !ledger.thread_sample(0, "none", 0) &&
+	  !ledger.thread_sample(CpuAccountingMaxThreads + 1, "none", 0);
+	CpuAccountingSnapshot snapshot;
+	ledger.snapshot(&snapshot);
+	return check(Sampled, "threads in range are sampled") &&
+	       check(Rejected, "threads out of range are rejected") &&
+	       check(strcmp(snapshot.threads[0].name, "first") == 0 &&
+	               snapshot.threads[0].cycles == 150 &&
+	               snapshot.threads[0].samples == 2,
+	             "a thread keeps its latest count") &&
+	       check(snapshot.threads[1].name[0] == '\0' &&
+	               snapshot.threads[1].samples == 0,
+	             "threads that haven't reported are empty") &&
+	       check(strcmp(snapshot.threads[2].name, "third") == 0,
+	             "threads are kept by their ID");
+}
+
+static bool compartment_test()
+{
+	Ledger ledger;
+	ledger.compartment_add("a_compartment_with_a_long_name", 10);
+	ledger.compartment_add("other", 5);
+	ledger.compartment_add("a_compartment_with_a_long_name", 20);
+	CpuAccountingSnapshot snapshot;
+	ledger.snapshot(&snapshot);
+	const bool Added = strcmp(snapshot.compartments[0].name,
+	                          "a_compartment_with_") == 0 &&
+	                   snapshot.compartments[0].cycles == 30 &&
+	                   snapshot.compartments[0].samples == 2 &&
+	                   snapshot.compartments[1].cycles == 5;
+
+	for (size_t i = 2; i < CpuAccountingMaxCompartments; i++)
+	{
+		char name[] = "filler0";
+		name[6] += i;
+		ledger.compartment_add(name, 1);
+	}
+	return check(Added, "cycles are added up by truncated name") &&
+	       check(!ledger.compartment_add("one_too_many", 1),
+	             "names are rejected once the entries are taken") &&
+	       check(ledger.compartment_add("other", 1),
+	             "known names are still added once the entries are taken");
+}
+
+static bool load_test()
+{
+	CpuAccountingSnapshot before = {};
+	before.cycles                = 1000;
+	before.idleCycles            = 200;
+	before.cyclesCounted         = true;
+	before.threads[0]            = {"busy", 100, 1};
+	before.threads[1]            = {"sleepy", 50, 4};
+	before.compartments[0]       = {"shared", 10, 1};
+
+	// Over 1000 cycles, 400 are idle, the two threads report 300 and 100 of
+	// the rest, and a third thread reports for the first time.
+	CpuAccountingSnapshot after = before;
+	after.cycles                = 2000;
+	after.idleCycles            = 600;
+	after.threads[0]            = {"busy", 400, 2};
+	after.threads[1]            = {"sleepy", 150, 6};
+	after.threads[2]            = {"new", 5000, 1};
+	after.compartments[0]       = {"shared", 60, 3};
+	after.compartments[1]       = {"fresh", 20, 1};
+
+	const Load Result = load_between(before, after);
+	return check(Result.cycles == 1000 && Result.busyPermille == 600,
+	             "the busy share leaves out the idle cycles") &&
+	       check(Result.threads[0].permille == 300 &&
+	               Result.threads[0].samples == 1 &&
+	               Result.threads[1].permille == 100 &&
+	               Result.threads[1].samples == 2,
+	             "threads get the share that they reported") &&
+	       check(Result.threads[2].permille == 0,
+	             "a thread's first report isn't counted") &&
+	       check(Result.unreportedPermille == 200,
+	             "busy cycles that no thread reported are unreported") &&
+	       check(Result.compartments[0].permille == 50 &&
+	               Result.compartments[0].samples == 2 &&
+	               Result.compartments[1].permille == 20,
+	             "compartments get the cycles added to them");
+}
+
+static bool uncounted_test()
+{
+	CpuAccountingSnapshot before = {};
+	before.cycles                = 1000;
+	before.threads[0]            = {"spinner", 0, 1};
+	CpuAccountingSnapshot after  = before;
+	after.cycles                 = 3000;
+	after.threads[0]             = {"spinner", 0, 11};
+
+	const Load Result = load_between(before, after);
+	return check(!Result.cyclesCounted && Result.busyPermille == 0 &&
+	               Result.unreportedPermille == 0,
+	             "nothing is busy without cycle counts") &&
+	       check(Result.threads[0].samples == 10,
+	             "samples are counted without cycle counts");
+}
+
+bool cpu_accounting_tests()
+{
+	const sonata::test::TestCase Tests[] = {
+	  {"CPU accounting ledger test", ledger_test},
+	  {"CPU accounting compartment test", compartment_test},
+	  {"CPU accounting load test", load_test},
+	  {"CPU accounting uncounted test", uncounted_test},
+	};
+	return sonata::test::run_tests(Tests);
+}
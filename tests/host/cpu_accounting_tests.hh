@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Tests the CPU accounting ledger and the load worked out from it.
+bool cpu_accounting_tests();
@@ -0,0 +1,167 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "game_of_life_tests.hh"
+#include "../../libraries/game_of_life.hh"
+#include "host_test.hh"
+#include <vector>
+
+using namespace sonata::game_of_life;
+using sonata::test::check;
+
+/// A grid of cells, stepped one cell at a time as a reference.
+struct Grid
+{
+	ptrdiff_t         width;
+	ptrdiff_t         height;
+	bool              wrap;
+	std::vector<bool> cells = std::vector<bool>(width * height);
+
+	bool at(ptrdiff_t x, ptrdiff_t y) const
+	{
+		if (wrap)
+		{
+			x = (x + width) % width;
+			y = (y + height) % height;
+		}
+		else if (x < 0 || y < 0 || x >= width || y >= height)
+		{
+			return false;
+		}
+		return cells[y * width + x];
+	}
+
+	void step()
+	{
+		std::vector<bool> next(cells.size());
+		for (ptrdiff_t y = 0; y < height; y++)
+		{
+			for (ptrdiff_t x = 0; x < width; x++)
+			{
+				// Count the whole 3x3 block, including the cell itself.
+				size_t count = 0;
+				for (ptrdiff_t dy = -1; dy <= 1; dy++)
+				{
+					for (ptrdiff_t dx = -1; dx <= 1; dx++)
+					{
+						count += at(x + dx, y + dy);
+					}
+				}
+				next[y * width + x] = count == 3 || (count == 4 && at(x, y));
+			}
+		}
+		cells = next;
+	}
+};
+
+/// A deterministic xorshift generator for random boards.
+static uint64_t random_board()
+{
+	static uint64_t state = 0x9E3779B97F4A7C15;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+static bool single_tile_test()
+{
+	for (bool wrap : {false, true})
+	{
+		for (size_t i = 0; i < 500; i++)
+		{
+			const Board Start = random_board() & random_board();
+			Grid        grid{8, 8, wrap};
+			for (size_t cell = 0; cell < 64; cell++)
+			{
+				grid.cells[cell] = (Start >> cell) & 1;
+			}
+			grid.step();
+			const Board Next = step(Start, wrap);
+			for (size_t cell = 0; cell < 64; cell++)
+			{
+				if (!check(((Next >> cell) & 1) == grid.cells[cell],
+				           "a tile steps like the reference"))
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+static bool oscillator_test()
+{
+	const Board Blinker = from_rows({0, 0, 0, 0b00111000, 0, 0, 0, 0});
+	const Board Turned  = from_rows({0, 0, 0b00010000, 0b00010000, 0b00010000});
+	return check(step(Blinker) == Turned, "a blinker turns") &&
+	       check(step(Turned) == Blinker, "a blinker turns back");
+}
+
+static bool world_test()
+{
+	for (bool wrap : {false, true})
+	{
+		World<3, 2> world(wrap);
+		Grid        grid{world.CellsWide, world.CellsHigh, wrap};
+		for (size_t y = 0; y < world.CellsHigh; y++)
+		{
+			const Board Row = random_board();
+			for (size_t x = 0; x < world.CellsWide; x++)
+			{
+				const bool Alive = (Row >> x) & (Row >> (x + 24)) & 1;
+				world.set(x, y, Alive);
+				grid.cells[y * grid.width + x] = Alive;
+			}
+		}
+		for (size_t generation = 0; generation < 20; generation++)
+		{
+			world.step();
+			grid.step();
+		}
+		for (size_t y = 0; y < world.CellsHigh; y++)
+		{
+			for (size_t x = 0; x < world.CellsWide; x++)
+			{
+				if (!check(world.is_alive(x, y) == grid.at(x, y),
+				           "a world steps like the reference"))
+				{
+					return false;
+				}
+			}
+		}
+
+		// Check windows that cross tile and world edges.
+		for (size_t top = 0; top < world.CellsHigh + 4; top += 3)
+		{
+			for (size_t left = 0; left < world.CellsWide + 4; left += 5)
+			{
+				const Board Window = world.viewport(left, top);
+				for (size_t y = 0; y < 8; y++)
+				{
+					for (size_t x = 0; x < 8; x++)
+					{
+						if (!check(is_alive(Window, x, y) ==
+						             grid.at(left + x, top + y),
+						           "the viewport shows the world"))
+						{
+							return false;
+						}
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+bool game_of_life_tests()
+{
+	const sonata::test::TestCase Tests[] = {
+	  {"Game of Life single tile test", single_tile_test},
+	  {"Game of Life oscillator test", oscillator_test},
+	  {"Game of Life world test", world_test},
+	};
+	return sonata::test::run_tests(Tests);
+}
@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Tests the bitboard Game of Life engine against a cell by cell version.
+bool game_of_life_tests();
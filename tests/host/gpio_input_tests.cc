@@ -0,0 +1,172 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "gpio_input_tests.hh"
+#include "../../libraries/gpio_input.hh"
+#include "host_test.hh"
+#include <errno.h>
+#include <vector>
+
+using namespace sonata::gpio_input;
+using sonata::test::check;
+
+static constexpr uint32_t Button = 1 << 2;
+
+/// Samples `raw` `count` times, collecting the events that come of it.
+static void sample(InputTracker                &tracker,
+                   uint32_t                     raw,
+                   size_t                       count,
+                   std::vector<GpioInputEvent> *events)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		tracker.sample(raw, i, [&](const GpioInputEvent &event) {
+			events->push_back(event);
+		});
+	}
+}
+
+static bool debounce_test()
+{
+	Debouncer<3> debouncer;
+	const bool   Bounce = debouncer.sample(1) == 0 &&
+	                    debouncer.sample(0) == 0 &&
+	                    debouncer.sample(1) == 0 && debouncer.sample(1) == 0;
+	const bool Pressed = debouncer.sample(1) == 1;
+	const bool Glitch  = debouncer.sample(0) == 1 && debouncer.sample(1) == 1;
+	return check(Bounce, "bouncing inputs are ignored") &&
+	       check(Pressed, "inputs change once they are steady") &&
+	       check(Glitch, "single sample glitches are ignored");
+}
+
+static bool press_release_test()
+{
+	InputTracker                tracker;
+	std::vector<GpioInputEvent> events;
+	sample(tracker, Button, DebounceSamples + 2, &events);
+	if (!check(events.size() == 1 &&
+	             events[0].kind == GpioInputEventKind::Press &&
+	             events[0].input == Button && events[0].inputs == Button,
+	           "a press is seen once") ||
+	    !check(tracker.state() == Button, "the input is held"))
+	{
+		return false;
+	}
+	sample(tracker, 0, DebounceSamples, &events);
+	return check(events.size() == 2 &&
+	               events[1].kind == GpioInputEventKind::Release &&
+	               events[1].inputs == 0,
+	             "a release is seen once") &&
+	       check(tracker.state() == 0, "the input is released");
+}
+
+static bool hold_repeat_test()
+{
+	InputTracker                tracker;
+	std::vector<GpioInputEvent> events;
+	sample(tracker,
+	       Button,
+	       DebounceSamples - 1 + HoldSamples + 2 * RepeatSamples,
+	       &events);
+	return check(events.size() == 4,
+	             "a press, hold and two repeats are seen") &&
+	       check(events[1].kind == GpioInputEventKind::Hold &&
+	               events[2].kind == GpioInputEventKind::Repeat &&
+	               events[3].kind == GpioInputEventKind::Repeat,
+	             "the hold comes before the repeats") &&
+	       check(events[3].cycles - events[2].cycles == RepeatSamples,
+	             "repeats are evenly spaced");
+}
+
+static bool several_inputs_test()
+{
+	InputTracker                tracker;
+	std::vector<GpioInputEvent> events;
+	sample(tracker, 0b101, DebounceSamples, &events);
+	return check(events.size() == 2 && events[0].input == 0b001 &&
+	               events[1].input == 0b100 && events[0].inputs == 0b101,
+	             "each input gets its own event");
+}
+
+static bool full_queue_test()
+{
+	EventQueue<4>  queue;
+	GpioInputEvent event{0, Button, Button, GpioInputEventKind::Press};
+	for (uint64_t i = 0; i < 4; i++)
+	{
+		event.cycles = i;
+		queue.push(event);
+	}
+	event.kind      = GpioInputEventKind::Hold;
+	const bool Held = !queue.push(event);
+	event.kind          = GpioInputEventKind::Repeat;
+	const bool Repeated = !queue.push(event);
+	bool       kept     = queue.size() == 4;
+	for (uint64_t i = 0; i < 4; i++)
+	{
+		kept = kept && queue.pop(&event) && event.cycles == i &&
+		       event.kind == GpioInputEventKind::Press;
+	}
+	if (!check(Held && Repeated && kept,
+	           "holds and repeats don't push out presses") ||
+	    !check(queue.dropped() == 2, "the dropped events are counted"))
+	{
+		return false;
+	}
+
+	const GpioInputEventKind Kinds[] = {GpioInputEventKind::Press,
+	                                    GpioInputEventKind::Hold,
+	                                    GpioInputEventKind::Repeat,
+	                                    GpioInputEventKind::Repeat};
+	for (uint64_t i = 0; i < 4; i++)
+	{
+		queue.push({i, Button, Button, Kinds[i]});
+	}
+	queue.push({4, Button, 0, GpioInputEventKind::Release});
+	const uint64_t Expected[] = {0, 2, 3, 4};
+	bool           inOrder    = queue.size() == 4;
+	for (uint64_t cycles : Expected)
+	{
+		inOrder = inOrder && queue.pop(&event) && event.cycles == cycles;
+	}
+	if (!check(inOrder, "a release replaces the oldest hold"))
+	{
+		return false;
+	}
+
+	for (uint64_t i = 0; i < 5; i++)
+	{
+		queue.push({i, Button, Button, GpioInputEventKind::Press});
+	}
+	return check(queue.pop(&event) && event.cycles == 1,
+	             "the oldest press goes when there are only presses") &&
+	       check(queue.size() == 3, "the queue stays full");
+}
+
+static bool wait_test()
+{
+	GpioInputEvent event;
+	Timeout        timeout{10};
+	gpio_input_flush();
+	return check(gpio_input_wait(&timeout, &event) == -ETIMEDOUT,
+	             "waiting with nothing queued times out") &&
+	       check(timeout.remaining == 0, "the whole timeout is waited") &&
+	       check(gpio_input_wait(nullptr, &event) == -EINVAL &&
+	               gpio_input_wait(&timeout, nullptr) == -EINVAL,
+	             "invalid arguments are rejected") &&
+	       check(!gpio_input_wait_for_press(10, Button),
+	             "no press is seen with nothing queued");
+}
+
+bool gpio_input_tests()
+{
+	const sonata::test::TestCase Tests[] = {
+	  {"GPIO input debounce test", debounce_test},
+	  {"GPIO input press and release test", press_release_test},
+	  {"GPIO input hold and repeat test", hold_repeat_test},
+	  {"GPIO input several inputs test", several_inputs_test},
+	  {"GPIO input full queue test", full_queue_test},
+	  {"GPIO input wait test", wait_test},
+	};
+	return sonata::test::run_tests(Tests);
+}
@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Tests the debouncing and events of the GPIO input compartment.
+bool gpio_input_tests();
@@ -0,0 +1,111 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "../../examples/automotive/lib/automotive_common.h"
+#include "../../libraries/lcd.hh"
+#include "../../libraries/sense_hat.hh"
+#include <algorithm>
+#include <compartment.h>
+#include <debug.hh>
+#include <functional>
+#include <platform-i2c.hh>
+#include <string>
+#include <thread.h>
+#include <vector>
+
+/*
+ * Micro-benchmarks of the libraries, built for the host against the mock
+ * devices. Alongside the time each operation takes on the host, each
+ * benchmark reports the number of bytes moved over the device's bus, which
+ * is a proxy for how long the operation takes on Sonata.
+ *
+ * Results are printed in the same form as the benchmark suite firmware's.
+ */
+
+using namespace sonata::lcd;
+using sonata::mock::Recorder;
+
+using Debug = ConditionalDebug<true, "Host Benchmark">;
+
+struct HostBenchmark
+{
+	const char           *name;
+	std::function<void()> body;
+	/// The recorder of the bus that the benchmark uses.
+	Recorder &bus;
+	size_t    iterations = 100;
+};
+
+static void run(const HostBenchmark &benchmark)
+{
+	benchmark.bus.clear();
+	benchmark.body();
+	const size_t BusBytes = benchmark.bus.bytes_transferred();
+
+	std::vector<uint64_t> times;
+	for (size_t i = 0; i < benchmark.iterations; i++)
+	{
+		benchmark.bus.clear();
+		const uint64_t Start = rdcycle64();
+		benchmark.body();
+		times.push_back(rdcycle64() - Start);
+	}
+	std::sort(times.begin(), times.end());
+	Debug::log("bench name={} iterations={} ns_min={} ns_median={} ns_max={} "
+	           "bus_bytes={}",
+	           benchmark.name,
+	           std::to_string(benchmark.iterations).c_str(),
+	           std::to_string(times.front()).c_str(),
+	           std::to_string(times[times.size() / 2]).c_str(),
+	           std::to_string(times.back()).c_str(),
+	           std::to_string(BusBytes).c_str());
+}
+
+static void record_frame(const uint8_t *buffer, uint16_t length)
+{
+	MMIO_CAPABILITY(sonata::mock::Ethernet, ethernet)
+	  ->send_frame(buffer, length);
+}
+
+int main()
+{
+	SenseHat         senseHat;
+	SenseHat::Colour pixels[64] = {};
+	std::fill(std::begin(pixels), std::end(pixels), SenseHat::Colour{31, 0, 0});
+
+	SonataLcd  lcd;
+	const Rect Square = Rect::from_point_and_size({16, 16}, {32, 32});
+
+	AutomotiveCallbacks benchmarkCallbacks = {};
+	benchmarkCallbacks.ethernet_transmit   = record_frame;
+	init_callbacks(benchmarkCallbacks);
+	const uint64_t PedalData[2] = {0x0123456789ABCDEF, 0xFEDCBA9876543210};
+
+	auto *i2c      = MMIO_CAPABILITY(OpenTitanI2c, i2c1);
+	auto *spi      = MMIO_CAPABILITY(SonataSpi::Lcd, spi_lcd);
+	auto *ethernet = MMIO_CAPABILITY(sonata::mock::Ethernet, ethernet);
+
+	const HostBenchmark Benchmarks[] = {
+	  {"host.sense_hat.set_pixels",
+	   [&] { senseHat.set_pixels(pixels); },
+	   i2c->recorder},
+	  {"host.lcd.clean", [&] { lcd.clean(Color::Black); }, spi->recorder, 10},
+	  {"host.lcd.fill_rect.32x32",
+	   [&] { lcd.fill_rect(Square, Color::Red); },
+	   spi->recorder},
+	  {"host.lcd.draw_str.m3x6",
+	   [&] {
+		   lcd.draw_str({4, 100}, "Sonata bench", Color::Black, Color::White);
+	   },
+	   spi->recorder},
+	  {"host.automotive.send_data_frame",
+	   [&] { send_data_frame(PedalData, FixedDemoHeader, 2); },
+	   ethernet->recorder},
+	};
+	for (const HostBenchmark &Benchmark : Benchmarks)
+	{
+		run(Benchmark);
+	}
+	Debug::log("All benchmarks finished");
+	return 0;
+}
@@ -0,0 +1,46 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <debug.hh>
+#include <functional>
+#include <utility>
+
+namespace sonata::test
+{
+	using Debug = ConditionalDebug<true, "Host Test">;
+
+	using TestCase = std::pair<const char *, std::function<bool()>>;
+
+	/**
+	 * Logs `description` if `condition` doesn't hold, and returns
+	 * `condition`.
+	 */
+	inline bool check(bool condition, const char *description)
+	{
+		if (!condition)
+		{
+			Debug::log("Check failed: {}", description);
+		}
+		return condition;
+	}
+
+	/**
+	 * Runs each of the given tests, stopping at the first failure.
+	 */
+	template<size_t N>
+	bool run_tests(const TestCase (&tests)[N])
+	{
+		for (auto &[name, function] : tests)
+		{
+			Debug::log("Running {}", name);
+			if (!function())
+			{
+				Debug::log("{} failed", name);
+				return false;
+			}
+		}
+		return true;
+	}
+} // namespace sonata::test
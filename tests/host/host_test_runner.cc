@@ -0,0 +1,46 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "apds9960_tests.hh"
+#include "automotive_tests.hh"
+#include "cpu_accounting_tests.hh"
+#include "game_of_life_tests.hh"
+#include "gpio_input_tests.hh"
+#include "i2c_bus_tests.hh"
+#include "i2c_device_tests.hh"
+#include "ksz8851_tests.hh"
+#include "lcd_tests.hh"
+#include "rgbled_animation_tests.hh"
+#include "sense_hat_tests.hh"
+#include "text_scroller_tests.hh"
+#include <debug.hh>
+
+using Debug = ConditionalDebug<true, "Sonata Host Test Runner">;
+
+int main()
+{
+	bool (*const TestSuites[])() = {
+	  sense_hat_tests,
+	  lcd_tests,
+	  automotive_tests,
+	  game_of_life_tests,
+	  text_scroller_tests,
+	  i2c_device_tests,
+	  i2c_bus_tests,
+	  apds9960_tests,
+	  rgbled_animation_tests,
+	  gpio_input_tests,
+	  ksz8851_tests,
+	  cpu_accounting_tests,
+	};
+	for (auto suite : TestSuites)
+	{
+		if (!suite())
+		{
+			Debug::log("One or more tests failed");
+			return 1;
+		}
+	}
+	Debug::log("All tests finished");
+	return 0;
+}
@@ -0,0 +1,232 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "i2c_bus_tests.hh"
+#include "../../libraries/i2c_bus.hh"
+#include "host_test.hh"
+#include <compartment.h>
+#include <errno.h>
+#include <platform-i2c.hh>
+
+using sonata::mock::Transaction;
+using sonata::test::check;
+
+static constexpr uint8_t FirstAddress  = 0x20;
+static constexpr uint8_t SecondAddress = 0x21;
+
+static OpenTitanI2c *i2c()
+{
+	return MMIO_CAPABILITY(OpenTitanI2c, i2c0);
+}
+
+static void reset_i2c()
+{
+	*i2c() = OpenTitanI2c{};
+}
+
+static bool open_test()
+{
+	reset_i2c();
+	i2c()->controllerHalted = true;
+
+	SealedI2cDevice first;
+	SealedI2cDevice second;
+	if (!check(i2c_device_open(
+	             &first, 0, FirstAddress, 100, I2cPriority::Normal) == 0,
+	           "a device can be opened") ||
+	    !check(i2c_device_open(
+	             &second, 0, SecondAddress, 400, I2cPriority::Normal) == 0,
+	           "another device on the bus can be opened"))
+	{
+		return false;
+	}
+	const bool Initialised = !i2c()->controllerHalted &&
+	                         i2c()->fifoResets == 1 &&
+	                         i2c()->speedKhz == 100;
+	i2c_device_close(first);
+	i2c_device_close(second);
+	return check(Initialised,
+	             "the controller is set up when the first device is opened") &&
+	       check(i2c()->recorder.transactions.empty(), "nothing is sent");
+}
+
+static bool exclusive_open_test()
+{
+	reset_i2c();
+	SealedI2cDevice device;
+	SealedI2cDevice again = nullptr;
+	i2c_device_open(&device, 0, FirstAddress, 100, I2cPriority::Normal);
+	const int Busy =
+	  i2c_device_open(&again, 0, FirstAddress, 100, I2cPriority::High);
+	const int OtherBus =
+	  i2c_device_open(&again, 1, FirstAddress, 100, I2cPriority::High);
+	i2c_device_close(again);
+	i2c_device_close(device);
+	const int Reopened =
+	  i2c_device_open(&device, 0, FirstAddress, 100, I2cPriority::Normal);
+	i2c_device_close(device);
+	return check(Busy == -EBUSY, "an open device can't be opened again") &&
+	       check(OtherBus == 0, "the same address on another bus can be") &&
+	       check(Reopened == 0, "a closed device can be opened again");
+}
+
+static bool invalid_arguments_test()
+{
+	reset_i2c();
+	SealedI2cDevice device;
+	uint8_t         data[2] = {};
+	if (!check(i2c_device_open(
+	             &device, 2, FirstAddress, 100, I2cPriority::Normal) == -EINVAL,
+	           "buses that don't exist are rejected") ||
+	    !check(i2c_device_open(&device, 0, 0x80, 100, I2cPriority::Normal) ==
+	             -EINVAL,
+	           "addresses over seven bits are rejected") ||
+	    !check(i2c_transfer(nullptr, data, 1, nullptr, 0) == -EINVAL,
+	           "transfers without a device are rejected"))
+	{
+		return false;
+	}
+	i2c_device_open(&device, 0, FirstAddress, 100, I2cPriority::Normal);
+	const int Unreadable = i2c_transfer(device, data, 1, nullptr, 2);
+	i2c_device_close(device);
+	return check(Unreadable == -EINVAL,
+	             "transfers without a buffer to read into are rejected") &&
+	       check(i2c_transfer(device, data, 1, nullptr, 0) == -EINVAL,
+	             "transfers to a closed device are rejected") &&
+	       check(i2c()->recorder.transactions.empty(), "nothing is sent");
+}
+
+static bool transfer_test()
+{
+	reset_i2c();
+	i2c()->recorder.respond({0x12, 0x34});
+	SealedI2cDevice device;
+	i2c_device_open(&device, 0, FirstAddress, 100, I2cPriority::Normal);
+	const uint8_t Write[] = {0x05};
+	uint8_t       read[2] = {};
+	const int     Result  = i2c_transfer(device, Write, 1, read, 2);
+	i2c_device_close(device);
+
+	auto &transactions = i2c()->recorder.transactions;
+	return check(Result == 0 && read[0] == 0x12 && read[1] == 0x34,
+	             "the transfer succeeds") &&
+	       check(transactions.size() == 2 &&
+	               transactions[0].kind == Transaction::Kind::Write &&
+	               transactions[0].target == FirstAddress &&
+	               transactions[1].kind == Transaction::Kind::Read,
+	             "a write then a read are made to the device") &&
+	       check(!transactions[0].stop,
+	             "the read begins with a repeated start");
+}
+
+static bool speed_test()
+{
+	reset_i2c();
+	SealedI2cDevice slow;
+	SealedI2cDevice fast;
+	i2c_device_open(&slow, 0, FirstAddress, 100, I2cPriority::Normal);
+	i2c_device_open(&fast, 0, SecondAddress, 400, I2cPriority::Normal);
+	const uint8_t Data[] = {0};
+
+	i2c_transfer(fast, Data, 1, nullptr, 0);
+	const uint32_t FastSpeed = i2c()->speedKhz;
+	i2c_transfer(slow, Data, 1, nullptr, 0);
+	const uint32_t SlowSpeed = i2c()->speedKhz;
+	i2c()->speedKhz          = 0;
+	i2c_transfer(slow, Data, 1, nullptr, 0);
+	const bool Kept = i2c()->speedKhz == 0;
+	i2c_device_close(slow);
+	i2c_device_close(fast);
+	return check(FastSpeed == 400 && SlowSpeed == 100,
+	             "the bus is set to each device's speed") &&
+	       check(Kept, "the speed isn't set again when it's unchanged");
+}
+
+static bool statistics_test()
+{
+	reset_i2c();
+	I2cBusStatistics statistics;
+	i2c_bus_statistics(0, &statistics, true);
+
+	SealedI2cDevice present;
+	SealedI2cDevice absent;
+	i2c_device_open(&present, 0, FirstAddress, 100, I2cPriority::Normal);
+	i2c_device_open(&absent, 0, SecondAddress, 100, I2cPriority::Normal);
+	i2c()->absentAddresses.insert(SecondAddress);
+	const uint8_t Data[] = {1, 2, 3};
+	uint8_t       read[4];
+	i2c_transfer(present, Data, 3, read, 4);
+	i2c_transfer(present, Data, 2, nullptr, 0);
+	const int Failed = i2c_transfer(absent, Data, 1, nullptr, 0);
+	i2c_device_close(present);
+	i2c_device_close(absent);
+
+	if (!check(Failed == -EIO, "transfers that aren't acknowledged fail") ||
+	    !check(i2c_bus_statistics(0, &statistics, true) == 0,
+	           "statistics can be read"))
+	{
+		return false;
+	}
+	const bool Counted = statistics.transfers == 3 &&
+	                     statistics.failedTransfers == 1 &&
+	                     statistics.bytesTransferred == 9;
+	const bool Timed   = statistics.busyCycles > 0 &&
+	                   statistics.elapsedCycles >= statistics.busyCycles;
+	const bool Idle    = statistics.queueDepth == 0 &&
+	                  statistics.maxQueueDepth == 0;
+	i2c_bus_statistics(0, &statistics, false);
+	return check(Counted,
+	             "transfers, failures and the bytes of those that succeeded "
+	             "are counted") &&
+	       check(Timed, "the time the bus is busy is counted") &&
+	       check(Idle, "nothing waited for the bus") &&
+	       check(statistics.transfers == 0 && statistics.busyCycles == 0,
+	             "statistics are reset");
+}
+
+static bool fault_test()
+{
+	reset_i2c();
+	I2cBusStatistics statistics;
+	i2c_bus_statistics(0, &statistics, true);
+
+	SealedI2cDevice device;
+	i2c_device_open(&device, 0, FirstAddress, 100, I2cPriority::Normal);
+	const uint8_t Data[] = {1, 2};
+	i2c()->faultOnWrite  = true;
+	bool faulted         = false;
+	try
+	{
+		i2c_transfer(device, Data, 2, nullptr, 0);
+	}
+	catch (OpenTitanI2c::Fault)
+	{
+		// The switcher calls the handler of the compartment that faulted.
+		faulted = compartment_error_handler(nullptr, 0, 0) ==
+		          ErrorRecoveryBehaviour::ForceUnwind;
+	}
+	i2c_bus_statistics(0, &statistics, true);
+	const bool Counted = statistics.transfers == 1 &&
+	                     statistics.failedTransfers == 1 &&
+	                     statistics.bytesTransferred == 0;
+	// This would wait forever if the bus hadn't been released.
+	const int Result = i2c_transfer(device, Data, 2, nullptr, 0);
+	i2c_device_close(device);
+	return check(faulted, "a fault unwinds out of the compartment") &&
+	       check(Counted, "a transfer that faults counts as failed") &&
+	       check(Result == 0, "the bus is released after a fault");
+}
+
+bool i2c_bus_tests()
+{
+	const sonata::test::TestCase Tests[] = {
+	  {"I2C bus open test", open_test},
+	  {"I2C bus exclusive open test", exclusive_open_test},
+	  {"I2C bus invalid arguments test", invalid_arguments_test},
+	  {"I2C bus transfer test", transfer_test},
+	  {"I2C bus speed test", speed_test},
+	  {"I2C bus statistics test", statistics_test},
+	  {"I2C bus fault test", fault_test},
+	};
+	return sonata::test::run_tests(Tests);
+}
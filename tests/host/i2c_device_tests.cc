@@ -0,0 +1,161 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "i2c_device_tests.hh"
+#include "../../libraries/i2c_device.hh"
+#include "host_test.hh"
+#include <algorithm>
+#include <compartment.h>
+#include <vector>
+
+using namespace sonata::i2c;
+using sonata::mock::Transaction;
+using sonata::test::check;
+
+static constexpr uint8_t TargetAddress = 0x20;
+
+static OpenTitanI2c *i2c()
+{
+	return MMIO_CAPABILITY(OpenTitanI2c, i2c0);
+}
+
+static void reset_i2c()
+{
+	*i2c() = OpenTitanI2c{};
+}
+
+/// Returns the data of each write made, in order.
+static std::vector<std::vector<uint8_t>> writes()
+{
+	std::vector<std::vector<uint8_t>> data;
+	for (const Transaction &Transfer : i2c()->recorder.transactions)
+	{
+		if (Transfer.kind == Transaction::Kind::Write)
+		{
+			data.push_back(Transfer.data);
+		}
+	}
+	return data;
+}
+
+static bool register_test()
+{
+	reset_i2c();
+	i2c()->recorder.respond({0x12, 0x34, 0x12, 0x34});
+	const Device Target(i2c(), TargetAddress);
+
+	constexpr Register<int16_t> BigEndian{0x05};
+	constexpr Register<uint16_t, ByteOrder::LittleEndian> LittleEndian{0x06};
+
+	int16_t  big    = 0;
+	uint16_t little = 0;
+	if (!check(Target.read(BigEndian, &big) && big == 0x1234,
+	           "big endian registers are decoded") ||
+	    !check(Target.read(LittleEndian, &little) && little == 0x3412,
+	           "little endian registers are decoded"))
+	{
+		return false;
+	}
+	auto &transactions = i2c()->recorder.transactions;
+	if (!check(transactions.size() == 4 && transactions[0].data.size() == 1 &&
+	             transactions[0].data[0] == 0x05 &&
+	             transactions[1].kind == Transaction::Kind::Read &&
+	             transactions[1].data.size() == 2,
+	           "the register address is sent before both bytes are read") ||
+	    !check(!transactions[0].stop && !transactions[2].stop,
+	           "reads begin with a repeated start"))
+	{
+		return false;
+	}
+	i2c()->recorder.clear();
+	Target.write(LittleEndian, uint16_t{0xABCD});
+	return check(writes() == std::vector<std::vector<uint8_t>>{
+	                           {0x06, 0xCD, 0xAB}},
+	             "values are written in a single transaction");
+}
+
+static bool wide_address_test()
+{
+	reset_i2c();
+	const Device<uint16_t> Eeprom(i2c(), 0x50);
+	uint8_t                data[4];
+	Eeprom.read(0x0102, data, sizeof(data));
+	return check(writes() == std::vector<std::vector<uint8_t>>{{0x01, 0x02}},
+	             "wide register addresses are sent most significant first");
+}
+
+static bool write_limit_test()
+{
+	reset_i2c();
+	const Device  Target(i2c(), TargetAddress);
+	const uint8_t Data[Device<>::MaxWriteBytes + 1] = {};
+	return check(!Target.write(0, Data, sizeof(Data)),
+	             "writes that don't fit are refused") &&
+	       check(i2c()->recorder.transactions.empty(), "nothing is sent") &&
+	       check(Target.write(7, nullptr, 0) &&
+	               writes() == std::vector<std::vector<uint8_t>>{{7}},
+	             "a write can be only the register address");
+}
+
+static bool run_test()
+{
+	reset_i2c();
+	const Device Target(i2c(), TargetAddress);
+	const Step   Init[] = {
+	  {0x10, 1},
+	  {0x11, 2},
+	  {0x12, 3, 5},
+	  {0x13, 4},
+	  {0x20, 5},
+	};
+	return check(Target.run(Init), "the sequence is sent") &&
+	       check(writes() == std::vector<std::vector<uint8_t>>{
+	                           {0x10, 1, 2, 3}, {0x13, 4}, {0x20, 5}},
+	             "consecutive registers are joined up to a wait") &&
+	       check(std::ranges::all_of(i2c()->recorder.transactions,
+	                                 &Transaction::stop),
+	             "each write ends with a stop") &&
+	       check(sonata::mock::clock().waitedMilliseconds >= 5,
+	             "the wait is made");
+}
+
+static bool shadow_test()
+{
+	reset_i2c();
+	ShadowedDevice<0x10, 4> target(i2c(), TargetAddress);
+	const Step              Init[] = {
+	  {0x10, 1},
+	  {0x11, 2},
+	  {0x10, 0},
+	  {0x10, 1},
+	};
+	target.run(Init);
+	i2c()->recorder.clear();
+	target.run(Init);
+	target.write(0x11, 2);
+	if (!check(writes() == std::vector<std::vector<uint8_t>>{{0x10, 0},
+	                                                          {0x10, 1}},
+	           "only writes that change a register are sent"))
+	{
+		return false;
+	}
+	i2c()->recorder.clear();
+	i2c()->absentAddresses.insert(TargetAddress);
+	target.write(0x11, 3);
+	i2c()->absentAddresses.clear();
+	target.write(0x10, 1);
+	return check(writes() == std::vector<std::vector<uint8_t>>{{0x10, 1}},
+	             "registers are forgotten after a failed write");
+}
+
+bool i2c_device_tests()
+{
+	const sonata::test::TestCase Tests[] = {
+	  {"I2C device register test", register_test},
+	  {"I2C device wide address test", wide_address_test},
+	  {"I2C device write limit test", write_limit_test},
+	  {"I2C device run test", run_test},
+	  {"I2C device shadow test", shadow_test},
+	};
+	return sonata::test::run_tests(Tests);
+}
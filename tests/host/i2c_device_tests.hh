@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Tests the I2C register layer against a mock I2C controller.
+bool i2c_device_tests();
@@ -0,0 +1,150 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ksz8851_tests.hh"
+#include "../../libraries/ksz8851.hh"
+#include "host_test.hh"
+#include <compartment.h>
+#include <platform-spi.hh>
+
+using namespace sonata::ksz8851;
+using sonata::mock::Transaction;
+using sonata::test::check;
+
+using EthernetSpi = SonataSpi::EthernetMac;
+
+/// The chip select bit of the MAC, which is low while it's selected.
+static constexpr uint32_t EthernetCsBit = 1 << 0;
+
+static EthernetSpi *spi()
+{
+	return MMIO_CAPABILITY(EthernetSpi, spi_ethmac);
+}
+
+static void reset_spi()
+{
+	*spi()             = EthernetSpi{};
+	spi()->chipSelects = EthernetCsBit;
+}
+
+/**
+ * Returns the value written to `reg` by the write at `index` of the recorded
+ * transactions, or -1 if there isn't a write of that register there.
+ */
+static int32_t written_value(size_t index, Register reg)
+{
+	const auto &Transactions = spi()->recorder.transactions;
+	if (index + 1 >= Transactions.size())
+	{
+		return -1;
+	}
+	const Transaction &Command = Transactions[index];
+	const Transaction &Value   = Transactions[index + 1];
+	const uint8_t      Offset  = static_cast<uint8_t>(reg);
+	if (Command.data.size() != 2 || Value.data.size() != 2 ||
+	    Command.data[0] >> 6 != 0b01 ||
+	    ((Command.data[0] & 0b11) << 6 | Command.data[1] >> 2) !=
+	      (Offset & 0xFC))
+	{
+		return -1;
+	}
+	return Value.data[0] | (Value.data[1] << 8);
+}
+
+static bool register_access_test()
+{
+	reset_spi();
+	spi()->recorder.respond({0x34, 0x12});
+	const uint16_t Value = register_read(Register::ReceiveControl1);
+	register_write(Register::MulticastHashTable1, 0xBEEF);
+
+	const auto &Transactions = spi()->recorder.transactions;
+	if (!check(Transactions.size() == 4, "each access is a command and data"))
+	{
+		return false;
+	}
+	return check(Value == 0x1234, "the register is read little-endian") &&
+	       check(Transactions[0].data == std::vector<uint8_t>{0x0D, 0xD0},
+	             "the read command holds the register's address") &&
+	       check((Transactions[0].target & EthernetCsBit) == 0 &&
+	               (Transactions[1].target & EthernetCsBit) == 0,
+	             "the MAC is selected during the access") &&
+	       check(Transactions[2].data == std::vector<uint8_t>{0x72, 0x80},
+	             "the write command enables the register's upper bytes") &&
+	       check(written_value(2, Register::MulticastHashTable1) == 0xBEEF,
+	             "the value is written") &&
+	       check((spi()->chipSelects & EthernetCsBit) != 0,
+	             "the MAC is deselected afterwards");
+}
+
+static bool multicast_hash_test()
+{
+	// The hashes of the IPv4 and IPv6 all hosts groups, which are the top six
+	// bits of the bit-reversed CRC-32 of each address.
+	return check(multicast_hash({0x01, 0x00, 0x5E, 0x00, 0x00, 0x01}) == 0x1F,
+	             "the IPv4 all hosts group is hashed") &&
+	       check(multicast_hash({0x33, 0x33, 0x00, 0x00, 0x00, 0x01}) == 0x3E,
+	             "the IPv6 all hosts group is hashed");
+}
+
+static bool filter_test()
+{
+	reset_spi();
+	const MacAddress Group = {0x3b, 0x30, 0x25, 0x24, 0xfe, 0x7a};
+	const uint8_t    Hash  = multicast_hash(Group);
+	// The receive control register as left by the driver, which receives
+	// broadcast, multicast and unicast frames.
+	spi()->recorder.respond({0xE1, 0x7C});
+	filter_received_frames(&Group, 1);
+
+	const Register HashTables[4] = {Register::MulticastHashTable0,
+	                                Register::MulticastHashTable1,
+	                                Register::MulticastHashTable2,
+	                                Register::MulticastHashTable3};
+	bool           hashSet       = true;
+	for (size_t i = 0; i < 4; i++)
+	{
+		const int32_t Expected = (Hash >> 4) == i ? 1 << (Hash & 0xF) : 0;
+		hashSet &= written_value(i * 2, HashTables[i]) == Expected;
+	}
+	const int32_t Control = written_value(10, Register::ReceiveControl1);
+	return check(hashSet, "only the group's hash is set") &&
+	       check(Control != -1, "the receive control register is written") &&
+	       check((Control & ReceiveControl1::BroadcastEnable) == 0,
+	             "broadcast frames are dropped") &&
+	       check((Control & ReceiveControl1::AllEnable) == 0,
+	             "frames aren't all received") &&
+	       check((Control & ReceiveControl1::PhysicalAddressFiltering) != 0 &&
+	               (Control & ReceiveControl1::UnicastEnable) != 0,
+	             "unicast frames must match the MAC's address") &&
+	       check((Control & ReceiveControl1::MulticastEnable) != 0 &&
+	               (Control & ReceiveControl1::MulticastAddressFiltering) == 0,
+	             "multicast frames are filtered by their hash") &&
+	       check((Control & ReceiveControl1::Enable) != 0,
+	             "receiving stays enabled");
+}
+
+static bool received_counts_test()
+{
+	reset_spi();
+	spi()->recorder.respond({3, 0, 0, 0, 2, 0, 1, 0, 5, 0, 0, 0});
+	const ReceivedCounts Counts = received_counts_read();
+	return check(Counts.unicast == 3, "the unicast count is read") &&
+	       check(Counts.multicast == 0x10002,
+	             "the multicast count is read from both halves") &&
+	       check(Counts.broadcast == 5, "the broadcast count is read") &&
+	       check(Counts.total() == 0x1000A, "the counts are totalled") &&
+	       check(written_value(0, Register::IndirectAccessControl) == 0x1C0D,
+	             "the unicast counter is selected for reading");
+}
+
+bool ksz8851_tests()
+{
+	const sonata::test::TestCase Tests[] = {
+	  {"KSZ8851 register access test", register_access_test},
+	  {"KSZ8851 multicast hash test", multicast_hash_test},
+	  {"KSZ8851 filter test", filter_test},
+	  {"KSZ8851 received counts test", received_counts_test},
+	};
+	return sonata::test::run_tests(Tests);
+}
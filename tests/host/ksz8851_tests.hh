@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Tests the KSZ8851 register helpers against a mock SPI device.
+bool ksz8851_tests();
@@ -0,0 +1,494 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "lcd_tests.hh"
+#include "../../libraries/lcd.hh"
+#include "../../libraries/lcd_console.hh"
+#include "../../libraries/lcd_widgets.hh"
+#include "host_test.hh"
+#include <compartment.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace sonata::lcd;
+using sonata::mock::Transaction;
+using sonata::test::check;
+
+using LcdPwm = SonataPulseWidthModulation::LcdBacklight;
+using LcdSpi = SonataSpi::Lcd;
+
+/// The chip select bits that drive the LCD's control lines.
+static constexpr uint32_t LcdDcBit  = 1 << 1;
+static constexpr uint32_t LcdRstBit = 1 << 2;
+
+static LcdSpi *spi()
+{
+	return MMIO_CAPABILITY(LcdSpi, spi_lcd);
+}
+
+static LcdPwm *backlight()
+{
+	return MMIO_CAPABILITY(LcdPwm, pwm_lcd);
+}
+
+static void reset_devices()
+{
+	*spi()                = LcdSpi{};
+	*backlight()          = LcdPwm{};
+	sonata::mock::clock() = {};
+}
+
+/**
+ * Counts the bytes written while the data/command line was high, which are
+ * parameters and pixel data rather than commands.
+ */
+static size_t data_bytes_written()
+{
+	size_t count = 0;
+	for (const Transaction &Transfer : spi()->recorder.transactions)
+	{
+		if (Transfer.kind == Transaction::Kind::Write &&
+		    (Transfer.target & LcdDcBit) != 0)
+		{
+			count += Transfer.data.size();
+		}
+	}
+	return count;
+}
+
+static bool init_test()
+{
+	reset_devices();
+	SonataLcd lcd;
+	return check(backlight()->period == 1 && backlight()->dutyCycle == 255,
+	             "the backlight is turned on") &&
+	       check(sonata::mock::clock().waitedMilliseconds >= 150,
+	             "the LCD is held in reset") &&
+	       check((spi()->chipSelects & LcdRstBit) != 0,
+	             "the LCD is out of reset") &&
+	       check(spi()->halfClockPeriod == 0,
+	             "the SPI clock ends at full speed") &&
+	       check(lcd.resolution().width > 0 && lcd.resolution().height > 0,
+	             "the resolution is known");
+}
+
+static bool destroy_test()
+{
+	reset_devices();
+	{
+		SonataLcd lcd;
+	}
+	return check(backlight()->period == 0 && backlight()->dutyCycle == 0,
+	             "the backlight is turned off") &&
+	       check((spi()->chipSelects & LcdRstBit) == 0,
+	             "the LCD is held in reset");
+}
+
+static bool spi_calibration_test()
+{
+	// The mock panel reads back nothing but zeros, so no divider is verified
+	// and the fastest clock is used unchecked.
+	reset_devices();
+	SpiCalibration calibration;
+	SonataLcd      lcd(internal::LCD_Rotate180, &calibration);
+	const size_t   CalibratedBytesRead = spi()->recorder.bytesRead;
+	const Size     Resolution          = lcd.resolution();
+	const bool     ClearedOnce =
+	  data_bytes_written() < 2 * Resolution.width * Resolution.height * 2;
+	const bool     Calibrated =
+	  calibration.valid && !calibration.verified && calibration.divider == 0 &&
+	  calibration.pixelsPerSecond > 0 &&
+	  lcd.spi_calibration().pixelsPerSecond == calibration.pixelsPerSecond;
+
+	// Bringing the LCD up again with the calibration skips reading it back.
+	reset_devices();
+	calibration.divider = 1;
+	SonataLcd cachedLcd(internal::LCD_Rotate180, &calibration);
+	return check(Calibrated,
+	             "the calibration falls back to the fastest clock") &&
+	       check(ClearedOnce,
+	             "the fill rate is timed from the clear at start up") &&
+	       check(spi()->halfClockPeriod == 1, "the cached divider is used") &&
+	       check(spi()->recorder.bytesRead < CalibratedBytesRead,
+	             "the cached calibration isn't checked again") &&
+	       check(calibration.clock_hz() == CPU_TIMER_HZ / 4,
+	             "the clock is half the system clock over the divider");
+}
+
+static bool fill_rect_test()
+{
+	reset_devices();
+	SonataLcd lcd;
+	spi()->recorder.clear();
+	lcd.fill_rect(Rect::from_point_and_size({8, 8}, {32, 16}), Color::Red);
+
+	// Each pixel is sent as two bytes, after a handful of bytes of parameters
+	// setting the window to draw to.
+	const size_t PixelBytes = 32 * 16 * 2;
+	const size_t DataBytes  = data_bytes_written();
+	return check(DataBytes >= PixelBytes && DataBytes <= PixelBytes + 16,
+	             "only the rectangle's pixels are sent") &&
+	       check(spi()->recorder.bytesRead == 0, "nothing is read");
+}
+
+static bool draw_pixel_test()
+{
+	reset_devices();
+	SonataLcd lcd;
+	spi()->recorder.clear();
+	lcd.draw_pixel({4, 4}, Color::White);
+	const size_t DataBytes = data_bytes_written();
+	return check(DataBytes >= 2 && DataBytes <= 2 + 16,
+	             "a single pixel is sent");
+}
+
+static bool color565_test()
+{
+	static_assert(Color565(Color::Red).rgb565() == 0xF800,
+	              "constant colours convert at compile time");
+	const Color565 Orange = Color565::from_rgb888(0xFF8040);
+	return check(Orange.rgb565() == ((0xFF >> 3) << 11 | (0x80 >> 2) << 5 |
+	                                 (0x40 >> 3)),
+	             "the top bits of each component are kept") &&
+	       check(Color565::from_rgb888(Orange.rgb888()) == Orange,
+	             "expanding to RGB888 gives back the same colour");
+}
+
+static bool bgr_conversion_test()
+{
+	// Enough pixels for the word at a time conversion, starting from each
+	// alignment of the image.
+	alignas(4) uint8_t bgr[3 * 19 + 3];
+	for (size_t i = 0; i < sizeof(bgr); i++)
+	{
+		bgr[i] = static_cast<uint8_t>(i * 37 + 11);
+	}
+	for (size_t offset = 0; offset < 4; offset++)
+	{
+		alignas(4) uint8_t rgb565[2 * 19];
+		bgr888_to_rgb565(&bgr[offset], rgb565, 19);
+		for (size_t i = 0; i < 19; i++)
+		{
+			const uint8_t *Pixel = &bgr[offset + 3 * i];
+			const uint16_t Expected =
+			  Color565::from_rgb888(Pixel[2] << 16 | Pixel[1] << 8 | Pixel[0])
+			    .rgb565();
+			if (!check(rgb565[2 * i] == Expected >> 8 &&
+			             rgb565[2 * i + 1] == (Expected & 0xFF),
+			           "each pixel is converted and sent high byte first"))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static bool draw_image_bgr_test()
+{
+	reset_devices();
+	SonataLcd lcd;
+	static uint8_t image[32 * 16 * 3];
+	spi()->recorder.clear();
+	lcd.draw_image_bgr(Rect::from_point_and_size({8, 8}, {32, 16}), image);
+
+	// The image is drawn in bands of whole rows, each of which sets its own
+	// window.
+	const size_t PixelBytes = 32 * 16 * 2;
+	const size_t DataBytes  = data_bytes_written();
+	return check(DataBytes >= PixelBytes && DataBytes <= PixelBytes + 16 * 4,
+	             "only the image's pixels are sent");
+}
+
+/**
+ * Returns the last `length` bytes written while the data/command line was
+ * high, which are the pixels of the last thing drawn.
+ */
+static std::vector<uint8_t> last_data_written(size_t length)
+{
+	std::vector<uint8_t> data;
+	for (const Transaction &Transfer : spi()->recorder.transactions)
+	{
+		if (Transfer.kind == Transaction::Kind::Write &&
+		    (Transfer.target & LcdDcBit) != 0)
+		{
+			data.insert(data.end(), Transfer.data.begin(), Transfer.data.end());
+		}
+	}
+	if (data.size() > length)
+	{
+		data.erase(data.begin(), data.end() - length);
+	}
+	return data;
+}
+
+static bool sprite_test()
+{
+	// A 4x2 sprite of red, green, blue and white on black, which is the key.
+	static const uint8_t Pixels[] = {
+	  0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0xE0,
+	  0x00, 0x00, 0x00, 0x1F, 0xFF, 0xFF, 0x00, 0x00,
+	};
+	static const uint8_t Mask[]       = {0b10010000, 0b01100000};
+	static const uint8_t Background[] = {
+	  0x11, 0x11, 0x22, 0x22, 0x33, 0x33, 0x44, 0x44,
+	  0x55, 0x55, 0x66, 0x66, 0x77, 0x77, 0x88, 0x88,
+	};
+	const std::vector<uint8_t> OverGrey = {
+	  0xF8, 0x00, 0xAD, 0x55, 0xAD, 0x55, 0x07, 0xE0,
+	  0xAD, 0x55, 0x00, 0x1F, 0xFF, 0xFF, 0xAD, 0x55,
+	};
+	const std::vector<uint8_t> OverImage = {
+	  0xF8, 0x00, 0x22, 0x22, 0x33, 0x33, 0x07, 0xE0,
+	  0x55, 0x55, 0x00, 0x1F, 0xFF, 0xFF, 0x88, 0x88,
+	};
+	const Sprite Keyed  = {{4, 2}, Pixels, Color565(Color::Black)};
+	const Sprite Masked = {{4, 2}, Pixels, Color565(Color::White), Mask};
+
+	reset_devices();
+	SonataLcd lcd;
+	lcd.draw_sprite({8, 8}, Keyed, Color::Grey);
+	const std::vector<uint8_t> KeyedOverGrey = last_data_written(16);
+	lcd.draw_sprite({8, 8}, Masked, Color::Grey);
+	const std::vector<uint8_t> MaskedOverGrey = last_data_written(16);
+	lcd.draw_sprite({8, 8}, Keyed, Background, 4);
+	const std::vector<uint8_t> KeyedOverImage = last_data_written(16);
+	return check(KeyedOverGrey == OverGrey,
+	             "pixels of the key colour show the background") &&
+	       check(MaskedOverGrey == OverGrey,
+	             "pixels outside the mask show the background") &&
+	       check(KeyedOverImage == OverImage,
+	             "transparent pixels show the background image");
+}
+
+static bool frame_capture_test()
+{
+	static uint8_t framebuffer[internal::Panel::Resolution.width *
+	                           internal::Panel::Resolution.height * 2];
+	const uint8_t  Check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+	memset(framebuffer, 0, sizeof(framebuffer));
+
+	reset_devices();
+	SonataLcd lcd;
+	lcd.attach_shadow(framebuffer);
+	const uint32_t BlankCrc = lcd.frame_crc();
+	lcd.fill_rect(Rect::from_point_and_size({8, 8}, {32, 16}), Color::Red);
+
+	const Size           Screen = lcd.resolution();
+	std::vector<uint8_t> frame(Screen.width * Screen.height * 2);
+	lcd.read_pixels({0, 0, Screen.width, Screen.height}, frame.data());
+	size_t drawnPixels = 0;
+	for (size_t i = 0; i < frame.size(); i += 2)
+	{
+		drawnPixels += (frame[i] | frame[i + 1]) != 0;
+	}
+	return check(crc32(Check, sizeof(Check)) == 0xCBF43926,
+	             "the CRC is CRC-32") &&
+	       check(drawnPixels == 32 * 16, "the shadow follows the fill") &&
+	       check(lcd.frame_crc() == crc32(frame.data(), frame.size()),
+	             "the frame's CRC is of its pixels") &&
+	       check(lcd.frame_crc() != BlankCrc, "the CRC changes with the frame");
+}
+
+static bool frame_report_test()
+{
+	static uint8_t framebuffer[internal::Panel::Resolution.width *
+	                           internal::Panel::Resolution.height * 2];
+	memset(framebuffer, 0, sizeof(framebuffer));
+
+	reset_devices();
+	SonataLcd lcd;
+	lcd.attach_shadow(framebuffer);
+	std::ostringstream log;
+	std::streambuf    *stdoutBuffer = std::cout.rdbuf(log.rdbuf());
+	lcd.report_frame("test", true);
+	std::cout.rdbuf(stdoutBuffer);
+
+	// These are the forms that scripts/lcd_frames_to_png.py reads.
+	const std::string Lines = log.str();
+	return check(Lines.find("lcd_frame name=test width=160 height=128 crc=") !=
+	               std::string::npos,
+	             "the frame's size is reported in decimal") &&
+	       check(Lines.find("lcd_frame_data name=test row=127 column=128 "
+	                        "pixels=") != std::string::npos,
+	             "the positions of the pixels are reported in decimal");
+}
+
+static bool shadow_scroll_test()
+{
+	static uint8_t framebuffer[internal::Panel::Resolution.width *
+	                           internal::Panel::Resolution.height * 2];
+	memset(framebuffer, 0, sizeof(framebuffer));
+
+	// Scrolling a portrait screen moves its rows, which is followed when
+	// pixels are captured.
+	reset_devices();
+	SonataLcd lcd(internal::LCD_Rotate90);
+	lcd.attach_shadow(framebuffer);
+	const Size Screen = lcd.resolution();
+	lcd.fill_rect({0, 20, Screen.width, 21}, Color565(0xFFFF));
+	lcd.scroll_area(16, 80);
+	lcd.scroll_to(26);
+
+	std::vector<uint8_t> row(Screen.width * 2);
+	lcd.read_pixels({0, 20, Screen.width, 21}, row.data());
+	const bool Moved = row[0] == 0 && row[Screen.width * 2 - 1] == 0;
+	lcd.read_pixels({0, 90, Screen.width, 91}, row.data());
+	const bool Shown = row[0] == 0xFF && row[Screen.width * 2 - 1] == 0xFF;
+
+	uint8_t outside[4] = {1, 2, 3, 4};
+	lcd.read_pixels({Screen.width - 1, 0, Screen.width + 1, 1}, outside);
+	return check(Screen.height > Screen.width, "the LCD is in portrait") &&
+	       check(Moved && Shown, "captures follow the scrolling") &&
+	       check(outside[0] == 1 && outside[3] == 4,
+	             "areas off the screen aren't captured");
+}
+
+static bool fill_rgb565_test()
+{
+	static uint8_t framebuffer[internal::Panel::Resolution.width *
+	                           internal::Panel::Resolution.height * 2];
+	memset(framebuffer, 0, sizeof(framebuffer));
+
+	// The colour doesn't survive a round trip through RGB888 any differently,
+	// but its bytes show that it reaches the panel as it is.
+	reset_devices();
+	SonataLcd lcd;
+	lcd.attach_shadow(framebuffer);
+	const Color565 Colour(0x1234);
+	lcd.fill_rect(Rect::from_point_and_size({8, 8}, {32, 16}), Colour);
+	lcd.draw_line({8, 30}, {18, 30}, Colour);
+	lcd.draw_pixel({50, 50}, Colour);
+
+	const Size           Screen = lcd.resolution();
+	std::vector<uint8_t> frame(Screen.width * Screen.height * 2);
+	lcd.read_pixels({0, 0, Screen.width, Screen.height}, frame.data());
+	size_t colouredPixels = 0;
+	size_t otherPixels    = 0;
+	for (size_t i = 0; i < frame.size(); i += 2)
+	{
+		if (frame[i] == 0x12 && frame[i + 1] == 0x34)
+		{
+			colouredPixels++;
+		}
+		else if ((frame[i] | frame[i + 1]) != 0)
+		{
+			otherPixels++;
+		}
+	}
+	return check(colouredPixels == 32 * 16 + 10 + 1,
+	             "the RGB565 colour is written to each pixel") &&
+	       check(otherPixels == 0, "nothing else is drawn");
+}
+
+static bool widgets_test()
+{
+	reset_devices();
+	SonataLcd              lcd;
+	SevenSegmentDisplay<3> speed({0, 0}, Color::White, Color::Black);
+	BarGauge               gauge(
+	  {0, 50, 100, 60}, 100, Color::Black, Color::Green);
+
+	Compositor screen{speed, gauge};
+	screen.render(lcd);
+
+	spi()->recorder.clear();
+	const size_t Unchanged = screen.render(lcd);
+	const size_t IdleBytes = data_bytes_written();
+
+	// Going from 0 to 8 only turns on the middle segment, and moving the
+	// gauge to 30 only fills the first 30 columns.
+	speed.set(8);
+	gauge.set(30);
+	spi()->recorder.clear();
+	const size_t Changed       = screen.render(lcd);
+	const size_t SegmentBytes  = 15 * 5 * 2;
+	const size_t GaugeBytes    = 30 * 10 * 2;
+	const size_t ChangedBytes  = data_bytes_written();
+	const size_t ExpectedBytes = SegmentBytes + GaugeBytes;
+	return check(Unchanged == 0 && IdleBytes == 0,
+	             "nothing is drawn when nothing changes") &&
+	       check(Changed == 2, "only the changed widgets are drawn") &&
+	       check(ChangedBytes >= ExpectedBytes &&
+	               ChangedBytes <= ExpectedBytes + 32,
+	             "only the changed pixels are sent");
+}
+
+/// Returns true if `command` was sent to the LCD.
+static bool command_written(uint8_t command)
+{
+	for (const Transaction &Transfer : spi()->recorder.transactions)
+	{
+		if (Transfer.kind == Transaction::Kind::Write &&
+		    (Transfer.target & LcdDcBit) == 0 && Transfer.data.size() == 1 &&
+		    Transfer.data[0] == command)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool console_test()
+{
+	reset_devices();
+	SonataLcd  lcd(internal::LCD_Rotate90);
+	const Size Resolution = lcd.resolution();
+	LcdConsole console(lcd, 16, 8, 10, Color::Black, Color::White);
+	for (size_t i = 0; i < 8; i++)
+	{
+		console.append("Filling the console");
+	}
+
+	// Appending to a full console draws only the new line, and scrolls the
+	// rest up rather than drawing them again.
+	spi()->recorder.clear();
+	console.append("One more line");
+	const size_t LineBytes = Resolution.width * 10 * 2;
+	const size_t DataBytes = data_bytes_written();
+	return check(Resolution.height > Resolution.width,
+	             "the LCD is in portrait") &&
+	       check(command_written(0x37), "the console is scrolled") &&
+	       check(DataBytes <= 2 * LineBytes, "only one line is drawn");
+}
+
+static bool layout_test()
+{
+	reset_devices();
+	SonataLcd    lcd;
+	const Size   Resolution = lcd.resolution();
+	const Layout Same(Resolution, Resolution);
+	const Layout Double({Resolution.width / 2, Resolution.height / 2},
+	                    Resolution);
+	const Point  Scaled = Double.at({10, 20});
+	return check(Resolution.width == internal::Panel::Resolution.width,
+	             "the panel's landscape resolution is used") &&
+	       check(Same.at({10, 20}).x == 10 && Same.at({10, 20}).y == 20,
+	             "positions at the reference resolution are kept") &&
+	       check(Scaled.x == 20 && Scaled.y == 40,
+	             "positions are scaled to the screen");
+}
+
+bool lcd_tests()
+{
+	const sonata::test::TestCase Tests[] = {
+	  {"LCD init test", init_test},
+	  {"LCD destroy test", destroy_test},
+	  {"LCD SPI calibration test", spi_calibration_test},
+	  {"LCD fill rect test", fill_rect_test},
+	  {"LCD draw pixel test", draw_pixel_test},
+	  {"LCD colour 565 test", color565_test},
+	  {"LCD BGR conversion test", bgr_conversion_test},
+	  {"LCD draw BGR image test", draw_image_bgr_test},
+	  {"LCD sprite test", sprite_test},
+	  {"LCD frame capture test", frame_capture_test},
+	  {"LCD frame report test", frame_report_test},
+	  {"LCD RGB565 fill test", fill_rgb565_test},
+	  {"LCD shadow scroll test", shadow_scroll_test},
+	  {"LCD widgets test", widgets_test},
+	  {"LCD console test", console_test},
+	  {"LCD layout test", layout_test},
+	};
+	return sonata::test::run_tests(Tests);
+}
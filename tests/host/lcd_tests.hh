@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Tests the LCD library against mock SPI and PWM devices.
+bool lcd_tests();
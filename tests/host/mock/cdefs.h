@@ -0,0 +1,16 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+/*
+ * Host stand-ins for the CHERIoT compartment attributes. On the host every
+ * library and compartment is linked into one program, so calls between them
+ * are ordinary function calls.
+ */
+#define __cheri_libcall
+#define __cheri_callback
+#define __cheri_compartment(name)
+
+/// Sealed pointers are ordinary pointers on the host.
+#define CHERI_SEALED(type) type
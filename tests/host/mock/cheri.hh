@@ -0,0 +1,81 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <compartment.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread.h>
+
+namespace CHERI
+{
+	/**
+	 * A host stand-in for a capability, which is just a pointer without any
+	 * bounds or permissions.
+	 */
+	template<typename T>
+	class Capability
+	{
+		T *pointer;
+
+		public:
+		Capability(T *pointer) : pointer(pointer) {}
+
+		T *get() const
+		{
+			return pointer;
+		}
+
+		T *operator->() const
+		{
+			return pointer;
+		}
+
+		T &operator*() const
+		{
+			return *pointer;
+		}
+
+		operator T *() const
+		{
+			return pointer;
+		}
+	};
+
+	enum class Permission
+	{
+		Global,
+		Load,
+		Store,
+		LoadStoreCapability,
+	};
+
+	struct PermissionSet
+	{
+		uint32_t bits;
+
+		template<typename... Permissions>
+		constexpr PermissionSet(Permissions... permissions)
+		  : bits((0 | ... | (1u << static_cast<uint32_t>(permissions))))
+		{
+		}
+	};
+
+	/**
+	 * A host stand-in for checking a pointer passed between compartments,
+	 * which can only check that it isn't null.
+	 */
+	template<PermissionSet Permissions = PermissionSet{Permission::Load},
+	         bool          CheckStack  = true>
+	bool check_pointer(auto &pointer, size_t space = 1)
+	{
+		return pointer != nullptr || space == 0;
+	}
+
+	/// A host stand-in for checking a timeout passed between compartments.
+	inline bool check_timeout_pointer(const Timeout *timeout)
+	{
+		return timeout != nullptr;
+	}
+} // namespace CHERI
@@ -0,0 +1,31 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "mock_device.hh"
+#include <cdefs.h>
+#include <stddef.h>
+
+/**
+ * Returns the mock device standing in for the named MMIO region, in place of
+ * a capability to the device's registers.
+ */
+#define MMIO_CAPABILITY(type, name) (::sonata::mock::device<type>(#name))
+
+/// What the switcher does after a compartment's error handler returns.
+enum class ErrorRecoveryBehaviour
+{
+	InstallContext,
+	ForceUnwind,
+};
+
+/// The register state of a thread that faulted, given to the error handler.
+struct ErrorState
+{
+	void *pcc;
+};
+
+/// The error handler of the compartment under test, if it has one.
+extern "C" ErrorRecoveryBehaviour
+compartment_error_handler(ErrorState *frame, size_t mcause, size_t mtval);
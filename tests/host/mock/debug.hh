@@ -0,0 +1,112 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <cdefs.h>
+#include <cstdlib>
+#include <iostream>
+#include <stddef.h>
+#include <stdint.h>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * The name of a debug context, passed as a template argument.
+ */
+template<size_t N>
+struct DebugContext
+{
+	char name[N];
+
+	constexpr DebugContext(const char (&str)[N])
+	{
+		std::copy_n(str, N, name);
+	}
+};
+
+namespace sonata::mock
+{
+	template<typename T>
+	void print_argument(std::ostream &out, T argument)
+	{
+		if constexpr (std::is_enum_v<T>)
+		{
+			out << static_cast<std::underlying_type_t<T>>(argument) + 0;
+		}
+		else if constexpr (std::is_same_v<T, bool>)
+		{
+			out << (argument ? "true" : "false");
+		}
+		else if constexpr (std::is_integral_v<T> && std::is_unsigned_v<T>)
+		{
+			// The RTOS prints unsigned integers in hexadecimal.
+			out << "0x" << std::hex << uint64_t{argument} << std::dec;
+		}
+		else if constexpr (std::is_integral_v<T>)
+		{
+			// Promote characters so that they are printed as numbers.
+			out << +argument;
+		}
+		else
+		{
+			out << argument;
+		}
+	}
+
+	/**
+	 * Prints `format`, replacing each `{}` with the next argument.
+	 */
+	inline void print_format(std::ostream &out, std::string_view format)
+	{
+		out << format;
+	}
+
+	template<typename T, typename... Args>
+	void print_format(std::ostream    &out,
+	                  std::string_view format,
+	                  T                argument,
+	                  Args... arguments)
+	{
+		size_t placeholder = format.find("{}");
+		if (placeholder == std::string_view::npos)
+		{
+			out << format;
+			return;
+		}
+		out << format.substr(0, placeholder);
+		print_argument(out, argument);
+		print_format(out, format.substr(placeholder + 2), arguments...);
+	}
+} // namespace sonata::mock
+
+/**
+ * A host stand-in for the RTOS debug helper, which writes to the standard
+ * output in place of the UART.
+ */
+template<bool Enabled, DebugContext Context>
+struct ConditionalDebug
+{
+	template<typename... Args>
+	static void log(const char *format, Args... arguments)
+	{
+		if constexpr (Enabled)
+		{
+			std::cout << Context.name << ": ";
+			sonata::mock::print_format(std::cout, format, arguments...);
+			std::cout << std::endl;
+		}
+	}
+
+	template<typename... Args>
+	static void
+	Invariant(bool condition, const char *format, Args... arguments)
+	{
+		if (!condition)
+		{
+			log(format, arguments...);
+			std::abort();
+		}
+	}
+};
@@ -0,0 +1,36 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <errno.h>
+#include <stdint.h>
+#include <thread.h>
+
+/*
+ * Host stand-ins for the scheduler's futexes. The host tests run on a single
+ * thread, so a wait would never be woken and returns at once instead.
+ */
+
+inline int futex_wait(const uint32_t *address, uint32_t expected)
+{
+	return 0;
+}
+
+/// Waits out the whole timeout, unless the futex has already changed.
+inline int
+futex_timed_wait(Timeout *timeout, const uint32_t *address, uint32_t expected)
+{
+	if (*address != expected)
+	{
+		return 0;
+	}
+	timeout->elapsed += timeout->remaining;
+	timeout->remaining = 0;
+	return -ETIMEDOUT;
+}
+
+inline int futex_wake(uint32_t *address, uint32_t count)
+{
+	return 0;
+}
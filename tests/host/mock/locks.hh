@@ -0,0 +1,33 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+/*
+ * Host stand-ins for the RTOS locks. The host tests run on a single thread,
+ * so locks are never contended.
+ */
+
+class FlagLock
+{
+	public:
+	void lock() {}
+	void unlock() {}
+};
+
+template<typename Lock>
+class LockGuard
+{
+	Lock &wrappedLock;
+
+	public:
+	explicit LockGuard(Lock &lock) : wrappedLock(lock)
+	{
+		wrappedLock.lock();
+	}
+
+	~LockGuard()
+	{
+		wrappedLock.unlock();
+	}
+};
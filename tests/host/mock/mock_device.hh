@@ -0,0 +1,137 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <deque>
+#include <initializer_list>
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Support for the mock devices used by the host build.
+ *
+ * Each mock device records the bus transactions that the code under test
+ * makes, so that tests can check the bytes sent to a device and benchmarks
+ * can report how much bus traffic an operation needs.
+ */
+namespace sonata::mock
+{
+	/// A single transfer made by the code under test.
+	struct Transaction
+	{
+		enum class Kind
+		{
+			Write,
+			Read,
+		};
+
+		Kind kind;
+		/**
+		 * The I2C address of the target or, for SPI, the value of the chip
+		 * select register during the transfer.
+		 */
+		uint32_t             target;
+		std::vector<uint8_t> data;
+		/**
+		 * False for an I2C write that skips the stop, so that the transfer
+		 * after it begins with a repeated start.
+		 */
+		bool stop = true;
+	};
+
+	/**
+	 * Records the transactions made with a device and supplies the data that
+	 * reads return.
+	 */
+	class Recorder
+	{
+		public:
+		std::vector<Transaction> transactions;
+		/// Bytes returned by reads, in order. Reads return zero once empty.
+		std::deque<uint8_t> responses;
+		size_t              bytesWritten = 0;
+		size_t              bytesRead    = 0;
+
+		void record_write(uint32_t       target,
+		                  const uint8_t *data,
+		                  size_t         length,
+		                  bool           stop = true)
+		{
+			transactions.push_back(
+			  {Transaction::Kind::Write, target, {data, data + length}, stop});
+			bytesWritten += length;
+		}
+
+		void record_read(uint32_t target, uint8_t *data, size_t length)
+		{
+			for (size_t i = 0; i < length; i++)
+			{
+				data[i] = 0;
+				if (!responses.empty())
+				{
+					data[i] = responses.front();
+					responses.pop_front();
+				}
+			}
+			transactions.push_back(
+			  {Transaction::Kind::Read, target, {data, data + length}});
+			bytesRead += length;
+		}
+
+		/// Queues bytes to be returned by later reads.
+		void respond(std::initializer_list<uint8_t> bytes)
+		{
+			responses.insert(responses.end(), bytes);
+		}
+
+		/// The total number of bytes moved over the bus in either direction.
+		size_t bytes_transferred() const
+		{
+			return bytesWritten + bytesRead;
+		}
+
+		void clear()
+		{
+			transactions.clear();
+			responses.clear();
+			bytesWritten = 0;
+			bytesRead    = 0;
+		}
+	};
+
+	/// A mock Ethernet interface, which records each frame sent.
+	struct Ethernet
+	{
+		Recorder recorder;
+
+		void send_frame(const uint8_t *frame, size_t length)
+		{
+			recorder.record_write(0, frame, length);
+		}
+	};
+
+	/**
+	 * Returns the mock device of type `T` that stands in for the MMIO region
+	 * `name`. Each name refers to a single device for the whole program.
+	 */
+	template<typename T>
+	T *device(const char *name)
+	{
+		static std::map<std::string, T> devices;
+		return &devices[name];
+	}
+
+	/**
+	 * Returns the recorder of a device that is accessed through a volatile
+	 * pointer, as device registers are.
+	 */
+	template<typename T>
+	Recorder &recorder(volatile T *device)
+	{
+		return const_cast<T *>(device)->recorder;
+	}
+} // namespace sonata::mock
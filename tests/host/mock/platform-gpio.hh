@@ -0,0 +1,46 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+/// A mock of the Sonata board GPIO, whose inputs tests set directly.
+struct SonataGpioBoard
+{
+	enum JoystickDirection : uint8_t
+	{
+		Left    = 1 << 0,
+		Up      = 1 << 1,
+		Pressed = 1 << 2,
+		Down    = 1 << 3,
+		Right   = 1 << 4,
+	};
+
+	enum Inputs : uint32_t
+	{
+		Joystick = 0x1f,
+	};
+
+	struct JoystickValue
+	{
+		JoystickDirection direction;
+
+		bool is_pressed() const
+		{
+			return (direction & Pressed) != 0;
+		}
+
+		bool is_direction_pressed(JoystickDirection directions) const
+		{
+			return (direction & directions) != 0;
+		}
+	};
+
+	uint32_t input = 0;
+
+	JoystickValue read_joystick() volatile
+	{
+		return {static_cast<JoystickDirection>(input & Joystick)};
+	}
+};
@@ -0,0 +1,111 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "mock_device.hh"
+#include <set>
+#include <stdint.h>
+
+/**
+ * A mock of the OpenTitan I2C controller, which records each transfer.
+ *
+ * Writes to an address in `absentAddresses` aren't acknowledged, in the same
+ * way as writes to a device that isn't connected.
+ */
+struct OpenTitanI2c
+{
+	static constexpr uint32_t ControlEnableHost   = 1 << 0;
+	static constexpr uint32_t ControlEnableTarget = 1 << 1;
+
+	enum class Interrupt
+	{
+		FormatThreshold,
+		ReceiveThreshold,
+		AcquiredThreshold,
+		ReceiveOverflow,
+		ControllerHalt,
+		SclInterference,
+		SdaInterference,
+		StretchTimeout,
+		SdaUnstable,
+		CommandComplete,
+		TransmitStretch,
+		TransmitThreshold,
+		AcquiredFull,
+		UnexpectedStop,
+		HostTimeout,
+	};
+
+	/// Thrown by a write when `faultOnWrite` is set.
+	struct Fault
+	{
+	};
+
+	uint32_t control = 0;
+
+	sonata::mock::Recorder recorder;
+	std::set<uint8_t>      absentAddresses;
+	bool                   controllerHalted = false;
+	/// Makes the next write throw a `Fault`, standing in for a CHERI fault.
+	bool                   faultOnWrite     = false;
+	uint32_t               speedKhz         = 0;
+	uint32_t               fifoResets       = 0;
+
+	bool interrupt_is_asserted(Interrupt interrupt) volatile
+	{
+		return interrupt == Interrupt::ControllerHalt &&
+		       const_cast<OpenTitanI2c *>(this)->controllerHalted;
+	}
+
+	void reset_controller_events() volatile
+	{
+		const_cast<OpenTitanI2c *>(this)->controllerHalted = false;
+	}
+
+	void reset_fifos() volatile
+	{
+		const_cast<OpenTitanI2c *>(this)->fifoResets++;
+	}
+
+	void host_mode_set() volatile
+	{
+		control = (control & ~ControlEnableTarget) | ControlEnableHost;
+	}
+
+	void speed_set(uint32_t speedKhz) volatile
+	{
+		const_cast<OpenTitanI2c *>(this)->speedKhz = speedKhz;
+	}
+
+	bool blocking_write(uint8_t       address,
+	                    const uint8_t data[],
+	                    uint32_t      length,
+	                    bool          skipStop) volatile
+	{
+		auto *self = const_cast<OpenTitanI2c *>(this);
+		if (self->faultOnWrite)
+		{
+			self->faultOnWrite = false;
+			throw Fault{};
+		}
+		if (self->absentAddresses.contains(address))
+		{
+			return false;
+		}
+		self->recorder.record_write(address, data, length, !skipStop);
+		return true;
+	}
+
+	bool blocking_read(uint8_t address, uint8_t buffer[], uint32_t length)
+	  volatile
+	{
+		auto *self = const_cast<OpenTitanI2c *>(this);
+		if (self->absentAddresses.contains(address))
+		{
+			return false;
+		}
+		self->recorder.record_read(address, buffer, length);
+		return true;
+	}
+};
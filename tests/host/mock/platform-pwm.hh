@@ -0,0 +1,28 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+namespace SonataPulseWidthModulation
+{
+	/// A mock of a PWM output, which keeps the last settings written to it.
+	struct Output
+	{
+		uint8_t  period     = 0;
+		uint8_t  dutyCycle  = 0;
+		uint32_t writeCount = 0;
+
+		void output_set(uint8_t period, uint8_t dutyCycle) volatile
+		{
+			auto *self      = const_cast<Output *>(this);
+			self->period    = period;
+			self->dutyCycle = dutyCycle;
+			self->writeCount++;
+		}
+	};
+
+	using General      = Output;
+	using LcdBacklight = Output;
+} // namespace SonataPulseWidthModulation
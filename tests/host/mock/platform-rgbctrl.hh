@@ -0,0 +1,43 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+enum class SonataRgbLed
+{
+	Led0 = 0,
+	Led1 = 1,
+};
+
+/**
+ * A mock of the RGB LED controller, which keeps the colours last set and
+ * counts the updates that would send them to the LEDs.
+ */
+struct SonataRgbLedController
+{
+	uint8_t  colours[2][3] = {};
+	uint32_t updateCount   = 0;
+
+	void rgb(SonataRgbLed led, uint8_t red, uint8_t green, uint8_t blue)
+	  volatile
+	{
+		auto     *self  = const_cast<SonataRgbLedController *>(this);
+		const int Index = static_cast<int>(led);
+		self->colours[Index][0] = red;
+		self->colours[Index][1] = green;
+		self->colours[Index][2] = blue;
+	}
+
+	void update() volatile
+	{
+		const_cast<SonataRgbLedController *>(this)->updateCount++;
+	}
+
+	void clear() volatile
+	{
+		auto *self = const_cast<SonataRgbLedController *>(this);
+		*self      = SonataRgbLedController{};
+	}
+};
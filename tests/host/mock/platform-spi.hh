@@ -0,0 +1,51 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "mock_device.hh"
+#include <stdint.h>
+
+namespace SonataSpi
+{
+	/**
+	 * A mock of a Sonata SPI controller, which records each transfer along
+	 * with the chip selects that were set while it was made.
+	 */
+	struct Generic
+	{
+		uint32_t chipSelects = 0;
+
+		sonata::mock::Recorder recorder;
+		uint16_t               halfClockPeriod = 0;
+		uint32_t               initialisations = 0;
+
+		void init(bool     clockPolarity,
+		          bool     clockPhase,
+		          bool     msbFirst,
+		          uint16_t halfClockPeriod) volatile
+		{
+			auto *self            = const_cast<Generic *>(this);
+			self->halfClockPeriod = halfClockPeriod;
+			self->initialisations++;
+		}
+
+		void wait_idle() volatile {}
+
+		void blocking_write(const uint8_t data[], uint16_t length) volatile
+		{
+			const_cast<Generic *>(this)->recorder.record_write(
+			  chipSelects, data, length);
+		}
+
+		void blocking_read(uint8_t data[], uint16_t length) volatile
+		{
+			const_cast<Generic *>(this)->recorder.record_read(
+			  chipSelects, data, length);
+		}
+	};
+
+	using Lcd         = Generic;
+	using EthernetMac = Generic;
+	using Flash       = Generic;
+} // namespace SonataSpi
@@ -0,0 +1,69 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cdefs.h>
+#include <chrono>
+#include <stdint.h>
+
+/**
+ * Host stand-ins for the scheduler's interfaces. Waiting doesn't take any
+ * real time, but is added up so that tests can check how long code would
+ * have waited for.
+ */
+namespace sonata::mock
+{
+	struct Clock
+	{
+		uint64_t waitedMilliseconds = 0;
+		uint64_t sleptTicks         = 0;
+	};
+
+	inline Clock &clock()
+	{
+		static Clock clock;
+		return clock;
+	}
+} // namespace sonata::mock
+
+struct Timeout
+{
+	uint64_t elapsed = 0;
+	uint64_t remaining;
+
+	Timeout(uint64_t remaining) : remaining(remaining) {}
+
+	bool may_block() const
+	{
+		return remaining > 0;
+	}
+};
+
+inline int thread_sleep(Timeout *timeout, uint32_t flags = 0)
+{
+	sonata::mock::clock().sleptTicks += timeout->remaining;
+	timeout->elapsed += timeout->remaining;
+	timeout->remaining = 0;
+	return 0;
+}
+
+inline void thread_millisecond_wait(uint32_t milliseconds)
+{
+	sonata::mock::clock().waitedMilliseconds += milliseconds;
+}
+
+inline uint16_t thread_id_get()
+{
+	return 1;
+}
+
+/**
+ * Returns the time in nanoseconds, which stands in for the cycle counter.
+ */
+inline uint64_t rdcycle64()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+	         std::chrono::steady_clock::now().time_since_epoch())
+	  .count();
+}
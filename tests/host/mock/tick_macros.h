@@ -0,0 +1,7 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+/// The mock scheduler counts time in milliseconds, so a tick is one.
+#define MS_TO_TICKS(x) (x)
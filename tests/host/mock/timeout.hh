@@ -0,0 +1,17 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+#include <thread.h>
+
+static constexpr uint64_t UnlimitedTimeout = UINT32_MAX;
+
+/// Calls `Fn` with a timeout that never expires.
+template<auto Fn, typename... Args>
+auto blocking_forever(Args... arguments)
+{
+	Timeout timeout{UnlimitedTimeout};
+	return Fn(&timeout, arguments...);
+}
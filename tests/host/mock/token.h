@@ -0,0 +1,88 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cdefs.h>
+#include <map>
+#include <new>
+#include <thread.h>
+#include <utility>
+
+/*
+ * Host stand-ins for the allocator's sealing tokens. A sealed object is an
+ * ordinary heap object that is recorded against the key it was sealed with,
+ * so that unsealing with another key, or after the object is destroyed,
+ * fails as it would on Sonata.
+ */
+
+struct TokenKeyType;
+using SKey                = TokenKeyType *;
+using AllocatorCapability = void *;
+
+#define MALLOC_CAPABILITY nullptr
+
+namespace sonata::mock
+{
+	inline std::map<const void *, SKey> &sealed_objects()
+	{
+		static std::map<const void *, SKey> objects;
+		return objects;
+	}
+} // namespace sonata::mock
+
+inline SKey token_key_new()
+{
+	static uintptr_t keys = 0;
+	return reinterpret_cast<SKey>(++keys);
+}
+
+template<typename T>
+class Sealed
+{
+	T *pointer;
+
+	public:
+	Sealed(T *pointer = nullptr) : pointer(pointer) {}
+
+	T *get() const
+	{
+		return pointer;
+	}
+
+	bool is_valid() const
+	{
+		return pointer != nullptr;
+	}
+};
+
+template<typename T>
+std::pair<T *, Sealed<T>>
+token_allocate(Timeout *timeout, AllocatorCapability heap, SKey key)
+{
+	T *object = new T{};
+
+	sonata::mock::sealed_objects()[object] = key;
+	return {object, Sealed<T>{object}};
+}
+
+template<typename T>
+T *token_unseal(SKey key, Sealed<T> sealed)
+{
+	auto &objects = sonata::mock::sealed_objects();
+	auto  found   = objects.find(sealed.get());
+	return found != objects.end() && found->second == key ? sealed.get()
+	                                                       : nullptr;
+}
+
+template<typename T>
+int token_obj_destroy(AllocatorCapability heap, SKey key, T *object)
+{
+	if (token_unseal(key, Sealed<T>{object}) == nullptr)
+	{
+		return -1;
+	}
+	sonata::mock::sealed_objects().erase(object);
+	delete object;
+	return 0;
+}
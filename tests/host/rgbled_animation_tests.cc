@@ -0,0 +1,116 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "rgbled_animation_tests.hh"
+#include "../../libraries/rgbled_animation.hh"
+#include "host_test.hh"
+
+using namespace sonata::rgbled;
+using sonata::test::check;
+
+static bool same(RgbLedColour a, RgbLedColour b)
+{
+	return a.red == b.red && a.green == b.green && a.blue == b.blue;
+}
+
+static bool easing_test()
+{
+	const RgbLedEasing Easings[] = {RgbLedEasing::Linear,
+	                                RgbLedEasing::EaseIn,
+	                                RgbLedEasing::EaseOut,
+	                                RgbLedEasing::EaseInOut};
+	for (RgbLedEasing easing : Easings)
+	{
+		Progress last = 0;
+		for (Progress t = 0; t <= ProgressOne; t += ProgressOne / 64)
+		{
+			const Progress Eased = ease(easing, t);
+			if (!check(Eased >= last && Eased <= ProgressOne,
+			           "easing rises from zero to one"))
+			{
+				return false;
+			}
+			last = Eased;
+		}
+		if (!check(ease(easing, 0) == 0 && ease(easing, ProgressOne) ==
+		                                     ProgressOne,
+		           "easing starts at zero and ends at one"))
+		{
+			return false;
+		}
+	}
+	const Progress Half = ProgressOne / 2;
+	return check(ease(RgbLedEasing::EaseIn, Half) < Half &&
+	               ease(RgbLedEasing::EaseOut, Half) > Half &&
+	               ease(RgbLedEasing::EaseInOut, Half) == Half,
+	             "easing curves bend the right way") &&
+	       check(ease(RgbLedEasing::Step, ProgressOne - 1) == 0,
+	             "stepping waits for the end");
+}
+
+static bool gamma_test()
+{
+	constexpr GammaTable Table(64);
+	static_assert(Table.levels[0] == 0 && Table.levels[255] == 64);
+	bool rising = true;
+	for (size_t i = 1; i < 256; i++)
+	{
+		rising &= Table.levels[i] >= Table.levels[i - 1];
+	}
+	return check(rising, "levels never fall as brightness rises") &&
+	       check(Table.levels[128] < 32,
+	             "half brightness is driven at less than half the level");
+}
+
+static bool keyframe_test()
+{
+	const RgbLedKeyframe Keyframes[] = {
+	  {{200, 0, 0}, 100},
+	  {{200, 0, 100}, 0},
+	  {{0, 0, 0}, 50, RgbLedEasing::Step},
+	};
+	Animation animation;
+	animation.start(Keyframes, 3, false);
+	if (!check(same(animation.advance(50), {100, 0, 0}),
+	           "the first fade is half way after half its duration") ||
+	    !check(same(animation.advance(50), {200, 0, 100}),
+	           "keyframes with no duration are jumped to") ||
+	    !check(same(animation.advance(49), {200, 0, 100}),
+	           "stepping keeps the colour until the end") ||
+	    !check(animation.running(), "the animation is still running"))
+	{
+		return false;
+	}
+	return check(same(animation.advance(1), {0, 0, 0}),
+	             "the last keyframe is reached") &&
+	       check(!animation.running(), "the animation has finished") &&
+	       check(same(animation.advance(1000), {0, 0, 0}),
+	             "a finished animation holds its colour");
+}
+
+static bool loop_test()
+{
+	const RgbLedKeyframe Keyframes[] = {
+	  {{0, 100, 0}, 100},
+	  {{0, 0, 0}, 100},
+	};
+	Animation animation;
+	animation.start(Keyframes, 2, true);
+	animation.advance(100);
+	const RgbLedColour Restarted = animation.advance(250);
+	animation.start(Keyframes + 1, 1, false);
+	return check(same(Restarted, {0, 50, 0}), "looping animations restart") &&
+	       check(same(animation.advance(50), {0, 25, 0}),
+	             "new animations start from the current colour");
+}
+
+bool rgbled_animation_tests()
+{
+	const sonata::test::TestCase Tests[] = {
+	  {"RGB LED animation easing test", easing_test},
+	  {"RGB LED animation gamma test", gamma_test},
+	  {"RGB LED animation keyframe test", keyframe_test},
+	  {"RGB LED animation loop test", loop_test},
+	};
+	return sonata::test::run_tests(Tests);
+}
@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Tests the RGB LED animation easing, gamma correction and keyframes.
+bool rgbled_animation_tests();
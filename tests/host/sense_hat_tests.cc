@@ -0,0 +1,164 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "sense_hat_tests.hh"
+#include "../../libraries/sense_hat.hh"
+#include "host_test.hh"
+#include <compartment.h>
+#include <platform-i2c.hh>
+
+using sonata::mock::Transaction;
+using sonata::test::check;
+
+/// The I2C address of the Sense HAT's LED matrix controller.
+static constexpr uint8_t LedMatrixAddress = 0x46;
+
+static OpenTitanI2c *i2c()
+{
+	return MMIO_CAPABILITY(OpenTitanI2c, i2c1);
+}
+
+static void reset_i2c()
+{
+	*i2c() = OpenTitanI2c{};
+}
+
+static bool init_test()
+{
+	reset_i2c();
+	i2c()->control          = OpenTitanI2c::ControlEnableTarget;
+	i2c()->controllerHalted = true;
+
+	SenseHat senseHat;
+	return check(!i2c()->controllerHalted, "controller halt is cleared") &&
+	       check(i2c()->control == OpenTitanI2c::ControlEnableHost,
+	             "only host mode is enabled") &&
+	       check(i2c()->fifoResets == 1, "FIFOs are reset") &&
+	       check(i2c()->speedKhz == 100, "speed is 100 kHz") &&
+	       check(i2c()->recorder.transactions.empty(), "nothing is sent");
+}
+
+static bool set_pixels_test()
+{
+	reset_i2c();
+	SenseHat         senseHat;
+	SenseHat::Colour pixels[64];
+	for (uint8_t i = 0; i < 64; i++)
+	{
+		pixels[i] = {static_cast<uint8_t>(i % 32),
+		             static_cast<uint8_t>(i % 64),
+		             static_cast<uint8_t>(31 - i % 32)};
+	}
+	if (!check(senseHat.set_pixels(pixels), "set_pixels succeeds"))
+	{
+		return false;
+	}
+
+	auto &transactions = i2c()->recorder.transactions;
+	if (!check(transactions.size() == 1, "one transaction is made"))
+	{
+		return false;
+	}
+	const Transaction &Write = transactions[0];
+	if (!check(Write.kind == Transaction::Kind::Write &&
+	             Write.target == LedMatrixAddress,
+	           "the LED matrix is written to") ||
+	    !check(Write.data.size() == 1 + 64 * 3, "the whole matrix is sent") ||
+	    !check(Write.data[0] == 0, "the write starts at address zero") ||
+	    !check(Write.stop, "the frame ends with a stop"))
+	{
+		return false;
+	}
+	// Each row is sent as eight red values, then eight green and eight blue.
+	for (uint32_t row = 0; row < 8; row++)
+	{
+		for (uint32_t column = 0; column < 8; column++)
+		{
+			const SenseHat::Colour &Pixel   = pixels[row * 8 + column];
+			const uint8_t          *rowData = &Write.data[1 + row * 24];
+			if (!check(rowData[column] == Pixel.red &&
+			             rowData[8 + column] == Pixel.green &&
+			             rowData[16 + column] == Pixel.blue,
+			           "pixels are sent in row, then colour, order"))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static bool set_pixels_bitboard_test()
+{
+	reset_i2c();
+	SenseHat               senseHat;
+	const SenseHat::Colour On     = {31, 63, 31};
+	const SenseHat::Colour Off    = {1, 2, 3};
+	const uint64_t         Pixels = 0x8000'0000'0000'0081;
+	if (!check(senseHat.set_pixels(Pixels, On, Off), "set_pixels succeeds"))
+	{
+		return false;
+	}
+
+	auto &transactions = i2c()->recorder.transactions;
+	if (!check(transactions.size() == 1 &&
+	             transactions[0].data.size() == 1 + 64 * 3,
+	           "the whole matrix is sent at once"))
+	{
+		return false;
+	}
+	const uint8_t *data = &transactions[0].data[1];
+	for (uint32_t row = 0; row < 8; row++)
+	{
+		for (uint32_t column = 0; column < 8; column++)
+		{
+			const SenseHat::Colour &Expected =
+			  ((Pixels >> (row * 8 + column)) & 1) ? On : Off;
+			const uint8_t          *rowData  = &data[row * 24];
+			if (!check(rowData[column] == Expected.red &&
+			             rowData[8 + column] == Expected.green &&
+			             rowData[16 + column] == Expected.blue,
+			           "set bits are on and clear bits are off"))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static bool colour_range_test()
+{
+	reset_i2c();
+	SenseHat         senseHat;
+	SenseHat::Colour pixels[64] = {};
+	pixels[9].green             = SenseHat::Colour::MaxGreenValue + 1;
+	return check(!senseHat.set_pixels(pixels),
+	             "out of range colours are rejected") &&
+	       check(!senseHat.set_pixels(1, pixels[9], pixels[0]),
+	             "out of range bitboard colours are rejected") &&
+	       check(i2c()->recorder.transactions.empty(),
+	             "nothing is sent for out of range colours");
+}
+
+static bool missing_device_test()
+{
+	reset_i2c();
+	i2c()->absentAddresses.insert(LedMatrixAddress);
+	SenseHat         senseHat;
+	SenseHat::Colour pixels[64] = {};
+	return check(!senseHat.set_pixels(pixels),
+	             "a missing Sense HAT is reported");
+}
+
+bool sense_hat_tests()
+{
+	const sonata::test::TestCase Tests[] = {
+	  {"Sense HAT init test", init_test},
+	  {"Sense HAT set pixels test", set_pixels_test},
+	  {"Sense HAT set pixels bitboard test", set_pixels_bitboard_test},
+	  {"Sense HAT colour range test", colour_range_test},
+	  {"Sense HAT missing device test", missing_device_test},
+	};
+	return sonata::test::run_tests(Tests);
+}
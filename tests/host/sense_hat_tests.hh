@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Tests the Sense HAT LED matrix driver against a mock I2C controller.
+bool sense_hat_tests();
@@ -0,0 +1,113 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "text_scroller_tests.hh"
+#include "../../libraries/text_scroller.hh"
+#include "host_test.hh"
+
+using namespace sonata::text_scroller;
+using sonata::test::check;
+
+/**
+ * A made up font, in which a letter's glyph is as many columns wide as its
+ * distance from 'a', plus one, and every other character is fully lit.
+ */
+static constexpr uint8_t glyph_row(char character, size_t row)
+{
+	if (character == ' ' || row == 0)
+	{
+		return 0;
+	}
+	if (character >= 'a' && character <= 'z')
+	{
+		return static_cast<uint8_t>((1u << (character - 'a' + 1)) - 1);
+	}
+	return 0xFF;
+}
+
+/// Lays text out a frame at a time, as the Sense HAT demo used to.
+struct Reference
+{
+	const char *text;
+	size_t      index  = 0;
+	size_t      column = 0;
+	uint64_t    board  = 0;
+
+	void step()
+	{
+		if (text[index] == '\0')
+		{
+			index = 0;
+		}
+		const char Character = text[index];
+		board                = (board >> 1) & ~0x8080808080808080;
+		bool empty           = true;
+		for (size_t y = 0; y < 8; y++)
+		{
+			if ((glyph_row(Character, y) >> column) & 1)
+			{
+				board |= uint64_t{1} << (y * 8 + 7);
+				empty = false;
+			}
+		}
+		if ((empty && Character != ' ') || column == MaxGlyphWidth - 1)
+		{
+			index++;
+			column = 0;
+		}
+		else
+		{
+			column++;
+		}
+	}
+};
+
+static bool glyph_width_test()
+{
+	constexpr ColumnStream<32> Text("ac -", glyph_row);
+	// Glyphs end after their first gap, and spaces are always full width.
+	static_assert(Text.size() == 2 + 4 + 7 + 7);
+	return check(Text.column(0) == 0xFE && Text.column(1) == 0,
+	             "a glyph's columns are followed by a gap") &&
+	       check(Text.column(13) == 0xFE && Text.column(19) == 0xFE,
+	             "a glyph with no gap is cut off") &&
+	       check(Text.column(Text.size()) == Text.column(0),
+	             "the stream repeats");
+}
+
+static bool truncation_test()
+{
+	const ColumnStream<5> Text("zzz", glyph_row);
+	return check(Text.size() == 5, "text that doesn't fit is cut off");
+}
+
+static bool reference_test()
+{
+	static constexpr char Text[] = "Sonata <3 abc! ";
+	const ColumnStream<sizeof(Text) * MaxGlyphWidth> Columns(Text, glyph_row);
+	Reference                                        reference{Text};
+	uint64_t                                         board = 0;
+	for (size_t frame = 0; frame < Columns.size() * 3; frame++)
+	{
+		reference.step();
+		board = slide(board, Columns.column(frame));
+		if (!check(board == reference.board,
+		           "scrolling matches laying out each frame") ||
+		    (frame >= 7 && !check(board == Columns.board(frame - 7),
+		                          "a window can be taken at any offset")))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool text_scroller_tests()
+{
+	const sonata::test::TestCase Tests[] = {
+	  {"Text scroller glyph width test", glyph_width_test},
+	  {"Text scroller truncation test", truncation_test},
+	  {"Text scroller reference test", reference_test},
+	};
+	return sonata::test::run_tests(Tests);
+}
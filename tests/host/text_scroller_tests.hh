@@ -0,0 +1,5 @@
+// Copyright lowRISC Contributors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Tests laying out and scrolling text with the column stream.
+bool text_scroller_tests();
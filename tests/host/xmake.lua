@@ -0,0 +1,40 @@
+-- Copyright lowRISC Contributors.
+-- SPDX-License-Identifier: Apache-2.0
+
+-- Builds the libraries for the host, against the mock devices in `mock/`, so
+-- that they can be tested and benchmarked without Sonata or the simulator.
+set_project("Sonata Host Tests")
+set_languages("c11", "cxx20")
+set_warnings("all")
+add_rules("mode.release", "mode.debug")
+
+target("host_libraries")
+    set_kind("static")
+    add_includedirs("mock", {public = true})
+    -- The mock `rdcycle64` counts nanoseconds.
+    add_defines("CPU_TIMER_HZ=1000000000", {public = true})
+    add_includedirs("../../third_party/display_drivers/src/", {public = true})
+    add_files("../../third_party/display_drivers/src/core/lcd_base.c")
+    add_files("../../third_party/display_drivers/src/core/m3x6_16pt.c")
+    add_files("../../third_party/display_drivers/src/core/m5x7_16pt.c")
+    add_files("../../third_party/display_drivers/src/core/lucida_console_10pt.c")
+    add_files("../../third_party/display_drivers/src/core/lucida_console_12pt.c")
+    add_files("../../third_party/display_drivers/src/st7735/lcd_st7735.c")
+    add_files("../../libraries/lcd.cc")
+    add_files("../../libraries/gpio_input.cc")
+    add_files("../../libraries/i2c_bus.cc")
+    add_files("../../libraries/sense_hat.cc")
+    add_files("../../libraries/apds9960.cc")
+    add_files("../../libraries/ksz8851.cc")
+    add_files("../../examples/automotive/lib/*.c")
+
+target("host_tests")
+    set_kind("binary")
+    add_deps("host_libraries")
+    add_files("host_test_runner.cc")
+    add_files("*_tests.cc")
+
+target("host_benchmarks")
+    set_kind("binary")
+    add_deps("host_libraries")
+    add_files("host_benchmarks.cc")